@@ -79,11 +79,12 @@
   if( aktool_check_command( "test", argv[1] )) return aktool_test( argc, argv );
   if( aktool_check_command( "k", argv[1] )) return aktool_key( argc, argv );
   if( aktool_check_command( "key", argv[1] )) return aktool_key( argc, argv );
-
-/*
-    if( aktool_check_command( "i", argv[1] )) return aktool_icode( argc, argv );
-    if( aktool_check_command( "icode", argv[1] )) return aktool_icode( argc, argv );
- */
+  if( aktool_check_command( "i", argv[1] )) return aktool_icode( argc, argv );
+  if( aktool_check_command( "icode", argv[1] )) return aktool_icode( argc, argv );
+  if( aktool_check_command( "e", argv[1] )) return aktool_encrypt( argc, argv );
+  if( aktool_check_command( "encrypt", argv[1] )) return aktool_encrypt( argc, argv );
+  if( aktool_check_command( "d", argv[1] )) return aktool_decrypt( argc, argv );
+  if( aktool_check_command( "decrypt", argv[1] )) return aktool_decrypt( argc, argv );
 
  /* ничего не подошло, выводим сообщение об ошибке */
   ak_log_set_function( ak_function_log_stderr );
@@ -181,6 +182,26 @@
 /* ----------------------------------------------------------------------------------------------- */
  int aktool_destroy_libakrypt( void ) { return ak_libakrypt_destroy(); }
 
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_load_user_password( char *password, const size_t pass_size )
+{
+  int error = ak_error_ok;
+  char buffer[aktool_password_max_length];
+
+  fprintf( stdout, _("password: ")); fflush( stdout );
+  error = ak_password_read( buffer, sizeof( buffer ));
+  fprintf( stdout, "\n" );
+
+  if( error == ak_error_ok ) {
+    memset( password, 0, pass_size );
+    memcpy( password, buffer, ak_min( pass_size - 1, strlen( buffer )));
+    if( strlen( password ) == 0 ) error = ak_error_zero_length;
+  }
+  memset( buffer, 0, sizeof( buffer ));
+
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                                 реализация вывода справки                                       */
 /* ----------------------------------------------------------------------------------------------- */
@@ -224,6 +245,8 @@
   printf(_("  aktool command [options] [files]\n\n"));
   printf(_("available commands (in short and long forms):\n"));
   printf(_("  a, asn1parse  -  decode and print the ASN.1 data\n"));
+  printf(_("  d, decrypt    -  decrypt files created by encrypt command\n"));
+  printf(_("  e, encrypt    -  encrypt files with authentication of each segment\n"));
   printf(_("  i, icode      -  calculate or check integrity codes\n"));
   printf(_("  k, key        -  key generation and management functions\n"));
   printf(_("  s, show       -  show useful information\n"));
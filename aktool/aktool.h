@@ -53,6 +53,8 @@
  bool_t aktool_create_libakrypt( void );
 /* общий для всех подпрограмм запуск процедуры остановки билиотеки */
  int aktool_destroy_libakrypt( void );
+/* однократное чтение пароля пользователя с консоли */
+ int aktool_load_user_password( char * , const size_t );
 
 /* ----------------------------------------------------------------------------------------------- */
 /* реализации пользовательских команд */
@@ -60,6 +62,9 @@
  int aktool_test( int argc, tchar *argv[] );
  int aktool_asn1( int argc, tchar *argv[] );
  int aktool_key( int argc, tchar *argv[] );
+ int aktool_icode( int argc, tchar *argv[] );
+ int aktool_encrypt( int argc, tchar *argv[] );
+ int aktool_decrypt( int argc, tchar *argv[] );
 
  #endif
 /* ----------------------------------------------------------------------------------------------- */
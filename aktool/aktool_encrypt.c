@@ -0,0 +1,570 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Copyright (c) 2014 - 2020 by Axel Kenzo, axelkenzo@mail.ru                                     */
+/*                                                                                                 */
+/*  Файл aktool_encrypt.c                                                                          */
+/*  - содержит реализацию команд зашифрования и расшифрования файлов                               */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <aktool.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+/* - зашифрование файла с выработкой ключа из пароля
+       aktool e --password pass --output backup.bin backup.tar
+   - расшифрование всего файла
+       aktool d --password pass --output backup.tar backup.bin
+   - расшифрование одного сегмента (без обработки остальных сегментов файла)
+       aktool d --password pass --segment 17 --output segment.tar backup.bin                      */
+/* ----------------------------------------------------------------------------------------------- */
+/*  Формат зашифрованного файла: заголовок длины aktool_container_header_size октетов,
+    за которым следуют сегменты. Каждый сегмент содержит зашифрованные данные (длина всех
+    сегментов, кроме последнего, равна segment_size октетов) и имитовставку, длина которой
+    совпадает с длиной блока шифра.
+
+    Заголовок (все целые числа записываются в порядке little endian):
+      0   8 октетов  сигнатура aktool_container_magic
+      8   4 октета   длина сегмента
+     12   4 октета   количество итераций функции PBKDF2
+     16  32 октета   имя режима аутентифицированного шифрования (дополняется нулями)
+     48  32 октета   соль для выработки ключа из пароля
+     80  16 октетов  синхропосылка
+     96  32 октета   резерв (нули)
+
+    Для каждого сегмента с номером i вырабатываются собственные ключи шифрования
+    и имитозащиты, равные Стрибог512( K || i ), где K - 64 октета, выработанные из пароля
+    функцией PBKDF2. Смена ключей гарантирует, что ресурс ключа не будет исчерпан
+    при шифровании файлов произвольной длины. Синхропосылка сегмента получается сложением
+    по модулю два синхропосылки из заголовка и номера сегмента; ассоциированными данными
+    являются заголовок, номер сегмента и признак последнего сегмента, что исключает
+    перестановку, удаление и усечение сегментов.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+ #define aktool_container_magic               "akcrypt1"
+ #define aktool_container_header_size              (128)
+ #define aktool_container_segment_size         (1048576)
+ #define aktool_container_min_segment_size        (4096)
+ #define aktool_container_max_segment_size     (2097152)
+ #define aktool_container_adata_size ( aktool_container_header_size + 9 )
+ #define aktool_container_buffer_size ( aktool_container_adata_size + ci.segment_size + 16 )
+
+/* соль и синхропосылка не являются секретными, поэтому используется неблокирующий генератор */
+#if defined(__unix__) || defined(__APPLE__)
+ #define aktool_container_generator "dev-urandom"
+#else
+ #ifdef AK_HAVE_WINDOWS_H
+  #define aktool_container_generator "winrtl"
+ #else
+  #define aktool_container_generator "lcg"
+ #endif
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_encrypt_help( void );
+ int aktool_decrypt_help( void );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Данные, принадлежащие одному потоку пула. */
+ typedef struct container_worker {
+  /*! \brief Контекст функции хеширования для выработки ключей сегментов. */
+   struct hash hctx;
+  /*! \brief Ключ шифрования. */
+   ak_pointer ekey;
+  /*! \brief Ключ имитозащиты. */
+   ak_pointer akey;
+  /*! \brief Буффер для ассоциированных данных, одного сегмента и его имитовставки. */
+   ak_uint8 *buffer;
+ } *container_worker;
+
+/* ----------------------------------------------------------------------------------------------- */
+ static struct container_info {
+   ak_oid mode;
+   bool_t encrypt;
+   size_t segment_size, tag_size, iterations;
+   ak_int64 segment;
+   ak_uint64 count, first, last;
+   ak_uint8 header[aktool_container_header_size];
+   ak_uint8 master[64];
+   struct file in, out;
+   container_worker workers;
+   size_t workers_count;
+   char password[aktool_password_max_length];
+   char output_file[FILENAME_MAX];
+ } ci;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                       служебные функции                                         */
+/* ----------------------------------------------------------------------------------------------- */
+ static void aktool_encrypt_store( ak_uint8 *out, ak_uint64 value, const size_t size )
+{
+  size_t i = 0;
+  for( i = 0; i < size; i++, value >>= 8 ) out[i] = ( ak_uint8 )( value&0xFF );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint64 aktool_encrypt_load( const ak_uint8 *in, const size_t size )
+{
+  size_t i = size;
+  ak_uint64 value = 0;
+  while( i-- > 0 ) value = ( value << 8 )^in[i];
+ return value;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция считывает из файла ровно `size` октетов, начиная с заданного смещения. */
+ static int aktool_encrypt_read( ak_file file, ak_uint8 *buffer, size_t size, ak_int64 offset )
+{
+  while( size > 0 ) {
+    ssize_t len = ak_file_pread( file, buffer, size, offset );
+    if( len <= 0 ) return ak_error_read_data;
+    buffer += len; size -= ( size_t )len; offset += len;
+  }
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция записывает в файл ровно `size` октетов, начиная с заданного смещения. */
+ static int aktool_encrypt_write( ak_file file, ak_uint8 *buffer, size_t size, ak_int64 offset )
+{
+  while( size > 0 ) {
+    ssize_t len = ak_file_pwrite( file, buffer, size, offset );
+    if( len <= 0 ) return ak_error_write_data;
+    buffer += len; size -= ( size_t )len; offset += len;
+  }
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                  ключи и контексты рабочих потоков                              */
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_encrypt_create_workers( void )
+{
+  size_t i = 0;
+  container_worker worker = NULL;
+
+  ci.workers_count = ak_thread_pool_size() + 1;
+  if(( ci.workers = calloc( ci.workers_count, sizeof( struct container_worker ))) == NULL ) {
+    aktool_error(_("out of memory"));
+    return ak_error_out_of_memory;
+  }
+  for( i = 0, worker = ci.workers; i < ci.workers_count; i++, worker++ ) {
+     if(( worker->buffer = malloc( aktool_container_buffer_size )) == NULL ) break;
+     if( ak_hash_create_streebog512( &worker->hctx ) != ak_error_ok ) {
+       free( worker->buffer );
+       worker->buffer = NULL;
+       break;
+     }
+     if(( worker->ekey = ak_oid_new_object( ci.mode )) == NULL ) break;
+     if(( worker->akey = ak_oid_new_second_object( ci.mode )) == NULL ) break;
+  }
+  if( i < ci.workers_count ) {
+    aktool_error(_("incorrect creation of \"%s\" keys"), ci.mode->name[0] );
+    return ak_error_out_of_memory;
+  }
+  ci.tag_size = (( ak_bckey ) ci.workers[0].ekey )->bsize;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void aktool_encrypt_destroy_workers( void )
+{
+  size_t i = 0;
+  container_worker worker = ci.workers;
+
+  if( worker == NULL ) return;
+  for( i = 0; i < ci.workers_count; i++, worker++ ) {
+     if( worker->ekey != NULL ) ak_oid_delete_object( ci.mode, worker->ekey );
+     if( worker->akey != NULL ) ak_oid_delete_second_object( ci.mode, worker->akey );
+     if( worker->buffer != NULL ) {
+       memset( worker->buffer, 0, aktool_container_buffer_size );
+       free( worker->buffer );
+       ak_hash_destroy( &worker->hctx );
+     }
+  }
+  free( ci.workers );
+  ci.workers = NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция проверяет, что режим является режимом аутентифицированного шифрования,
+    оба ключа которого являются ключами блочного шифра (mgm или ctr-cmac). */
+ static bool_t aktool_encrypt_check_mode( ak_oid mode )
+{
+  if( mode == NULL ) return ak_false;
+  if(( mode->engine != block_cipher ) || ( mode->mode != aead )) return ak_false;
+  if( mode->func.second.size != sizeof( struct bckey )) return ak_false;
+ return ak_true;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                 обработка одного сегмента файла                                 */
+/* ----------------------------------------------------------------------------------------------- */
+/*! Задание пула потоков: чтение, зашифрование (расшифрование) и запись одного сегмента.
+    Поскольку положение каждого сегмента в файле определяется его номером, потоки обрабатывают
+    сегменты независимо друг от друга, а объем используемой памяти не зависит от длины файла.     */
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_encrypt_task( ak_pointer ptr, const size_t task, const size_t thread )
+{
+  size_t i = 0;
+  int error = ak_error_ok;
+  container_worker worker = ci.workers + thread;
+  ak_uint64 index = ci.first + task;
+  size_t len = ( index == ci.count - 1 ) ? ci.last : ci.segment_size;
+  ak_int64 cpos = aktool_container_header_size +
+                                     ( ak_int64 )( index*( ci.segment_size + ci.tag_size )),
+           ppos = ( ci.segment < 0 ) ? ( ak_int64 )( index*ci.segment_size ) : 0;
+  ak_uint8 keys[64], seed[72], iv[16], *adata = worker->buffer,
+                                                  *data = worker->buffer + aktool_container_adata_size;
+  (void) ptr;
+
+ /* считываем сегмент */
+  if( ci.encrypt ) error = aktool_encrypt_read( &ci.in, data, len, ppos );
+   else error = aktool_encrypt_read( &ci.in, data, len + ci.tag_size, cpos );
+  if( error != ak_error_ok ) return ak_error_message_fmt( error, __func__,
+                                    "incorrect reading of segment %llu", (unsigned long long) index );
+
+ /* вырабатываем ключи, синхропосылку и ассоциированные данные сегмента */
+  memcpy( seed, ci.master, 64 );
+  aktool_encrypt_store( seed + 64, index, 8 );
+  error = ak_hash_ptr( &worker->hctx, seed, sizeof( seed ), keys, sizeof( keys ));
+  if( error == ak_error_ok ) error = ci.mode->func.first.set_key( worker->ekey, keys, 32 );
+  if( error == ak_error_ok ) error = ci.mode->func.second.set_key( worker->akey, keys + 32, 32 );
+  memset( seed, 0, sizeof( seed ));
+  memset( keys, 0, sizeof( keys ));
+  if( error != ak_error_ok ) return ak_error_message( error, __func__,
+                                                         "incorrect creation of segment keys" );
+  memcpy( iv, ci.header + 80, 16 );
+  for( i = 0; i < 8; i++ ) iv[i] ^= ( ak_uint8 )( index >> ( i << 3 ));
+
+  memcpy( adata, ci.header, aktool_container_header_size );
+  aktool_encrypt_store( adata + aktool_container_header_size, index, 8 );
+  adata[aktool_container_header_size + 8] = ( index == ci.count - 1 );
+
+ /* шифруем и записываем результат */
+  if( ci.encrypt ) {
+    if(( error = ci.mode->func.direct( worker->ekey, worker->akey,
+                           adata, aktool_container_adata_size, data, data, len, iv, ci.tag_size,
+                                                   data + len, ci.tag_size )) == ak_error_ok )
+      error = aktool_encrypt_write( &ci.out, data, len + ci.tag_size, cpos );
+  } else {
+      if(( error = ci.mode->func.invert( worker->ekey, worker->akey,
+                           adata, aktool_container_adata_size, data, data, len, iv, ci.tag_size,
+                                                   data + len, ci.tag_size )) == ak_error_ok )
+        error = aktool_encrypt_write( &ci.out, data, len, ppos );
+       else if( error == ak_error_not_equal_data ) {
+         aktool_error(_("segment %llu is damaged or the password is wrong"),
+                                                                     (unsigned long long) index );
+       }
+    }
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                   формирование заголовка файла                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_encrypt_create_header( void )
+{
+  int error = ak_error_ok;
+  ak_random generator = NULL;
+  ak_oid oid = ak_oid_find_by_name( aktool_container_generator );
+
+  memset( ci.header, 0, sizeof( ci.header ));
+  memcpy( ci.header, aktool_container_magic, 8 );
+  aktool_encrypt_store( ci.header + 8, ci.segment_size, 4 );
+  aktool_encrypt_store( ci.header + 12, ci.iterations, 4 );
+  memcpy( ci.header + 16, ci.mode->name[0], ak_min( 31, strlen( ci.mode->name[0] )));
+
+ /* соль и синхропосылка вырабатываются случайно */
+  if(( oid == NULL ) || (( generator = ak_oid_new_object( oid )) == NULL )) {
+    aktool_error(_("incorrect creation of random generator"));
+    return ak_error_get_value();
+  }
+  error = ak_random_ptr( generator, ci.header + 48, 48 );
+  ak_oid_delete_object( oid, generator );
+  if( error != ak_error_ok ) aktool_error(_("incorrect generation of random values"));
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_encrypt_parse_header( void )
+{
+  char name[33];
+
+  if( aktool_encrypt_read( &ci.in, ci.header, aktool_container_header_size, 0 ) != ak_error_ok )
+    return ak_error_read_data;
+  if( memcmp( ci.header, aktool_container_magic, 8 ) != 0 ) return ak_error_undefined_value;
+
+  ci.segment_size = ( size_t ) aktool_encrypt_load( ci.header + 8, 4 );
+  ci.iterations = ( size_t ) aktool_encrypt_load( ci.header + 12, 4 );
+  if(( ci.segment_size < aktool_container_min_segment_size ) ||
+     ( ci.segment_size > aktool_container_max_segment_size ) || ( ci.iterations == 0 ))
+    return ak_error_wrong_length;
+
+  memset( name, 0, sizeof( name ));
+  memcpy( name, ci.header + 16, 32 );
+  if( !aktool_encrypt_check_mode( ci.mode = ak_oid_find_by_name( name )))
+    return ak_error_oid_name;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет количество сегментов и длину последнего сегмента. */
+ static int aktool_encrypt_layout( void )
+{
+  ak_uint64 body = 0, unit = 0;
+
+  if( ci.encrypt ) {
+    body = ( ak_uint64 ) ci.in.size;
+    ci.count = body ? ( body + ci.segment_size - 1 )/ci.segment_size : 1;
+    ci.last = body - ( ci.count - 1 )*ci.segment_size;
+    return ak_error_ok;
+  }
+
+  if( ci.in.size < aktool_container_header_size + ( ak_int64 )ci.tag_size )
+    return ak_error_wrong_length;
+  body = ( ak_uint64 )ci.in.size - aktool_container_header_size;
+  unit = ci.segment_size + ci.tag_size;
+  ci.count = ( body + unit - 1 )/unit;
+  if( body - ( ci.count - 1 )*unit < ci.tag_size ) return ak_error_wrong_length;
+  ci.last = body - ( ci.count - 1 )*unit - ci.tag_size;
+  if(( ci.count > 1 ) && ( ci.last == 0 )) return ak_error_wrong_length;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                   общая часть обеих команд                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_encrypt_run( const char *filename )
+{
+  int error = ak_error_ok, exit_status = EXIT_FAILURE;
+  bool_t created = ak_false;
+
+  if(( error = ak_file_open_to_read( &ci.in, filename )) != ak_error_ok ) {
+    aktool_error(_("incorrect opening of file \"%s\""), filename );
+    return EXIT_FAILURE;
+  }
+  if( !ci.encrypt && (( error = aktool_encrypt_parse_header()) != ak_error_ok )) {
+    aktool_error(_("file \"%s\" has unsupported format"), filename );
+    goto labex;
+  }
+  if( strlen( ci.password ) == 0 ) {
+    if( aktool_load_user_password( ci.password, sizeof( ci.password )) != ak_error_ok ) {
+      aktool_error(_("incorrect password"));
+      goto labex;
+    }
+  }
+  if( aktool_encrypt_create_workers() != ak_error_ok ) goto labex;
+  if( ci.encrypt && ( aktool_encrypt_create_header() != ak_error_ok )) goto labex;
+  if( aktool_encrypt_layout() != ak_error_ok ) {
+    aktool_error(_("file \"%s\" is truncated"), filename );
+    goto labex;
+  }
+
+ /* ключевая информация вырабатывается один раз, сегментные ключи - из нее */
+  if(( error = ak_hmac_pbkdf2_streebog512( ci.password, strlen( ci.password ),
+           ci.header + 48, 32, ci.iterations, sizeof( ci.master ), ci.master )) != ak_error_ok ) {
+    aktool_error(_("incorrect creation of secret key from password"));
+    goto labex;
+  }
+
+ /* выбираем сегменты для обработки */
+  ci.first = 0;
+  if( ci.segment >= 0 ) {
+    if(( ak_uint64 ) ci.segment >= ci.count ) {
+      aktool_error(_("file \"%s\" contains only %llu segments"), filename,
+                                                                   (unsigned long long) ci.count );
+      goto labex;
+    }
+    ci.first = ( ak_uint64 ) ci.segment;
+  }
+
+  if(( error = ak_file_create_to_write( &ci.out, ci.output_file )) != ak_error_ok ) {
+    aktool_error(_("incorrect creation of file \"%s\""), ci.output_file );
+    goto labex;
+  }
+  created = ak_true;
+  if( ci.encrypt &&
+     ( aktool_encrypt_write( &ci.out, ci.header, aktool_container_header_size, 0 ) != ak_error_ok ))
+    goto labex;
+
+  if(( error = ak_thread_pool_run( aktool_encrypt_task, NULL,
+                                         ci.segment < 0 ? ci.count : 1 )) == ak_error_ok )
+    exit_status = EXIT_SUCCESS;
+   else aktool_error(_("incorrect processing of file \"%s\" (code: %d)"), filename, error );
+
+  labex:
+   if( created ) {
+     ak_file_close( &ci.out );
+    /* неполный результат не сохраняется */
+     if( exit_status != EXIT_SUCCESS ) remove( ci.output_file );
+   }
+   ak_file_close( &ci.in );
+   aktool_encrypt_destroy_workers();
+   memset( ci.master, 0, sizeof( ci.master ));
+
+ return exit_status;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_encrypt_command( int argc, tchar *argv[], bool_t encrypt )
+{
+  ak_int64 value = 0;
+  int next_option = 0, exit_status = EXIT_FAILURE;
+  char *mode = "mgm-kuznechik";
+
+  const struct option long_options[] = {
+     { "mode",             1, NULL, 'm' },
+     { "output",           1, NULL, 'o' },
+     { "password",         1, NULL, 255 },
+     { "segment-size",     1, NULL, 254 },
+     { "segment",          1, NULL, 253 },
+     { "threads",          1, NULL, 252 },
+
+     { "openssl-style",    0, NULL,   5 },
+     { "audit",            1, NULL,   4 },
+     { "dont-use-colors",  0, NULL,   3 },
+     { "audit-file",       1, NULL,   2 },
+     { "help",             0, NULL,   1 },
+     { NULL,               0, NULL,   0 }
+  };
+
+  memset( &ci, 0, sizeof( struct container_info ));
+  ci.encrypt = encrypt;
+  ci.segment = -1;
+  ci.segment_size = aktool_container_segment_size;
+
+ /* разбираем опции командной строки */
+  do {
+       next_option = getopt_long( argc, argv, "m:o:", long_options, NULL );
+       switch( next_option )
+      {
+        case  1  :   return encrypt ? aktool_encrypt_help() : aktool_decrypt_help();
+        case  2  : /* получили от пользователя имя файла для вывода аудита */
+                     aktool_set_audit( optarg );
+                     break;
+        case  3  : /* установка флага запрета вывода символов смены цветовой палитры */
+                     ak_error_set_color_output( ak_false );
+                     ak_libakrypt_set_option( "use_color_output", 0 );
+                     break;
+        case  4  : /* устанавливаем уровень аудита */
+                     aktool_log_level = atoi( optarg );
+                     break;
+        case  5  : /* переходим к стилю openssl */
+                     aktool_openssl_compability = ak_true;
+                     break;
+
+        case 'm' : /* режим аутентифицированного шифрования */
+                     mode = optarg;
+                     break;
+        case 'o' : /* имя файла для сохранения результата */
+                     strncpy( ci.output_file, optarg, sizeof( ci.output_file ) - 1 );
+                     break;
+
+        case 255 : /* пароль для выработки ключей */
+                     memset( ci.password, 0, sizeof( ci.password ));
+                     strncpy( ci.password, optarg, sizeof( ci.password ) - 1 );
+                     break;
+        case 254 : /* длина одного сегмента */
+                     value = atoll( optarg );
+                     if(( value < aktool_container_min_segment_size ) ||
+                                               ( value > aktool_container_max_segment_size )) {
+                       aktool_error(_("segment size must be between %d and %d octets"),
+                                aktool_container_min_segment_size, aktool_container_max_segment_size );
+                       return EXIT_FAILURE;
+                     }
+                     ci.segment_size = ( size_t ) value;
+                     break;
+        case 253 : /* номер расшифровываемого сегмента */
+                     if(( ci.segment = atoll( optarg )) < 0 ) {
+                       aktool_error(_("incorrect segment number \"%s\""), optarg );
+                       return EXIT_FAILURE;
+                     }
+                     break;
+        case 252 : /* количество рабочих потоков */
+                     ak_libakrypt_set_option( "thread_pool_size", atoi( optarg ));
+                     break;
+
+        default:   /* обрабатываем ошибочные параметры */
+                     if( next_option != -1 )
+                       return encrypt ? aktool_encrypt_help() : aktool_decrypt_help();
+                     break;
+       }
+   } while( next_option != -1 );
+
+ /* после разбора опций первым из оставшихся аргументов является имя команды */
+   if(( optind + 2 != argc ) || ( strlen( ci.output_file ) == 0 ))
+     return encrypt ? aktool_encrypt_help() : aktool_decrypt_help();
+   if( encrypt && ( ci.segment >= 0 )) {
+     aktool_error(_("option --segment can be used only for decryption"));
+     return EXIT_FAILURE;
+   }
+
+ /* начинаем работу с криптографическими примитивами */
+   if( !aktool_create_libakrypt( )) return EXIT_FAILURE;
+
+   if( encrypt ) {
+     if( !aktool_encrypt_check_mode( ci.mode = ak_oid_find_by_ni( mode ))) {
+       aktool_error(_("using unsupported authenticated encryption mode \"%s\""), mode );
+       goto labex;
+     }
+     ci.iterations = ( size_t ) ak_libakrypt_get_option_by_name( "pbkdf2_iteration_count" );
+   }
+   exit_status = aktool_encrypt_run( argv[optind + 1] );
+
+  labex:
+   memset( ci.password, 0, sizeof( ci.password ));
+   aktool_destroy_libakrypt();
+
+ return exit_status;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_encrypt( int argc, tchar *argv[] )
+{
+  return aktool_encrypt_command( argc, argv, ak_true );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_decrypt( int argc, tchar *argv[] )
+{
+  return aktool_encrypt_command( argc, argv, ak_false );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_encrypt_help( void )
+{
+  printf(
+   _("aktool encrypt [options] file  - encrypt file with authentication of each segment\n\n"
+     "available options:\n"
+     " -m, --mode <ni>         set the authenticated encryption mode (default: mgm-kuznechik)\n"
+     "                         mgm and ctr-cmac modes are supported\n"
+     " -o, --output <file>     name of encrypted file\n"
+     "     --password <pass>   password for secret keys generation\n"
+     "     --segment-size <n>  length of one segment in octets (default: %d)\n"
+     "     --threads <n>       set the number of worker threads\n\n"
+  ), aktool_container_segment_size );
+
+ return aktool_print_common_options();
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_decrypt_help( void )
+{
+  printf(
+   _("aktool decrypt [options] file  - decrypt file created by encrypt command\n\n"
+     "available options:\n"
+     " -o, --output <file>     name of decrypted file\n"
+     "     --password <pass>   password for secret keys generation\n"
+     "     --segment <n>       decrypt only one segment with given number (starting from zero)\n"
+     "     --threads <n>       set the number of worker threads\n\n"
+  ));
+
+ return aktool_print_common_options();
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                               aktool_encrypt.c  */
+/* ----------------------------------------------------------------------------------------------- */
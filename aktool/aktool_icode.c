@@ -0,0 +1,739 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Copyright (c) 2014 - 2020 by Axel Kenzo, axelkenzo@mail.ru                                     */
+/*                                                                                                 */
+/*  Файл aktool_icode.c                                                                            */
+/*  - содержит реализацию команды вычисления и проверки кодов целостности файлов                   */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <aktool.h>
+#ifdef AK_HAVE_SYSSTAT_H
+ #include <sys/stat.h>
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/* - вычисление кодов целостности всех файлов каталога с сохранением результата в файл
+       aktool icode -r --output manifest.txt /usr/lib
+   - проверка кодов целостности, сохраненных ранее
+       aktool icode --check manifest.txt
+   - вычисление имитовставок с использованием кеша неизмененных файлов
+       aktool icode -a hmac-streebog256 --cache icode.cache -r /usr/lib                            */
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_icode_help( void );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Максимальная длина строки файла с кодами целостности. */
+ #define aktool_icode_line_length ( FILENAME_MAX + 256 )
+/*! \brief Соль, используемая по-умолчанию при выработке ключа имитозащиты из пароля. */
+ #define aktool_icode_default_salt "aktool icode"
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Информация об одном обрабатываемом файле. */
+ typedef struct icode_entry {
+  /*! \brief Имя файла. */
+   char *name;
+  /*! \brief Вычисленный код целостности файла. */
+   ak_uint8 icode[64];
+  /*! \brief Код целостности, считанный из файла с контрольными суммами. */
+   ak_uint8 expected[64];
+  /*! \brief Номер индексного дескриптора файла. */
+   ak_uint64 inode;
+  /*! \brief Размер файла. */
+   ak_uint64 size;
+  /*! \brief Время последней модификации файла. */
+   ak_int64 mtime;
+  /*! \brief Время последнего изменения атрибутов файла (не может быть установлено
+      пользователем, в отличие от времени модификации). */
+   ak_int64 ctime;
+  /*! \brief Код ошибки, возникшей при обработке файла. */
+   int error;
+  /*! \brief Флаг того, что код целостности взят из кеша. */
+   bool_t cached;
+  /*! \brief Флаг того, что запись кеша заменяется вновь вычисленным значением. */
+   bool_t replaced;
+ } *icode_entry;
+
+/*! \brief Массив обрабатываемых файлов. */
+ typedef struct icode_list {
+  /*! \brief Элементы массива. */
+   struct icode_entry *entries;
+  /*! \brief Количество элементов. */
+   size_t count;
+  /*! \brief Количество элементов, под которые выделена память. */
+   size_t capacity;
+ } *icode_list;
+
+/* ----------------------------------------------------------------------------------------------- */
+ static struct icode_info {
+   ak_oid oid;
+   size_t tag_size;
+   ak_pointer *contexts;
+   size_t contexts_count;
+   bool_t serial, recursive, quiet, use_cache;
+   char *pattern;
+   char password[aktool_password_max_length];
+   size_t lenpass;
+   char salt[aktool_password_max_length];
+   char output_file[FILENAME_MAX];
+   char check_file[FILENAME_MAX];
+   char cache_file[FILENAME_MAX];
+   ak_uint8 check_value[64];
+   struct icode_list files;
+   struct icode_list cache;
+ } ic;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                               работа с массивом обрабатываемых файлов                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static icode_entry aktool_icode_list_add( icode_list list, const char *name )
+{
+  icode_entry entry = NULL;
+  size_t len = strlen( name );
+
+  if( list->count == list->capacity ) {
+    size_t capacity = list->capacity ? ( list->capacity << 1 ) : 1024;
+    if(( entry = realloc( list->entries, capacity*sizeof( struct icode_entry ))) == NULL )
+      return NULL;
+    list->entries = entry;
+    list->capacity = capacity;
+  }
+  entry = list->entries + list->count;
+  memset( entry, 0, sizeof( struct icode_entry ));
+  if(( entry->name = malloc( len + 1 )) == NULL ) return NULL;
+  memcpy( entry->name, name, len + 1 );
+  list->count++;
+
+ return entry;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void aktool_icode_list_free( icode_list list )
+{
+  size_t i = 0;
+  for( i = 0; i < list->count; i++ ) free( list->entries[i].name );
+  if( list->entries ) free( list->entries );
+  memset( list, 0, sizeof( struct icode_list ));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_icode_list_compare( const void *left, const void *right )
+{
+  return strcmp((( const struct icode_entry *) left )->name,
+                                                        (( const struct icode_entry *) right )->name );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вызывается функцией ak_file_find() для каждого найденного файла. */
+ static int aktool_icode_find_function( const tchar *filename, ak_pointer ptr )
+{
+  if( aktool_icode_list_add( ptr, filename ) == NULL ) return ak_error_out_of_memory;
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция добавляет в массив заданный пользователем файл или все файлы заданного каталога. */
+ static int aktool_icode_add_path( icode_list list, char *path )
+{
+  size_t len = strlen( path );
+
+  switch( ak_file_or_directory( path )) {
+    case DT_DIR:
+     /* удаляем завершающие разделители, чтобы не дублировать их в именах найденных файлов */
+      while(( len > 1 ) && (( path[len-1] == '/' ) || ( path[len-1] == '\\' ))) path[--len] = 0;
+      return ak_file_find( path, ic.pattern, aktool_icode_find_function, list, ic.recursive );
+
+    case DT_REG:
+      if( aktool_icode_list_add( list, path ) == NULL ) return ak_error_out_of_memory;
+      return ak_error_ok;
+
+    default:
+      aktool_error(_("incorrect access to \"%s\""), path );
+      return ak_error_access_file;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                             контексты алгоритмов для рабочих потоков                            */
+/* ----------------------------------------------------------------------------------------------- */
+/*! Каждый поток пула (и вызывающий поток) использует собственный контекст алгоритма.
+    Древовидные функции хеширования сами распределяют обработку одного файла по потокам пула,
+    поэтому для них файлы обрабатываются последовательно одним контекстом.                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_icode_create_contexts( void )
+{
+  size_t i = 0;
+  int error = ak_error_ok;
+
+  ic.serial = ( ic.oid->func.first.create ==
+                              ( ak_function_create_object *) ak_hash_create_streebog256_tree ) ||
+              ( ic.oid->func.first.create ==
+                              ( ak_function_create_object *) ak_hash_create_streebog512_tree );
+  ic.contexts_count = ic.serial ? 1 : ak_thread_pool_size() + 1;
+  if(( ic.contexts = calloc( ic.contexts_count, sizeof( ak_pointer ))) == NULL ) {
+    aktool_error(_("out of memory"));
+    return ak_error_out_of_memory;
+  }
+
+  for( i = 0; i < ic.contexts_count; i++ ) {
+     if(( ic.contexts[i] = ak_oid_new_object( ic.oid )) == NULL ) {
+       aktool_error(_("incorrect creation of \"%s\" context"), ic.oid->name[0] );
+       return ak_error_get_value();
+     }
+     if( ic.oid->engine == hmac_function ) {
+       if(( error = ak_hmac_set_key_from_password( ic.contexts[i], ic.password, ic.lenpass,
+                                                     ic.salt, strlen( ic.salt ))) != ak_error_ok ) {
+         aktool_error(_("incorrect creation of secret key from password"));
+         return error;
+       }
+     }
+  }
+
+ /* значение, по которому проверяется соответствие кеша алгоритму и ключу */
+  if( ic.oid->engine == hmac_function ) {
+    ic.tag_size = ak_hmac_get_tag_size( ic.contexts[0] );
+    error = ak_hmac_ptr( ic.contexts[0], aktool_icode_default_salt,
+                               strlen( aktool_icode_default_salt ), ic.check_value, ic.tag_size );
+  } else {
+      ic.tag_size = ak_hash_get_tag_size( ic.contexts[0] );
+      error = ak_hash_ptr( ic.contexts[0], aktool_icode_default_salt,
+                               strlen( aktool_icode_default_salt ), ic.check_value, ic.tag_size );
+    }
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void aktool_icode_destroy_contexts( void )
+{
+  size_t i = 0;
+
+  if( ic.contexts == NULL ) return;
+  for( i = 0; i < ic.contexts_count; i++ )
+     if( ic.contexts[i] != NULL ) ak_oid_delete_object( ic.oid, ic.contexts[i] );
+  free( ic.contexts );
+  ic.contexts = NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                 кеш кодов целостности (индексный дескриптор, размер, время)                     */
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет контрольное значение содержимого файла кеша: для алгоритмов hmac
+    используется ключ, выработанный из пароля, и содержимое кеша аутентифицируется;
+    для функций хеширования контрольное значение позволяет обнаружить только
+    случайное искажение кеша.                                                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_icode_cache_tag( const char *data, const size_t size, ak_uint8 *tag )
+{
+  if( ic.oid->engine == hmac_function )
+    return ak_hmac_ptr( ic.contexts[0], ( ak_pointer ) data, size, tag, ic.tag_size );
+ return ak_hash_ptr( ic.contexts[0], ( ak_pointer ) data, size, tag, ic.tag_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Первая строка файла кеша содержит имя алгоритма и контрольное значение ключа; следующие
+    строки имеют вид `inode size mtime ctime icode filename`; последняя строка
+    `# tag value` содержит контрольное значение всех предыдущих строк, вычисленное функцией
+    aktool_icode_cache_tag(). Кеш, контрольное значение которого не совпадает с вычисленным,
+    не используется.                                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_icode_load_cache( void )
+{
+  FILE *fp = NULL;
+  long fsize = 0;
+  int error = ak_error_ok;
+  char *data = NULL, *line = NULL, *next = NULL, *last = NULL;
+  size_t len = 0;
+  ak_uint8 tag[64], expected[64];
+  char header[aktool_icode_line_length];
+
+  if(( fp = fopen( ic.cache_file, "rb" )) == NULL ) return ak_error_ok; /* кеш еще не создан */
+  if(( fseek( fp, 0, SEEK_END ) != 0 ) || (( fsize = ftell( fp )) <= 0 ) ||
+                                                               ( fseek( fp, 0, SEEK_SET ) != 0 )) {
+    fclose( fp );
+    return ak_error_ok;
+  }
+  if(( data = malloc(( size_t ) fsize + 1 )) == NULL ) {
+    fclose( fp );
+    aktool_error(_("out of memory"));
+    return ak_error_out_of_memory;
+  }
+  len = fread( data, 1, ( size_t ) fsize, fp );
+  fclose( fp );
+  data[len] = 0;
+
+ /* проверяем контрольное значение, содержащееся в последней строке */
+  while(( len > 0 ) && (( data[len-1] == '\n' ) || ( data[len-1] == '\r' ))) data[--len] = 0;
+  if((( last = strrchr( data, '\n' )) == NULL ) || ( strncmp( last+1, "# tag ", 6 ) != 0 ) ||
+     ( strlen( last+7 ) != 2*ic.tag_size ) ||
+     ( ak_hexstr_to_ptr( last+7, expected, ic.tag_size, ak_false ) != ak_error_ok ) ||
+     ( aktool_icode_cache_tag( data, ( size_t )( last - data ) + 1, tag ) != ak_error_ok ) ||
+     ( !ak_ptr_is_equal( tag, expected, ic.tag_size ))) {
+    aktool_error(_("cache file \"%s\" is damaged or created with another key and is not used"),
+                                                                                    ic.cache_file );
+    goto labex;
+  }
+  *last = 0;
+
+ /* проверяем, что кеш создан для используемого алгоритма и ключа */
+  ak_snprintf( header, sizeof( header ), "# %s %s", ic.oid->name[0],
+                                       ak_ptr_to_hexstr( ic.check_value, ic.tag_size, ak_false ));
+  if(( next = strchr( data, '\n' )) == NULL ) goto labex;
+  *next++ = 0;
+  if( strcmp( data, header ) != 0 ) goto labex;
+
+  for( line = next; line != NULL; line = next ) {
+    char *ptr = line, *hex = NULL;
+    icode_entry entry = NULL;
+    ak_uint64 inode = 0, size = 0;
+    ak_int64 mtime = 0, ctime = 0;
+
+    if(( next = strchr( line, '\n' )) != NULL ) *next++ = 0;
+    len = strlen( line );
+    while(( len > 0 ) && ( line[len-1] == '\r' )) line[--len] = 0;
+
+    inode = strtoull( ptr, &ptr, 10 );
+    size = strtoull( ptr, &ptr, 10 );
+    mtime = strtoll( ptr, &ptr, 10 );
+    ctime = strtoll( ptr, &ptr, 10 );
+    while( *ptr == ' ' ) ptr++;
+    hex = ptr;
+    if(( ptr = strchr( hex, ' ' )) == NULL ) continue;
+    *ptr++ = 0;
+    if( strlen( hex ) != 2*ic.tag_size ) continue;
+
+    if(( entry = aktool_icode_list_add( &ic.cache, ptr )) == NULL ) {
+      aktool_error(_("out of memory"));
+      error = ak_error_out_of_memory;
+      goto labex;
+    }
+    entry->inode = inode;
+    entry->size = size;
+    entry->mtime = mtime;
+    entry->ctime = ctime;
+    if( ak_hexstr_to_ptr( hex, entry->icode, ic.tag_size, ak_false ) != ak_error_ok )
+      ic.cache.count--, free( entry->name );
+  }
+  qsort( ic.cache.entries, ic.cache.count, sizeof( struct icode_entry ), aktool_icode_list_compare );
+
+  labex:
+   free( data );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция добавляет в буффер строку кеша для заданного файла. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_icode_cache_append( char **data, size_t *size, size_t *capacity,
+                                                                                icode_entry entry )
+{
+  char *ptr = NULL;
+  size_t len = strlen( entry->name ) + 2*ic.tag_size + 128;
+
+  if( *size + len > *capacity ) {
+    size_t capacity2 = ak_max( *capacity << 1, *size + len );
+    if(( ptr = realloc( *data, capacity2 )) == NULL ) return ak_error_out_of_memory;
+    *data = ptr;
+    *capacity = capacity2;
+  }
+  *size += ( size_t ) ak_snprintf( *data + *size, *capacity - *size, "%llu %llu %lld %lld %s %s\n",
+               (unsigned long long) entry->inode, (unsigned long long) entry->size,
+               (long long) entry->mtime, (long long) entry->ctime,
+                             ak_ptr_to_hexstr( entry->icode, ic.tag_size, ak_false ), entry->name );
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция сохраняет в кеш коды целостности обработанных файлов, а также записи кеша
+    для остальных файлов, считанные функцией aktool_icode_load_cache().                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_icode_save_cache( void )
+{
+  size_t i = 0, size = 0, capacity = aktool_icode_line_length;
+  FILE *fp = NULL;
+  char *data = NULL;
+  ak_uint8 tag[64];
+  int error = ak_error_ok;
+  icode_entry found = NULL;
+
+ /* отмечаем записи кеша, заменяемые вновь вычисленными значениями */
+  for( i = 0; i < ic.files.count; i++ ) {
+     if( ic.files.entries[i].error != ak_error_ok ) continue;
+     if(( found = bsearch( ic.files.entries + i, ic.cache.entries, ic.cache.count,
+                           sizeof( struct icode_entry ), aktool_icode_list_compare )) != NULL )
+       found->replaced = ak_true;
+  }
+
+ /* формируем содержимое кеша */
+  if(( data = malloc( capacity )) == NULL ) {
+    aktool_error(_("out of memory"));
+    return ak_error_out_of_memory;
+  }
+  size = ( size_t ) ak_snprintf( data, capacity, "# %s %s\n", ic.oid->name[0],
+                                       ak_ptr_to_hexstr( ic.check_value, ic.tag_size, ak_false ));
+  for( i = 0; ( i < ic.files.count ) && ( error == ak_error_ok ); i++ )
+     if( ic.files.entries[i].error == ak_error_ok )
+       error = aktool_icode_cache_append( &data, &size, &capacity, ic.files.entries + i );
+  for( i = 0; ( i < ic.cache.count ) && ( error == ak_error_ok ); i++ )
+     if( !ic.cache.entries[i].replaced )
+       error = aktool_icode_cache_append( &data, &size, &capacity, ic.cache.entries + i );
+  if( error != ak_error_ok ) {
+    aktool_error(_("out of memory"));
+    goto labex;
+  }
+  if(( error = aktool_icode_cache_tag( data, size, tag )) != ak_error_ok ) {
+    aktool_error(_("incorrect calculation of cache integrity code"));
+    goto labex;
+  }
+
+ /* сохраняем содержимое и контрольное значение */
+  if(( fp = fopen( ic.cache_file, "wb" )) == NULL ) {
+    aktool_error(_("incorrect creation of cache file \"%s\""), ic.cache_file );
+    error = ak_error_create_file;
+    goto labex;
+  }
+  if(( fwrite( data, 1, size, fp ) != size ) ||
+     ( fprintf( fp, "# tag %s\n", ak_ptr_to_hexstr( tag, ic.tag_size, ak_false )) < 0 ))
+    error = ak_error_write_data;
+  if(( fclose( fp ) == EOF ) && ( error == ak_error_ok )) error = ak_error_write_data;
+
+  labex:
+   free( data );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция определяет атрибуты файла и, если они совпадают с сохраненными в кеше,
+    копирует из кеша код целостности файла. Время изменения атрибутов (ctime) сравнивается
+    вместе со временем модификации, поэтому восстановление времени модификации
+    после изменения содержимого файла не приводит к использованию кеша.
+
+    При проверке кодов целостности (опция `--check`) значения из кеша используются только
+    для алгоритмов hmac, для которых содержимое кеша аутентифицировано ключом проверки,
+    и только если значение из кеша совпадает с проверяемым; в противном случае
+    код целостности файла вычисляется заново.                                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t aktool_icode_lookup_cache( icode_entry entry )
+{
+  icode_entry found = NULL;
+#ifdef _WIN32
+  struct _stat st;
+  if( _stat( entry->name, &st ) < 0 ) return ak_false;
+#else
+  struct stat st;
+  if( stat( entry->name, &st ) < 0 ) return ak_false;
+#endif
+  entry->inode = ( ak_uint64 ) st.st_ino;
+  entry->size = ( ak_uint64 ) st.st_size;
+  entry->mtime = ( ak_int64 ) st.st_mtime;
+  entry->ctime = ( ak_int64 ) st.st_ctime;
+  if(( strlen( ic.check_file ) > 0 ) && ( ic.oid->engine != hmac_function )) return ak_false;
+
+  if(( found = bsearch( entry, ic.cache.entries, ic.cache.count,
+                         sizeof( struct icode_entry ), aktool_icode_list_compare )) == NULL )
+    return ak_false;
+  if(( found->inode != entry->inode ) || ( found->size != entry->size ) ||
+     ( found->mtime != entry->mtime ) || ( found->ctime != entry->ctime )) return ak_false;
+  if(( strlen( ic.check_file ) > 0 ) &&
+                         !ak_ptr_is_equal( found->icode, entry->expected, ic.tag_size )) return ak_false;
+  memcpy( entry->icode, found->icode, ic.tag_size );
+ return ak_true;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                     вычисление кодов целостности                                */
+/* ----------------------------------------------------------------------------------------------- */
+/*! Задание пула потоков: вычисление кода целостности одного файла. */
+ static int aktool_icode_task( ak_pointer ptr, const size_t task, const size_t thread )
+{
+  icode_entry entry = (( icode_list ) ptr )->entries + task;
+  ak_pointer ctx = ic.contexts[ ic.serial ? 0 : thread ];
+
+  if( ic.use_cache && ( entry->cached = aktool_icode_lookup_cache( entry ))) return ak_error_ok;
+  if( ic.oid->engine == hmac_function )
+    entry->error = ak_hmac_file( ctx, entry->name, entry->icode, ic.tag_size );
+   else entry->error = ak_hash_file( ctx, entry->name, entry->icode, ic.tag_size );
+
+ return entry->error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_icode_run( icode_list list )
+{
+  size_t i = 0;
+
+  if( ic.serial ) {
+    for( i = 0; i < list->count; i++ ) aktool_icode_task( list, i, 0 );
+    return ak_error_ok;
+  }
+ /* ошибки обработки отдельных файлов сохраняются в элементах массива */
+  ak_thread_pool_run( aktool_icode_task, list, list->count );
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_icode_generate( void )
+{
+  size_t i = 0;
+  FILE *fp = stdout;
+  int exit_status = EXIT_SUCCESS;
+
+  if( ic.files.count == 0 ) {
+    aktool_error(_("no files found"));
+    return EXIT_FAILURE;
+  }
+  aktool_icode_run( &ic.files );
+
+  if( strlen( ic.output_file ) > 0 ) {
+    if(( fp = fopen( ic.output_file, "w" )) == NULL ) {
+      aktool_error(_("incorrect creation of output file \"%s\""), ic.output_file );
+      return EXIT_FAILURE;
+    }
+  }
+ /* формат строк совпадает с форматом утилиты gost12sum */
+  for( i = 0; i < ic.files.count; i++ ) {
+     icode_entry entry = ic.files.entries + i;
+     if( entry->error != ak_error_ok ) {
+       aktool_error(_("incorrect integrity code calculation for \"%s\""), entry->name );
+       exit_status = EXIT_FAILURE;
+       continue;
+     }
+     fprintf( fp, "%s %s\n", ak_ptr_to_hexstr( entry->icode, ic.tag_size, ak_false ), entry->name );
+  }
+  if( fp != stdout ) fclose( fp );
+
+ return exit_status;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция считывает файл с кодами целостности; допускаются строки вида `icode filename`,
+    `icode  filename` и `icode *filename`.                                                         */
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_icode_load_manifest( void )
+{
+  FILE *fp = NULL;
+  size_t len = 0, hexlen = 2*ic.tag_size;
+  char line[aktool_icode_line_length];
+
+  if(( fp = fopen( ic.check_file, "r" )) == NULL ) {
+    aktool_error(_("incorrect opening of file \"%s\""), ic.check_file );
+    return ak_error_open_file;
+  }
+  while( fgets( line, sizeof( line ), fp ) != NULL ) {
+    char *ptr = line + hexlen;
+    icode_entry entry = NULL;
+
+    len = strlen( line );
+    while(( len > 0 ) && (( line[len-1] == '\n' ) || ( line[len-1] == '\r' ))) line[--len] = 0;
+    if(( len <= hexlen + 1 ) || ( *ptr != ' ' )) continue;
+    *ptr++ = 0;
+    if( *ptr == ' ' || *ptr == '*' ) ptr++;
+    if( *ptr == 0 ) continue;
+
+    if(( entry = aktool_icode_list_add( &ic.files, ptr )) == NULL ) {
+      fclose( fp );
+      aktool_error(_("out of memory"));
+      return ak_error_out_of_memory;
+    }
+    if( ak_hexstr_to_ptr( line, entry->expected, ic.tag_size, ak_false ) != ak_error_ok )
+      ic.files.count--, free( entry->name );
+  }
+  fclose( fp );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_icode_check( void )
+{
+  size_t i = 0, wrong = 0;
+
+  if( aktool_icode_load_manifest() != ak_error_ok ) return EXIT_FAILURE;
+  if( ic.files.count == 0 ) {
+    aktool_error(_("file \"%s\" does not contain integrity codes"), ic.check_file );
+    return EXIT_FAILURE;
+  }
+  aktool_icode_run( &ic.files );
+
+  for( i = 0; i < ic.files.count; i++ ) {
+     icode_entry entry = ic.files.entries + i;
+     if( entry->error != ak_error_ok ) {
+       printf(_("%s: error\n"), entry->name );
+       wrong++;
+       continue;
+     }
+     if( ak_ptr_is_equal( entry->icode, entry->expected, ic.tag_size )) {
+       if( !ic.quiet ) printf(_("%s: Ok\n"), entry->name );
+     } else {
+         printf(_("%s: Wrong\n"), entry->name );
+         wrong++;
+       }
+  }
+  if( wrong ) {
+    printf(_("%u of %u files failed the integrity check\n"), (unsigned int) wrong,
+                                                                    (unsigned int) ic.files.count );
+    return EXIT_FAILURE;
+  }
+
+ return EXIT_SUCCESS;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_icode( int argc, tchar *argv[] )
+{
+  int idx = 0, next_option = 0, exit_status = EXIT_FAILURE;
+  char *value = "streebog256";
+
+  const struct option long_options[] = {
+     { "algorithm",        1, NULL, 'a' },
+     { "check",            1, NULL, 'c' },
+     { "output",           1, NULL, 'o' },
+     { "pattern",          1, NULL, 'p' },
+     { "quiet",            0, NULL, 'q' },
+     { "recursive",        0, NULL, 'r' },
+     { "password",         1, NULL, 255 },
+     { "salt",             1, NULL, 254 },
+     { "cache",            1, NULL, 253 },
+     { "threads",          1, NULL, 252 },
+
+     { "openssl-style",    0, NULL,   5 },
+     { "audit",            1, NULL,   4 },
+     { "dont-use-colors",  0, NULL,   3 },
+     { "audit-file",       1, NULL,   2 },
+     { "help",             0, NULL,   1 },
+     { NULL,               0, NULL,   0 }
+  };
+
+  memset( &ic, 0, sizeof( struct icode_info ));
+  ic.pattern = "*";
+  strncpy( ic.salt, aktool_icode_default_salt, sizeof( ic.salt ) - 1 );
+
+ /* разбираем опции командной строки */
+  do {
+       next_option = getopt_long( argc, argv, "a:c:o:p:qr", long_options, NULL );
+       switch( next_option )
+      {
+        case  1  :   return aktool_icode_help();
+        case  2  : /* получили от пользователя имя файла для вывода аудита */
+                     aktool_set_audit( optarg );
+                     break;
+        case  3  : /* установка флага запрета вывода символов смены цветовой палитры */
+                     ak_error_set_color_output( ak_false );
+                     ak_libakrypt_set_option( "use_color_output", 0 );
+                     break;
+        case  4  : /* устанавливаем уровень аудита */
+                     aktool_log_level = atoi( optarg );
+                     break;
+        case  5  : /* переходим к стилю openssl */
+                     aktool_openssl_compability = ak_true;
+                     break;
+
+        case 'a' : /* алгоритм вычисления кодов целостности */
+                     value = optarg;
+                     break;
+        case 'c' : /* проверка кодов целостности */
+                     strncpy( ic.check_file, optarg, sizeof( ic.check_file ) - 1 );
+                     break;
+        case 'o' : /* файл для сохранения кодов целостности */
+                     strncpy( ic.output_file, optarg, sizeof( ic.output_file ) - 1 );
+                     break;
+        case 'p' : /* маска имен файлов */
+                     ic.pattern = optarg;
+                     break;
+        case 'q' : /* выводить только сообщения об ошибках */
+                     ic.quiet = ak_true;
+                     break;
+        case 'r' : /* обработка вложенных каталогов */
+                     ic.recursive = ak_true;
+                     break;
+
+        case 255 : /* пароль для выработки ключа имитозащиты */
+                     memset( ic.password, 0, sizeof( ic.password ));
+                     strncpy( ic.password, optarg, sizeof( ic.password ) - 1 );
+                     ic.lenpass = strlen( ic.password );
+                     break;
+        case 254 : /* соль для выработки ключа имитозащиты */
+                     memset( ic.salt, 0, sizeof( ic.salt ));
+                     strncpy( ic.salt, optarg, sizeof( ic.salt ) - 1 );
+                     break;
+        case 253 : /* файл с кешем кодов целостности */
+                     strncpy( ic.cache_file, optarg, sizeof( ic.cache_file ) - 1 );
+                     ic.use_cache = ak_true;
+                     break;
+        case 252 : /* количество рабочих потоков */
+                     ak_libakrypt_set_option( "thread_pool_size", atoi( optarg ));
+                     break;
+
+        default:   /* обрабатываем ошибочные параметры */
+                     if( next_option != -1 ) return aktool_icode_help();
+                     break;
+       }
+   } while( next_option != -1 );
+  /* после разбора опций первым из оставшихся аргументов является имя команды */
+   if(( strlen( ic.check_file ) == 0 ) && ( optind + 1 >= argc )) return aktool_icode_help();
+
+ /* начинаем работу с криптографическими примитивами */
+   if( !aktool_create_libakrypt( )) return EXIT_FAILURE;
+
+   if((( ic.oid = ak_oid_find_by_ni( value )) == NULL ) ||
+      (( ic.oid->engine != hash_function ) && ( ic.oid->engine != hmac_function )) ||
+                                                                     ( ic.oid->mode != algorithm )) {
+     aktool_error(_("using unsupported name or identifier \"%s\""), value );
+     goto labex;
+   }
+   if(( ic.oid->engine == hmac_function ) && ( ic.lenpass == 0 )) {
+     if( aktool_load_user_password( ic.password, sizeof( ic.password )) != ak_error_ok ) {
+       aktool_error(_("incorrect password"));
+       goto labex;
+     }
+     ic.lenpass = strlen( ic.password );
+   }
+   if( aktool_icode_create_contexts() != ak_error_ok ) goto labex;
+   if( ic.use_cache && ( aktool_icode_load_cache() != ak_error_ok )) goto labex;
+
+   if( strlen( ic.check_file ) > 0 ) exit_status = aktool_icode_check();
+    else {
+      for( idx = optind + 1; idx < argc; idx++ )
+         if( aktool_icode_add_path( &ic.files, argv[idx] ) != ak_error_ok ) goto labex;
+      qsort( ic.files.entries, ic.files.count,
+                                          sizeof( struct icode_entry ), aktool_icode_list_compare );
+      exit_status = aktool_icode_generate();
+    }
+   if( ic.use_cache && ( aktool_icode_save_cache() != ak_error_ok )) exit_status = EXIT_FAILURE;
+
+  labex:
+   aktool_icode_list_free( &ic.cache );
+   aktool_icode_list_free( &ic.files );
+   aktool_icode_destroy_contexts();
+   memset( ic.password, 0, sizeof( ic.password ));
+   aktool_destroy_libakrypt();
+
+ return exit_status;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_icode_help( void )
+{
+  printf(
+   _("aktool icode [options] [files or directories]  - calculate or check integrity codes\n\n"
+     "available options:\n"
+     " -a, --algorithm <ni>    set the algorithm, hash function or hmac (default: streebog256)\n"
+     "     --cache <file>      skip files whose inode, size and modification times are saved in cache\n"
+     "                         (when checking, the cache is used only with hmac algorithms)\n"
+     " -c, --check <file>      check integrity codes saved in file\n"
+     " -o, --output <file>     save integrity codes to file (default: stdout)\n"
+     "     --password <pass>   password for secret key generation (used with hmac algorithms)\n"
+     " -p, --pattern <mask>    process only files whose names match the mask (default: \"*\")\n"
+     " -q, --quiet             show only files that failed the check\n"
+     " -r, --recursive         process subdirectories\n"
+     "     --salt <string>     salt for secret key generation (used with hmac algorithms)\n"
+     "     --threads <n>       set the number of worker threads\n"
+     "\n"
+     "the output format is compatible with gost12sum utility\n"
+  ));
+
+ return aktool_print_common_options();
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                                 aktool_icode.c  */
+/* ----------------------------------------------------------------------------------------------- */
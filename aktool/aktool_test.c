@@ -2,6 +2,14 @@
  #include <stdlib.h>
  #include <string.h>
  #include <aktool.h>
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ))
+ #include <x86intrin.h>
+ #define aktool_test_cycles() ( __rdtsc( ))
+ #define aktool_test_cycles_unit "cycle"
+#else
+ #define aktool_test_cycles() ( clock( ))
+ #define aktool_test_cycles_unit "clock tick"
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
 /* - запуск теста криптографических алгоритмов
@@ -10,6 +18,8 @@
  int aktool_test_help( void );
  int aktool_test_speed_block_cipher( ak_oid );
  int aktool_test_speed_hash_function( ak_oid );
+ int aktool_test_speed_hmac_function( ak_oid );
+ int aktool_test_speed_hash_file( ak_oid , const char * );
  int aktool_test_speed_sign_function( ak_oid );
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -19,7 +29,7 @@
  int aktool_test( int argc, tchar *argv[] )
 {
   ak_oid oid = NULL;
-  char *value = NULL;
+  char *value = NULL, *filename = NULL;
   int next_option = 0, exit_status = EXIT_SUCCESS;
 
   enum { do_nothing, do_dynamic, do_speed_oid } work = do_nothing;
@@ -27,6 +37,7 @@
   const struct option long_options[] = {
      { "crypto",           0, NULL, 255 },
      { "speed",            1, NULL, 254 },
+     { "file",             1, NULL, 253 },
      { "verbose",          0, NULL, 'v' },
 
      { "openssl-style",    0, NULL,   5 },
@@ -69,6 +80,10 @@
                      work = do_speed_oid; value = optarg;
                      break;
 
+        case 253 : /* тест скорости хеширования заданного файла */
+                     filename = optarg;
+                     break;
+
         default:   /* обрабатываем ошибочные параметры */
                      if( next_option != -1 ) work = do_nothing;
                      break;
@@ -102,7 +117,11 @@
            exit_status = aktool_test_speed_block_cipher( oid );
            break;
         case hash_function:
-           exit_status = aktool_test_speed_hash_function( oid );
+           if( filename != NULL ) exit_status = aktool_test_speed_hash_file( oid, filename );
+            else exit_status = aktool_test_speed_hash_function( oid );
+           break;
+        case hmac_function:
+           exit_status = aktool_test_speed_hmac_function( oid );
            break;
         case sign_function:
            exit_status = aktool_test_speed_sign_function( oid );
@@ -136,6 +155,7 @@
      "     --crypto            complete test of cryptographic algorithms\n"
      "                         run all available algorithms on test values taken from standards and recommendations\n"
      "     --speed <ni>        measuring the speed of the crypto algorithm with a given name or identifier\n"
+     "     --file <file>       measuring the speed of hashing a given file (used with --speed option)\n"
      " -v, --verbose           detailed information output\n"
      "\n"
      "for more information run tests with \"--audit 2 --audit-file stderr\" options or see /var/log/auth.log file\n"
@@ -153,6 +173,53 @@
     0xe9, 0xa8, 0x11, 0x12, 0x4c, 0x1b, 0x01, 0x1f, 0xf0, 0x87, 0xac, 0xab, 0x53, 0x19, 0x7d, 0xd1
   };
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Измерение скорости аутентифицированного шифрования сообщений длины 4 килобайта,
+    1 мегабайт и 256 мегабайт (общий объем обрабатываемых данных для всех длин одинаков).       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_test_speed_aead_messages( ak_oid oid,
+                                             ak_pointer encryptionKey, ak_pointer authenticationKey )
+{
+  ak_uint8 *data = NULL, adata[128], icode[64];
+  size_t i = 0, j = 0, count = 0;
+  const size_t total = 256*1024*1024,
+               sizes[3] = { 4096, 1024*1024, 256*1024*1024 };
+  int error = ak_error_ok, exit_status = EXIT_FAILURE;
+
+  if(( data = malloc( total )) == NULL ) {
+    aktool_error(_("memory allocation error"));
+    return exit_status;
+  }
+  memset( data, 0x5a, total );
+  memset( adata, 0xa5, sizeof( adata ));
+
+  for( i = 0; i < 3; i++ ) {
+     clock_t timea = 1;
+
+     ((ak_skey)encryptionKey)->resource.value.counter = total;
+     ((ak_skey)authenticationKey)->resource.value.counter = total;
+     count = total/sizes[i];
+     timea = clock();
+     for( j = 0; j < count; j++ )
+        if(( error = oid->func.direct( encryptionKey, authenticationKey,
+                                adata, sizeof( adata ), data + j*sizes[i], data + j*sizes[i],
+                          sizes[i], iv, sizeof( iv ), icode, sizeof( icode ))) != ak_error_ok ) break;
+     timea = clock() - timea;
+     if( error != ak_error_ok ) break;
+     if( timea == 0 ) timea = 1;
+
+     printf(_("[%s: messages of %9u bytes], speed: %10f MBs\n"),
+               oid->name[0], (unsigned int) sizes[i],
+               (double) CLOCKS_PER_SEC*total / ( (double) timea*1024*1024 ));
+  }
+  free( data );
+
+  if( error != ak_error_ok ) aktool_error(_("computational error (%d)"), error );
+   else exit_status = EXIT_SUCCESS;
+
+ return exit_status;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  int aktool_test_speed_block_cipher( ak_oid oid )
 {
@@ -328,7 +395,9 @@
   if( !aktool_test_verbose ) printf(_(" 128MB],"));
   printf(_(" average speed: %10f MBs\n"), avg/iter );
 
-  exit_status = EXIT_SUCCESS;
+  if( oid->mode == aead )
+    exit_status = aktool_test_speed_aead_messages( oid, encryptionKey, authenticationKey );
+   else exit_status = EXIT_SUCCESS;
   exit:
    ak_oid_delete_object( oid, encryptionKey );
    if( authenticationKey != NULL ) ak_oid_delete_second_object( oid, authenticationKey );
@@ -348,6 +417,54 @@
  return exit_status;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Измерение скорости обновления контекста сжимающего отображения фрагментами
+    длины 64 октета, 1 килобайт и 1 мегабайт (в октетах на такт процессора).                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_test_speed_update( ak_oid oid, ak_pointer ctx,
+                                              ak_function_clean *clean, ak_function_update *update )
+{
+  ak_uint8 *data = NULL;
+  size_t i = 0, j = 0, count = 0;
+  const size_t total = 16*1024*1024,
+               sizes[3] = { 64, 1024, 1024*1024 };
+  int error = ak_error_ok, exit_status = EXIT_FAILURE;
+
+  if(( data = malloc( total )) == NULL ) {
+    aktool_error(_("memory allocation error"));
+    return exit_status;
+  }
+  memset( data, 0x5a, total );
+
+  for( i = 0; i < 3; i++ ) {
+     ak_uint64 cycles = 0;
+     clock_t timea = 1;
+
+     if(( error = clean( ctx )) != ak_error_ok ) break;
+     count = total/sizes[i];
+     timea = clock();
+     cycles = aktool_test_cycles();
+     for( j = 0; j < count; j++ )
+        if(( error = update( ctx, data + j*sizes[i], sizes[i] )) != ak_error_ok ) break;
+     cycles = aktool_test_cycles() - cycles;
+     timea = clock() - timea;
+     if( error != ak_error_ok ) break;
+     if( timea == 0 ) timea = 1;
+     if( cycles == 0 ) cycles = 1;
+
+     printf(_("[%s: update by %7u bytes], speed: %10f MBs, %f bytes per %s\n"),
+               oid->name[0], (unsigned int) sizes[i],
+               (double) CLOCKS_PER_SEC*total / ( (double) timea*1024*1024 ),
+               (double) total / (double) cycles, aktool_test_cycles_unit );
+  }
+  free( data );
+
+  if( error != ak_error_ok ) aktool_error(_("computational error (%d)"), error );
+   else exit_status = EXIT_SUCCESS;
+
+ return exit_status;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  int aktool_test_speed_hash_function( ak_oid oid )
 {
@@ -404,7 +521,112 @@
   if( !aktool_test_verbose ) printf(_(" 128MB],"));
   printf(_(" average speed: %10f MBs\n"), avg/iter );
 
+  exit_status = aktool_test_speed_update( oid, ctx,
+                    ( ak_function_clean * )ak_hash_clean, ( ak_function_update * )ak_hash_update );
+  exit:
+   ak_oid_delete_object( oid, ctx );
+
+ return exit_status;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Сравнение скорости хеширования файла функцией ak_hash_file() и последовательным
+    чтением файла блоками длины, рекомендуемой файловой системой.                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_test_speed_hash_file( ak_oid oid, const char *filename )
+{
+  ssize_t len = 0;
+  struct file file;
+  ak_int64 size = 0, blksize = 0;
+  clock_t timea = 1, timeb = 1;
+  ak_uint8 *data = NULL, icode[64], icode2[64];
+  int error = ak_error_ok, exit_status = EXIT_FAILURE;
+  ak_pointer ctx = NULL;
+
+  if( oid->mode != algorithm ) {
+    printf(_("hash function's mode \"%s\" is not supported yet for testing, sorry ... \n"),
+                                                           ak_libakrypt_get_mode_name( oid->mode ));
+    return EXIT_SUCCESS;
+  }
+  if(( ctx = ak_oid_new_object( oid )) == NULL ) {
+    aktool_error( _("incorrect creation of hash function context (code: %d)" ), ak_error_get_value());
+    return exit_status;
+  }
+
+ /* хешируем файл функцией библиотеки */
+  memset( icode, 0, sizeof( icode ));
+  memset( icode2, 0, sizeof( icode2 ));
+  timea = clock();
+  error = ak_hash_file( ctx, filename, icode, sizeof( icode ));
+  timea = clock() - timea;
+  if( error != ak_error_ok ) {
+    aktool_error(_("computational error (%d)"), error );
+    goto exit;
+  }
+
+ /* хешируем файл, последовательно считывая его блоками */
+  if(( error = ak_file_open_to_read( &file, filename )) != ak_error_ok ) {
+    aktool_error(_("incorrect access to file %s (code: %d)"), filename, error );
+    goto exit;
+  }
+  size = file.size;
+  blksize = file.blksize;
+  if(( data = malloc(( size_t )blksize )) == NULL ) {
+    ak_file_close( &file );
+    aktool_error(_("memory allocation error"));
+    goto exit;
+  }
+  timeb = clock();
+  ak_hash_clean( ctx );
+  while(( len = ak_file_read( &file, data, ( size_t )blksize )) > 0 )
+    ak_hash_update( ctx, data, ( size_t )len );
+  ak_hash_finalize( ctx, "", 0, icode2, sizeof( icode2 ));
+  timeb = clock() - timeb;
+  free( data );
+  ak_file_close( &file );
+  if( timea == 0 ) timea = 1;
+  if( timeb == 0 ) timeb = 1;
+
+  printf(_("[%s: %s, %.1f MB]\n"), oid->name[0], filename, (double) size/( 1024*1024 ));
+  printf(_(" ak_hash_file(): time = %fs, speed = %f MBs\n"),
+       (double) timea / (double) CLOCKS_PER_SEC,
+       (double) CLOCKS_PER_SEC*size / ( (double) timea*1024*1024 ));
+  printf(_(" reading by %u bytes: time = %fs, speed = %f MBs\n"), (unsigned int) blksize,
+       (double) timeb / (double) CLOCKS_PER_SEC,
+       (double) CLOCKS_PER_SEC*size / ( (double) timeb*1024*1024 ));
+  if( memcmp( icode, icode2, sizeof( icode ))) {
+    aktool_error(_("different integrity codes for the same file"));
+    goto exit;
+  }
   exit_status = EXIT_SUCCESS;
+
+  exit:
+   ak_oid_delete_object( oid, ctx );
+ return exit_status;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_test_speed_hmac_function( ak_oid oid )
+{
+  ak_pointer ctx = NULL;
+  int error = ak_error_ok, exit_status = EXIT_FAILURE;
+
+  if( oid->mode != algorithm ) {
+    printf(_("hmac function's mode \"%s\" is not supported yet for testing, sorry ... \n"),
+                                                           ak_libakrypt_get_mode_name( oid->mode ));
+    return EXIT_SUCCESS;
+  }
+  if(( ctx = ak_oid_new_object( oid )) == NULL ) {
+    aktool_error( _("incorrect creation of hmac function context (code: %d)" ), ak_error_get_value());
+    return exit_status;
+  }
+  if(( error = oid->func.first.set_key( ctx, iv, 32 )) != ak_error_ok ) {
+    aktool_error( _("incorrect assigning of secret key (code: %d)" ), error );
+    goto exit;
+  }
+
+  exit_status = aktool_test_speed_update( oid, ctx,
+                    ( ak_function_clean * )ak_hmac_clean, ( ak_function_update * )ak_hmac_update );
   exit:
    ak_oid_delete_object( oid, ctx );
 
@@ -45,11 +45,12 @@ else()
   try_append_c_flag( "-funroll-loops" CMAKE_C_FLAGS )
 #  try_append_c_flag( "-fomit-frame-pointer" CMAKE_C_FLAGS )
   try_append_c_flag( "-pipe" CMAKE_C_FLAGS )
-  try_append_c_flag( "-mpclmul" CMAKE_C_FLAGS )
   try_append_c_flag( "-msse" CMAKE_C_FLAGS )
   try_append_c_flag( "-msse2" CMAKE_C_FLAGS )
-  try_append_c_flag( "-mavx" CMAKE_C_FLAGS )
-  try_append_c_flag( "-mavx2" CMAKE_C_FLAGS )
+
+#  флаги -mpclmul и -mavx2 не используются: функции, применяющие эти расширения,
+#  компилируются с атрибутом target и выбираются во время выполнения программы
+#  (см. ak_libakrypt_create()), поэтому собранная библиотека работает на любом процессоре
 
 #  флаг -march-native позволяет получить доступ к регистам sse, mmx и т.п.
 #  но приводит к ошибке при кросс-платформенной компиляции.
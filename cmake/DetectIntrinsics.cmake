@@ -19,16 +19,47 @@ if( AK_HAVE_BUILTIN_MULQ_GCC )
     set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_BUILTIN_MULQ_GCC" )
 endif()
 
+# -------------------------------------------------------------------------------------------------- #
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  #include <sys/types.h>
+  int main( void ) {
+    #if defined( __x86_64__ )
+      u_int64_t lo, hi, u = 1, v = 2;
+      __asm__ (\"xorq %0, %0; mulxq %3, %0, %1; adcxq %0, %1; adoxq %0, %1\"
+               : \"=&r\" (lo), \"=&r\" (hi) : \"d\" (u), \"r\" (v) : \"cc\");
+      __builtin_cpu_init();
+      return __builtin_cpu_supports( \"bmi2\" ) && __builtin_cpu_supports( \"adx\" ) ? ( int )hi : 0;
+    #else
+      #error Unsupported architecture
+    #endif
+  }" AK_HAVE_BUILTIN_MULX_ADX )
+
+if( AK_HAVE_BUILTIN_MULX_ADX )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_BUILTIN_MULX_ADX" )
+endif()
+
 # -------------------------------------------------------------------------------------------------- #
 # -------------------------------------------------------------------------------------------------- #
 check_c_source_compiles("
   #include <wmmintrin.h>
+  #ifdef _MSC_VER
+   static __m128i f( __m128i a, __m128i b ) {
+  #else
+   __attribute__((target(\"pclmul\"))) static __m128i f( __m128i a, __m128i b ) {
+  #endif
+    return _mm_clmulepi64_si128( a, b, 0x00 );
+  }
   int main( void ) {
+   __m128i a = _mm_setzero_si128();
 
-   __m128i a, b, c;
-   c = _mm_clmulepi64_si128( a, b, 0x00 );
+  #ifndef _MSC_VER
+   __builtin_cpu_init();
+   if( __builtin_cpu_supports( \"pclmul\" ))
+  #endif
+   a = f( a, a );
 
-  return 0;
+  return _mm_cvtsi128_si32( a );
  }" AK_HAVE_BUILTIN_CLMULEPI64 )
 
 if( AK_HAVE_BUILTIN_CLMULEPI64 )
@@ -39,7 +70,7 @@ endif()
 # -------------------------------------------------------------------------------------------------- #
 check_c_source_compiles("
   #include <immintrin.h>
-  int main( void ) {
+  __attribute__((target(\"avx2\"))) static int f( void ) {
 
    __m256i theta = _mm256_setr_epi64x( 0x425, 0, 0, 0 );
    __m256i m2 = _mm256_srli_epi64( theta, 63 );
@@ -47,9 +78,39 @@ check_c_source_compiles("
    __m128i count = _mm_setr_epi32( 1, 0, 0, 0 );
    __m256i m3 = _mm256_sll_epi64( theta, count );
 
-  return 0;
+  return _mm256_extract_epi32( _mm256_xor_si256( m2, m3 ), 0 );
+  }
+  int main( void ) {
+  return f();
  }" AK_HAVE_BUILTIN_MM256_SLL )
 
 if( AK_HAVE_BUILTIN_MM256_SLL )
     set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_BUILTIN_MM256_SLL" )
 endif()
+
+# -------------------------------------------------------------------------------------------------- #
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  #include <immintrin.h>
+  __attribute__((target(\"ssse3\"))) static __m128i f128( __m128i a, __m128i b ) {
+    return _mm_shuffle_epi8( a, b );
+  }
+  __attribute__((target(\"avx2\"))) static int f256( void ) {
+    __m256i b = _mm256_setzero_si256();
+    b = _mm256_shuffle_epi8( b, _mm256_broadcastsi128_si256( _mm256_castsi256_si128( b )));
+    return _mm256_extract_epi32( b, 0 );
+  }
+  int main( void ) {
+   int b = 0;
+   __m128i a = _mm_setzero_si128();
+
+   __builtin_cpu_init();
+   if( __builtin_cpu_supports( \"ssse3\" )) a = f128( a, a );
+   if( __builtin_cpu_supports( \"avx2\" )) b = f256();
+
+  return _mm_cvtsi128_si32( a ) + b;
+ }" AK_HAVE_BUILTIN_SHUFFLE_EPI8 )
+
+if( AK_HAVE_BUILTIN_SHUFFLE_EPI8 )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_BUILTIN_SHUFFLE_EPI8" )
+endif()
@@ -0,0 +1,174 @@
+/* ----------------------------------------------------------------------------------------------- */
+/* Тестовый пример, проверяющий совпадение результатов потокового аутентифицированного шифрования
+   в режимах mgm и xtsmac с результатами однократного вызова функций шифрования, а также
+   корректность проверки имитовставки при расшифровании данных, поступающих фрагментами.
+
+   test-aead-stream.c                                                                              */
+/* ----------------------------------------------------------------------------------------------- */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define max_data_size (4099)
+
+ static ak_uint8 key1[32] = {
+     0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+     0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+ static ak_uint8 key2[32] = {
+     0xff, 0xfe, 0xfd, 0xfc, 0xfb, 0xfa, 0xf9, 0xf8, 0xf7, 0xf6, 0xf5, 0xf4, 0xf3, 0xf2, 0xf1, 0xf0,
+     0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff };
+ static ak_uint8 iv[16] = {
+     0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11 };
+
+/* ----------------------------------------------------------------------------------------------- */
+/* потоковое шифрование в одном из двух режимов: mgm или xtsmac */
+ typedef union {
+   struct mgm_stream mgm;
+   struct xtsmac_stream xtsmac;
+ } stream_ctx;
+
+ static const char *names[2] = { "mgm", "xtsmac" };
+ static ak_function_aead *encrypt[2] = { ak_bckey_encrypt_mgm, ak_bckey_encrypt_xtsmac };
+
+/* ----------------------------------------------------------------------------------------------- */
+/* обработка данных фрагментами длины chunk, функция возвращает длину результата */
+ static ssize_t stream_run( const int mode, const int decrypt, ak_bckey ekey, ak_bckey akey,
+                              ak_uint8 *adata, const size_t asize, ak_uint8 *in, const size_t size,
+                                          ak_uint8 *out, const size_t chunk, ak_uint8 *icode )
+{
+  size_t off, len;
+  ssize_t res, total = 0;
+  stream_ctx ctx;
+
+  if( mode ) ak_xtsmac_stream_init( &ctx.xtsmac, ekey, akey, iv, sizeof( iv ));
+   else ak_mgm_stream_init( &ctx.mgm, ekey, akey, iv, sizeof( iv ));
+
+  for( off = 0; off < asize; off += len ) {
+     len = ak_min( chunk, asize - off );
+     if( mode ) ak_xtsmac_stream_aad_update( &ctx.xtsmac, adata + off, len );
+      else ak_mgm_stream_aad_update( &ctx.mgm, adata + off, len );
+  }
+  for( off = 0; off < size; off += len ) {
+     len = ak_min( chunk, size - off );
+     if( mode ) res = decrypt ?
+                    ak_xtsmac_stream_decrypt_update( &ctx.xtsmac, in + off, out + total, len ) :
+                    ak_xtsmac_stream_encrypt_update( &ctx.xtsmac, in + off, out + total, len );
+      else res = decrypt ?
+                    ak_mgm_stream_decrypt_update( &ctx.mgm, in + off, out + total, len ) :
+                    ak_mgm_stream_encrypt_update( &ctx.mgm, in + off, out + total, len );
+     if( res < 0 ) goto exit;
+     total += res;
+  }
+  if( mode ) res = decrypt ?
+                 ak_xtsmac_stream_decrypt_finalize( &ctx.xtsmac, out + total, icode, ekey->bsize ) :
+                 ak_xtsmac_stream_encrypt_finalize( &ctx.xtsmac, out + total, icode, ekey->bsize );
+   else res = decrypt ?
+                 ak_mgm_stream_decrypt_finalize( &ctx.mgm, out + total, icode, ekey->bsize ) :
+                 ak_mgm_stream_encrypt_finalize( &ctx.mgm, out + total, icode, ekey->bsize );
+  if( res >= 0 ) res += total;
+
+  exit:
+   if( mode ) ak_xtsmac_stream_destroy( &ctx.xtsmac );
+    else ak_mgm_stream_destroy( &ctx.mgm );
+ return res;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t test_mode( const int mode, ak_bckey ekey, ak_bckey akey,
+                                  ak_uint8 *data, ak_uint8 *check, ak_uint8 *out, ak_uint8 *back )
+{
+  size_t i, j, k;
+  ssize_t res;
+  bool_t ok = ak_true;
+  ak_uint8 icode[16], icode2[16];
+  const size_t sizes[] = { 0, 16, 17, 31, 32, 33, 67, 1000, max_data_size };
+  const size_t asizes[] = { 0, 5, 41, 100 };
+  const size_t chunks[] = { 1, 7, 16, 33, 1000, max_data_size };
+
+  for( i = 0; i < sizeof( sizes )/sizeof( size_t ); i++ ) {
+   for( j = 0; j < sizeof( asizes )/sizeof( size_t ); j++ ) {
+     memset( check, 0, max_data_size );
+     encrypt[mode]( ekey, akey, data + 1000, asizes[j], data, check, sizes[i],
+                                                             iv, sizeof( iv ), icode, ekey->bsize );
+     for( k = 0; k < sizeof( chunks )/sizeof( size_t ); k++ ) {
+       /* зашифрование */
+        memset( out, 0, max_data_size + 32 );
+        res = stream_run( mode, 0, ekey, akey, data + 1000, asizes[j],
+                                                        data, sizes[i], out, chunks[k], icode2 );
+        if(( res != ( ssize_t )sizes[i] ) || !ak_ptr_is_equal( out, check, sizes[i] ) ||
+           !ak_ptr_is_equal( icode, icode2, ekey->bsize )) {
+          printf(" %s: encryption error (size: %u, adata: %u, chunk: %u)\n", names[mode],
+                        (unsigned int)sizes[i], (unsigned int)asizes[j], (unsigned int)chunks[k] );
+          ok = ak_false;
+        }
+       /* расшифрование */
+        memset( back, 0, max_data_size + 32 );
+        res = stream_run( mode, 1, ekey, akey, data + 1000, asizes[j],
+                                                          out, sizes[i], back, chunks[k], icode );
+        if(( res != ( ssize_t )sizes[i] ) || !ak_ptr_is_equal( back, data, sizes[i] )) {
+          printf(" %s: decryption error (size: %u, adata: %u, chunk: %u)\n", names[mode],
+                        (unsigned int)sizes[i], (unsigned int)asizes[j], (unsigned int)chunks[k] );
+          ok = ak_false;
+        }
+       /* расшифрование с неверной имитовставкой */
+        icode2[0] ^= 0x01; /* длина имитовставки совпадает с длиной блока */
+        res = stream_run( mode, 1, ekey, akey, data + 1000, asizes[j],
+                                                         out, sizes[i], back, chunks[k], icode2 );
+        if( res != ak_error_not_equal_data ) {
+          printf(" %s: wrong integrity code accepted (size: %u, adata: %u, chunk: %u)\n",
+          names[mode], (unsigned int)sizes[i], (unsigned int)asizes[j], (unsigned int)chunks[k] );
+          ok = ak_false;
+        }
+     }
+   }
+  }
+  printf(" %-7s %-10s %s\n", names[mode], ekey->key.oid->name[0], ok ? "Ok" : "Wrong" );
+ return ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i, j;
+  struct bckey ekey, akey;
+  int result = EXIT_SUCCESS;
+  ak_uint8 *data = NULL, *check = NULL, *out = NULL, *back = NULL;
+  int ( *create[2] )( ak_bckey ) = { ak_bckey_create_kuznechik, ak_bckey_create_magma };
+
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+  data = malloc( max_data_size + 1000 );
+  check = malloc( max_data_size );
+  out = malloc( max_data_size + 32 );
+  back = malloc( max_data_size + 32 );
+  if(( data == NULL ) || ( check == NULL ) || ( out == NULL ) || ( back == NULL )) {
+    result = EXIT_FAILURE;
+    goto exit;
+  }
+  for( i = 0; i < max_data_size + 1000; i++ ) data[i] = ( ak_uint8 )( i*13 + ( i >> 5 ));
+
+  for( i = 0; i < 2; i++ ) {
+     create[i]( &ekey );
+     create[i]( &akey );
+     ak_bckey_set_key( &ekey, key1, sizeof( key1 ));
+     ak_bckey_set_key( &akey, key2, sizeof( key2 ));
+     for( j = 0; j < 2; j++ )
+        if( !test_mode( (int)j, &ekey, &akey, data, check, out, back )) result = EXIT_FAILURE;
+     ak_bckey_destroy( &akey );
+     ak_bckey_destroy( &ekey );
+  }
+
+  exit:
+   if( back ) free( back );
+   if( out ) free( out );
+   if( check ) free( check );
+   if( data ) free( data );
+   ak_libakrypt_destroy();
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                              test-aead-stream.c */
+/* ----------------------------------------------------------------------------------------------- */
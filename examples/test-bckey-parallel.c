@@ -0,0 +1,112 @@
+/* ----------------------------------------------------------------------------------------------- */
+/* Тестовый пример, проверяющий совпадение результатов параллельной и последовательной
+   реализаций режимов шифрования.
+
+   test-bckey-parallel.c                                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint8 key[32] = {
+     0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+     0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+
+ static ak_uint8 iv[16] = {
+     0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11 };
+
+/* размер данных: половина мегабайта с неполным последним блоком
+   (ресурса ключа Магма должно хватить на все проверяемые режимы) */
+ #define data_size ( 524288 + 37 )
+
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t check( const char *mode, ak_uint8 *x, ak_uint8 *y, size_t size )
+{
+  bool_t result = ak_ptr_is_equal( x, y, size );
+  printf(" %-12s %s\n", mode, result ? "Ok" : "Wrong" );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int test_cipher( int ( *create )( ak_bckey ), ak_uint8 *in, ak_uint8 *out, ak_uint8 *res )
+{
+  int result = EXIT_SUCCESS;
+  struct bckey first, second;
+  size_t bsize, size;
+
+  create( &first ); ak_bckey_set_key( &first, key, sizeof( key ));
+  create( &second ); ak_bckey_set_key( &second, key, sizeof( key ));
+  bsize = first.bsize;
+  size = data_size - ( data_size%bsize );
+  printf("cipher: %s\n", first.key.oid->name[0] );
+
+ /* режим гаммирования, включая продолжение обработки данных без синхропосылки */
+  ak_bckey_ctr( &first, in, out, size, iv, bsize >> 1 );
+  ak_bckey_ctr( &first, in + size, out + size, data_size - size, NULL, 0 );
+  memset( res, 0, data_size );
+  ak_bckey_ctr_parallel( &second, in, res, size, iv, bsize >> 1 );
+  ak_bckey_ctr_parallel( &second, in + size, res + size, data_size - size, NULL, 0 );
+  if( !check( "ctr", out, res, data_size )) result = EXIT_FAILURE;
+
+ /* режим простой замены с зацеплением */
+  ak_bckey_encrypt_cbc( &first, in, out, size, iv, bsize );
+  memset( res, 0, data_size );
+  ak_bckey_decrypt_cbc_parallel( &second, out, res, size, iv, bsize );
+  if( !check( "cbc", in, res, size )) result = EXIT_FAILURE;
+
+ /* режим гаммирования с обратной связью по шифртексту */
+  ak_bckey_encrypt_cfb( &first, in, out, data_size, iv, bsize );
+  memset( res, 0, data_size );
+  ak_bckey_decrypt_cfb_parallel( &second, out, res, data_size, iv, bsize );
+  if( !check( "cfb", in, res, data_size )) result = EXIT_FAILURE;
+
+ /* режим xts */
+  ak_bckey_encrypt_xts( &first, &first, in, out, size, iv, sizeof( iv ));
+  memset( res, 0, data_size );
+  ak_bckey_encrypt_xts_parallel( &second, &second, in, res, size, iv, sizeof( iv ));
+  if( !check( "xts encrypt", out, res, size )) result = EXIT_FAILURE;
+  memset( res, 0, data_size );
+  ak_bckey_decrypt_xts_parallel( &second, &second, out, res, size, iv, sizeof( iv ));
+  if( !check( "xts decrypt", in, res, size )) result = EXIT_FAILURE;
+
+  ak_bckey_destroy( &first );
+  ak_bckey_destroy( &second );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i;
+  int result = EXIT_FAILURE;
+  ak_uint8 *in = NULL, *out = NULL, *res = NULL;
+
+ /* используем несколько потоков независимо от количества процессоров */
+  ak_libakrypt_set_option( "thread_pool_size", 4 );
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+
+  if((( in = malloc( data_size )) == NULL ) || (( out = malloc( data_size )) == NULL ) ||
+                                                      (( res = malloc( data_size )) == NULL )) {
+    printf("memory allocation error\n");
+    goto exlab;
+  }
+  for( i = 0; i < data_size; i++ ) in[i] = ( ak_uint8 )( i*7 + ( i >> 8 ));
+
+  if(( test_cipher( ak_bckey_create_magma, in, out, res ) == EXIT_SUCCESS ) &&
+     ( test_cipher( ak_bckey_create_kuznechik, in, out, res ) == EXIT_SUCCESS ))
+    result = EXIT_SUCCESS;
+
+  exlab:
+   if( in ) free( in );
+   if( out ) free( out );
+   if( res ) free( res );
+   ak_libakrypt_destroy();
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                           test-bckey-parallel.c */
+/* ----------------------------------------------------------------------------------------------- */
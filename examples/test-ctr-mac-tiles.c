@@ -0,0 +1,130 @@
+/* ----------------------------------------------------------------------------------------------- */
+/* Тестовый пример, проверяющий совпадение результатов однопроходного шифрования в режимах
+   ctr-cmac и ctr-hmac, при котором данные обрабатываются фрагментами длины ak_aead_tile_size,
+   с результатами последовательного вызова функций ak_bckey_ctr() и ak_bckey_cmac() (ak_hmac_ptr())
+   для данных, длина которых близка к границам фрагментов.
+
+   test-ctr-mac-tiles.c                                                                            */
+/* ----------------------------------------------------------------------------------------------- */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define max_data_size (40000)
+ #define max_adata_size (41)
+
+ static ak_uint8 key1[32] = {
+     0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+     0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+ static ak_uint8 key2[32] = {
+     0xff, 0xfe, 0xfd, 0xfc, 0xfb, 0xfa, 0xf9, 0xf8, 0xf7, 0xf6, 0xf5, 0xf4, 0xf3, 0xf2, 0xf1, 0xf0,
+     0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff };
+ static ak_uint8 iv[8] = { 0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xcd, 0xef };
+
+/* ----------------------------------------------------------------------------------------------- */
+/* сравнение однопроходного шифрования с последовательным вызовом функций шифрования
+   и выработки имитовставки; если hkey равен NULL, то используется режим ctr-cmac с ключом akey */
+ static bool_t test_mode( ak_bckey ekey, ak_bckey akey, ak_hmac hkey,
+                                                 ak_uint8 *data, ak_uint8 *check, ak_uint8 *out )
+{
+  size_t i, j, tsize;
+  bool_t ok = ak_true;
+  ak_uint8 icode[64], icode2[64], *adata = NULL, *plain = data + max_adata_size;
+  const size_t sizes[] = { 16383, 16384, 16385, max_data_size };
+  const size_t asizes[] = { 0, max_adata_size };
+  ak_pointer mkey = ( hkey == NULL ) ? ( ak_pointer )akey : ( ak_pointer )hkey;
+  ak_function_aead *encrypt = ( hkey == NULL ) ?
+                                        ak_bckey_encrypt_ctr_cmac : ak_bckey_encrypt_ctr_hmac;
+  ak_function_aead *decrypt = ( hkey == NULL ) ?
+                                        ak_bckey_decrypt_ctr_cmac : ak_bckey_decrypt_ctr_hmac;
+  const char *name = ( hkey == NULL ) ? "ctr-cmac" : "ctr-hmac";
+
+  tsize = ( hkey == NULL ) ? akey->bsize : ak_hmac_get_tag_size( hkey );
+  for( i = 0; i < sizeof( sizes )/sizeof( size_t ); i++ ) {
+   for( j = 0; j < sizeof( asizes )/sizeof( size_t ); j++ ) {
+     /* ассоциированные данные расположены непосредственно перед зашифровываемыми данными */
+      adata = asizes[j] ? plain - asizes[j] : NULL;
+
+     /* последовательное вычисление */
+      memset( check, 0, max_data_size );
+      memset( icode, 0, sizeof( icode ));
+      ak_bckey_ctr( ekey, plain, check, sizes[i], iv, ekey->bsize >> 1 );
+      if( hkey == NULL ) ak_bckey_cmac( akey, plain - asizes[j], asizes[j] + sizes[i], icode, tsize );
+       else ak_hmac_ptr( hkey, plain - asizes[j], asizes[j] + sizes[i], icode, tsize );
+
+     /* однопроходное зашифрование */
+      memset( out, 0, max_data_size );
+      memset( icode2, 0, sizeof( icode2 ));
+      if(( encrypt( ekey, mkey, adata, asizes[j], plain, out, sizes[i],
+                                        iv, ekey->bsize >> 1, icode2, tsize ) != ak_error_ok ) ||
+         !ak_ptr_is_equal( out, check, sizes[i] ) || !ak_ptr_is_equal( icode, icode2, tsize )) {
+        printf(" %s: encryption error (size: %u, adata: %u)\n", name,
+                                                  (unsigned int)sizes[i], (unsigned int)asizes[j] );
+        ok = ak_false;
+      }
+
+     /* однопроходное расшифрование на месте */
+      if(( decrypt( ekey, mkey, adata, asizes[j], out, out, sizes[i],
+                                         iv, ekey->bsize >> 1, icode, tsize ) != ak_error_ok ) ||
+         !ak_ptr_is_equal( out, plain, sizes[i] )) {
+        printf(" %s: decryption error (size: %u, adata: %u)\n", name,
+                                                  (unsigned int)sizes[i], (unsigned int)asizes[j] );
+        ok = ak_false;
+      }
+   }
+  }
+  printf(" %-9s %-10s %s\n", name, ( hkey == NULL ) ? akey->key.oid->name[0] :
+                                              hkey->key.oid->name[0], ok ? "Ok" : "Wrong" );
+ return ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i;
+  struct hmac hkey;
+  struct bckey ekey, akey;
+  int result = EXIT_SUCCESS;
+  ak_uint8 *data = NULL, *check = NULL, *out = NULL;
+  int ( *create[2] )( ak_bckey ) = { ak_bckey_create_kuznechik, ak_bckey_create_magma };
+  int ( *hcreate[2] )( ak_hmac ) = { ak_hmac_create_streebog256, ak_hmac_create_streebog512 };
+
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+  data = malloc( max_data_size + max_adata_size );
+  check = malloc( max_data_size );
+  out = malloc( max_data_size );
+  if(( data == NULL ) || ( check == NULL ) || ( out == NULL )) {
+    result = EXIT_FAILURE;
+    goto exit;
+  }
+  for( i = 0; i < max_data_size + max_adata_size; i++ ) data[i] = ( ak_uint8 )( i*7 + ( i >> 6 ));
+
+  for( i = 0; i < 2; i++ ) {
+     create[i]( &ekey );
+     create[i]( &akey );
+     ak_bckey_set_key( &ekey, key1, sizeof( key1 ));
+     ak_bckey_set_key( &akey, key2, sizeof( key2 ));
+     if( !test_mode( &ekey, &akey, NULL, data, check, out )) result = EXIT_FAILURE;
+
+     hcreate[i]( &hkey );
+     ak_hmac_set_key( &hkey, key2, sizeof( key2 ));
+     if( !test_mode( &ekey, NULL, &hkey, data, check, out )) result = EXIT_FAILURE;
+     ak_hmac_destroy( &hkey );
+     ak_bckey_destroy( &akey );
+     ak_bckey_destroy( &ekey );
+  }
+
+  exit:
+   if( out ) free( out );
+   if( check ) free( check );
+   if( data ) free( data );
+   ak_libakrypt_destroy();
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                            test-ctr-mac-tiles.c */
+/* ----------------------------------------------------------------------------------------------- */
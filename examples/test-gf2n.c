@@ -28,6 +28,8 @@
 
 #ifdef AK_HAVE_BUILTIN_CLMULEPI64
  static ak_uint8 delta[64] = { 0x0LL, 0x0LL, 0x0LL, 0x0LL, 0x0LL, 0x0LL, 0x0LL, 0x0LL };
+ /* реализация с pclmulqdq тестируется только на процессорах, поддерживающих эту инструкцию */
+ static bool_t pclmul = ak_false;
 #endif
 
 /* функция тестирования */
@@ -46,6 +48,34 @@
     printf(" (%s, %f sec)\n", str, (double)time / (double)CLOCKS_PER_SEC );
 }
 
+/* сравнение суммы попарных произведений с суммой, вычисленной с помощью умножения */
+ bool_t sumtest( size_t n, void (mul)( ak_pointer , ak_pointer , ak_pointer ),
+                       void (sum)( ak_pointer , ak_pointer , ak_pointer , const size_t ), char *str )
+{
+  size_t i, j, count;
+  ak_uint8 x[37*16], y[37*16+1], z[16], s1[16], s2[16];
+
+  for( i = 0; i < sizeof( x ); i++ ) x[i] = alpha[i%64] ^ ( ak_uint8 )i;
+  for( i = 0; i < sizeof( y ); i++ ) y[i] = beta[i%64] ^ ( ak_uint8 )( i >> 2 );
+
+  for( count = 0; count < 37; count++ ) {
+    /* второй массив передается с невыровненного адреса */
+     memset( s1, 0, sizeof( s1 )); memcpy( s2, alpha, n );
+     for( i = 0; i < count; i++ ) {
+        mul( z, x + i*n, y + 1 + i*n );
+        for( j = 0; j < n; j++ ) s1[j] ^= z[j];
+     }
+     for( j = 0; j < n; j++ ) s1[j] ^= alpha[j];
+     sum( s2, x, y + 1, count );
+     if( !ak_ptr_is_equal( s1, s2, n )) {
+       printf(" %s test is Wrong (count: %u)\n", str, (unsigned int)count );
+       return ak_false;
+     }
+  }
+  printf(" %s test is Ok\n", str );
+ return ak_true;
+}
+
  int main( void )
 {
    ak_uint8 t64[8] =
@@ -65,12 +95,19 @@
        0x7a, 0x9e, 0xf8, 0xe4, 0xab, 0x7f, 0x7b, 0x3b, 0x47, 0x95, 0x18, 0x3d, 0xf6, 0x73, 0x1c, 0x1e };
 
 
+   if( ak_libakrypt_create( NULL ) != ak_true ) return ak_libakrypt_destroy();
+ #ifdef AK_HAVE_BUILTIN_CLMULEPI64
+   pclmul = ( ak_libakrypt_dispatch.features&ak_cpu_feature_pclmul ) ? ak_true : ak_false;
+ #endif
+
    gftest( ak_gf64_mul_uint64, "ak_gf64_mul_uint64", 64, gamma );
  #ifdef AK_HAVE_BUILTIN_CLMULEPI64
-   gftest( ak_gf64_mul_pcmulqdq, "ak_gf64_mul_pcmulqdq", 64, delta );
-   printf(" dual test is ");
-   if( ak_ptr_is_equal( gamma, delta, 8 )) printf("Ok\n");
-     else { printf("Wrong\n"); return EXIT_FAILURE; }
+   if( pclmul ) {
+     gftest( ak_gf64_mul_pcmulqdq, "ak_gf64_mul_pcmulqdq", 64, delta );
+     printf(" dual test is ");
+     if( ak_ptr_is_equal( gamma, delta, 8 )) printf("Ok\n");
+       else { printf("Wrong\n"); return EXIT_FAILURE; }
+   }
  #endif
    printf(" const value test is ");
    if( ak_ptr_is_equal( gamma, t64, sizeof( t64 ))) printf("Ok\n\n");
@@ -79,10 +116,12 @@
 
    gftest( ak_gf128_mul_uint64, "ak_gf128_mul_uint64", 128, gamma );
  #ifdef AK_HAVE_BUILTIN_CLMULEPI64
-   gftest( ak_gf128_mul_pcmulqdq, "ak_gf128_mul_pcmulqdq", 128, delta );
-   printf(" dual test is ");
-   if( ak_ptr_is_equal( gamma, delta, 16 )) printf("Ok\n");
-     else { printf("Wrong\n"); return EXIT_FAILURE; }
+   if( pclmul ) {
+     gftest( ak_gf128_mul_pcmulqdq, "ak_gf128_mul_pcmulqdq", 128, delta );
+     printf(" dual test is ");
+     if( ak_ptr_is_equal( gamma, delta, 16 )) printf("Ok\n");
+       else { printf("Wrong\n"); return EXIT_FAILURE; }
+   }
  #endif
    printf(" const value test is ");
    if( ak_ptr_is_equal( gamma, t128, sizeof( t128 ))) printf("Ok\n\n");
@@ -91,10 +130,12 @@
 
    gftest( ak_gf256_mul_uint64, "ak_gf256_mul_uint64", 256, gamma );
  #ifdef AK_HAVE_BUILTIN_CLMULEPI64
-   gftest( ak_gf256_mul_pcmulqdq, "ak_gf256_mul_pcmulqdq", 256, delta );
-   printf(" dual test is ");
-   if( ak_ptr_is_equal( gamma, delta, 32 )) printf("Ok\n");
-     else { printf("Wrong\n"); return EXIT_FAILURE; }
+   if( pclmul ) {
+     gftest( ak_gf256_mul_pcmulqdq, "ak_gf256_mul_pcmulqdq", 256, delta );
+     printf(" dual test is ");
+     if( ak_ptr_is_equal( gamma, delta, 32 )) printf("Ok\n");
+       else { printf("Wrong\n"); return EXIT_FAILURE; }
+   }
  #endif
    printf(" const value test is ");
    if( ak_ptr_is_equal( gamma, t256, sizeof( t256 ))) printf("Ok\n\n");
@@ -103,14 +144,32 @@
 
    gftest( ak_gf512_mul_uint64, "", 512, gamma );
  #ifdef AK_HAVE_BUILTIN_CLMULEPI64
-   gftest( ak_gf512_mul_pcmulqdq, "", 512, delta );
-   printf(" dual test is ");
-   if( ak_ptr_is_equal( gamma, delta, 64 )) printf("Ok\n");
-     else { printf("Wrong\n"); return EXIT_FAILURE; }
+   if( pclmul ) {
+     gftest( ak_gf512_mul_pcmulqdq, "", 512, delta );
+     printf(" dual test is ");
+     if( ak_ptr_is_equal( gamma, delta, 64 )) printf("Ok\n");
+       else { printf("Wrong\n"); return EXIT_FAILURE; }
+   }
  #endif
    printf(" const value test is ");
    if( ak_ptr_is_equal( gamma, t512, 64 )) printf("Ok\n\n");
      else { printf("Wrong\n\n"); return EXIT_FAILURE; }
 
+  /* суммы произведений с однократным приведением по модулю */
+   if( !sumtest( 8, ak_gf64_mul_uint64, ak_gf64_mul_sum_uint64, "ak_gf64_mul_sum_uint64" ))
+     return EXIT_FAILURE;
+   if( !sumtest( 16, ak_gf128_mul_uint64, ak_gf128_mul_sum_uint64, "ak_gf128_mul_sum_uint64" ))
+     return EXIT_FAILURE;
+ #ifdef AK_HAVE_BUILTIN_CLMULEPI64
+   if( pclmul ) {
+     if( !sumtest( 8, ak_gf64_mul_uint64, ak_gf64_mul_sum_pcmulqdq, "ak_gf64_mul_sum_pcmulqdq" ))
+       return EXIT_FAILURE;
+     if( !sumtest( 16, ak_gf128_mul_uint64,
+                                        ak_gf128_mul_sum_pcmulqdq, "ak_gf128_mul_sum_pcmulqdq" ))
+       return EXIT_FAILURE;
+   }
+ #endif
+
+ ak_libakrypt_destroy();
  return EXIT_SUCCESS;
 }
@@ -0,0 +1,86 @@
+/* ----------------------------------------------------------------------------------------------- */
+/* Тестовый пример, проверяющий совпадение результатов одновременного хеширования нескольких
+   сообщений с результатами последовательного хеширования каждого сообщения.
+
+   test-hash-multi.c                                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+/* максимальное количество одновременно хешируемых сообщений */
+ #define messages (9)
+
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t test_hash( int ( *create )( ak_hash ), ak_uint8 *data )
+{
+  size_t i, count, size[messages];
+  struct hash ctx, mctx[messages];
+  ak_hash hptr[messages];
+  ak_pointer in[messages], out[messages];
+  ak_uint8 result[messages][64], check[64];
+  bool_t ok = ak_true;
+
+  create( &ctx );
+  for( i = 0; i < messages; i++ ) {
+     create( hptr[i] = mctx+i );
+     in[i] = data + 1000*i;
+     out[i] = result[i];
+  }
+
+ /* сообщения различной длины, включая пустые и кратные длине блока */
+  for( count = 1; count <= messages; count++ ) {
+     for( i = 0; i < count; i++ ) size[i] = ( i == 3 ) ? 0 : ( 64*( count+i ) + ( i&1 )*( 13*i ));
+     memset( result, 0, sizeof( result ));
+     ak_hash_ptr_multi( &ctx, in, size, out, sizeof( result[0] ), count );
+     for( i = 0; i < count; i++ ) {
+        ak_hash_ptr( &ctx, in[i], size[i], check, sizeof( check ));
+        if( !ak_ptr_is_equal( check, result[i], ak_hash_get_tag_size( &ctx ))) ok = ak_false;
+     }
+  }
+  printf(" %-12s ptr_multi:    %s\n", ctx.oid->name[0], ok ? "Ok" : "Wrong" );
+
+ /* последовательное обновление группы контекстов; часть контекстов содержит данные
+    во внутреннем буффере */
+  for( i = 0; i < messages; i++ ) {
+     ak_hash_clean( hptr[i] );
+     ak_hash_update( hptr[i], data + 1000*i, i%3 ? 0 : 7 );
+     in[i] = data + 1000*i + ( i%3 ? 0 : 7 );
+  }
+  ak_hash_update_multi( hptr, in, 200, messages );
+  for( i = 0; i < messages; i++ ) in[i] = (ak_uint8 *)in[i] + 200;
+  ak_hash_update_multi( hptr, in, 128, messages );
+  for( i = 0; i < messages; i++ ) {
+     ak_hash_finalize( hptr[i], NULL, 0, result[i], sizeof( result[i] ));
+     ak_hash_ptr( &ctx, data + 1000*i, 328 + ( i%3 ? 0 : 7 ), check, sizeof( check ));
+     if( !ak_ptr_is_equal( check, result[i], ak_hash_get_tag_size( &ctx ))) ok = ak_false;
+  }
+  printf(" %-12s update_multi: %s\n", ctx.oid->name[0], ok ? "Ok" : "Wrong" );
+
+  for( i = 0; i < messages; i++ ) ak_hash_destroy( hptr[i] );
+  ak_hash_destroy( &ctx );
+ return ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i;
+  int result = EXIT_SUCCESS;
+  ak_uint8 data[ 1000*messages + 1024 ];
+
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+  for( i = 0; i < sizeof( data ); i++ ) data[i] = ( ak_uint8 )( i*17 + ( i >> 7 ));
+
+  if( !test_hash( ak_hash_create_streebog256, data )) result = EXIT_FAILURE;
+  if( !test_hash( ak_hash_create_streebog512, data )) result = EXIT_FAILURE;
+
+  ak_libakrypt_destroy();
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                               test-hash-multi.c */
+/* ----------------------------------------------------------------------------------------------- */
@@ -0,0 +1,105 @@
+/* ----------------------------------------------------------------------------------------------- */
+/* Тестовый пример, проверяющий совпадение результатов древовидного хеширования, выполняемого
+   с помощью пула потоков, с результатами, вычисленными последовательно по определению дерева.
+
+   test-hash-tree.c                                                                                */
+/* ----------------------------------------------------------------------------------------------- */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+/* вычисление хеш-кода поддерева, содержащего данные длины size, по определению:
+   листья дополняются октетом 0x00, вершины - октетом 0x01, левое поддерево является полным
+   деревом максимально возможной высоты */
+ static void tree_root( ak_hash ctx, const ak_uint8 *data, const size_t size, ak_uint8 *out )
+{
+  ak_uint8 left[64], right[64], suffix[1];
+  size_t hsize = ak_hash_get_tag_size( ctx ), half = ak_hash_tree_leaf_size;
+
+  if( size <= ak_hash_tree_leaf_size ) {
+    suffix[0] = 0x00;
+    ak_hash_clean( ctx );
+    ak_hash_update( ctx, (ak_pointer) data, size );
+    ak_hash_finalize( ctx, suffix, 1, out, 64 );
+    return;
+  }
+  while(( half << 1 ) < size ) half <<= 1;
+  tree_root( ctx, data, half, left );
+  tree_root( ctx, data + half, size - half, right );
+
+  suffix[0] = 0x01;
+  ak_hash_clean( ctx );
+  ak_hash_update( ctx, left, hsize );
+  ak_hash_update( ctx, right, hsize );
+  ak_hash_finalize( ctx, suffix, 1, out, 64 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t test_tree( int ( *create )( ak_hash ), int ( *create_leaf )( ak_hash ),
+                                                                ak_uint8 *data, const size_t size )
+{
+  size_t i, j, off, len;
+  struct hash tctx, sctx;
+  ak_uint8 result[64], check[64];
+  bool_t ok = ak_true;
+  const size_t lengths[] = { 0, 100, 4096, ak_hash_tree_leaf_size, ak_hash_tree_leaf_size + 63,
+                             2*ak_hash_tree_leaf_size, 3*ak_hash_tree_leaf_size + 64*5 + 17, size };
+  const size_t chunks[] = { 777, 100000, 3*ak_hash_tree_leaf_size };
+
+  create( &tctx );
+  create_leaf( &sctx );
+  for( i = 0; i < sizeof( lengths )/sizeof( size_t ); i++ ) {
+     tree_root( &sctx, data, lengths[i], check );
+     memset( result, 0, sizeof( result ));
+     ak_hash_ptr( &tctx, data, lengths[i], result, sizeof( result ));
+     if( !ak_ptr_is_equal( check, result, ak_hash_get_tag_size( &tctx ))) ok = ak_false;
+
+    /* обработка данных фрагментами различной длины */
+     for( j = 0; j < sizeof( chunks )/sizeof( size_t ); j++ ) {
+        ak_hash_clean( &tctx );
+        for( off = 0; off < lengths[i]; off += len ) {
+           len = ak_min( chunks[j], lengths[i] - off );
+           ak_hash_update( &tctx, data + off, len );
+        }
+        memset( result, 0, sizeof( result ));
+        ak_hash_finalize( &tctx, NULL, 0, result, sizeof( result ));
+        if( !ak_ptr_is_equal( check, result, ak_hash_get_tag_size( &tctx ))) ok = ak_false;
+     }
+  }
+  printf(" %-17s %s\n", tctx.oid->name[0], ok ? "Ok" : "Wrong" );
+
+  ak_hash_destroy( &sctx );
+  ak_hash_destroy( &tctx );
+ return ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i;
+  ak_uint8 *data = NULL;
+  int result = EXIT_SUCCESS;
+  const size_t size = 5*ak_hash_tree_leaf_size + 1000;
+
+ /* листья дерева вычисляются рабочими потоками библиотеки */
+  ak_libakrypt_set_option( "thread_pool_size", 4 );
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+  if(( data = malloc( size )) == NULL ) return ak_libakrypt_destroy();
+  for( i = 0; i < size; i++ ) data[i] = ( ak_uint8 )( i*17 + ( i >> 7 ));
+
+  if( !test_tree( ak_hash_create_streebog256_tree, ak_hash_create_streebog256, data, size ))
+    result = EXIT_FAILURE;
+  if( !test_tree( ak_hash_create_streebog512_tree, ak_hash_create_streebog512, data, size ))
+    result = EXIT_FAILURE;
+
+  free( data );
+  ak_libakrypt_destroy();
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                                test-hash-tree.c */
+/* ----------------------------------------------------------------------------------------------- */
@@ -0,0 +1,198 @@
+/* ----------------------------------------------------------------------------------------------- */
+/* Тестовый пример, проверяющий совпадение результатов шифрования, аутентифицированного шифрования
+   и хеширования данных, разбитых на фрагменты произвольной длины, с результатами обработки
+   тех же данных, расположенных в памяти последовательно.
+
+   test-iovector.c                                                                                 */
+/* ----------------------------------------------------------------------------------------------- */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define max_data_size (3001)
+ #define max_fragments (64)
+
+ static ak_uint8 key1[32] = {
+     0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+     0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+ static ak_uint8 key2[32] = {
+     0xff, 0xfe, 0xfd, 0xfc, 0xfb, 0xfa, 0xf9, 0xf8, 0xf7, 0xf6, 0xf5, 0xf4, 0xf3, 0xf2, 0xf1, 0xf0,
+     0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff };
+ static ak_uint8 iv[16] = {
+     0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11 };
+
+/* ----------------------------------------------------------------------------------------------- */
+/* разбиение области памяти на фрагменты, длины которых циклически выбираются из массива lens;
+   функция возвращает количество фрагментов */
+ static size_t split( ak_uint8 *data, const size_t size,
+                                    const size_t *lens, const size_t lcount, struct iovector *iov )
+{
+  size_t count = 0, off = 0, len = 0;
+
+  for( off = 0; off < size; off += len, count++ ) {
+     len = ak_min( lens[count%lcount], size - off );
+     iov[count].data = data + off;
+     iov[count].size = len;
+  }
+ return count;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* проверка того, что разбиение данных заданной длины помещается в массив фрагментов */
+ static bool_t fits( const size_t size, const size_t *lens )
+{
+  return ( size <= ( lens[0] + lens[1] + lens[2] + lens[3] )*( max_fragments/4 - 1 ));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t test_cipher( ak_bckey ekey, ak_bckey akey,
+                                    ak_uint8 *data, ak_uint8 *check, ak_uint8 *out, ak_uint8 *back )
+{
+  size_t i, j, k, n, count, ocount, acount;
+  bool_t ok = ak_true;
+  ak_uint8 icode[16], icode2[16];
+  struct iovector ain[max_fragments], vin[max_fragments], vout[max_fragments];
+  const size_t sizes[] = { 1, 15, 16, 17, 100, 1000, max_data_size };
+  const size_t asizes[] = { 0, 5, 41 };
+  const size_t lens[][4] = {{ 1, 1, 1, 1 }, { 3, 7, 5, 13 }, { 16, 16, 16, 16 },
+                                                        { 17, 2, 31, 1 }, { 1000, 1, 500, 33 }};
+  const size_t lcount = sizeof( lens )/sizeof( lens[0] );
+
+  for( i = 0; i < sizeof( sizes )/sizeof( size_t ); i++ ) {
+     for( k = 0; k < lcount; k++ ) {
+       /* количество фрагментов ограничено размером массива */
+        if( !fits( sizes[i], lens[k] )) continue;
+       /* разбиение выходных данных, отличное от разбиения входных данных */
+        n = ( k+1 )%lcount;
+        if( !fits( sizes[i], lens[n] )) n = k;
+
+       /* режим гаммирования, результат помещается в отдельные фрагменты */
+        memset( check, 0, max_data_size );
+        memset( out, 0, max_data_size );
+        ak_bckey_ctr( ekey, data, check, sizes[i], iv, ekey->bsize >> 1 );
+        count = split( data, sizes[i], lens[k], 4, vin );
+        ocount = split( out, sizes[i], lens[n], 4, vout );
+        if(( ak_bckey_ctr_v( ekey, vin, count, vout, ocount,
+                                                       iv, ekey->bsize >> 1 ) != ak_error_ok ) ||
+                                                           !ak_ptr_is_equal( out, check, sizes[i] )) {
+          printf(" ctr: error (size: %u, fragments: %u, %u)\n", (unsigned int)sizes[i],
+                                                      (unsigned int)count, (unsigned int)ocount );
+          ok = ak_false;
+        }
+
+        for( j = 0; j < sizeof( asizes )/sizeof( size_t ); j++ ) {
+          /* режим mgm, зашифрование на месте */
+           memset( check, 0, max_data_size );
+           ak_bckey_encrypt_mgm( ekey, akey, data + max_data_size, asizes[j], data, check, sizes[i],
+                                                        iv, sizeof( iv ), icode, ekey->bsize );
+           memcpy( out, data, sizes[i] );
+           acount = split( data + max_data_size, asizes[j], lens[lcount-1-k], 4, ain );
+           count = split( out, sizes[i], lens[k], 4, vin );
+           memset( icode2, 0, sizeof( icode2 ));
+           if(( ak_bckey_encrypt_mgm_v( ekey, akey, ain, acount, vin, count, vin, count,
+                                      iv, sizeof( iv ), icode2, ekey->bsize ) != ak_error_ok ) ||
+              !ak_ptr_is_equal( out, check, sizes[i] ) ||
+              !ak_ptr_is_equal( icode, icode2, ekey->bsize )) {
+             printf(" mgm: encryption error (size: %u, adata: %u, fragments: %u)\n",
+                         (unsigned int)sizes[i], (unsigned int)asizes[j], (unsigned int)count );
+             ok = ak_false;
+           }
+
+          /* расшифрование в отдельные фрагменты с другим разбиением */
+           memset( back, 0, max_data_size );
+           ocount = split( back, sizes[i], lens[n], 4, vout );
+           if(( ak_bckey_decrypt_mgm_v( ekey, akey, ain, acount, vin, count, vout, ocount,
+                                      iv, sizeof( iv ), icode, ekey->bsize ) != ak_error_ok ) ||
+              !ak_ptr_is_equal( back, data, sizes[i] )) {
+             printf(" mgm: decryption error (size: %u, adata: %u, fragments: %u)\n",
+                         (unsigned int)sizes[i], (unsigned int)asizes[j], (unsigned int)count );
+             ok = ak_false;
+           }
+
+          /* расшифрование с неверной имитовставкой */
+           icode[0] ^= 0x01;
+           if( ak_bckey_decrypt_mgm_v( ekey, akey, ain, acount, vin, count, vout, ocount,
+                               iv, sizeof( iv ), icode, ekey->bsize ) != ak_error_not_equal_data ) {
+             printf(" mgm: wrong integrity code accepted (size: %u, adata: %u)\n",
+                                                  (unsigned int)sizes[i], (unsigned int)asizes[j] );
+             ok = ak_false;
+           }
+        }
+     }
+  }
+  printf(" %-10s %s\n", ekey->key.oid->name[0], ok ? "Ok" : "Wrong" );
+ return ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t test_hash( int ( *create )( ak_hash ), ak_uint8 *data )
+{
+  size_t k, count;
+  struct hash ctx;
+  bool_t ok = ak_true;
+  ak_uint8 result[64], check[64];
+  struct iovector vin[max_fragments];
+  const size_t lens[][4] = {{ 1, 2, 3, 4 }, { 63, 65, 64, 1 }, { 1000, 7, 500, 129 }};
+
+  create( &ctx );
+  for( k = 0; k < sizeof( lens )/sizeof( lens[0] ); k++ ) {
+     count = split( data, ak_min( max_data_size, 25*lens[k][0] ), lens[k], 4, vin );
+     ak_hash_ptr( &ctx, data, ak_min( max_data_size, 25*lens[k][0] ), check, sizeof( check ));
+     memset( result, 0, sizeof( result ));
+     ak_hash_clean( &ctx );
+     ak_hash_update_v( &ctx, vin, count );
+     ak_hash_finalize( &ctx, NULL, 0, result, sizeof( result ));
+     if( !ak_ptr_is_equal( check, result, ak_hash_get_tag_size( &ctx ))) ok = ak_false;
+  }
+  printf(" %-10s %s\n", ctx.oid->name[0], ok ? "Ok" : "Wrong" );
+  ak_hash_destroy( &ctx );
+ return ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  size_t i;
+  struct bckey ekey, akey;
+  int result = EXIT_SUCCESS;
+  ak_uint8 *data = NULL, *check = NULL, *out = NULL, *back = NULL;
+  int ( *create[2] )( ak_bckey ) = { ak_bckey_create_kuznechik, ak_bckey_create_magma };
+
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+  data = malloc( max_data_size + 64 );
+  check = malloc( max_data_size );
+  out = malloc( max_data_size );
+  back = malloc( max_data_size );
+  if(( data == NULL ) || ( check == NULL ) || ( out == NULL ) || ( back == NULL )) {
+    result = EXIT_FAILURE;
+    goto exit;
+  }
+  for( i = 0; i < max_data_size + 64; i++ ) data[i] = ( ak_uint8 )( i*11 + ( i >> 4 ));
+
+  for( i = 0; i < 2; i++ ) {
+     create[i]( &ekey );
+     create[i]( &akey );
+     ak_bckey_set_key( &ekey, key1, sizeof( key1 ));
+     ak_bckey_set_key( &akey, key2, sizeof( key2 ));
+     if( !test_cipher( &ekey, &akey, data, check, out, back )) result = EXIT_FAILURE;
+     ak_bckey_destroy( &akey );
+     ak_bckey_destroy( &ekey );
+  }
+  if( !test_hash( ak_hash_create_streebog256, data )) result = EXIT_FAILURE;
+  if( !test_hash( ak_hash_create_streebog512, data )) result = EXIT_FAILURE;
+
+  exit:
+   if( back ) free( back );
+   if( out ) free( out );
+   if( check ) free( check );
+   if( data ) free( data );
+   ak_libakrypt_destroy();
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                                 test-iovector.c */
+/* ----------------------------------------------------------------------------------------------- */
@@ -81,7 +81,7 @@
 {
   size_t i = 0, errors_gmp = 0, val = 0;
   mpz_t xm, ym, zm, tm, pm, rm, gm, sm, um, nm;
-  ak_mpznmax x, y, n, p, z;
+  ak_mpznmax x, y, n, p, z, w;
   struct random generator;
   clock_t tmr;
 
@@ -132,7 +132,9 @@
 
      ak_mpzn_mul_montgomery( z, x, y, p, n0, size );
      ak_mpzn_to_mpz( z, size, zm );
-     if( mpz_cmp( um, zm ) == 0 ) val++;
+    /* выбранная реализация должна совпадать с реализацией, не использующей расширений */
+     ak_mpzn_mul_montgomery_uint64( w, x, y, p, n0, size );
+     if(( mpz_cmp( um, zm ) == 0 ) && ( ak_mpzn_cmp( w, z, size ) == 0 )) val++;
   }
   printf(" correct montgomery multiplications %ld from %ld with %ld gmp errors\n", val, count, errors_gmp );
 
@@ -224,6 +226,107 @@
  return ( val == count );
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/* тест для операций вычисления обратного элемента по модулям p и q эллиптической кривой */
+ bool_t modinv_test( ak_wcurve wc, size_t count )
+{
+  size_t i = 0, j = 0, val = 0;
+  mpz_t xm, zm, pm;
+  ak_mpznmax x, z, t, one = ak_mpznmax_one;
+  ak_uint64 *mod[2] = { wc->p, wc->q }, n[2] = { wc->n, wc->nq };
+  struct random generator;
+
+  mpz_init(xm);
+  mpz_init(zm);
+  mpz_init(pm);
+  ak_random_create_lcg( &generator );
+
+  for( j = 0; j < 2; j++ ) {
+     ak_mpzn_to_mpz( mod[j], wc->size, pm );
+     for( i = 0; i < count; i++ ) {
+        ak_mpzn_set_random_modulo( x, mod[j], wc->size, &generator );
+        if( i == 0 ) ak_mpzn_set_ui( x, wc->size, 1 );
+        ak_mpzn_to_mpz( x, wc->size, xm );
+
+       /* бинарный алгоритм: z = x^{-1} (mod p) */
+        mpz_invert( zm, xm, pm );
+        ak_mpzn_modinv_binary( z, x, mod[j], wc->size );
+        ak_mpzn_to_mpz( z, wc->size, xm );
+        if( mpz_cmp( xm, zm ) != 0 ) continue;
+
+       /* представление Монтгомери: (x^{-1}r)(xr)r^{-1}r^{-1} = 1 (mod p) */
+        ak_mpzn_modinv_montgomery( z, x, mod[j], n[j], wc->size );
+        ak_mpzn_mul_montgomery( t, z, x, mod[j], n[j], wc->size );
+        ak_mpzn_mul_montgomery( t, t, one, mod[j], n[j], wc->size );
+        if( ak_mpzn_cmp_ui( t, wc->size, 1 )) val++;
+     }
+  }
+  printf(" correct inversions %ld from %ld\n\n", val, 2*count );
+
+  ak_random_destroy( &generator );
+  mpz_clear(pm);
+  mpz_clear(zm);
+  mpz_clear(xm);
+
+ return ( val == 2*count );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* тест для умножения по модулю p, выбираемого в соответствии с видом модуля эллиптической кривой */
+ bool_t wcurve_mul_test( ak_wcurve wc, size_t count )
+{
+  size_t i = 0, val = 0;
+  mpz_t xm, ym, zm, pm, rm;
+  ak_mpznmax x, y, z, w;
+  struct random generator;
+
+  mpz_init(xm);
+  mpz_init(ym);
+  mpz_init(zm);
+  mpz_init(pm);
+  mpz_init(rm);
+  ak_random_create_lcg( &generator );
+
+  ak_mpzn_to_mpz( wc->p, wc->size, pm );
+  mpz_set_ui( rm, 2 ); mpz_pow_ui( rm, rm, wc->size*64 );
+  mpz_invert( rm, rm, pm );
+  for( i = 0; i < count; i++ ) {
+     ak_mpzn_set_random_modulo( x, wc->p, wc->size, &generator );
+     ak_mpzn_set_random_modulo( y, wc->p, wc->size, &generator );
+    /* граничные значения: p-1 и ноль */
+     if( i < 2 ) {
+       ak_mpzn_set_ui( x, wc->size, 1 );
+       ak_mpzn_sub( x, wc->p, x, wc->size );
+       if( i == 0 ) ak_mpzn_set( y, x, wc->size );
+        else ak_mpzn_set_ui( y, wc->size, 0 );
+     }
+     ak_mpzn_to_mpz( x, wc->size, xm );
+     ak_mpzn_to_mpz( y, wc->size, ym );
+     mpz_mul( zm, xm, ym ); mpz_mul( zm, zm, rm ); mpz_mod( zm, zm, pm );
+
+     ak_wcurve_mul( wc )( z, x, y, wc->p, wc->n, wc->size );
+     ak_mpzn_to_mpz( z, wc->size, xm );
+     if( mpz_cmp( xm, zm ) != 0 ) continue;
+    /* специализированная реализация проверяется независимо от выбора таблицы реализаций */
+     if( wc->field == wcurve_field_pseudo_mersenne ) {
+       ak_mpzn_mul_montgomery_pseudo_mersenne_uint64( w, x, y, wc->p, wc->n, wc->size );
+       if( ak_mpzn_cmp( w, z, wc->size ) != 0 ) continue;
+     }
+     val++;
+  }
+  printf(" correct multiplications (%s modulo) %ld from %ld\n\n",
+    wc->field == wcurve_field_pseudo_mersenne ? "pseudo-mersenne" : "generic", val, count );
+
+  ak_random_destroy( &generator );
+  mpz_clear(rm);
+  mpz_clear(pm);
+  mpz_clear(zm);
+  mpz_clear(ym);
+  mpz_clear(xm);
+
+ return ( val == count );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  int main( void )
 {
@@ -249,9 +352,12 @@
         totalmany++;
         if( mul_montgomery_test( wc->size, str, wc->n, count )) howmany++;
         if( str ) free( (void *)str );
-
-  // добавить modpow!!
-
+        printf(" - ak_mpzn_modinv_binary() and ak_mpzn_modinv_montgomery() functions test started\n");
+        totalmany++;
+        if( modinv_test( wc, count/1000 )) howmany++;
+        printf(" - ak_wcurve_mul() function test started\n");
+        totalmany++;
+        if( wcurve_mul_test( wc, count/10 )) howmany++;
       }
       if( wc->size == ak_mpzn512_size ) {
         printf(" - p: %s\n", str = ak_mpzn_to_hexstr_alloc( wc->p, wc->size ));
@@ -262,6 +368,12 @@
         totalmany++;
         if( mul_montgomery_test( wc->size, str, wc->n, count )) howmany++;
         if( str ) free( (void *)str );
+        printf(" - ak_mpzn_modinv_binary() and ak_mpzn_modinv_montgomery() functions test started\n");
+        totalmany++;
+        if( modinv_test( wc, count/1000 )) howmany++;
+        printf(" - ak_wcurve_mul() function test started\n");
+        totalmany++;
+        if( wcurve_mul_test( wc, count/10 )) howmany++;
       }
     }
     oid = ak_oid_findnext_by_engine( oid, identifier );
@@ -0,0 +1,101 @@
+/* ----------------------------------------------------------------------------------------------- */
+/* Тестовый пример, проверяющий совпадение кратных точек эллиптических кривых, вычисляемых
+   различными способами: с помощью лесенки Монтгомери, с помощью предвычисленных таблиц,
+   а также одновременным вычислением суммы двух кратных точек.
+
+   test-wpoint-pow.c                                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define random_values (40)
+
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t test_curve( ak_oid oid, ak_random generator )
+{
+  size_t i;
+  bool_t ok = ak_true;
+  struct wpoint wp, wq, wt;
+  ak_mpzn512 k, k2, one = ak_mpzn512_one;
+  ak_wcurve wc = ( ak_wcurve )oid->data;
+
+  for( i = 0; i < random_values + 6; i++ ) {
+     switch( i ) {
+      /* граничные значения степени */
+       case 0: ak_mpzn_set_ui( k, wc->size, 0 ); break;
+       case 1: ak_mpzn_set_ui( k, wc->size, 1 ); break;
+       case 2: ak_mpzn_set_ui( k, wc->size, 2 ); break;
+       case 3: ak_mpzn_sub( k, wc->q, one, wc->size ); break;
+       case 4: ak_mpzn_set( k, wc->q, wc->size ); break;
+       case 5: memset( k, 0xff, wc->size*sizeof( ak_uint64 )); break;
+      /* случайные значения, как вычеты, так и произвольные числа */
+       default:
+         if( i&1 ) ak_mpzn_set_random_modulo( k, wc->q, wc->size, generator );
+          else ak_mpzn_set_random( k, wc->size, generator );
+     }
+     ak_wpoint_pow( &wp, &wc->point, k, wc->size, wc );
+     ak_wpoint_reduce( &wp, wc );
+     ak_wpoint_pow_base( &wq, k, wc->size, wc );
+     ak_wpoint_reduce( &wq, wc );
+
+     if( ak_mpzn_cmp( wp.x, wq.x, wc->size ) || ak_mpzn_cmp( wp.y, wq.y, wc->size ) ||
+         ak_mpzn_cmp( wp.z, wq.z, wc->size )) {
+       printf(" %s: wrong base point multiple (k = %s)\n",
+                                               oid->name[0], ak_mpzn_to_hexstr( k, wc->size ));
+       ok = ak_false;
+     }
+
+    /* сумма кратных точек P и Q = [k2]P (при i = 1 точки P и Q совпадают) */
+     ak_mpzn_set_random_modulo( k2, wc->q, wc->size, generator );
+     if( i == 1 ) ak_mpzn_set_ui( k2, wc->size, 1 );
+     ak_wpoint_pow( &wt, &wc->point, k2, wc->size, wc );
+     ak_wpoint_reduce( &wt, wc );
+     ak_mpzn_set_random_modulo( k2, wc->q, wc->size, generator );
+     if( i == 2 ) ak_mpzn_set_ui( k2, wc->size, 0 );
+     ak_wpoint_pow( &wp, &wc->point, k, wc->size, wc );
+     ak_wpoint_pow( &wq, &wt, k2, wc->size, wc );
+     ak_wpoint_add( &wp, &wq, wc );
+     ak_wpoint_reduce( &wp, wc );
+     ak_wpoint_pow_base_sum( &wq, k, &wt, k2, wc->size, wc );
+     ak_wpoint_reduce( &wq, wc );
+
+     if( ak_mpzn_cmp( wp.x, wq.x, wc->size ) || ak_mpzn_cmp( wp.y, wq.y, wc->size ) ||
+         ak_mpzn_cmp( wp.z, wq.z, wc->size )) {
+       printf(" %s: wrong sum of multiples (k = %s)\n",
+                                               oid->name[0], ak_mpzn_to_hexstr( k, wc->size ));
+       ok = ak_false;
+     }
+  }
+  printf(" %-40s %s\n", oid->name[0], ok ? "Ok" : "Wrong" );
+ return ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+  ak_oid oid = NULL;
+  struct random generator;
+  int result = EXIT_SUCCESS;
+
+  if( !ak_libakrypt_create( ak_function_log_stderr )) return ak_libakrypt_destroy();
+  ak_random_create_lcg( &generator );
+
+  oid = ak_oid_find_by_engine( identifier );
+  while( oid != NULL ) {
+    if( oid->mode == wcurve_params )
+      if( !test_curve( oid, &generator )) result = EXIT_FAILURE;
+    oid = ak_oid_findnext_by_engine( oid, identifier );
+  }
+
+  ak_random_destroy( &generator );
+  ak_libakrypt_destroy();
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                               test-wpoint-pow.c */
+/* ----------------------------------------------------------------------------------------------- */
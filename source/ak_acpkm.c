@@ -42,16 +42,12 @@
  /* выработка нового значения */
    switch( bkey->bsize ) {
       case  8: /* шифр с длиной блока 64 бита */
-         bkey->encrypt( &bkey->key, acpkm, new_key );
-         bkey->encrypt( &bkey->key, acpkm +8, new_key +8 );
-         bkey->encrypt( &bkey->key, acpkm +16, new_key +16 );
-         bkey->encrypt( &bkey->key, acpkm +24, new_key +24 );
-         counter = ak_libakrypt_get_option_by_name( "acpkm_section_magma_block_count" );
+         bkey->encrypt_blocks( &bkey->key, acpkm, new_key, 4 );
+         counter = bkey->options.acpkm_section_block_count;
          break;
       case 16: /* шифр с длиной блока 128 бит */
-         bkey->encrypt( &bkey->key, acpkm, new_key );
-         bkey->encrypt( &bkey->key, acpkm +16, new_key +16 );
-         counter = ak_libakrypt_get_option_by_name( "acpkm_section_kuznechik_block_count" );
+         bkey->encrypt_blocks( &bkey->key, acpkm, new_key, 2 );
+         counter = bkey->options.acpkm_section_block_count;
          break;
       default: return ak_error_message( ak_error_wrong_block_cipher,
                                            __func__ , "incorrect block size of block cipher key" );
@@ -168,8 +164,8 @@
                                                              а также устанавливаем синхропосылку */
   switch( bkey->bsize ) {
     case 8:
-       maxseclen = ak_libakrypt_get_option_by_name( "acpkm_section_magma_block_count" );
-       mcount = ak_libakrypt_get_option_by_name( "magma_cipher_resource" )/maxseclen;
+       maxseclen = bkey->options.acpkm_section_block_count;
+       mcount = bkey->options.cipher_resource/maxseclen;
        #ifdef AK_LITTLE_ENDIAN
          ctr[0] = ((ak_uint64 *)iv)[0] << 32;
        #else
@@ -178,8 +174,8 @@
       break;
 
     case 16:
-       maxseclen = ak_libakrypt_get_option_by_name( "acpkm_section_kuznechik_block_count" );
-       mcount = ak_libakrypt_get_option_by_name( "kuznechik_cipher_resource" )/maxseclen;
+       maxseclen = bkey->options.acpkm_section_block_count;
+       mcount = bkey->options.cipher_resource/maxseclen;
        ctr[1] = ((ak_uint64 *) iv)[0];
       break;
     default: return ak_error_message( ak_error_wrong_block_cipher,
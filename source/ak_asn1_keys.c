@@ -187,7 +187,7 @@
   ak_random_ptr( &generator, salt, sizeof( salt ));
 
   if(( error = ak_bckey_create_key_pair_from_password( ekey, ikey, oid, password, pass_size,
-      salt, sizeof( salt ), (size_t) ak_libakrypt_get_option_by_name( "pbkdf2_iteration_count" )))
+      salt, sizeof( salt ), (size_t) ak_libakrypt_get_option( pbkdf2_iteration_count_option )))
                                                                                   != ak_error_ok )
     return ak_error_message( error, __func__, "incorrect creation of derived key pairs");
 
@@ -201,7 +201,7 @@
    ak_asn1_add_oid( asn3, ak_oid_find_by_name( "hmac-streebog512" )->id[0] );
    ak_asn1_add_octet_string( asn3, salt, sizeof( salt ));
    ak_asn1_add_uint32( asn3,
-                         ( ak_uint32 )ak_libakrypt_get_option_by_name( "pbkdf2_iteration_count" ));
+                         ( ak_uint32 )ak_libakrypt_get_option( pbkdf2_iteration_count_option ));
 
    if(( ak_asn1_create( asn2 = malloc( sizeof( struct asn1 )))) != ak_error_ok ) {
      ak_bckey_destroy( ikey );
@@ -435,7 +435,7 @@
     return ak_error_message( error, __func__, "incorrect adding data storage identifier" );
   }
   if(( error = ak_asn1_add_uint32( content,
-        ( ak_uint32 )ak_libakrypt_get_option_by_name( "openssl_compability" ))) != ak_error_ok ) {
+        ( ak_uint32 )ak_libakrypt_get_option( openssl_compability_option ))) != ak_error_ok ) {
     ak_asn1_delete( content );
     return ak_error_message( error, __func__, "incorrect adding data storage identifier" );
   }
@@ -1056,7 +1056,7 @@
    if(( DATA_STRUCTURE( asn->current->tag ) != PRIMITIVE ) ||
             ( TAG_NUMBER( asn->current->tag ) != TINTEGER )) return ak_error_invalid_asn1_tag;
    ak_tlv_get_uint32( asn->current, &u32 );  /* теперь u32 содержит флаг совместимости с openssl */
-   if( u32 !=  (oc = ( ak_uint32 )ak_libakrypt_get_option_by_name( "openssl_compability" ))) /* текущее значение */
+   if( u32 !=  (oc = ( ak_uint32 )ak_libakrypt_get_option( openssl_compability_option ))) /* текущее значение */
      ak_libakrypt_set_openssl_compability( u32 );
 
   /* расшифровываем и проверяем имитовставку */
@@ -4,7 +4,7 @@
 /*  Файл ak_bckey.c                                                                                */
 /*  - содержит реализацию общих функций для алгоритмов блочного шифрования.                        */
 /* ----------------------------------------------------------------------------------------------- */
- #include <libakrypt.h>
+ #include <libakrypt-internal.h>
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция устанавливает параметры алгоритма блочного шифрования, передаваемые в качестве
@@ -13,6 +13,8 @@
 
     - bkey.encrypt -- алгоритм зашифрования одного блока
     - bkey.decrypt -- алгоритм расшифрования одного блока
+    - bkey.encrypt_blocks -- алгоритм зашифрования последовательности независимых блоков
+    - bkey.decrypt_blocks -- алгоритм расшифрования последовательности независимых блоков
     - bkey.shedule_keys -- алгоритм развертки ключа и генерации раундовых ключей
     - bkey.delete_keys -- функция удаления раундовых ключей
 
@@ -24,6 +26,7 @@
     - bkey.key.unmask -- функция снятия маски с ключа
     - bkey.key.set_icode -- функция вычисления кода целостности
     - bkey.key.check_icode -- функция проверки кода целостности
+    - bkey.options -- значения опций библиотеки, действующие в момент создания ключа
 
     Перечисленные методы могут переопределяться в производящих функциях,
     создающих объекты конкретных алгоритмов блочного шифрования.
@@ -37,12 +40,30 @@
  int ak_bckey_create( ak_bckey bkey, size_t keysize, size_t blocksize )
 {
   int error = ak_error_ok;
+  struct options_snapshot snapshot;
   if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                    "using a null pointer to block cipher context" );
   if( !keysize ) return ak_error_message( ak_error_zero_length, __func__,
                                                         "using block cipher key with zero length" );
   if( !blocksize ) return ak_error_message( ak_error_zero_length, __func__,
                                                             "using cipher with zero block length" );
+ /* запоминаем значения опций, используемые ключом */
+  if(( error = ak_libakrypt_get_options_snapshot( &snapshot )) != ak_error_ok )
+    return ak_error_message( error, __func__, "wrong reading of library options" );
+  bkey->options.openssl_compability = snapshot.value[openssl_compability_option];
+  switch( blocksize ) {
+    case  8: bkey->options.cipher_resource = snapshot.value[magma_cipher_resource_option];
+             bkey->options.acpkm_section_block_count =
+                                           snapshot.value[acpkm_section_magma_block_count_option];
+             break;
+    case 16: bkey->options.cipher_resource = snapshot.value[kuznechik_cipher_resource_option];
+             bkey->options.acpkm_section_block_count =
+                                       snapshot.value[acpkm_section_kuznechik_block_count_option];
+             break;
+    default: return ak_error_message( ak_error_wrong_block_cipher_length, __func__,
+                                                        "incorrect value of block cipher length" );
+  }
+
  /* инициализируем ключевые данные */
   if(( error = ak_skey_create( &bkey->key, keysize )) != ak_error_ok )
     return ak_error_message( error, __func__, "wrong creation of secret key" );
@@ -52,6 +73,8 @@
   bkey->ivector_size =  0;
   bkey->encrypt =       NULL;
   bkey->decrypt =       NULL;
+  bkey->encrypt_blocks = NULL;
+  bkey->decrypt_blocks = NULL;
   bkey->schedule_keys = NULL;
   bkey->delete_keys =   NULL;
 
@@ -86,6 +109,8 @@
   bkey->bsize =            0;
   bkey->encrypt =       NULL;
   bkey->decrypt =       NULL;
+  bkey->encrypt_blocks = NULL;
+  bkey->decrypt_blocks = NULL;
   bkey->schedule_keys = NULL;
   bkey->delete_keys =   NULL;
 
@@ -154,7 +179,7 @@
                                        "using a constant value for secret key with wrong length" );
 
  /* дополнительный переворот ключа для алгоритма Магма (в режиме совместимости с openssl) */
-  if(( ak_libakrypt_get_option_by_name( "openssl_compability" ) == 1 ) &&
+  if(( bkey->options.openssl_compability == 1 ) &&
                                          ( strncmp( bkey->key.oid->name[0], "magma", 5 ) == 0 )) {
     int i = 0;
     ak_uint8 revkey[32];
@@ -177,20 +202,9 @@
       ak_error_message( error, __func__, "incorrect execution of key scheduling procedure" );
   }
  /* устанавливаем ресурс использования секретного ключа */
-  switch( bkey->bsize ) {
-    case  8: if(( error = ak_skey_set_resource_values( &bkey->key,
-                      block_counter_resource, "magma_cipher_resource", 0, 0 )) != ak_error_ok )
-       ak_error_message( error, __func__, "incorrect assigning \"magma_cipher_resource\" option" );
-      break;
-
-    case 16: if(( error = ak_skey_set_resource_values( &bkey->key,
-                     block_counter_resource, "kuznechik_cipher_resource", 0, 0 )) != ak_error_ok )
-       ak_error_message( error, __func__,
-                                      "incorrect assigning \"kuznechik_cipher_resource\" option" );
-      break;
-    default:  ak_error_message( error = ak_error_wrong_block_cipher_length, __func__,
-                                                        "incorrect value of block cipher length" );
-  }
+  if(( error = ak_skey_set_resource_counter( &bkey->key,
+                  block_counter_resource, bkey->options.cipher_resource, 0, 0 )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect assigning of block cipher key resource" );
  return error;
 }
 
@@ -226,20 +240,9 @@
     ak_error_message( error, __func__, "incorrect execution of key scheduling procedure" );
 
  /* устанавливаем ресурс использования секретного ключа */
-  switch( bkey->bsize ) {
-    case  8: if(( error = ak_skey_set_resource_values( &bkey->key,
-                      block_counter_resource, "magma_cipher_resource", 0, 0 )) != ak_error_ok )
-       ak_error_message( error, __func__, "incorrect assigning \"magma_cipher_resource\" option" );
-      break;
-
-    case 16: if(( error = ak_skey_set_resource_values( &bkey->key,
-                     block_counter_resource, "kuznechik_cipher_resource", 0, 0 )) != ak_error_ok )
-       ak_error_message( error, __func__,
-                                      "incorrect assigning \"kuznechik_cipher_resource\" option" );
-      break;
-    default:  ak_error_message( error = ak_error_wrong_block_cipher_length, __func__,
-                                                        "incorrect value of block cipher length" );
-  }
+  if(( error = ak_skey_set_resource_counter( &bkey->key,
+                  block_counter_resource, bkey->options.cipher_resource, 0, 0 )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect assigning of block cipher key resource" );
  return error;
 }
 
@@ -283,21 +286,56 @@
     ak_error_message( error, __func__, "incorrect execution of key scheduling procedure" );
 
  /* устанавливаем ресурс использования секретного ключа */
-  switch( bkey->bsize ) {
-    case  8: if(( error = ak_skey_set_resource_values( &bkey->key,
-                      block_counter_resource, "magma_cipher_resource", 0, 0 )) != ak_error_ok )
-       ak_error_message( error, __func__, "incorrect assigning \"magma_cipher_resource\" option" );
-      break;
+  if(( error = ak_skey_set_resource_counter( &bkey->key,
+                  block_counter_resource, bkey->options.cipher_resource, 0, 0 )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect assigning of block cipher key resource" );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция позволяет для отдельного ключа изменить значения опций, установленные при его создании.
+    Допускается изменение ресурса ключа (опции `magma_cipher_resource` и `kuznechik_cipher_resource`,
+    новое значение ресурса устанавливается при следующем присвоении ключу значения),
+    а также длины секции режима ACPKM (опции `acpkm_section_magma_block_count` и
+    `acpkm_section_kuznechik_block_count`). Опция должна соответствовать алгоритму шифрования.
+
+    Флаг совместимости с библиотекой openssl определяет выбор функций зашифрования и
+    расшифрования при создании ключа и не может быть изменен.
+
+    @param bkey Контекст ключа блочного алгоритма шифрования.
+    @param opt Идентификатор опции.
+    @param value Новое значение опции.
 
-    case 16: if(( error = ak_skey_set_resource_values( &bkey->key,
-                     block_counter_resource, "kuznechik_cipher_resource", 0, 0 )) != ak_error_ok )
-       ak_error_message( error, __func__,
-                                      "incorrect assigning \"kuznechik_cipher_resource\" option" );
+    @return В случае успеха возвращается значение \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_set_option( ak_bckey bkey, const option_t opt, const ak_int64 value )
+{
+  int error = ak_error_ok;
+
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                        "using null pointer to secret key context" );
+  if(( error = ak_libakrypt_check_option_value( opt, value )) != ak_error_ok )
+    return ak_error_message( error, __func__, "using unexpected value of option" );
+
+  switch( opt ) {
+    case magma_cipher_resource_option:
+    case kuznechik_cipher_resource_option:
+      if(( bkey->bsize == 8 ) != ( opt == magma_cipher_resource_option )) break;
+      bkey->options.cipher_resource = value;
+      return ak_error_ok;
+
+    case acpkm_section_magma_block_count_option:
+    case acpkm_section_kuznechik_block_count_option:
+      if(( bkey->bsize == 8 ) != ( opt == acpkm_section_magma_block_count_option )) break;
+      bkey->options.acpkm_section_block_count = value;
+      return ak_error_ok;
+
+    default:
       break;
-    default:  ak_error_message( error = ak_error_wrong_block_cipher_length, __func__,
-                                                        "incorrect value of block cipher length" );
   }
- return error;
+ return ak_error_message( ak_error_wrong_option, __func__,
+                                            "this option can't be changed for block cipher key" );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -324,6 +362,9 @@
  /* создаем объект */
   if(( error = ((ak_function_bckey_create *)oid->func.first.create)( bkey )) != ak_error_ok )
     return ak_error_message( error, __func__, "incorrect creation of left block cipher context" );
+ /* переносим значения опций, измененные для исходного ключа */
+  bkey->options.cipher_resource = rkey->options.cipher_resource;
+  bkey->options.acpkm_section_block_count = rkey->options.acpkm_section_block_count;
 
  /* присваиваем ключ */
   if(( error = rkey->key.unmask( &rkey->key )) != ak_error_ok ) {
@@ -359,7 +400,6 @@
 {
   size_t blocks = 0;
   int error = ak_error_ok;
-  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
 
  /* выполняем проверку размера входных данных */
   if( size%bkey->bsize != 0 )
@@ -378,22 +418,11 @@
    else bkey->key.resource.value.counter -= blocks;
 
  /* теперь приступаем к зашифрованию данных */
-  switch( bkey->bsize ) {
-    case  8: /* шифр с длиной блока 64 бита */
-      do {
-        bkey->encrypt( &bkey->key, inptr++, outptr++ );
-      } while( --blocks > 0 );
-    break;
-
-    case 16: /* шифр с длиной блока 128 бит */
-      do {
-        bkey->encrypt( &bkey->key, inptr, outptr );
-        inptr+=2; outptr+=2;
-      } while( --blocks > 0 );
-    break;
-    default: return ak_error_message( ak_error_wrong_block_cipher,
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
                                           __func__ , "incorrect block size of block cipher key" );
-  }
+ /* блоки независимы, поэтому обрабатываются одним вызовом */
+  bkey->encrypt_blocks( &bkey->key, in, out, blocks );
  /* перемаскируем ключ */
   if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of secret key" );
@@ -416,7 +445,6 @@
 {
   size_t blocks = 0;
   int error = ak_error_ok;
-  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
 
  /* выполняем проверку размера входных данных */
   if( size%bkey->bsize != 0 )
@@ -435,22 +463,11 @@
    else bkey->key.resource.value.counter -= blocks;
 
  /* теперь приступаем к расшифрованию данных */
-  switch( bkey->bsize ) {
-    case  8: /* шифр с длиной блока 64 бита */
-      do {
-        bkey->decrypt( &bkey->key, inptr++, outptr++ );
-      } while( --blocks > 0 );
-    break;
-
-    case 16: /* шифр с длиной блока 128 бит */
-      do {
-        bkey->decrypt( &bkey->key, inptr, outptr );
-        inptr+=2; outptr+=2;
-      } while( --blocks > 0 );
-    break;
-    default: return ak_error_message( ak_error_wrong_block_cipher,
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
                                           __func__ , "incorrect block size of block cipher key" );
-  }
+ /* блоки независимы, поэтому обрабатываются одним вызовом */
+  bkey->decrypt_blocks( &bkey->key, in, out, blocks );
  /* перемаскируем ключ */
   if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of secret key" );
@@ -458,6 +475,47 @@
  return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Установка синхропосылки режима гаммирования.
+
+    Если указатель `iv` равен NULL или длина `iv_size` равна нулю, функция проверяет,
+    что ранее установленное значение синхропосылки может быть использовано повторно.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param iv Синхропосылка (может принимать значение NULL).
+    @param iv_size Длина синхропосылки в байтах.
+    @param oc Значение флага совместимости с библиотекой openssl.
+    @return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_ctr_set_ivector( ak_bckey bkey, ak_pointer iv, size_t iv_size, int oc )
+{
+  if(( iv == NULL ) || ( iv_size == 0 )) { /* запрос на использование внутреннего значения */
+
+    if( bkey->key.flags&ak_key_flag_not_ctr )
+      return ak_error_message( ak_error_wrong_block_cipher_function, __func__ ,
+                                           "function call with undefined value of initial vector" );
+  } else {
+    /* данное значение определяет в точности половину блока */
+     size_t halfsize = bkey->bsize >> 1 ;
+
+    /* проверяем длину синхропосылки (если меньше половины блока, то плохо)
+        если больше, то нормально - лишнее простое не используется */
+     if( iv_size < halfsize )
+       return ak_error_message( ak_error_wrong_iv_length, __func__,
+                                                              "incorrect length of initial value" );
+    /* помещаем во внутренний буффер значение синхропосылки */
+     memset( bkey->ivector, 0, ( bkey->ivector_size = bkey->bsize ));
+    /* слишком большое значение iv_size может привести к выходу за границы памяти,
+                                                       выделенной под переменную ivector */
+     memcpy( bkey->ivector + halfsize*((unsigned int)(1-oc)), iv, ak_min( halfsize, iv_size ));
+
+    /* поднимаем значение флага: синхропосылка установлена */ 
+     bkey->key.flags = ( bkey->key.flags&( ~ak_key_flag_not_ctr ));
+    }
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Поскольку в режиме гаммирования операцией шифрования является сложение открытого текста по
     модулю два с последовательностью, вырабатываемой блочным шифром из заданной синхропосылки,
@@ -513,8 +571,9 @@
 {
   ak_int64 blocks = (ak_int64)( size/bkey->bsize ),
              tail = (ak_int64)( size%bkey->bsize );
-  ak_uint64 x, yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
-  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  ak_int64 k = 0, n = 0;
+  ak_uint64 x, yaout[2], ctr[ak_bckey_batch_words], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
+  int error = ak_error_ok, oc = (int) bkey->options.openssl_compability;
 
   if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
                                                 "wrong value for \"openssl_compability\" option" );
@@ -536,50 +595,37 @@
  /* выбираем, как вычислять синхропосылку проверяем флаг
     флаг поднимается при вызове функции с заданным значением синхропосылки и
     всегда опускается при обработке данных, не кратных длина блока */
-  if(( iv == NULL ) || ( iv_size == 0 )) { /* запрос на использование внутреннего значения */
-
-    if( bkey->key.flags&ak_key_flag_not_ctr )
-      return ak_error_message( ak_error_wrong_block_cipher_function, __func__ ,
-                                           "function call with undefined value of initial vector" );
-  } else {
-    /* данное значение определяет в точности половину блока */
-     size_t halfsize = bkey->bsize >> 1 ;
-
-    /* проверяем длину синхропосылки (если меньше половины блока, то плохо)
-        если больше, то нормально - лишнее простое не используется */
-     if( iv_size < halfsize )
-       return ak_error_message( ak_error_wrong_iv_length, __func__,
-                                                              "incorrect length of initial value" );
-    /* помещаем во внутренний буффер значение синхропосылки */
-     memset( bkey->ivector, 0, ( bkey->ivector_size = bkey->bsize ));
-    /* слишком большое значение iv_size может привести к выходу за границы памяти,
-                                                       выделенной под переменную ivector */
-     memcpy( bkey->ivector + halfsize*((unsigned int)(1-oc)), iv, ak_min( halfsize, iv_size ));
+  if(( error = ak_bckey_ctr_set_ivector( bkey, iv, iv_size, oc )) != ak_error_ok ) return error;
 
-    /* поднимаем значение флага: синхропосылка установлена */ 
-     bkey->key.flags = ( bkey->key.flags&( ~ak_key_flag_not_ctr ));
-    }
-
- /* обработка основного массива данных (кратного длине блока) */
+ /* обработка основного массива данных (кратного длине блока):
+    за один вызов функции encrypt_blocks зашифровывается столько последовательных значений
+    счетчика, сколько помещается в буффер ctr */
   switch( bkey->bsize ) {
     case  8: /* шифр с длиной блока 64 бита (Магма) */
+     #ifndef AK_LITTLE_ENDIAN
+      x = oc ? ((ak_uint64 *)bkey->ivector)[0] : bswap_64( ((ak_uint64 *)bkey->ivector)[0] );
+     #else
+      x = oc ? bswap_64( ((ak_uint64 *)bkey->ivector)[0] ) : ((ak_uint64 *)bkey->ivector)[0];
+     #endif
       while( blocks > 0 ) {
-        #ifndef AK_LITTLE_ENDIAN
-          x = oc ? ((ak_uint64 *)bkey->ivector)[0] : bswap_64( ((ak_uint64 *)bkey->ivector)[0] );
-        #else
-          x = oc ? bswap_64( ((ak_uint64 *)bkey->ivector)[0] ) : ((ak_uint64 *)bkey->ivector)[0];
-        #endif
-          bkey->encrypt( &bkey->key, bkey->ivector, yaout );
-          *outptr = *inptr ^ yaout[0];
-          outptr++; inptr++;
-
-        #ifndef AK_LITTLE_ENDIAN
-          ((ak_uint64 *)bkey->ivector)[0] = oc ? ++x : bswap_64( ++x );
-        #else
-          ((ak_uint64 *)bkey->ivector)[0] = oc ? bswap_64( ++x ) : ++x;
-        #endif
-        --blocks;
+         n = ak_min( blocks, ak_bckey_batch_words );
+         for( k = 0; k < n; k++, x++ ) {
+           #ifndef AK_LITTLE_ENDIAN
+            ctr[k] = oc ? x : bswap_64( x );
+           #else
+            ctr[k] = oc ? bswap_64( x ) : x;
+           #endif
+         }
+         bkey->encrypt_blocks( &bkey->key, ctr, ctr, (size_t) n );
+         for( k = 0; k < n; k++ ) outptr[k] = inptr[k] ^ ctr[k];
+         outptr += n; inptr += n;
+         blocks -= n;
       }
+     #ifndef AK_LITTLE_ENDIAN
+      ((ak_uint64 *)bkey->ivector)[0] = oc ? x : bswap_64( x );
+     #else
+      ((ak_uint64 *)bkey->ivector)[0] = oc ? bswap_64( x ) : x;
+     #endif
     break;
 
     case 16: /* шифр с длиной блока 128 бит (Кузнечик) */
@@ -590,20 +636,28 @@
      #endif
 
       while( blocks > 0 ) {
-          bkey->encrypt( &bkey->key, bkey->ivector, yaout );
-          *outptr = *inptr ^ yaout[0]; outptr++; inptr++;
-          *outptr = *inptr ^ yaout[1]; outptr++; inptr++;
-
-       /* за элементарное сложение с единицей приходится платить одним разворотом */
-        #ifdef AK_LITTLE_ENDIAN
-         ((ak_uint64 *)bkey->ivector)[oc] = oc ? bswap_64(++x) : ++x;
-        #else
-          ((ak_uint64 *)bkey->ivector)[oc] = oc ? ++x : bswap_64( ++x );
-        #endif                    /* здесь мы не учитываем знак переноса
-                                     потому что объем данных на одном ключе не должен
-                                     превышать 2^64 блоков (контролируется через ресурс ключа) */
-        --blocks;
+         n = ak_min( blocks, ak_bckey_batch_words >> 1 );
+         for( k = 0; k < n; k++, x++ ) {
+            ctr[2*k+1-oc] = ((ak_uint64 *)bkey->ivector)[1-oc];
+           /* за элементарное сложение с единицей приходится платить одним разворотом */
+           #ifdef AK_LITTLE_ENDIAN
+            ctr[2*k+oc] = oc ? bswap_64( x ) : x;
+           #else
+            ctr[2*k+oc] = oc ? x : bswap_64( x );
+           #endif              /* здесь мы не учитываем знак переноса
+                                  потому что объем данных на одном ключе не должен
+                                  превышать 2^64 блоков (контролируется через ресурс ключа) */
+         }
+         bkey->encrypt_blocks( &bkey->key, ctr, ctr, (size_t) n );
+         for( k = 0; k < 2*n; k++ ) outptr[k] = inptr[k] ^ ctr[k];
+         outptr += 2*n; inptr += 2*n;
+         blocks -= n;
       }
+     #ifdef AK_LITTLE_ENDIAN
+      ((ak_uint64 *)bkey->ivector)[oc] = oc ? bswap_64( x ) : x;
+     #else
+      ((ak_uint64 *)bkey->ivector)[oc] = oc ? x : bswap_64( x );
+     #endif
     break;
 
     default: return ak_error_message( ak_error_wrong_block_cipher,
@@ -639,6 +693,160 @@
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция копирует `size` октетов между фрагментами массива `v`, начиная с позиции
+    (`idx`, `off`), и линейным буффером `buf`, после чего сдвигает текущую позицию.
+    \details Если `gather` истинно, то данные копируются из фрагментов в буффер,
+    в противном случае - из буффера во фрагменты.                                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_iovector_move( ak_iovector v, size_t *idx, size_t *off,
+                                          ak_uint8 *buf, size_t size, const bool_t gather )
+{
+  size_t take = 0;
+
+  while( size > 0 ) {
+     if( *off == v[*idx].size ) { ( *idx )++; *off = 0; continue; }
+     take = ak_min( size, v[*idx].size - *off );
+     if( gather ) memcpy( buf, (ak_uint8 *)v[*idx].data + *off, take );
+       else memcpy( (ak_uint8 *)v[*idx].data + *off, buf, take );
+     buf += take; size -= take; *off += take;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция последовательно передает функции `update` данные, содержащиеся во фрагментах `in`,
+    таким образом, что длина данных при каждом вызове кратна длине блока `bsize`; неполный блок
+    может быть передан только при последнем вызове.
+
+    Разбиения входных и выходных данных на фрагменты не зависят друг от друга: массивы `in`
+    и `out` просматриваются независимо, требуется только совпадение общей длины данных.
+    Полные блоки, целиком лежащие внутри текущих фрагментов обоих массивов, обрабатываются
+    без копирования. Блок, пересекающий границу фрагментов входных или выходных данных,
+    собирается во временном буффере, а результат его обработки распределяется
+    по соответствующим фрагментам массива `out`.
+
+    @param in Массив фрагментов входных данных.
+    @param count Количество фрагментов входных данных.
+    @param out Массив фрагментов выходных данных; общая длина фрагментов должна совпадать
+           с общей длиной фрагментов входных данных. Входные и выходные данные могут
+           располагаться в одной области памяти. Если функция `update` не вырабатывает
+           выходных данных, указатель может принимать значение `NULL`.
+    @param out_count Количество фрагментов выходных данных.
+    @param bsize Длина блока (в октетах), не более 16.
+    @param update Функция обработки данных.
+    @param ctx Контекст, передаваемый функции `update` первым аргументом.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_iovector_update( ak_iovector in, const size_t count, ak_iovector out,
+                                    const size_t out_count, const size_t bsize,
+                                                 ak_function_iovector_update *update, ak_pointer ctx )
+{
+  ak_uint64 xin[2], xout[2]; /* блок, пересекающий границу фрагментов */
+  ak_uint8 *inp = NULL, *outp = NULL;
+  size_t i = 0, j = 0, ioff = 0, ooff = 0, total = 0, otal = 0, remain = 0, take = 0;
+  int error = ak_error_ok;
+
+  if(( in == NULL ) && ( count > 0 )) return ak_error_message( ak_error_null_pointer, __func__,
+                                                           "using null pointer to input data" );
+  if(( out == NULL ) && ( out_count > 0 )) return ak_error_message( ak_error_null_pointer,
+                                                    __func__, "using null pointer to output data" );
+  if(( bsize == 0 ) || ( bsize > sizeof( xin ))) return ak_error_message( ak_error_wrong_length,
+                                                        __func__, "using unsupported block size" );
+ /* проверяем фрагменты и вычисляем общую длину данных */
+  for( i = 0; i < count; total += in[i++].size )
+     if(( in[i].size > 0 ) && ( in[i].data == NULL ))
+       return ak_error_message( ak_error_null_pointer, __func__, "using null pointer to fragment" );
+  if( out != NULL ) {
+    for( j = 0; j < out_count; otal += out[j++].size )
+       if(( out[j].size > 0 ) && ( out[j].data == NULL ))
+         return ak_error_message( ak_error_null_pointer, __func__,
+                                                                "using null pointer to fragment" );
+    if( otal != total ) return ak_error_message( ak_error_wrong_length, __func__,
+                                        "different total lengths of input and output fragments" );
+  }
+
+  for( i = j = 0, remain = total; remain > 0; remain -= take ) {
+    /* пропускаем пустые и полностью обработанные фрагменты */
+     while( ioff == in[i].size ) { i++; ioff = 0; }
+     inp = (ak_uint8 *)in[i].data + ioff;
+     take = in[i].size - ioff;
+     if( out != NULL ) {
+       while( ooff == out[j].size ) { j++; ooff = 0; }
+       outp = (ak_uint8 *)out[j].data + ooff;
+       take = ak_min( take, out[j].size - ooff );
+     }
+    /* обрабатываем полные блоки, лежащие внутри текущих фрагментов */
+     if(( take -= take%bsize ) > 0 ) {
+       if(( error = update( ctx, inp, outp, take )) != ak_error_ok ) goto exit;
+       ioff += take; ooff += take;
+       continue;
+     }
+    /* обрабатываем блок, пересекающий границу фрагментов (или последний неполный блок) */
+     take = ak_min( bsize, remain );
+     ak_bckey_iovector_move( in, &i, &ioff, (ak_uint8 *)xin, take, ak_true );
+     if(( error = update( ctx, xin, xout, take )) != ak_error_ok ) goto exit;
+     if( out != NULL ) ak_bckey_iovector_move( out, &j, &ooff, (ak_uint8 *)xout, take, ak_false );
+  }
+
+  exit:
+   memset( xin, 0, sizeof( xin ));
+   memset( xout, 0, sizeof( xout ));
+   if( error != ak_error_ok ) ak_error_message( error, __func__, "incorrect processing of fragment" );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Продолжение шифрования в режиме гаммирования без изменения синхропосылки. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_ctr_iovector_update( ak_pointer bkey,
+                                                 ak_pointer in, ak_pointer out, const size_t size )
+{
+  return ak_bckey_ctr( bkey, in, out, size, NULL, 0 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует режим гаммирования для данных, разбитых на несколько фрагментов
+    произвольной длины, например, для сетевого пакета, заголовок и содержимое которого
+    расположены в различных областях памяти. Результат совпадает с результатом вызова функции
+    ak_bckey_ctr() для данных, полученных последовательным объединением всех фрагментов,
+    при этом копирование фрагментов в одну область памяти не производится.
+
+    Если значение синхропосылки не задано (`iv` равен `NULL`), то шифрование продолжается
+    с текущего значения счетчика, так же, как и для функции ak_bckey_ctr().
+
+    @param bkey Ключ алгоритма блочного шифрования, на котором происходит зашифрование информации.
+    @param in Массив фрагментов зашифровываемых (расшифровываемых) данных.
+    @param count Количество фрагментов массива `in`.
+    @param out Массив фрагментов, в которые помещается результат; разбиение на фрагменты может
+           отличаться от разбиения массива `in`, должна совпадать только общая длина данных.
+    @param out_count Количество фрагментов массива `out`.
+    @param iv Синхропосылка (может принимать значение `NULL`).
+    @param iv_size Длина синхропосылки в байтах.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_ctr_v( ak_bckey bkey, ak_iovector in, const size_t count, ak_iovector out,
+                                             const size_t out_count, ak_pointer iv, size_t iv_size )
+{
+  int error = ak_error_ok;
+
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                        "using null pointer to block cipher key" );
+  if( out == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                          "using null pointer to output data" );
+ /* устанавливаем синхропосылку (или проверяем, что она была установлена ранее) */
+  if(( error = ak_bckey_ctr( bkey, NULL, NULL, 0, iv, iv_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect initialization of counter" );
+  if(( error = ak_bckey_iovector_update( in, count, out, out_count, bkey->bsize,
+                                          ak_bckey_ctr_iovector_update, bkey )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect encryption of fragmented data" );
+
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  int ak_bckey_encrypt_cbc( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
                                                                     ak_pointer iv, size_t iv_size )
@@ -646,7 +854,7 @@
    ak_int64 blocks = 0;
    ak_uint64 yaout[2], z = iv_size / bkey->bsize;
    ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out, *ivector = (ak_uint64 *)bkey->ivector;
-   int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+   int error = ak_error_ok, oc = (int) bkey->options.openssl_compability;
 
    if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
                                                  "wrong value for \"openssl_compability\" option" );
@@ -717,10 +925,10 @@
  int ak_bckey_decrypt_cbc( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
                                                                     ak_pointer iv, size_t iv_size )
  {
-  ak_int64 blocks = 0;
-  ak_uint64 yaout[2], z = iv_size / bkey->bsize;
+  ak_int64 blocks = 0, k = 0, n = 0, words = 0;
+  ak_uint64 yaout[ak_bckey_batch_words], z = iv_size / bkey->bsize;
   ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out, *ivector = (ak_uint64 *)bkey->ivector;
-  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  int error = ak_error_ok, oc = (int) bkey->options.openssl_compability;
 
   if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
                                                 "wrong value for \"openssl_compability\" option" );
@@ -749,35 +957,28 @@
                                                              "incorrect length of initial value" );
    memcpy(bkey->ivector, iv, iv_size);
 
- /* теперь приступаем к расшифрованию данных */
+ /* теперь приступаем к расшифрованию данных:
+    в отличие от зашифрования, расшифрование блоков не зависит от результатов предыдущих вычислений,
+    поэтому блоки расшифровываются группами, после чего складываются с предыдущим шифртекстом */
   switch( bkey->bsize ) {
     case  8: /* шифр с длиной блока 64 бита */
-      while( blocks > 0 ) {
-          bkey->decrypt( &bkey->key, inptr, yaout );
-          if( z == 0 ) {
-              ivector = (ak_uint64 *)in;
-          }
-          *outptr = yaout[0] ^ *ivector; outptr++; ivector++;
-          inptr++;
-          --blocks;
-          --z;
-      }
-    break;
-
     case 16: /* шифр с длиной блока 128 бит */
+      words = bkey->bsize >> 3;
       while( blocks > 0 ) {
-          bkey->decrypt( &bkey->key, inptr, yaout );
-          if( z == 0 ) {
-              ivector = (ak_uint64 *)in;
+          n = ak_min( blocks, (ak_int64)( sizeof( yaout )/bkey->bsize ));
+          bkey->decrypt_blocks( &bkey->key, inptr, yaout, (size_t) n );
+          for( k = 0; k < n*words; k++ ) {
+             if(( k%words == 0 ) && ( z == 0 )) {
+                 ivector = (ak_uint64 *)in;
+             }
+             *outptr = yaout[k] ^ *ivector; outptr++; ivector++;
+             if(( k+1 )%words == 0 ) --z;
           }
-          *outptr = yaout[0] ^ *ivector; outptr++; ivector++;
-          *outptr = yaout[1] ^ *ivector; outptr++; ivector++;
-          inptr+=2;
-          --blocks;
-          --z;
+          inptr += n*words;
+          blocks -= n;
       }
-
     break;
+
     default: return ak_error_message( ak_error_wrong_block_cipher,
                                           __func__ , "incorrect block size of block cipher key" );
   }
@@ -796,7 +997,7 @@
   ak_int64 blocks = (ak_int64)( size/bkey->bsize ),
              tail = (ak_int64)( size%bkey->bsize );
   ak_uint64 yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
-  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  int error = ak_error_ok, oc = (int) bkey->options.openssl_compability;
   unsigned long counter = 0, z = iv_size / bkey->bsize; /* во сколько раз синхрпосылка длиннее блока */
 
   if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
@@ -894,7 +1095,7 @@
               tail = (ak_int64)( size%bkey->bsize );
    ak_uint8 *vecptr = NULL;
    ak_uint64 yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
-   int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+   int error = ak_error_ok, oc = (int) bkey->options.openssl_compability;
    unsigned long i = 0, z = iv_size / bkey->bsize; // во сколько раз синхрпосылка длиннее блока
 
    if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
@@ -987,9 +1188,10 @@
    ak_int64 blocks = (ak_int64)( size/bkey->bsize ),
               tail = (ak_int64)( size%bkey->bsize );
    ak_uint8 *vecptr = NULL;
-   ak_uint64 yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
-   int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+   ak_uint64 yaout[ak_bckey_batch_words], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
+   int error = ak_error_ok, oc = (int) bkey->options.openssl_compability;
    unsigned long i = 0, z = iv_size / bkey->bsize; // во сколько раз синхрпосылка длиннее блока
+   unsigned long j = 0, k = 0, n = 0, words = 0, total = (unsigned long) blocks;
 
    if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
                                                  "wrong value for \"openssl_compability\" option" );
@@ -1025,31 +1227,31 @@
       bkey->key.flags = ( bkey->key.flags&( ~ak_key_flag_not_ctr ))^ak_key_flag_not_ctr;
      }
 
-  /* обработка основного массива данных (кратного длине блока) */
+  /* обработка основного массива данных (кратного длине блока):
+     при расшифровании все шифруемые значения известны заранее (это либо синхропосылка,
+     либо ранее полученный шифртекст), поэтому блоки зашифровываются группами */
    switch( bkey->bsize ) {
      case  8: /* шифр с длиной блока 64 бита */
-       while( blocks > 0 ) {
-           vecptr = (bkey->ivector + i*bkey->bsize);
-           bkey->encrypt( &bkey->key, vecptr, yaout );
-           *outptr = *inptr ^ yaout[0];
-           ((ak_uint64 *)vecptr)[0] = *inptr;
-           outptr++; inptr++;
-           if (++i == z) i = 0;
-           --blocks;
-       }
-     break;
-
      case 16: /* шифр с длиной блока 128 бит */
-       while( blocks > 0 ) {
-           vecptr = (bkey->ivector + i*bkey->bsize );
-           bkey->encrypt( &bkey->key, vecptr, yaout );
-           *outptr = *inptr ^ yaout[0];
-           ((ak_uint64 *)vecptr)[0] = *inptr; ++outptr; ++inptr;
-           *outptr = *inptr ^ yaout[1];
-           ((ak_uint64 *)vecptr)[1] = *inptr; ++outptr; ++inptr;
-           if (++i == z) i = 0;
-           --blocks;
+       if( z == 0 ) z = 1;
+       words = bkey->bsize >> 3;
+       while( j < total ) {
+           n = ak_min( total - j, sizeof( yaout )/bkey->bsize );
+           for( k = 0; k < n; k++ ) {
+              if( j+k < z ) vecptr = bkey->ivector + ( j+k )*bkey->bsize;
+                else vecptr = (ak_uint8 *)in + ( j+k-z )*bkey->bsize;
+              memcpy( yaout + k*words, vecptr, bkey->bsize );
+           }
+           bkey->encrypt_blocks( &bkey->key, yaout, yaout, n );
+           for( k = 0; k < n*words; k++ ) {
+              *outptr = *inptr ^ yaout[k]; ++outptr; ++inptr;
+           }
+           j += n;
        }
+      /* помещаем в синхропосылку последние блоки шифртекста */
+       for( j = ( total > z ? total - z : 0 ); j < total; j++ )
+          memcpy( bkey->ivector + ( j%z )*bkey->bsize, (ak_uint8 *)in + j*bkey->bsize, bkey->bsize );
+       i = total%z;
      break;
 
      default: return ak_error_message( ak_error_wrong_block_cipher,
@@ -1058,7 +1260,7 @@
 
   /* обрабатываем хвост сообщения */
    if( tail ) {
-     vecptr = (bkey->ivector + bkey->bsize * (i % (int)(iv_size / bkey->bsize)));
+     vecptr = (bkey->ivector + bkey->bsize * i );
      bkey->encrypt( &bkey->key, vecptr, yaout );
      for( i = 0; i < (unsigned long)tail; i++ )
         ( (ak_uint8*)outptr)[i] = ( (ak_uint8*)inptr )[i]^( (ak_uint8 *)yaout)[i];
@@ -1074,12 +1276,493 @@
    return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                  параллельная обработка данных с помощью пула потоков библиотеки                */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Контекст параллельной обработки данных ключом алгоритма блочного шифрования. */
+ typedef struct bckey_parallel {
+  /*! \brief Копии ключа, по одной для каждого потока пула. */
+   ak_bckey keys;
+  /*! \brief Указатель на входные данные. */
+   ak_uint8 *in;
+  /*! \brief Указатель на выходные данные. */
+   ak_uint8 *out;
+  /*! \brief Общее количество полных блоков. */
+   ak_int64 blocks;
+  /*! \brief Длина последнего неполного блока (в октетах). */
+   ak_int64 tail;
+  /*! \brief Количество блоков, обрабатываемых одним заданием. */
+   ak_int64 chunk;
+  /*! \brief Количество заданий. */
+   size_t tasks;
+  /*! \brief Начальное значение счетчика режима гаммирования. */
+   ak_uint64 counter;
+  /*! \brief Значение флага совместимости с библиотекой openssl. */
+   int oc;
+  /*! \brief Значение синхропосылки, установленное в исходном ключе. */
+   ak_uint8 ivector[64];
+  /*! \brief Синхропосылки заданий режимов с зацеплением. */
+   ak_uint8 *ivectors;
+  /*! \brief Длина синхропосылки одного задания (в октетах). */
+   size_t iv_size;
+ } *ak_bckey_parallel;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Данные разбиваются на задания, содержащие не менее \ref ak_thread_pool_min_task_size октетов;
+    количество заданий не превышает учетверенного количества потоков, что позволяет свободным
+    потокам забирать задания у занятых.
+
+    @param size Размер обрабатываемых данных (в октетах).
+    @return Количество заданий. Значение, меньшее двух, означает, что данные следует
+    обрабатывать последовательно.                                                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ size_t ak_bckey_parallel_tasks( const size_t size )
+{
+  size_t threads = ak_thread_pool_size();
+
+  if( threads == 0 ) return 0;
+ return ak_min( size/ak_thread_pool_min_task_size, 4*( threads+1 ));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Каждый поток пула (включая поток, запускающий задания) использует собственную копию ключа,
+    поэтому изменение внутреннего состояния ключа (вектора синхропосылки, ресурса, а также
+    состояния генератора, используемого при маскировании) в одном потоке не влияет на остальные.
+
+    @param bkey Контекст исходного ключа.
+    @param keys Указатель, в который помещается адрес массива копий ключа.
+    @param resource Ресурс, устанавливаемый каждой копии ключа.
+    @return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_parallel_create_keys( ak_bckey bkey, ak_bckey *keys, const ak_int64 resource )
+{
+  size_t i = 0, count = ak_thread_pool_size()+1;
+  int error = ak_error_ok;
+
+  if(( *keys = calloc( count, sizeof( struct bckey ))) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__,
+                                              "incorrect memory allocation for block cipher keys" );
+  for( i = 0; i < count; i++ ) {
+     if(( error = ak_bckey_create_and_set_bckey( *keys+i, bkey )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "incorrect creation of block cipher key copy" );
+       while( i > 0 ) ak_bckey_destroy( *keys + (--i) );
+       free( *keys );
+       *keys = NULL;
+       return error;
+     }
+     (*keys)[i].key.resource.value.counter = resource;
+  }
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param keys Массив копий ключа, созданный функцией ak_bckey_parallel_create_keys().
+    @return Функция возвращает \ref ak_error_ok.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_parallel_destroy_keys( ak_bckey keys )
+{
+  size_t i = 0, count = ak_thread_pool_size()+1;
+
+  if( keys == NULL ) return ak_error_ok;
+  for( i = 0; i < count; i++ ) ak_bckey_destroy( keys+i );
+  free( keys );
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Разбиение данных на задания равной длины (последнее задание может быть короче). */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_parallel_split( ak_bckey_parallel ctx, ak_bckey bkey,
+                                             ak_pointer in, ak_pointer out, size_t size, size_t tasks )
+{
+  memset( ctx, 0, sizeof( struct bckey_parallel ));
+  ctx->in = ( ak_uint8 * ) in;
+  ctx->out = ( ak_uint8 * ) out;
+  ctx->blocks = ( ak_int64 )( size/bkey->bsize );
+  ctx->tail = ( ak_int64 )( size%bkey->bsize );
+  ctx->chunk = ( ctx->blocks + ( ak_int64 )tasks - 1 )/( ak_int64 )tasks;
+  ctx->tasks = ( size_t )(( ctx->blocks + ctx->chunk - 1 )/ctx->chunk );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Номер первого блока и размер данных (в октетах), обрабатываемых заданием. */
+/* ----------------------------------------------------------------------------------------------- */
+ static size_t ak_bckey_parallel_task_bounds( ak_bckey_parallel ctx,
+                                                 const size_t task, const size_t bsize, size_t *start )
+{
+  *start = task*( size_t )ctx->chunk;
+  if( task == ctx->tasks - 1 )
+    return ( size_t )( ctx->blocks - ( ak_int64 )*start )*bsize + ( size_t )ctx->tail;
+ return ( size_t )ctx->chunk*bsize;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Создание синхропосылок для заданий режимов с зацеплением.
+    \details Для задания, начинающегося с блока с номером \f$ s > 0 \f$, синхропосылкой являются
+    \f$ z \f$ блоков шифртекста, предшествующих блоку \f$ s \f$, где \f$ z \f$ - количество блоков
+    в исходной синхропосылке. Синхропосылки копируются до запуска заданий, поэтому область
+    памяти с шифртекстом может изменяться во время обработки.                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_parallel_create_ivectors( ak_bckey_parallel ctx, ak_bckey bkey,
+                                                                ak_pointer iv, const size_t iv_size )
+{
+  size_t i = 0;
+
+  if(( ctx->ivectors = malloc( ctx->tasks*iv_size )) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__,
+                                            "incorrect memory allocation for initial vectors" );
+  ctx->iv_size = iv_size;
+  memcpy( ctx->ivectors, iv, iv_size );
+  for( i = 1; i < ctx->tasks; i++ )
+     memcpy( ctx->ivectors + i*iv_size,
+                                  ctx->in + i*( size_t )ctx->chunk*bkey->bsize - iv_size, iv_size );
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Значение счетчика режима гаммирования, хранящееся в контексте ключа
+    (в том виде, в котором его использует функция ak_bckey_ctr()). */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint64 ak_bckey_ctr_get_counter( ak_bckey bkey, const int oc )
+{
+  if( bkey->bsize == 8 ) {
+   #ifndef AK_LITTLE_ENDIAN
+    return oc ? ((ak_uint64 *)bkey->ivector)[0] : bswap_64( ((ak_uint64 *)bkey->ivector)[0] );
+   #else
+    return oc ? bswap_64( ((ak_uint64 *)bkey->ivector)[0] ) : ((ak_uint64 *)bkey->ivector)[0];
+   #endif
+  }
+ #ifndef AK_LITTLE_ENDIAN
+  return bswap_64( ((ak_uint64 *)bkey->ivector)[oc] );
+ #else
+  return ((ak_uint64 *)bkey->ivector)[oc];
+ #endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция, обратная к ak_bckey_ctr_get_counter(). */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_ctr_set_counter( ak_bckey bkey, const int oc, const ak_uint64 x )
+{
+  if( bkey->bsize == 8 ) {
+   #ifndef AK_LITTLE_ENDIAN
+    ((ak_uint64 *)bkey->ivector)[0] = oc ? x : bswap_64( x );
+   #else
+    ((ak_uint64 *)bkey->ivector)[0] = oc ? bswap_64( x ) : x;
+   #endif
+    return;
+  }
+ #ifndef AK_LITTLE_ENDIAN
+  ((ak_uint64 *)bkey->ivector)[oc] = bswap_64( x );
+ #else
+  ((ak_uint64 *)bkey->ivector)[oc] = x;
+ #endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_ctr_parallel_task( ak_pointer ptr, const size_t task, const size_t thread )
+{
+  size_t start = 0, size = 0;
+  ak_bckey_parallel ctx = ( ak_bckey_parallel ) ptr;
+  ak_bckey key = ctx->keys + thread;
+
+  size = ak_bckey_parallel_task_bounds( ctx, task, key->bsize, &start );
+ /* устанавливаем в копии ключа значение счетчика для первого блока задания */
+  memcpy( key->ivector, ctx->ivector, key->bsize );
+  ak_bckey_ctr_set_counter( key, ctx->oc, ctx->counter + ( ak_uint64 )start );
+  key->key.flags = key->key.flags&( ~ak_key_flag_not_ctr );
+
+ return ak_bckey_ctr( key, ctx->in + start*key->bsize, ctx->out + start*key->bsize, size, NULL, 0 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует режим гаммирования, распределяя обработку данных между потоками пула,
+    созданного при инициализации библиотеки (количество потоков определяется опцией
+    `thread_pool_size`). Данные разбиваются на фрагменты, длина которых кратна длине блока;
+    каждый фрагмент обрабатывается функцией ak_bckey_ctr() с использованием копии ключа и
+    значения счетчика, соответствующего первому блоку фрагмента.
+
+    Результат работы функции, а также значение синхропосылки, сохраняемое в контексте ключа,
+    совпадают с результатом работы функции ak_bckey_ctr(). Если пул потоков не создан или
+    объем данных невелик, то функция ak_bckey_ctr() вызывается непосредственно.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param in Указатель на область памяти, где хранятся входные данные.
+    @param out Указатель на область памяти, куда помещаются выходные данные
+    (этот указатель может совпадать с `in`).
+    @param size Размер обрабатываемых данных (в байтах).
+    @param iv Указатель на синхропосылку.
+    @param iv_size Длина синхропосылки в байтах.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_ctr_parallel( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                                                     ak_pointer iv, size_t iv_size )
+{
+  size_t tasks = 0;
+  struct bckey_parallel ctx;
+  int error = ak_error_ok, oc = 0;
+
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                        "using null pointer to block cipher key" );
+  if(( tasks = ak_bckey_parallel_tasks( size )) < 2 )
+    return ak_bckey_ctr( bkey, in, out, size, iv, iv_size );
+
+  if((( oc = (int) bkey->options.openssl_compability ) < 0 ) || ( oc > 1 ))
+    return ak_error_message( ak_error_wrong_option, __func__,
+                                                "wrong value for \"openssl_compability\" option" );
+  if(( bkey->bsize != 8 ) && ( bkey->bsize != 16 ))
+    return ak_error_message( ak_error_wrong_block_cipher,
+                                           __func__ , "incorrect block size of block cipher key" );
+ /* проверяем, установлен ли ключ */
+  if(( bkey->key.flags&ak_key_flag_set_key ) == 0 ) return ak_error_message( ak_error_key_value,
+                                    __func__, "using secret key context with undefined key value" );
+ /* проверяем целостность ключа */
+  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+    return ak_error_message( ak_error_wrong_key_icode, __func__,
+                                                   "incorrect integrity code of secret key value" );
+ /* уменьшаем значение ресурса ключа */
+  ak_bckey_parallel_split( &ctx, bkey, in, out, size, tasks );
+  if( bkey->key.resource.value.counter < ( ctx.blocks + ( ctx.tail > 0 )))
+    return ak_error_message( ak_error_low_key_resource,
+                                                    __func__ , "low resource of block cipher key" );
+   else bkey->key.resource.value.counter -= ( ctx.blocks + ( ctx.tail > 0 ));
+
+  if(( error = ak_bckey_ctr_set_ivector( bkey, iv, iv_size, oc )) != ak_error_ok ) return error;
+  ctx.oc = oc;
+  ctx.counter = ak_bckey_ctr_get_counter( bkey, oc );
+  memcpy( ctx.ivector, bkey->ivector, bkey->bsize );
+
+ /* обрабатываем данные */
+  if(( error = ak_bckey_parallel_create_keys( bkey, &ctx.keys, ctx.blocks+1 )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect creation of block cipher keys" );
+  error = ak_thread_pool_run( ak_bckey_ctr_parallel_task, &ctx, ctx.tasks );
+  ak_bckey_parallel_destroy_keys( ctx.keys );
+  if( error != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect parallel encryption of data" );
+
+ /* изменяем значение синхропосылки так же, как это делает функция ak_bckey_ctr() */
+  if( ctx.tail ) {
+    memset( bkey->ivector, 0, sizeof( bkey->ivector ));
+    bkey->key.flags = bkey->key.flags&( ~ak_key_flag_not_ctr );
+  } else {
+      ctx.counter += ( ak_uint64 )ctx.blocks;
+      if( bkey->bsize == 8 ) ak_bckey_ctr_set_counter( bkey, oc, ctx.counter );
+       else
+       #ifdef AK_LITTLE_ENDIAN
+        ((ak_uint64 *)bkey->ivector)[oc] = oc ? bswap_64( ctx.counter ) : ctx.counter;
+       #else
+        ((ak_uint64 *)bkey->ivector)[oc] = oc ? ctx.counter : bswap_64( ctx.counter );
+       #endif
+    }
+
+ /* перемаскируем ключ */
+  if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
+    ak_error_message( error, __func__ , "wrong remasking of secret key" );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_decrypt_cbc_parallel_task( ak_pointer ptr,
+                                                             const size_t task, const size_t thread )
+{
+  size_t start = 0, size = 0;
+  ak_bckey_parallel ctx = ( ak_bckey_parallel ) ptr;
+  ak_bckey key = ctx->keys + thread;
+
+  size = ak_bckey_parallel_task_bounds( ctx, task, key->bsize, &start );
+ return ak_bckey_decrypt_cbc( key, ctx->in + start*key->bsize, ctx->out + start*key->bsize,
+                                               size, ctx->ivectors + task*ctx->iv_size, ctx->iv_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция распределяет расшифрование данных между потоками пула, созданного при инициализации
+    библиотеки. При расшифровании в режиме простой замены с зацеплением каждый блок открытого
+    текста вычисляется по блоку шифртекста и предшествующим ему блокам, поэтому данные
+    разбиваются на независимые фрагменты, синхропосылкой для которых служат предшествующие
+    фрагменту блоки шифртекста.
+
+    Результат работы функции совпадает с результатом работы функции ak_bckey_decrypt_cbc().
+    Если пул потоков не создан или объем данных невелик, то функция ak_bckey_decrypt_cbc()
+    вызывается непосредственно.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param in Указатель на область памяти, где хранятся зашифрованные данные.
+    @param out Указатель на область памяти, куда помещаются расшифрованные данные.
+    @param size Размер обрабатываемых данных (в байтах), должен быть кратен длине блока.
+    @param iv Указатель на синхропосылку.
+    @param iv_size Длина синхропосылки в байтах, должна быть кратна длине блока.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_decrypt_cbc_parallel( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                                                     ak_pointer iv, size_t iv_size )
+{
+  size_t tasks = 0;
+  struct bckey_parallel ctx;
+  int error = ak_error_ok;
+
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                        "using null pointer to block cipher key" );
+  if(( tasks = ak_bckey_parallel_tasks( size )) < 2 )
+    return ak_bckey_decrypt_cbc( bkey, in, out, size, iv, iv_size );
+
+ /* выполняем проверку размера входных данных */
+  if( size%bkey->bsize != 0 )
+    return ak_error_message( ak_error_wrong_block_cipher_length,
+                            __func__ , "the length of input data is not divided by block length" );
+ /* проверяем целостность ключа */
+  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+    return ak_error_message( ak_error_wrong_key_icode,
+                                        __func__, "incorrect integrity code of secret key value" );
+ /* уменьшаем значение ресурса ключа */
+  ak_bckey_parallel_split( &ctx, bkey, in, out, size, tasks );
+  if( bkey->key.resource.value.counter < ctx.blocks )
+    return ak_error_message( ak_error_low_key_resource,
+                                                   __func__ , "low resource of block cipher key" );
+   else bkey->key.resource.value.counter -= ctx.blocks;
+
+ /* проверяем длину синхропосылки */
+  if(( iv == NULL ) || ( iv_size < bkey->bsize ) || ( iv_size%bkey->bsize != 0 ) ||
+     ( iv_size > sizeof( bkey->ivector )))
+    return ak_error_message( ak_error_wrong_iv_length, __func__,
+                                                             "incorrect length of initial value" );
+  memcpy( bkey->ivector, iv, iv_size );
+
+ /* обрабатываем данные */
+  if(( error = ak_bckey_parallel_create_ivectors( &ctx, bkey, iv, iv_size )) != ak_error_ok )
+    return error;
+  if(( error = ak_bckey_parallel_create_keys( bkey, &ctx.keys, ctx.blocks )) != ak_error_ok ) {
+    free( ctx.ivectors );
+    return ak_error_message( error, __func__, "incorrect creation of block cipher keys" );
+  }
+  error = ak_thread_pool_run( ak_bckey_decrypt_cbc_parallel_task, &ctx, ctx.tasks );
+  ak_bckey_parallel_destroy_keys( ctx.keys );
+  free( ctx.ivectors );
+  if( error != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect parallel decryption of data" );
+
+ /* перемаскируем ключ */
+  if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
+    ak_error_message( error, __func__ , "wrong remasking of secret key" );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_decrypt_cfb_parallel_task( ak_pointer ptr,
+                                                             const size_t task, const size_t thread )
+{
+  size_t start = 0, size = 0;
+  ak_bckey_parallel ctx = ( ak_bckey_parallel ) ptr;
+  ak_bckey key = ctx->keys + thread;
+
+  size = ak_bckey_parallel_task_bounds( ctx, task, key->bsize, &start );
+ return ak_bckey_decrypt_cfb( key, ctx->in + start*key->bsize, ctx->out + start*key->bsize,
+                                               size, ctx->ivectors + task*ctx->iv_size, ctx->iv_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция распределяет расшифрование данных между потоками пула, созданного при инициализации
+    библиотеки. Аналогично режиму простой замены с зацеплением, данные разбиваются на
+    независимые фрагменты, синхропосылкой для которых служат предшествующие фрагменту
+    блоки шифртекста.
+
+    Результат работы функции, а также значение синхропосылки, сохраняемое в контексте ключа,
+    совпадают с результатом работы функции ak_bckey_decrypt_cfb(). Если пул потоков не создан,
+    объем данных невелик или синхропосылка не задана (используется значение, сохраненное
+    в контексте ключа), то функция ak_bckey_decrypt_cfb() вызывается непосредственно.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param in Указатель на область памяти, где хранятся зашифрованные данные.
+    @param out Указатель на область памяти, куда помещаются расшифрованные данные.
+    @param size Размер обрабатываемых данных (в байтах).
+    @param iv Указатель на синхропосылку.
+    @param iv_size Длина синхропосылки в байтах, должна быть кратна длине блока.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_decrypt_cfb_parallel( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                                                     ak_pointer iv, size_t iv_size )
+{
+  size_t tasks = 0, z = 0;
+  struct bckey_parallel ctx;
+  int error = ak_error_ok;
+  ak_int64 j = 0;
+
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                        "using null pointer to block cipher key" );
+  if((( tasks = ak_bckey_parallel_tasks( size )) < 2 ) || ( iv == NULL ) || ( iv_size == 0 ))
+    return ak_bckey_decrypt_cfb( bkey, in, out, size, iv, iv_size );
+
+ /* проверяем целостность ключа */
+  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+    return ak_error_message( ak_error_wrong_key_icode, __func__,
+                                                   "incorrect integrity code of secret key value" );
+ /* уменьшаем значение ресурса ключа */
+  ak_bckey_parallel_split( &ctx, bkey, in, out, size, tasks );
+  if( bkey->key.resource.value.counter < ( ctx.blocks + ( ctx.tail > 0 )))
+    return ak_error_message( ak_error_low_key_resource,
+                                                    __func__ , "low resource of block cipher key" );
+   else bkey->key.resource.value.counter -= ( ctx.blocks + ( ctx.tail > 0 ));
+
+ /* проверяем длину синхропосылки */
+  if(( iv_size%bkey->bsize ) || ( iv_size > 64 ))
+    return ak_error_message( ak_error_wrong_iv_length, __func__,
+                                                              "incorrect length of initial value" );
+  z = iv_size/bkey->bsize;
+
+ /* копируем синхропосылки заданий до начала обработки, поскольку
+    расшифрование может выполняться на месте шифртекста */
+  if(( error = ak_bckey_parallel_create_ivectors( &ctx, bkey, iv, iv_size )) != ak_error_ok )
+    return error;
+
+ /* вычисляем значение синхропосылки, которое функция ak_bckey_decrypt_cfb()
+    оставляет в контексте ключа: последние блоки шифртекста или нули */
+  bkey->key.flags = ( bkey->key.flags&( ~ak_key_flag_not_ctr ))^ak_key_flag_not_ctr;
+  if( ctx.tail ) {
+    memset( bkey->ivector, 0, sizeof( bkey->ivector ));
+    bkey->key.flags = bkey->key.flags&( ~ak_key_flag_not_ctr );
+  } else {
+      memcpy( bkey->ivector, iv, iv_size );
+      for( j = ( ctx.blocks > ( ak_int64 )z ? ctx.blocks - ( ak_int64 )z : 0 ); j < ctx.blocks; j++ )
+         memcpy( bkey->ivector + (( size_t )j%z )*bkey->bsize,
+                                           ctx.in + ( size_t )j*bkey->bsize, bkey->bsize );
+    }
+
+ /* обрабатываем данные */
+  if(( error = ak_bckey_parallel_create_keys( bkey, &ctx.keys, ctx.blocks+1 )) != ak_error_ok ) {
+    free( ctx.ivectors );
+    return ak_error_message( error, __func__, "incorrect creation of block cipher keys" );
+  }
+  error = ak_thread_pool_run( ak_bckey_decrypt_cfb_parallel_task, &ctx, ctx.tasks );
+  ak_bckey_parallel_destroy_keys( ctx.keys );
+  free( ctx.ivectors );
+  if( error != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect parallel decryption of data" );
+
+ /* перемаскируем ключ */
+  if(( error = bkey->key.set_mask( &bkey->key )) != ak_error_ok )
+    ak_error_message( error, __func__ , "wrong remasking of secret key" );
+
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция реализует последовательную комбинацию алгоритма выработки имитовставки HMAC и
-    режима гаммирования данных, согласно ГОСТ Р 34.12-2015. В начале
-    вычисляется имитовставка от объединения ассоцииированных данных и
-    данных, подлежащих зашифрования. При этом предполагается, что ассоциированные данные
-    расположены вначале. После этого, данные зашифровываются.
+    режима гаммирования данных, согласно ГОСТ Р 34.12-2015: вычисляется имитовставка
+    от объединения ассоцииированных данных и данных, подлежащих зашифрованию,
+    после чего данные зашифровываются.
+
+    Данные обрабатываются за один проход фрагментами длины \ref ak_aead_tile_size октетов:
+    каждый фрагмент передается алгоритму HMAC и сразу же зашифровывается, пока он находится
+    в кэше процессора. Результат совпадает с результатом последовательного вызова
+    функций ak_hmac_ptr() и ak_bckey_ctr().
 
     Режим `ctr-hmac` \b должен использовать для шифрования и выработки имитовставки два
     различных ключа -- ключ алгоритма шифрования и ключ алгоритма hmac.
@@ -1128,6 +1811,7 @@
                                                          ak_pointer icode, const size_t icode_size )
 {
   int error = ak_error_ok;
+  size_t offset = 0, len = 0;
 
  /* проверки ключей */
   if(( encryptionKey == NULL ) && ( authenticationKey == NULL ))
@@ -1142,19 +1826,31 @@
                                   ((ak_hmac)authenticationKey)->key.oid->engine != hmac_function )
     return ak_error_message( ak_error_null_pointer, __func__ ,
                                                  "using non hmac key for checkin data integrity" );
- /* вычисляем имитовставку */
+ /* начинаем вычислять имитовставку */
   if( authenticationKey != NULL ) {
     if(( error = ak_hmac_clean( authenticationKey )) != ak_error_ok )
       return ak_error_message( error, __func__, "incorrect cleaning of hmac secret key context" );
     if(( error = ak_hmac_update( authenticationKey, adata, adata_size )) != ak_error_ok )
       return ak_error_message( error, __func__, "incorrect updating of associated data" );
-    if(( error = ak_hmac_finalize( authenticationKey, in, size, icode, icode_size )) != ak_error_ok )
-      return ak_error_message( error, __func__, "incorrect finalizing of integrity code" );
   }
- /* зашифровываем даные */
-  if( encryptionKey != NULL ) {
-    if(( error = ak_bckey_ctr( encryptionKey, in, out, size, iv, iv_size )) != ak_error_ok )
-     return ak_error_message( error, __func__, "incorrect data encryption" );
+ /* фрагмент открытого текста сначала передается алгоритму hmac,
+    поскольку при in == out он будет заменен шифртекстом */
+  for( offset = 0; offset < size; offset += len ) {
+     len = ak_min( ak_aead_tile_size, size - offset );
+     if( authenticationKey != NULL ) {
+       if(( error = ak_hmac_update( authenticationKey,
+                                         (ak_uint8 *)in + offset, len )) != ak_error_ok )
+         return ak_error_message( error, __func__, "incorrect updating of plain data" );
+     }
+     if( encryptionKey != NULL ) {
+       if(( error = ak_bckey_ctr( encryptionKey, (ak_uint8 *)in + offset,
+          (ak_uint8 *)out + offset, len, offset ? NULL : iv, offset ? 0 : iv_size )) != ak_error_ok )
+         return ak_error_message( error, __func__, "incorrect data encryption" );
+     }
+  }
+  if( authenticationKey != NULL ) {
+    if(( error = ak_hmac_finalize( authenticationKey, NULL, 0, icode, icode_size )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect finalizing of integrity code" );
   }
 
  return error;
@@ -1195,6 +1891,8 @@
                                                          ak_pointer icode, const size_t icode_size )
 {
   int error = ak_error_ok;
+  size_t offset = 0, len = 0;
+  ak_uint8 icode2[128];
 
  /* проверки ключей */
   if(( encryptionKey == NULL ) && ( authenticationKey == NULL ))
@@ -1209,16 +1907,8 @@
                                   ((ak_hmac)authenticationKey)->key.oid->engine != hmac_function )
     return ak_error_message( ak_error_null_pointer, __func__ ,
                                                  "using non hmac key for checkin data integrity" );
- /* расшифровываем даные */
-  if( encryptionKey != NULL ) {
-    if(( error = ak_bckey_ctr( encryptionKey, in, out, size, iv, iv_size )) != ak_error_ok )
-     return ak_error_message( error, __func__, "incorrect data decryption" );
-  }
- /* вычисляем имитовставку */
+ /* начинаем вычислять имитовставку */
   if( authenticationKey != NULL ) {
-    ak_uint8 icode2[128];
-    memset( icode2, 0, sizeof( icode2 ));
-
     if( ak_hmac_get_tag_size( authenticationKey ) > sizeof( icode2 ))
       return ak_error_message( ak_error_wrong_length, __func__,
                                                        "using hmac key with very huge tag size" );
@@ -1226,7 +1916,24 @@
       return ak_error_message( error, __func__, "incorrect cleaning of hmac secret key context" );
     if(( error = ak_hmac_update( authenticationKey, adata, adata_size )) != ak_error_ok )
       return ak_error_message( error, __func__, "incorrect updating of associated data" );
-    if(( error = ak_hmac_finalize( authenticationKey, out, size, icode2, icode_size )) != ak_error_ok )
+  }
+ /* имитовставка вычисляется от только что расшифрованного фрагмента */
+  for( offset = 0; offset < size; offset += len ) {
+     len = ak_min( ak_aead_tile_size, size - offset );
+     if( encryptionKey != NULL ) {
+       if(( error = ak_bckey_ctr( encryptionKey, (ak_uint8 *)in + offset,
+          (ak_uint8 *)out + offset, len, offset ? NULL : iv, offset ? 0 : iv_size )) != ak_error_ok )
+         return ak_error_message( error, __func__, "incorrect data decryption" );
+     }
+     if( authenticationKey != NULL ) {
+       if(( error = ak_hmac_update( authenticationKey,
+                                        (ak_uint8 *)out + offset, len )) != ak_error_ok )
+         return ak_error_message( error, __func__, "incorrect updating of plain data" );
+     }
+  }
+  if( authenticationKey != NULL ) {
+    memset( icode2, 0, sizeof( icode2 ));
+    if(( error = ak_hmac_finalize( authenticationKey, NULL, 0, icode2, icode_size )) != ak_error_ok )
       return ak_error_message( error, __func__, "incorrect finalizing of integrity code" );
     if( ak_ptr_is_equal( icode, icode2, icode_size )) error = ak_error_ok;
        else error = ak_error_not_equal_data;
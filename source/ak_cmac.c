@@ -4,7 +4,7 @@
 /*  Файл ak_cmac.c                                                                                 */
 /*  - содержит реализацию общих функций для алгоритмов блочного шифрования.                        */
 /* ----------------------------------------------------------------------------------------------- */
- #include <libakrypt.h>
+ #include <libakrypt-internal.h>
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция вычисляет имитовставку от заданной области памяти фиксированного размера.
@@ -26,7 +26,7 @@
  int ak_bckey_cmac( ak_bckey bkey, ak_pointer in,
                                           const size_t size, ak_pointer out, const size_t out_size )
 {
-  ak_int64 i = 0, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" ),
+  ak_int64 i = 0, oc = bkey->options.openssl_compability,
         #ifdef AK_LITTLE_ENDIAN
            one64[2] = { 0x02, 0x00 },
         #else
@@ -132,6 +132,123 @@
  return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Обработка заданного количества полных блоков данных (без изменения ресурса ключа).
+
+    @param bkey Ключ алгоритма блочного шифрования.
+    @param yaout Текущее значение вычисляемой имитовставки.
+    @param in Указатель на обрабатываемые данные.
+    @param blocks Количество блоков.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_cmac_blocks( ak_bckey bkey, ak_uint64 *yaout,
+                                                         const ak_uint8 *in, const size_t blocks )
+{
+  size_t i = 0;
+  ak_uint64 *inptr = (ak_uint64 *)in;
+
+  switch( bkey->bsize ) {
+   case  8 :
+         /* здесь длина блока равна 64 бита */
+            for( i = 0; i < blocks; i++, inptr++ ) {
+               yaout[0] ^= inptr[0];
+               bkey->encrypt( &bkey->key, yaout, yaout );
+            }
+            break;
+
+   case 16 :
+          /* здесь длина блока равна 128 бит */
+            for( i = 0; i < blocks; i++, inptr += 2 ) {
+               yaout[0] ^= inptr[0];
+               yaout[1] ^= inptr[1];
+               bkey->encrypt( &bkey->key, yaout, yaout );
+            }
+            break;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Обработка последнего (возможно, неполного) блока данных и формирование имитовставки
+    (без изменения ресурса ключа).
+
+    @param bkey Ключ алгоритма блочного шифрования.
+    @param yaout Текущее значение вычисляемой имитовставки.
+    @param in Указатель на последний блок данных.
+    @param size Длина последнего блока (от единицы до длины блока включительно).
+    @param out Область памяти, куда помещается результат.
+    @param out_size Ожидаемый размер имитовставки.                                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_cmac_last_block( ak_bckey bkey, ak_uint64 *yaout, const ak_uint8 *in,
+                                     const size_t size, ak_pointer out, const size_t out_size )
+{
+  ak_int64 oc = bkey->options.openssl_compability,
+        #ifdef AK_LITTLE_ENDIAN
+           one64[2] = { 0x02, 0x00 };
+        #else
+           one64[2] = { 0x0200000000000000LL, 0x00 };
+        #endif
+  ak_uint64 i, akey[2], *inptr = (ak_uint64 *)in;
+
+  memset( akey, 0, sizeof( akey ));
+  switch( bkey->bsize ) {
+   case  8 :
+          /* теперь ключи для завершения алгоритма */
+            bkey->encrypt( &bkey->key, akey, akey );
+            if( oc ) akey[0] = bswap_64( akey[0] );
+            ak_gf64_mul( akey, akey, one64 );
+
+            if( size < bkey->bsize ) {
+              ak_gf64_mul( akey, akey, one64 );
+              ((ak_uint8 *)akey)[size] ^= 0x80;
+            }
+
+          /* теперь шифруем последний блок */
+            if( oc ) {
+               yaout[0] ^= bswap_64( akey[0] );
+               for( i = 0; i < size; i++ ) ((ak_uint8 *)yaout)[7-i] ^= ((ak_uint8 *)inptr)[size-1-i];
+            }
+              else {
+               yaout[0] ^= akey[0];
+               for( i = 0; i < size; i++ ) ((ak_uint8 *)yaout)[i] ^= ((ak_uint8 *)inptr)[i];
+              }
+            bkey->encrypt( &bkey->key, yaout, akey );
+          break;
+
+   case 16 :
+          /* вырабатываем ключи для завершения алгортма */
+            bkey->encrypt( &bkey->key, akey, akey );
+            if( oc ) {
+              ak_uint64 tmp = bswap_64( akey[0] );
+              akey[0] = bswap_64( akey[1] );
+              akey[1] = tmp;
+            }
+            ak_gf128_mul( akey, akey, one64 );
+            if( size < bkey->bsize ) {
+              ak_gf128_mul( akey, akey, one64 );
+              ((ak_uint8 *)akey)[size] ^= 0x80;
+            }
+
+          /* теперь шифруем последний блок*/
+            if( oc ) {
+               yaout[0] ^= bswap_64( akey[1] );
+               yaout[1] ^= bswap_64( akey[0] );
+               for( i = 0; i < size; i++ ) ((ak_uint8 *)yaout)[15-i] ^= ((ak_uint8 *)inptr)[size-1-i];
+            }
+             else {
+              yaout[0] ^= akey[0];
+              yaout[1] ^= akey[1];
+              for( i = 0; i < size; i++ ) ((ak_uint8 *)yaout)[i] ^= ((ak_uint8 *)inptr)[i];
+             }
+            bkey->encrypt( &bkey->key, yaout, akey );
+          break;
+  }
+
+ /* копируем нужную часть результирующего массива и завершаем работу */
+ if( oc ) memcpy( out, (ak_uint8 *)akey, ak_min( out_size, bkey->bsize ));
+  else memcpy( out, (ak_uint8 *)akey+( out_size > bkey->bsize ? 0 : bkey->bsize-out_size ),
+                                                                  ak_min( out_size, bkey->bsize ));
+}
+
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Алгоритм вычисления имитовставки может быть представлен в виде последовательного вызова
     трех функций
@@ -191,8 +308,7 @@
 /* ----------------------------------------------------------------------------------------------- */
  int ak_bckey_cmac_update( ak_bckey bkey, const ak_pointer in, const size_t size )
 {
-  ak_int64 i, blocks = 0;
-  ak_uint64 *yaout = NULL, *inptr = (ak_uint64 *)in;
+  ak_int64 blocks = 0;
 
   if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                         "using null pointer to block cipher key" );
@@ -211,25 +327,7 @@
    else bkey->key.resource.value.counter -= blocks; /* уменьшаем ресурс ключа */
 
  /* основной цикл */
-  yaout = (ak_uint64 *) bkey->ivector;
-  switch( bkey->bsize ) {
-   case  8 :
-         /* здесь длина блока равна 64 бита */
-            for( i = 0; i < blocks; i++, inptr++ ) {
-               yaout[0] ^= inptr[0];
-               bkey->encrypt( &bkey->key, yaout, yaout );
-            }
-            break;
-
-   case 16 :
-          /* здесь длина блока равна 128 бит */
-            for( i = 0; i < blocks; i++, inptr += 2 ) {
-               yaout[0] ^= inptr[0];
-               yaout[1] ^= inptr[1];
-               bkey->encrypt( &bkey->key, yaout, yaout );
-            }
-            break;
-  }
+  ak_bckey_cmac_blocks( bkey, ( ak_uint64 * )bkey->ivector, in, ( size_t )blocks );
 
  return ak_error_ok;
 }
@@ -267,14 +365,6 @@
  int ak_bckey_cmac_finalize( ak_bckey bkey, const ak_pointer in, const size_t size,
                                                            ak_pointer out, const size_t out_size )
 {
-  ak_int64 oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" ),
-        #ifdef AK_LITTLE_ENDIAN
-           one64[2] = { 0x02, 0x00 };
-        #else
-           one64[2] = { 0x0200000000000000LL, 0x00 };
-        #endif
-  ak_uint64 i, *yaout, akey[2], *inptr = (ak_uint64 *)in;
-
   if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                         "using null pointer to block cipher key" );
   if( size == 0 ) return ak_error_message( ak_error_zero_length, __func__,
@@ -288,76 +378,101 @@
  /* уменьшаем значение ресурса ключа */
   bkey->key.resource.value.counter--; /* уменьшаем ресурс ключа */
 
-  memset( akey, 0, sizeof( akey ));
-  yaout = ( ak_uint64 * )bkey->ivector;
+  ak_bckey_cmac_last_block( bkey, ( ak_uint64 * )bkey->ivector, in, size, out, out_size );
+ return ak_error_ok;
+}
 
- /* основной цикл */
-  switch( bkey->bsize ) {
-   case  8 :
-          /* теперь ключи для завершения алгоритма */
-            bkey->encrypt( &bkey->key, akey, akey );
-            if( oc ) akey[0] = bswap_64( akey[0] );
-            ak_gf64_mul( akey, akey, one64 );
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Состояние алгоритма выработки имитовставки, используемое режимом `ctr-cmac`.
+    \details В отличие от функций ak_bckey_cmac_update() и ak_bckey_cmac_finalize() состояние
+    хранится вне контекста ключа, поэтому один и тот же ключ может одновременно использоваться
+    для шифрования в режиме гаммирования, хранящего свое состояние в контексте ключа.              */
+ struct cmac_stream {
+  /*! \brief Текущее значение имитовставки. */
+   ak_uint64 yaout[2];
+  /*! \brief Последний (возможно, неполный) блок данных, обрабатываемый при завершении. */
+   ak_uint8 buffer[16];
+  /*! \brief Количество октетов в буффере. */
+   size_t length;
+ };
 
-            if( size < bkey->bsize ) {
-              ak_gf64_mul( akey, akey, one64 );
-              ((ak_uint8 *)akey)[size] ^= 0x80;
-            }
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Обработка фрагмента данных произвольной длины.
 
-          /* теперь шифруем последний блок */
-            if( oc ) {
-               yaout[0] ^= bswap_64( akey[0] );
-               for( i = 0; i < size; i++ ) ((ak_uint8 *)yaout)[7-i] ^= ((ak_uint8 *)inptr)[size-1-i];
-            }
-              else {
-               yaout[0] ^= akey[0];
-               for( i = 0; i < size; i++ ) ((ak_uint8 *)yaout)[i] ^= ((ak_uint8 *)inptr)[i];
-              }
-            bkey->encrypt( &bkey->key, yaout, akey );
-          break;
+    Последний блок (полный или неполный) всегда остается в буффере, поскольку он обрабатывается
+    иначе, чем все остальные блоки.                                                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_cmac_stream_update( ak_bckey bkey, struct cmac_stream *sx,
+                                                            const ak_uint8 *in, const size_t size )
+{
+  size_t len = size, fill = 0, blocks = 0;
+
+  if( !len ) return;
+  if( sx->length ) {
+    fill = ak_min( bkey->bsize - sx->length, len );
+    memcpy( sx->buffer + sx->length, in, fill );
+    sx->length += fill; in += fill; len -= fill;
+    if( !len ) return;
+    ak_bckey_cmac_blocks( bkey, sx->yaout, sx->buffer, 1 );
+  }
+  blocks = ( len - 1 )/bkey->bsize;
+  ak_bckey_cmac_blocks( bkey, sx->yaout, in, blocks );
+  memcpy( sx->buffer, in + blocks*bkey->bsize, sx->length = len - blocks*bkey->bsize );
+}
 
-   case 16 :
-          /* вырабатываем ключи для завершения алгортма */
-            bkey->encrypt( &bkey->key, akey, akey );
-            if( oc ) {
-              ak_uint64 tmp = bswap_64( akey[0] );
-              akey[0] = bswap_64( akey[1] );
-              akey[1] = tmp;
-            }
-            ak_gf128_mul( akey, akey, one64 );
-            if( size < bkey->bsize ) {
-              ak_gf128_mul( akey, akey, one64 );
-              ((ak_uint8 *)akey)[size] ^= 0x80;
-            }
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Инициализация состояния и обработка ассоциированных данных.
 
-          /* теперь шифруем последний блок*/
-            if( oc ) {
-               yaout[0] ^= bswap_64( akey[1] );
-               yaout[1] ^= bswap_64( akey[0] );
-               for( i = 0; i < size; i++ ) ((ak_uint8 *)yaout)[15-i] ^= ((ak_uint8 *)inptr)[size-1-i];
-            }
-             else {
-              yaout[0] ^= akey[0];
-              yaout[1] ^= akey[1];
-              for( i = 0; i < size; i++ ) ((ak_uint8 *)yaout)[i] ^= ((ak_uint8 *)inptr)[i];
-             }
-            bkey->encrypt( &bkey->key, yaout, akey );
-          break;
-  }
+    Функция проверяет ключ и уменьшает его ресурс на количество блоков, которое будет обработано
+    при выработке имитовставки от данных общей длины `adata_size + size` октетов.                  */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_cmac_stream_init( ak_bckey bkey, struct cmac_stream *sx,
+                                 const ak_pointer adata, const size_t adata_size, const size_t size )
+{
+  const size_t asize = ( adata == NULL ) ? 0 : adata_size;
+  ak_int64 blocks = ( ak_int64 )(( asize + size + bkey->bsize - 1 )/bkey->bsize );
 
- /* копируем нужную часть результирующего массива и завершаем работу */
- if( oc ) memcpy( out, (ak_uint8 *)akey, ak_min( out_size, bkey->bsize ));
-  else memcpy( out, (ak_uint8 *)akey+( out_size > bkey->bsize ? 0 : bkey->bsize-out_size ),
-                                                                  ak_min( out_size, bkey->bsize ));
+ /* проверяем целостность ключа */
+  if( bkey->key.check_icode( &bkey->key ) != ak_true )
+    return ak_error_message( ak_error_wrong_key_icode, __func__,
+                                                  "incorrect integrity code of secret key value" );
+ /* уменьшаем значение ресурса ключа */
+  if( bkey->key.resource.value.counter < blocks )
+    return ak_error_message( ak_error_low_key_resource, __func__ ,
+                                                              "low resource of block cipher key" );
+   else bkey->key.resource.value.counter -= blocks;
+
+  memset( sx, 0, sizeof( struct cmac_stream ));
+  ak_bckey_cmac_stream_update( bkey, sx, adata, asize );
  return ak_error_ok;
+}
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Завершение вычислений и формирование имитовставки. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_cmac_stream_finalize( ak_bckey bkey, struct cmac_stream *sx,
+                                                          ak_pointer out, const size_t out_size )
+{
+  if( !sx->length ) return ak_error_message( ak_error_zero_length, __func__,
+                                                                 "using a data with zero length" );
+  if( out == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                           "using null pointer to result buffer" );
+  if( !out_size ) return ak_error_message( ak_error_zero_length, __func__,
+                                                            "using zero length of result buffer" );
+  ak_bckey_cmac_last_block( bkey, sx->yaout, sx->buffer, sx->length, out, out_size );
+  memset( sx, 0, sizeof( struct cmac_stream ));
+ return ak_error_ok;
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! Функция реализует последовательную комбинацию режимов из ГОСТ Р 34.12-2015. В начале
+/*! Функция реализует последовательную комбинацию режимов из ГОСТ Р 34.12-2015:
     вычисляется имитовставка от объединения ассоциированных данных и
-    данных, подлежащих зашифрования. При этом предполагается, что ассоциированные данные
-    расположены вначале. После этого, данные зашифровываются.
+    данных, подлежащих зашифрованию, после чего данные зашифровываются.
+
+    Данные обрабатываются за один проход фрагментами длины \ref ak_aead_tile_size октетов:
+    каждый фрагмент передается алгоритму выработки имитовставки и сразу же зашифровывается,
+    пока он находится в кэше процессора. Результат совпадает с результатом последовательного
+    вызова функций ak_bckey_cmac() и ak_bckey_ctr().
 
     Режим `ctr-cmac` \b должен использовать для шифрования и выработки имитовставки два
     различных ключа, при этом длины блоков обрабатываемых данных для ключей должны совпадать
@@ -379,10 +494,6 @@
 
     Ситуация, при которой оба указателя на ключ принимают значение `NULL` воспринимается как ошибка.
 
-    \note В настоящий момент использована наиболее простая реализация алгоритма,
-    предполагающая что ассоциированные данные и шифруемые данные находятся в памяти последовательно.
-    Если это допущение невыполнено, то результат работы функции может быть непредсказуемым.
-
     @param encryptionKey ключ шифрования (указатель на struct bckey), должен быть инициализирован
            перед вызовом функции; может принимать значение `NULL`;
     @param authenticationKey ключ выработки кода аутентификации (имитовставки)
@@ -411,39 +522,40 @@
                                      const size_t size, const ak_pointer iv, const size_t iv_size,
                                                          ak_pointer icode, const size_t icode_size )
 {
-  size_t sizeptr = 0;
-  ak_pointer ptr = NULL;
   int error = ak_error_ok;
+  size_t offset = 0, len = 0;
+  struct cmac_stream sx;
+  ak_bckey ekey = ( ak_bckey )encryptionKey, akey = ( ak_bckey )authenticationKey;
 
  /* проверки ключей */
-  if(( encryptionKey == NULL ) && ( authenticationKey == NULL ))
+  if(( ekey == NULL ) && ( akey == NULL ))
     return ak_error_message( ak_error_null_pointer, __func__ ,
                                 "using null pointers both to encryption and authentication keys" );
-  if(( encryptionKey != NULL ) && ( authenticationKey ) != NULL ) {
-    if( ((ak_bckey)encryptionKey)->bsize != ((ak_bckey)authenticationKey)->bsize )
+  if(( ekey != NULL ) && ( akey != NULL )) {
+    if( ekey->bsize != akey->bsize )
       return ak_error_message( ak_error_wrong_length, __func__,
                                                            "different block sizes for given keys");
   }
-  if(( adata != NULL ) && ( adata_size != 0 )) {
-    /* проверяем, что данные расположены в памяти последовательно */
-     if( ((ak_uint8*)adata)+adata_size != (ak_uint8 *)in )
-       return ak_error_message( ak_error_linked_data, __func__,
-                                          "this function can't be applied to non sequenced data" );
-     ptr = adata;
-     sizeptr = adata_size + size;
-  } else {
-      ptr = iv;
-      sizeptr = size;
-    }
+  if( akey != NULL ) {
+    if(( error = ak_bckey_cmac_stream_init( akey, &sx, adata, adata_size, size )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect initialization of integrity code" );
+  }
 
-  if( authenticationKey != NULL ) {
-    if(( error =
-             ak_bckey_cmac( authenticationKey, ptr, sizeptr, icode, icode_size )) != ak_error_ok )
-     return ak_error_message( error, __func__, "incorrect data encryption" );
+ /* фрагмент открытого текста сначала передается алгоритму выработки имитовставки,
+    поскольку при in == out он будет заменен шифртекстом */
+  for( offset = 0; offset < size; offset += len ) {
+     len = ak_min( ak_aead_tile_size, size - offset );
+     if( akey != NULL ) ak_bckey_cmac_stream_update( akey, &sx, (ak_uint8 *)in + offset, len );
+     if( ekey != NULL ) {
+       if(( error = ak_bckey_ctr( ekey, (ak_uint8 *)in + offset, (ak_uint8 *)out + offset, len,
+                       offset ? NULL : iv, offset ? 0 : iv_size )) != ak_error_ok )
+         return ak_error_message( error, __func__, "incorrect data encryption" );
+     }
   }
-  if( encryptionKey != NULL ) {
-    if(( error = ak_bckey_ctr( encryptionKey, in, out, size, iv, iv_size )) != ak_error_ok )
-     return ak_error_message( error, __func__, "incorrect data encryption" );
+
+  if( akey != NULL ) {
+    if(( error = ak_bckey_cmac_stream_finalize( akey, &sx, icode, icode_size )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect calculation of integrity code" );
   }
  return ak_error_ok;
 }
@@ -482,48 +594,48 @@
                                      const size_t size, const ak_pointer iv, const size_t iv_size,
                                                          ak_pointer icode, const size_t icode_size )
 {
-  size_t sizeptr = 0;
-  ak_pointer ptr = NULL;
   int error = ak_error_ok;
+  size_t offset = 0, len = 0;
+  struct cmac_stream sx;
+  ak_bckey ekey = ( ak_bckey )encryptionKey, akey = ( ak_bckey )authenticationKey;
 
  /* проверки ключей */
-  if(( encryptionKey == NULL ) && ( authenticationKey == NULL ))
+  if(( ekey == NULL ) && ( akey == NULL ))
     return ak_error_message( ak_error_null_pointer, __func__ ,
                                 "using null pointers both to encryption and authentication keys" );
-  if(( encryptionKey != NULL ) && ( authenticationKey ) != NULL ) {
-    if( ((ak_bckey)encryptionKey)->bsize != ((ak_bckey)authenticationKey)->bsize )
+  if(( ekey != NULL ) && ( akey != NULL )) {
+    if( ekey->bsize != akey->bsize )
       return ak_error_message( ak_error_wrong_length, __func__,
                                                            "different block sizes for given keys");
   }
-  if(( adata != NULL ) && ( adata_size != 0 )) {
-    /* проверяем, что данные расположены в памяти последовательно */
-     if( ((ak_uint8*)adata)+adata_size != (ak_uint8 *)in )
-       return ak_error_message( ak_error_linked_data, __func__,
-                                          "this function can't be applied to non sequenced data" );
-     ptr = adata;
-     sizeptr = adata_size + size;
-  } else {
-      ptr = iv;
-      sizeptr = size;
-    }
+  if( akey != NULL ) {
+    if( akey->bsize > icode_size )
+      return ak_error_message( ak_error_wrong_length, __func__,
+                                                "using block cipher with very huge block length" );
+    if(( error = ak_bckey_cmac_stream_init( akey, &sx, adata, adata_size, size )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect initialization of integrity code" );
+  }
 
-  if( encryptionKey != NULL ) {
-    if(( error = ak_bckey_ctr( encryptionKey, in, out, size, iv, iv_size )) != ak_error_ok )
-     return ak_error_message( error, __func__, "incorrect data decryption" );
+ /* имитовставка вычисляется от только что расшифрованного фрагмента */
+  for( offset = 0; offset < size; offset += len ) {
+     len = ak_min( ak_aead_tile_size, size - offset );
+     if( ekey != NULL ) {
+       if(( error = ak_bckey_ctr( ekey, (ak_uint8 *)in + offset, (ak_uint8 *)out + offset, len,
+                       offset ? NULL : iv, offset ? 0 : iv_size )) != ak_error_ok )
+         return ak_error_message( error, __func__, "incorrect data decryption" );
+     }
+     if( akey != NULL ) ak_bckey_cmac_stream_update( akey, &sx, (ak_uint8 *)out + offset, len );
   }
-  if( authenticationKey != NULL ) {
+
+  if( akey != NULL ) {
     ak_uint8 icode2[32];
     memset( icode2, 0, sizeof( icode2 ));
 
-    if( ((ak_bckey)authenticationKey)->bsize > icode_size )
-      return ak_error_message( ak_error_wrong_length, __func__,
-                                                "using block cipher with very huge block length" );
-    if(( error =
-             ak_bckey_cmac( authenticationKey, ptr, sizeptr, icode2, icode_size )) != ak_error_ok )
+    if(( error = ak_bckey_cmac_stream_finalize( akey, &sx, icode2, icode_size )) != ak_error_ok )
       return ak_error_message( error, __func__,
                                              "incorrect calculation of data authentication code" );
-     if( ak_ptr_is_equal( icode, icode2, icode_size )) error = ak_error_ok;
-       else error = ak_error_not_equal_data;
+    if( ak_ptr_is_equal( icode, icode2, icode_size )) error = ak_error_ok;
+      else error = ak_error_not_equal_data;
   }
  return error;
 }
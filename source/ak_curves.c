@@ -4,9 +4,12 @@
 /*  Файл ak_curves.с                                                                               */
 /*  - содержит реализацию функций для работы с эллиптическими кривыми.                             */
 /* ----------------------------------------------------------------------------------------------- */
- #include <libakrypt.h>
+ #include <libakrypt-internal.h>
 
 /* ----------------------------------------------------------------------------------------------- */
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
 #ifdef AK_HAVE_STRING_H
  #include <string.h>
 #else
@@ -30,27 +33,27 @@
  /* определяем константы 4 и 27 в представлении Монтгомери */
   ak_mpzn_set_ui( d, ec->size, 4 );
   ak_mpzn_set_ui( s, ak_mpznmax_size, 27 );
-  ak_mpzn_mul_montgomery( d, d, ec->r2, ec->p, ec->n, ec->size );
-  ak_mpzn_mul_montgomery( s, s, ec->r2, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( d, d, ec->r2, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( s, s, ec->r2, ec->p, ec->n, ec->size );
 
  /* вычисляем 4a^3 (mod p) значение в представлении Монтгомери */
-  ak_mpzn_mul_montgomery( d, d, ec->a, ec->p, ec->n, ec->size );
-  ak_mpzn_mul_montgomery( d, d, ec->a, ec->p, ec->n, ec->size );
-  ak_mpzn_mul_montgomery( d, d, ec->a, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( d, d, ec->a, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( d, d, ec->a, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( d, d, ec->a, ec->p, ec->n, ec->size );
 
  /* вычисляем значение 4a^3 + 27b^2 (mod p) в представлении Монтгомери */
-  ak_mpzn_mul_montgomery( s, s, ec->b, ec->p, ec->n, ec->size );
-  ak_mpzn_mul_montgomery( s, s, ec->b, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( s, s, ec->b, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( s, s, ec->b, ec->p, ec->n, ec->size );
   ak_mpzn_add_montgomery( d, d, s, ec->p, ec->size );
 
  /* определяем константу -16 в представлении Монтгомери и вычисляем D = -16(4a^3+27b^2) (mod p) */
   ak_mpzn_set_ui( s, ec->size, 16 );
   ak_mpzn_sub( s, ec->p, s, ec->size );
-  ak_mpzn_mul_montgomery( s, s, ec->r2, ec->p, ec->n, ec->size );
-  ak_mpzn_mul_montgomery( d, d, s, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( s, s, ec->r2, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( d, d, s, ec->p, ec->n, ec->size );
 
  /* возвращаем результат (в обычном представлении) */
-  ak_mpzn_mul_montgomery( d, d, one, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( d, d, one, ec->p, ec->n, ec->size );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -102,6 +105,38 @@
    else return ak_error_curve_order_parameters;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция проверяет, что вид модуля, указанный в контексте эллиптической кривой, допустим
+    и соответствует значению модуля \f$ p \f$. Для модулей вида \ref wcurve_field_pseudo_mersenne
+    проверяется, что \f$ p = 2^{64\cdot size} - c \f$, где \f$ c < 2^{32} \f$: только для таких
+    модулей корректно специализированное умножение ak_mpzn_mul_montgomery_pseudo_mersenne_uint64().
+
+    @param ec Контекст эллиптической кривой.
+
+    @return Функция возвращает \ref ak_error_ok в случае, если вид модуля указан корректно.
+    В противном случае возвращается код ошибки.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_wcurve_check_field( ak_wcurve ec )
+{
+  size_t i = 0;
+
+  if( ec == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                               "using a null pointer to elliptic curve context" );
+  switch( ec->field ) {
+    case wcurve_field_montgomery:
+      return ak_error_ok;
+
+    case wcurve_field_pseudo_mersenne:
+      for( i = 1; i < ec->size; i++ )
+         if( ec->p[i] != 0xffffffffffffffffLL ) return ak_error_curve_prime_modulo;
+      if( ec->p[0] < 0xffffffff00000000LL ) return ak_error_curve_prime_modulo;
+      return ak_error_ok;
+
+    default:
+      return ak_error_curve_prime_modulo;
+  }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция принимает на вход контекст эллиптической кривой, заданной в короткой форме Вейерштрасса,
     и выполняет следующие математические проверки
@@ -109,6 +144,8 @@
      - проверяется, что модуль кривой (простое число \f$ p \f$) удовлетворяет неравенству
        \f$ 2^{n-32} < p < 2^n \f$, где \f$ n \f$ это либо 256, либо 512 в зависимости от
        параметров кривой,
+     - проверяется, что вид модуля, определяющий реализацию умножения, соответствует
+       значению модуля (см. ak_wcurve_check_field()),
      - проверяется, что дискриминант кривой отличен от нуля по модулю \f$ p \f$,
      - проверяется, что фиксированная точка кривой, содержащаяся в контексте эллиптической кривой,
        действительно принадлежит эллиптической кривой,
@@ -134,6 +171,11 @@
     return ak_error_message( ak_error_curve_prime_modulo, __func__ ,
                                            "using elliptic curve parameters with wrong module" );
 
+ /* проверяем, что вид модуля соответствует его значению */
+  if(( error = ak_wcurve_check_field( ec )) != ak_error_ok )
+    return ak_error_message( error, __func__ ,
+                                      "using elliptic curve parameters with wrong modulo type" );
+
  /* проверяем соответствие данных в памяти их символьному представлению */
   if(( str = ak_mpzn_to_hexstr( ec->p, ec->size )) == NULL )
     return ak_error_message( error, __func__ , "incorrect convertation mpzn integer to string" );
@@ -182,10 +224,10 @@
   if( oid != NULL ) {
     ak_error_message_fmt( error, __func__, "elliptic curve: %s (oid: %s)",
                                                                        oid->name[0], oid->id[0] );
-    ak_mpzn_mul_montgomery( tmp, ec->a, one, ec->p, ec->n, ec->size );
+    ak_wcurve_mul( ec )( tmp, ec->a, one, ec->p, ec->n, ec->size );
     ak_error_message_fmt( error, __func__, " a = %s",
                                      str = ak_mpzn_to_hexstr_alloc( tmp, ec->size )); free( str );
-    ak_mpzn_mul_montgomery( tmp, ec->b, one, ec->p, ec->n, ec->size );
+    ak_wcurve_mul( ec )( tmp, ec->b, one, ec->p, ec->n, ec->size );
     ak_error_message_fmt( error, __func__, " b = %s",
                                      str = ak_mpzn_to_hexstr_alloc( tmp, ec->size )); free( str );
     ak_error_message_fmt( error, __func__, " b = %s",
@@ -235,9 +277,9 @@
 
   fprintf( fp, "\nparameters:\n");
 
-  ak_mpzn_mul_montgomery( tmp, ec->a, one, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( tmp, ec->a, one, ec->p, ec->n, ec->size );
   fprintf( fp, "  a =  0x%s\n", ak_mpzn_to_hexstr( tmp, ec->size ));
-  ak_mpzn_mul_montgomery( tmp, ec->b, one, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( tmp, ec->b, one, ec->p, ec->n, ec->size );
   fprintf( fp, "  b =  0x%s\n", ak_mpzn_to_hexstr( tmp, ec->size ));
 
   fprintf( fp, "  p =  0x%s\n", ak_mpzn_to_hexstr( ec->p, ec->size ));
@@ -393,23 +435,23 @@
 
  /* Проверяем принадлежность точки заданной кривой */
   ak_mpzn_set( t, ec->a, ec->size );
-  ak_mpzn_mul_montgomery( t, t, wp->x, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( t, t, wp->x, ec->p, ec->n, ec->size );
   ak_mpzn_set( s, ec->b, ec->size );
-  ak_mpzn_mul_montgomery( s, s, wp->z, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( s, s, wp->z, ec->p, ec->n, ec->size );
   ak_mpzn_add_montgomery( t, t, s, ec->p, ec->size ); // теперь в t величина (ax+bz)
 
   ak_mpzn_set( s, wp->z, ec->size );
-  ak_mpzn_mul_montgomery( s, s, s, ec->p, ec->n, ec->size );
-  ak_mpzn_mul_montgomery( t, t, s, ec->p, ec->n, ec->size ); // теперь в t величина (ax+bz)z^2
+  ak_wcurve_mul( ec )( s, s, s, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( t, t, s, ec->p, ec->n, ec->size ); // теперь в t величина (ax+bz)z^2
 
   ak_mpzn_set( s, wp->x, ec->size );
-  ak_mpzn_mul_montgomery( s, s, s, ec->p, ec->n, ec->size );
-  ak_mpzn_mul_montgomery( s, s, wp->x, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( s, s, s, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( s, s, wp->x, ec->p, ec->n, ec->size );
   ak_mpzn_add_montgomery( t, t, s, ec->p, ec->size ); // теперь в t величина x^3 + (ax+bz)z^2
 
   ak_mpzn_set( s, wp->y, ec->size );
-  ak_mpzn_mul_montgomery( s, s, s, ec->p, ec->n, ec->size );
-  ak_mpzn_mul_montgomery( s, s, wp->z, ec->p, ec->n, ec->size ); // теперь в s величина x^3 + (ax+bz)z^2
+  ak_wcurve_mul( ec )( s, s, s, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( s, s, wp->z, ec->p, ec->n, ec->size ); // теперь в s величина x^3 + (ax+bz)z^2
 
   if( ak_mpzn_cmp( t, s, ec->size )) return ak_false;
  return ak_true;
@@ -451,30 +493,30 @@
    return;
  }
  // dbl-2007-bl
- ak_mpzn_mul_montgomery( u1, wp->x, wp->x, ec->p, ec->n, ec->size );
- ak_mpzn_mul_montgomery( u2, wp->z, wp->z, ec->p, ec->n, ec->size );
+ ak_wcurve_mul( ec )( u1, wp->x, wp->x, ec->p, ec->n, ec->size );
+ ak_wcurve_mul( ec )( u2, wp->z, wp->z, ec->p, ec->n, ec->size );
  ak_mpzn_lshift_montgomery( u4, u1, ec->p, ec->size );
  ak_mpzn_add_montgomery( u4, u4, u1, ec->p, ec->size );
- ak_mpzn_mul_montgomery( u3, u2, ec->a, ec->p, ec->n, ec->size );
+ ak_wcurve_mul( ec )( u3, u2, ec->a, ec->p, ec->n, ec->size );
  ak_mpzn_add_montgomery( u3, u3, u4, ec->p, ec->size );  // u3 = az^2 + 3x^2
- ak_mpzn_mul_montgomery( u4, wp->y, wp->z, ec->p, ec->n, ec->size );
+ ak_wcurve_mul( ec )( u4, wp->y, wp->z, ec->p, ec->n, ec->size );
  ak_mpzn_lshift_montgomery( u4, u4, ec->p, ec->size );   // u4 = 2yz
- ak_mpzn_mul_montgomery( u5, wp->y, u4, ec->p, ec->n, ec->size ); // u5 = 2y^2z
+ ak_wcurve_mul( ec )( u5, wp->y, u4, ec->p, ec->n, ec->size ); // u5 = 2y^2z
  ak_mpzn_lshift_montgomery( u6, u5, ec->p, ec->size ); // u6 = 2u5
- ak_mpzn_mul_montgomery( u7, u6, wp->x, ec->p, ec->n, ec->size ); // u7 = 8xy^2z
+ ak_wcurve_mul( ec )( u7, u6, wp->x, ec->p, ec->n, ec->size ); // u7 = 8xy^2z
  ak_mpzn_lshift_montgomery( u1, u7, ec->p, ec->size );
  ak_mpzn_sub( u1, ec->p, u1, ec->size );
- ak_mpzn_mul_montgomery( u2, u3, u3, ec->p, ec->n, ec->size );
+ ak_wcurve_mul( ec )( u2, u3, u3, ec->p, ec->n, ec->size );
  ak_mpzn_add_montgomery( u2, u2, u1, ec->p, ec->size );
- ak_mpzn_mul_montgomery( wp->x, u2, u4, ec->p, ec->n, ec->size );
- ak_mpzn_mul_montgomery( u6, u6, u5, ec->p, ec->n, ec->size );
+ ak_wcurve_mul( ec )( wp->x, u2, u4, ec->p, ec->n, ec->size );
+ ak_wcurve_mul( ec )( u6, u6, u5, ec->p, ec->n, ec->size );
  ak_mpzn_sub( u6, ec->p, u6, ec->size );
  ak_mpzn_sub( u2, ec->p, u2, ec->size );
  ak_mpzn_add_montgomery( u2, u2, u7, ec->p, ec->size );
- ak_mpzn_mul_montgomery( wp->y, u2, u3, ec->p, ec->n, ec->size );
+ ak_wcurve_mul( ec )( wp->y, u2, u3, ec->p, ec->n, ec->size );
  ak_mpzn_add_montgomery( wp->y, wp->y, u6, ec->p, ec->size );
- ak_mpzn_mul_montgomery( wp->z, u4, u4, ec->p, ec->n, ec->size );
- ak_mpzn_mul_montgomery( wp->z, wp->z, u4, ec->p, ec->n, ec->size );
+ ak_wcurve_mul( ec )( wp->z, u4, u4, ec->p, ec->n, ec->size );
+ ak_wcurve_mul( ec )( wp->z, wp->z, u4, ec->p, ec->n, ec->size );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -522,11 +564,11 @@
   }
   // поскольку удвоение точки с помощью формул сложения дает бесконечно удаленную точку,
   // необходимо выполнить проверку
-  ak_mpzn_mul_montgomery( u1, wp1->x, wp2->z, ec->p, ec->n, ec->size );
-  ak_mpzn_mul_montgomery( u2, wp2->x, wp1->z, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( u1, wp1->x, wp2->z, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( u2, wp2->x, wp1->z, ec->p, ec->n, ec->size );
   if( ak_mpzn_cmp( u1, u2, ec->size ) == 0 ) { // случай совпадения х-координат точки
-    ak_mpzn_mul_montgomery( u1, wp1->y, wp2->z, ec->p, ec->n, ec->size );
-    ak_mpzn_mul_montgomery( u2, wp2->y, wp1->z, ec->p, ec->n, ec->size );
+    ak_wcurve_mul( ec )( u1, wp1->y, wp2->z, ec->p, ec->n, ec->size );
+    ak_wcurve_mul( ec )( u2, wp2->y, wp1->z, ec->p, ec->n, ec->size );
     if( ak_mpzn_cmp( u1, u2, ec->size ) == 0 ) // случай полного совпадения точек
       ak_wpoint_double( wp1, ec );
      else ak_wpoint_set_as_unit( wp1, ec );
@@ -534,31 +576,31 @@
   }
 
   //add-1998-cmo-2
-  ak_mpzn_mul_montgomery( u1, wp1->x, wp2->z, ec->p, ec->n, ec->size );
-  ak_mpzn_mul_montgomery( u2, wp1->y, wp2->z, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( u1, wp1->x, wp2->z, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( u2, wp1->y, wp2->z, ec->p, ec->n, ec->size );
   ak_mpzn_sub( u2, ec->p, u2, ec->size );
-  ak_mpzn_mul_montgomery( u3, wp1->z, wp2->z, ec->p, ec->n, ec->size );
-  ak_mpzn_mul_montgomery( u4, wp2->y, wp1->z, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( u3, wp1->z, wp2->z, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( u4, wp2->y, wp1->z, ec->p, ec->n, ec->size );
   ak_mpzn_add_montgomery( u4, u4, u2, ec->p, ec->size );
-  ak_mpzn_mul_montgomery( u5, u4, u4, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( u5, u4, u4, ec->p, ec->n, ec->size );
   ak_mpzn_sub( u7, ec->p, u1, ec->size );
-  ak_mpzn_mul_montgomery( wp1->x, wp2->x, wp1->z, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( wp1->x, wp2->x, wp1->z, ec->p, ec->n, ec->size );
   ak_mpzn_add_montgomery( wp1->x, wp1->x, u7, ec->p, ec->size );
-  ak_mpzn_mul_montgomery( u7, wp1->x, wp1->x, ec->p, ec->n, ec->size );
-  ak_mpzn_mul_montgomery( u6, u7, wp1->x, ec->p, ec->n, ec->size);
-  ak_mpzn_mul_montgomery( u1, u7, u1, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( u7, wp1->x, wp1->x, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( u6, u7, wp1->x, ec->p, ec->n, ec->size);
+  ak_wcurve_mul( ec )( u1, u7, u1, ec->p, ec->n, ec->size );
   ak_mpzn_lshift_montgomery( u7, u1, ec->p, ec->size );
   ak_mpzn_add_montgomery( u7, u7, u6, ec->p, ec->size );
   ak_mpzn_sub( u7, ec->p, u7, ec->size );
-  ak_mpzn_mul_montgomery( u5, u5, u3, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( u5, u5, u3, ec->p, ec->n, ec->size );
   ak_mpzn_add_montgomery( u5, u5, u7, ec->p, ec->size );
-  ak_mpzn_mul_montgomery( wp1->x, wp1->x, u5, ec->p, ec->n, ec->size );
-  ak_mpzn_mul_montgomery( u2, u2, u6, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( wp1->x, wp1->x, u5, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( u2, u2, u6, ec->p, ec->n, ec->size );
   ak_mpzn_sub( u5, ec->p, u5, ec->size );
   ak_mpzn_add_montgomery( u1, u1, u5, ec->p, ec->size );
-  ak_mpzn_mul_montgomery( wp1->y, u4, u1, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( wp1->y, u4, u1, ec->p, ec->n, ec->size );
   ak_mpzn_add_montgomery( wp1->y, wp1->y, u2, ec->p, ec->size );
-  ak_mpzn_mul_montgomery( wp1->z, u6, u3, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( wp1->z, u6, u3, ec->p, ec->n, ec->size );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -577,13 +619,11 @@
    return;
  }
 
- ak_mpzn_set_ui( u, ec->size, 2 );
- ak_mpzn_sub( u, ec->p, u, ec->size );
- ak_mpzn_modpow_montgomery( u, wp->z, u, ec->p, ec->n, ec->size ); // u <- z^{p-2} (mod p)
- ak_mpzn_mul_montgomery( u, u, one, ec->p, ec->n, ec->size );
+ ak_mpzn_modinv_montgomery( u, wp->z, ec->p, ec->n, ec->size ); // u <- z^{-1} (mod p)
+ ak_wcurve_mul( ec )( u, u, one, ec->p, ec->n, ec->size );
 
- ak_mpzn_mul_montgomery( wp->x, wp->x, u, ec->p, ec->n, ec->size );
- ak_mpzn_mul_montgomery( wp->y, wp->y, u, ec->p, ec->n, ec->size );
+ ak_wcurve_mul( ec )( wp->x, wp->x, u, ec->p, ec->n, ec->size );
+ ak_wcurve_mul( ec )( wp->y, wp->y, u, ec->p, ec->n, ec->size );
  ak_mpzn_set_ui( wp->z, ec->size, 1 );
 }
 
@@ -652,6 +692,473 @@
   return ak_mpzn_cmp_ui( ep.z, ec->size, 0 );
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                 вычисление кратных образующей точки с помощью предвычисленных таблиц            */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Ширина окна (в битах), используемая при вычислении кратных образующей точки. */
+ #define ak_wpoint_base_window  (4)
+/*! \brief Количество точек, хранящихся в таблице для одного окна. */
+ #define ak_wpoint_base_points  ( 1 << ( ak_wpoint_base_window - 1 ))
+/*! \brief Максимальное количество одновременно хранимых таблиц. */
+ #define ak_wpoint_base_tables_count  (16)
+
+/*! \brief Таблица кратных образующей точки эллиптической кривой.
+    \details Для окна с номером \f$ i \f$ таблица содержит нечетные кратные
+    \f$ [(2j+1)2^{wi}]P \f$, где \f$ j = 0, \ldots, 2^{w-1}-1 \f$, а \f$ w \f$ - ширина окна.
+    Точки хранятся в аффинной форме, их координаты - в представлении Монтгомери.
+    Таблица вычисляется при первом обращении и далее используется только для чтения.              */
+ typedef struct wpoint_base_table {
+  /*! \brief Эллиптическая кривая, для образующей точки которой вычислена таблица. */
+   ak_wcurve wc;
+  /*! \brief Количество окон. */
+   size_t windows;
+  /*! \brief Единица поля (величина \f$ r \pmod{p} \f$) в представлении Монтгомери. */
+   ak_uint64 one[ak_mpzn512_size];
+  /*! \brief Аффинные координаты точки \f$ [2^{64s}]P \f$, где \f$ s \f$ - размер кривой
+      в 64-х битных словах. */
+   ak_uint64 top[2*ak_mpzn512_size];
+  /*! \brief Координаты точек таблицы: для каждой точки последовательно хранятся x и y. */
+   ak_uint64 *points;
+ } *ak_wpoint_base_table;
+
+/*! \brief Таблицы кратных образующих точек для использованных ранее эллиптических кривых. */
+ static struct wpoint_base_table wpoint_base_tables[ak_wpoint_base_tables_count];
+#ifdef AK_HAVE_PTHREAD_H
+/*! \brief Мьютекс, защищающий создание и удаление таблиц кратных точек. */
+ static pthread_mutex_t wpoint_base_tables_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Прибавление к точке \f$ P \f$ точки \f$ Q = (x_2:y_2:1)\f$, заданной в аффинной форме.
+
+    Функция реализует те же соотношения, что и функция ak_wpoint_add(), однако,
+    поскольку координата \f$ z_2 \f$ равна единице поля, три умножения не выполняются.
+
+    @param wp точка \f$ P \f$, в которую помещается результат операции сложения.
+    @param x x-координата точки \f$ Q \f$ в представлении Монтгомери.
+    @param y y-координата точки \f$ Q \f$ в представлении Монтгомери.
+    @param one единица поля в представлении Монтгомери.
+    @param ec эллиптическая кривая, которой принадлежат складываемые точки.                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_add_affine( ak_wpoint wp, ak_uint64 *x, ak_uint64 *y,
+                                                                   ak_uint64 *one, ak_wcurve ec )
+{
+  ak_mpznmax u1, u2, u3, u4, u5, u6, u7;
+
+  if( ak_mpzn_cmp_ui( wp->z, ec->size, 0 ) == ak_true ) {
+    ak_mpzn_set( wp->x, x, ec->size );
+    ak_mpzn_set( wp->y, y, ec->size );
+    ak_mpzn_set( wp->z, one, ec->size );
+    return;
+  }
+  ak_wcurve_mul( ec )( u2, x, wp->z, ec->p, ec->n, ec->size );
+  if( ak_mpzn_cmp( wp->x, u2, ec->size ) == 0 ) { // случай совпадения х-координат точки
+    ak_wcurve_mul( ec )( u2, y, wp->z, ec->p, ec->n, ec->size );
+    if( ak_mpzn_cmp( wp->y, u2, ec->size ) == 0 ) // случай полного совпадения точек
+      ak_wpoint_double( wp, ec );
+     else ak_wpoint_set_as_unit( wp, ec );
+    return;
+  }
+
+  //add-1998-cmo-2, z2 = 1
+  ak_mpzn_set( u1, wp->x, ec->size );
+  ak_mpzn_sub( u2, ec->p, wp->y, ec->size );
+  ak_mpzn_set( u3, wp->z, ec->size );
+  ak_wcurve_mul( ec )( u4, y, wp->z, ec->p, ec->n, ec->size );
+  ak_mpzn_add_montgomery( u4, u4, u2, ec->p, ec->size );
+  ak_wcurve_mul( ec )( u5, u4, u4, ec->p, ec->n, ec->size );
+  ak_mpzn_sub( u7, ec->p, u1, ec->size );
+  ak_wcurve_mul( ec )( wp->x, x, wp->z, ec->p, ec->n, ec->size );
+  ak_mpzn_add_montgomery( wp->x, wp->x, u7, ec->p, ec->size );
+  ak_wcurve_mul( ec )( u7, wp->x, wp->x, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( u6, u7, wp->x, ec->p, ec->n, ec->size);
+  ak_wcurve_mul( ec )( u1, u7, u1, ec->p, ec->n, ec->size );
+  ak_mpzn_lshift_montgomery( u7, u1, ec->p, ec->size );
+  ak_mpzn_add_montgomery( u7, u7, u6, ec->p, ec->size );
+  ak_mpzn_sub( u7, ec->p, u7, ec->size );
+  ak_wcurve_mul( ec )( u5, u5, u3, ec->p, ec->n, ec->size );
+  ak_mpzn_add_montgomery( u5, u5, u7, ec->p, ec->size );
+  ak_wcurve_mul( ec )( wp->x, wp->x, u5, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( u2, u2, u6, ec->p, ec->n, ec->size );
+  ak_mpzn_sub( u5, ec->p, u5, ec->size );
+  ak_mpzn_add_montgomery( u1, u1, u5, ec->p, ec->size );
+  ak_wcurve_mul( ec )( wp->y, u4, u1, ec->p, ec->n, ec->size );
+  ak_mpzn_add_montgomery( wp->y, wp->y, u2, ec->p, ec->size );
+  ak_wcurve_mul( ec )( wp->z, u6, u3, ec->p, ec->n, ec->size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Приведение нескольких проективных точек к аффинной форме с помощью одного обращения.
+
+    Для вычисления обратных величин к z-координатам точек используется прием Монтгомери:
+    обращается только произведение всех z-координат. Поскольку координаты кратных образующей
+    точки не являются секретными, обращение выполняется бинарным алгоритмом Евклида.
+
+    @param wp массив проективных точек, z-координаты которых отличны от нуля.
+    @param count количество точек, не более \ref ak_wpoint_base_points.
+    @param out массив, в который последовательно помещаются x и y координаты точек
+    (в представлении Монтгомери).
+    @param ec эллиптическая кривая, которой принадлежат точки.                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_base_table_set_affine( ak_wpoint wp, const size_t count,
+                                                                   ak_uint64 *out, ak_wcurve ec )
+{
+  size_t i;
+  ak_mpznmax u, v, c[ak_wpoint_base_points];
+
+ /* c[i] <- z_0 * ... * z_i */
+  ak_mpzn_set( c[0], wp[0].z, ec->size );
+  for( i = 1; i < count; i++ )
+     ak_wcurve_mul( ec )( c[i], c[i-1], wp[i].z, ec->p, ec->n, ec->size );
+
+ /* u <- ( z_0 * ... * z_{count-1} )^{-1} (в представлении Монтгомери) */
+  ak_mpzn_modinv_binary( u, c[count-1], ec->p, ec->size );
+  ak_wcurve_mul( ec )( u, u, ec->r2, ec->p, ec->n, ec->size );
+  ak_wcurve_mul( ec )( u, u, ec->r2, ec->p, ec->n, ec->size );
+
+  for( i = count; i > 0; i-- ) {
+    /* v <- z_{i-1}^{-1} */
+     if( i > 1 ) {
+       ak_wcurve_mul( ec )( v, u, c[i-2], ec->p, ec->n, ec->size );
+       ak_wcurve_mul( ec )( u, u, wp[i-1].z, ec->p, ec->n, ec->size );
+     } else ak_mpzn_set( v, u, ec->size );
+
+     ak_wcurve_mul( ec )( out + 2*(i-1)*ec->size,
+                                                  wp[i-1].x, v, ec->p, ec->n, ec->size );
+     ak_wcurve_mul( ec )( out + ( 2*i-1 )*ec->size,
+                                                  wp[i-1].y, v, ec->p, ec->n, ec->size );
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисление таблицы кратных образующей точки заданной эллиптической кривой.
+
+    @param tb указатель на неиспользуемую таблицу.
+    @param wc эллиптическая кривая.
+    @return В случае успеха функция возвращает \ref ak_error_ok, в противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_wpoint_base_table_create( ak_wpoint_base_table tb, ak_wcurve wc )
+{
+  size_t i, j;
+  struct wpoint base, dbl, pts[ak_wpoint_base_points];
+  ak_mpznmax one = ak_mpznmax_one;
+  const size_t stride = 2*ak_wpoint_base_points*wc->size;
+
+  tb->windows = ( 64*wc->size )/ak_wpoint_base_window;
+  if(( tb->points = malloc( tb->windows*stride*sizeof( ak_uint64 ))) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__,
+                                            "incorrect memory allocation for base point table" );
+  ak_wcurve_mul( wc )( tb->one, one, wc->r2, wc->p, wc->n, wc->size );
+
+ /* для каждого окна вычисляем нечетные кратные точки base = [2^{wi}]P */
+  ak_wpoint_set( &base, wc );
+  for( i = 0; i < tb->windows; i++ ) {
+     ak_wpoint_set_wpoint( pts, &base, wc );
+     ak_wpoint_set_wpoint( &dbl, &base, wc );
+     ak_wpoint_double( &dbl, wc );
+     for( j = 1; j < ak_wpoint_base_points; j++ ) {
+        ak_wpoint_set_wpoint( pts+j, pts+j-1, wc );
+        ak_wpoint_add( pts+j, &dbl, wc );
+     }
+     ak_wpoint_base_table_set_affine( pts, ak_wpoint_base_points, tb->points + i*stride, wc );
+     for( j = 0; j < ak_wpoint_base_window; j++ ) ak_wpoint_double( &base, wc );
+  }
+  ak_wpoint_base_table_set_affine( &base, 1, tb->top, wc );
+  tb->wc = wc;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Поиск (при необходимости, вычисление) таблицы кратных образующей точки.
+
+    Таблицы вычисляются только для эллиптических кривых, параметры которых хранятся
+    в библиотеке и доступны через OID.
+
+    @param wc эллиптическая кривая.
+    @return Функция возвращает указатель на таблицу. Если таблица не может быть
+    вычислена, то возвращается NULL.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_wpoint_base_table ak_wpoint_base_table_get( ak_wcurve wc )
+{
+  size_t i;
+  ak_oid oid = NULL;
+  ak_wpoint_base_table tb = NULL;
+
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &wpoint_base_tables_mutex );
+#endif
+  for( i = 0; i < ak_wpoint_base_tables_count; i++ )
+     if( wpoint_base_tables[i].wc == wc ) {
+       tb = wpoint_base_tables+i;
+       goto exit;
+     }
+
+ /* проверяем, что кривая является одной из кривых библиотеки */
+  oid = ak_oid_find_by_engine( identifier );
+  while( oid != NULL ) {
+    if(( oid->mode == wcurve_params ) && ( oid->data == wc )) break;
+    oid = ak_oid_findnext_by_engine( oid, identifier );
+  }
+  if( oid == NULL ) goto exit;
+
+  for( i = 0; i < ak_wpoint_base_tables_count; i++ )
+     if( wpoint_base_tables[i].wc == NULL ) {
+       if( ak_wpoint_base_table_create( wpoint_base_tables+i, wc ) == ak_error_ok )
+         tb = wpoint_base_tables+i;
+       break;
+     }
+
+  exit:
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &wpoint_base_tables_mutex );
+#endif
+ return tb;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция освобождает память, выделенную под таблицы кратных образующих точек.
+    Функция вызывается при завершении работы с библиотекой.                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_wcurve_destroy_base_tables( void )
+{
+  size_t i;
+
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &wpoint_base_tables_mutex );
+#endif
+  for( i = 0; i < ak_wpoint_base_tables_count; i++ ) {
+     if( wpoint_base_tables[i].points != NULL ) free( wpoint_base_tables[i].points );
+     memset( wpoint_base_tables+i, 0, sizeof( struct wpoint_base_table ));
+  }
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &wpoint_base_tables_mutex );
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Для образующей точки \f$ P \f$ эллиптической кривой и заданного целого числа \f$ k \f$
+    функция вычисляет кратную точку \f$ Q = [k]P \f$.
+
+    При вычислении используется таблица нечетных кратных точки \f$ P \f$, вычисляемая
+    при первом обращении к кривой. Число \f$ k \f$ заменяется нечетным числом
+    \f$ k' \in \{ k, k+q \} \f$ и представляется в виде
+    \f$ k' = 2^{64s} + \sum_{i} d_i 2^{wi} \f$, где все цифры \f$ d_i \f$ нечетны и
+    \f$ |d_i| < 2^w \f$. Поэтому точка вычисляется с помощью фиксированного количества
+    сложений и без удвоений, а выбор точки из таблицы и ее отрицание выполняются
+    без ветвлений, зависящих от значения \f$ k \f$.
+
+    Если таблица не может быть вычислена (например, кривая не является одной из кривых,
+    параметры которых хранятся в библиотеке), то вызывается функция ak_wpoint_pow().
+
+    \b Для \b информации: функция не приводит результирующую точку \f$ Q \f$ к аффинной форме.
+
+    @param wq Точка \f$ Q \f$, в которую помещается результат.
+    @param k Степень кратности.
+    @param size Размер степени \f$ k \f$ в машинных словах; значение не должно
+    превышать размера параметров эллиптической кривой.
+    @param ec Эллиптическая кривая, на которой происходят вычисления                               */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_wpoint_pow_base( ak_wpoint wq, ak_uint64 *k, size_t size, ak_wcurve ec )
+{
+  size_t i, j, l, bit;
+  ak_wpoint_base_table tb = NULL;
+  ak_uint64 digit, neg, mask, *entry;
+  ak_mpznmax kt = ak_mpznmax_zero, x, y, t;
+  const size_t stride = 2*ak_wpoint_base_points*ec->size;
+
+  if(( size > ec->size ) || (( tb = ak_wpoint_base_table_get( ec )) == NULL )) {
+    ak_wpoint_pow( wq, &ec->point, k, size, ec );
+    return;
+  }
+
+ /* k' <- k + q, если k четно; старший бит k' помещается в слово kt[ec->size] */
+  memcpy( kt, k, size*sizeof( ak_uint64 ));
+  mask = ( kt[0]&1 ) - 1;
+  for( l = 0; l < ec->size; l++ ) t[l] = ec->q[l]&mask;
+  kt[ec->size] = ak_mpzn_add( kt, kt, t, ec->size );
+
+ /* старшая цифра представления k' всегда равна единице */
+  ak_mpzn_set( wq->x, tb->top, ec->size );
+  ak_mpzn_set( wq->y, tb->top + ec->size, ec->size );
+  ak_mpzn_set( wq->z, tb->one, ec->size );
+
+  for( i = 0; i < tb->windows; i++ ) {
+    /* вычисляем цифру d_i = v - 2^w, где v - нечетное число из w+1 бит */
+     bit = i*ak_wpoint_base_window;
+     digit = kt[bit >> 6] >> ( bit&0x3f );
+     if(( bit&0x3f ) > 63 - ak_wpoint_base_window )
+       digit |= kt[( bit >> 6 )+1] << ( 64 - ( bit&0x3f ));
+     digit = ( digit&(( 2 << ak_wpoint_base_window ) - 1 )) | 1;
+     neg = ( digit >> ak_wpoint_base_window )^1;
+     digit = (( digit^((( 1 << ak_wpoint_base_window ) - 1 )*neg )) &
+                                                   (( 1 << ak_wpoint_base_window ) - 1 )) >> 1;
+
+    /* выбираем точку [|d_i|2^{wi}]P, просматривая все точки окна */
+     memset( x, 0, ec->size*sizeof( ak_uint64 ));
+     memset( y, 0, ec->size*sizeof( ak_uint64 ));
+     for( j = 0; j < ak_wpoint_base_points; j++ ) {
+        mask = ( ak_uint64 )0 - ((( ak_uint64 )( j^digit ) - 1 ) >> 63 );
+        entry = tb->points + i*stride + 2*j*ec->size;
+        for( l = 0; l < ec->size; l++ ) {
+           x[l] |= entry[l]&mask;
+           y[l] |= entry[l + ec->size]&mask;
+        }
+     }
+    /* для отрицательной цифры заменяем y на p - y */
+     ak_mpzn_sub( t, ec->p, y, ec->size );
+     mask = ( ak_uint64 )0 - neg;
+     for( l = 0; l < ec->size; l++ ) y[l] ^= ( y[l]^t[l] )&mask;
+
+     ak_wpoint_add_affine( wq, x, y, tb->one, ec );
+  }
+
+ /* очищаем значения, зависящие от k */
+  memset( kt, 0, sizeof( ak_mpznmax ));
+  memset( t, 0, sizeof( ak_mpznmax ));
+  memset( x, 0, sizeof( ak_mpznmax ));
+  memset( y, 0, sizeof( ak_mpznmax ));
+  digit = neg = 0;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Максимальная длина представления степени в виде w-NAF. */
+ #define ak_wpoint_naf_size  ( 64*ak_mpzn512_size + 1 )
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Представление числа в виде w-NAF (non-adjacent form) с шириной окна
+    \ref ak_wpoint_base_window + 1.
+
+    Число \f$ k \f$ представляется в виде \f$ k = \sum_i d_i 2^i\f$, где каждая
+    ненулевая цифра \f$ d_i \f$ нечетна, удовлетворяет неравенству \f$ |d_i| < 2^w \f$
+    и за ней следуют по меньшей мере \f$ w \f$ нулевых цифр.
+    Время работы функции зависит от значения \f$ k \f$.
+
+    @param naf массив, в который помещаются цифры, длина массива \ref ak_wpoint_naf_size.
+    @param k представляемое число.
+    @param size размер числа \f$ k \f$ в машинных словах.
+    @return Функция возвращает количество цифр представления.                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static size_t ak_wpoint_naf( signed char *naf, ak_uint64 *k, const size_t size )
+{
+  size_t i, len = 0;
+  ak_uint64 kt[ak_mpzn512_size+1];
+  const int modulo = 2 << ak_wpoint_base_window;
+  int digit;
+
+  memcpy( kt, k, size*sizeof( ak_uint64 ));
+  kt[size] = 0;
+  memset( naf, 0, ak_wpoint_naf_size );
+
+  while( ak_mpzn_cmp_ui( kt, size+1, 0 ) != ak_true ) {
+     if( kt[0]&1 ) {
+       digit = ( int )( kt[0]&( modulo - 1 ));
+       if( digit >= ( modulo >> 1 )) digit -= modulo;
+      /* k <- k - d, младшие w+1 бит числа обнуляются */
+       if( digit > 0 ) kt[0] -= ( ak_uint64 )digit;
+        else {
+          kt[0] += ( ak_uint64 )( -digit );
+          if( kt[0] < ( ak_uint64 )( -digit ))
+            for( i = 1; i <= size; i++ ) if( ++kt[i] != 0 ) break;
+        }
+       naf[len] = ( signed char )digit;
+     }
+     len++;
+     for( i = 0; i < size; i++ ) kt[i] = ( kt[i] >> 1 )^( kt[i+1] << 63 );
+     kt[size] >>= 1;
+  }
+ return len;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Для образующей точки \f$ P \f$ эллиптической кривой, заданной точки \f$ Q \f$ и
+    целых чисел \f$ k_1, k_2 \f$ функция вычисляет точку \f$ R = [k_1]P + [k_2]Q \f$.
+
+    Используется метод Штрауса (Shamir's trick): числа \f$ k_1 \f$ и \f$ k_2 \f$ представляются
+    в виде w-NAF, после чего обе кратные точки вычисляются за один проход с общими удвоениями.
+    Нечетные кратные точки \f$ P \f$ берутся из таблицы, используемой функцией
+    ak_wpoint_pow_base(), нечетные кратные точки \f$ Q \f$ вычисляются заново.
+
+    \warning Время работы функции зависит от значений \f$ k_1 \f$ и \f$ k_2 \f$, поэтому
+    функция может использоваться только для открытых данных, например, при проверке
+    электронной подписи.
+
+    \b Для \b информации: функция не приводит результирующую точку \f$ R \f$ к аффинной форме.
+
+    @param wr Точка \f$ R \f$, в которую помещается результат.
+    @param k1 Степень кратности точки \f$ P \f$.
+    @param wq Точка \f$ Q \f$.
+    @param k2 Степень кратности точки \f$ Q \f$.
+    @param size Размер степеней \f$ k_1 \f$ и \f$ k_2 \f$ в машинных словах; значение
+    не должно превышать размера параметров эллиптической кривой.
+    @param ec Эллиптическая кривая, на которой происходят вычисления                               */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_wpoint_pow_base_sum( ak_wpoint wr, ak_uint64 *k1,
+                                            ak_wpoint wq, ak_uint64 *k2, size_t size, ak_wcurve ec )
+{
+  long long int i;
+  size_t j, len1, len2;
+  ak_mpznmax y;
+  ak_uint64 *entry = NULL;
+  ak_wpoint_base_table tb = NULL;
+  signed char naf1[ak_wpoint_naf_size], naf2[ak_wpoint_naf_size];
+  struct wpoint R, T, pt[ak_wpoint_base_points], qt[ak_wpoint_base_points];
+
+  if( size > ec->size ) {
+    ak_wpoint_pow( &T, wq, k2, size, ec );
+    ak_wpoint_pow( wr, &ec->point, k1, size, ec );
+    ak_wpoint_add( wr, &T, ec );
+    return;
+  }
+  len1 = ak_wpoint_naf( naf1, k1, size );
+  len2 = ak_wpoint_naf( naf2, k2, size );
+
+ /* нечетные кратные точек Q и, при отсутствии таблицы, P */
+  ak_wpoint_set_wpoint( qt, wq, ec );
+  ak_wpoint_set_wpoint( &T, wq, ec );
+  ak_wpoint_double( &T, ec );
+  for( j = 1; j < ak_wpoint_base_points; j++ ) {
+     ak_wpoint_set_wpoint( qt+j, qt+j-1, ec );
+     ak_wpoint_add( qt+j, &T, ec );
+  }
+  if(( tb = ak_wpoint_base_table_get( ec )) == NULL ) {
+    ak_wpoint_set( pt, ec );
+    ak_wpoint_set( &T, ec );
+    ak_wpoint_double( &T, ec );
+    for( j = 1; j < ak_wpoint_base_points; j++ ) {
+       ak_wpoint_set_wpoint( pt+j, pt+j-1, ec );
+       ak_wpoint_add( pt+j, &T, ec );
+    }
+  }
+
+ /* основной цикл с общими удвоениями */
+  ak_wpoint_set_as_unit( &R, ec );
+  for( i = ( long long int )ak_max( len1, len2 ) - 1; i >= 0; i-- ) {
+     ak_wpoint_double( &R, ec );
+     if( naf1[i] ) {
+       j = ( size_t )( naf1[i] > 0 ? naf1[i] : -naf1[i] ) >> 1;
+       if( tb != NULL ) {
+         entry = tb->points + 2*j*ec->size;
+         if( naf1[i] > 0 ) ak_mpzn_set( y, entry + ec->size, ec->size );
+          else ak_mpzn_sub( y, ec->p, entry + ec->size, ec->size );
+         ak_wpoint_add_affine( &R, entry, y, tb->one, ec );
+       } else {
+           ak_wpoint_set_wpoint( &T, pt+j, ec );
+           if( naf1[i] < 0 ) ak_mpzn_sub( T.y, ec->p, T.y, ec->size );
+           ak_wpoint_add( &R, &T, ec );
+         }
+     }
+     if( naf2[i] ) {
+       j = ( size_t )( naf2[i] > 0 ? naf2[i] : -naf2[i] ) >> 1;
+       ak_wpoint_set_wpoint( &T, qt+j, ec );
+       if( naf2[i] < 0 ) ak_mpzn_sub( T.y, ec->p, T.y, ec->size );
+       ak_wpoint_add( &R, &T, ec );
+     }
+  }
+  ak_wpoint_set_wpoint( wr, &R, ec );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                                                                                    ak_curves.c  */
 /* ----------------------------------------------------------------------------------------------- */
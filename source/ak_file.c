@@ -292,6 +292,7 @@
   }
   file->blksize = ( ak_int64 )st.st_blksize;
  #endif
+  file->map_size = 0;
 
  return ak_error_ok;
 }
@@ -308,6 +309,7 @@
     return ak_error_message( ak_error_null_pointer, __func__, "using null pointer" );
 
   file->size = 0;
+  file->map_size = 0;
  #ifdef AK_HAVE_WINDOWS_H
   if(( file->hFile = CreateFile( filename,   /* name of the write */
                      GENERIC_WRITE,          /* open for writing */
@@ -340,6 +342,7 @@
 {
    file->size = 0;
    file->blksize = 0;
+   file->map_size = 0;
   #ifdef AK_HAVE_WINDOWS_H
    CloseHandle( file->hFile);
   #else
@@ -382,6 +385,69 @@
  #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция не изменяет текущую позицию в файле, поэтому может одновременно вызываться
+    несколькими потоками для одного и того же файла.
+
+    @param file Контекст файла.
+    @param buffer Буффер, в который помещаются считанные данные.
+    @param size Количество считываемых байт.
+    @param offset Смещение (в октетах) от начала файла.
+    @return Количество считанных байт или -1 в случае ошибки.                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ ssize_t ak_file_pread( ak_file file, ak_pointer buffer, size_t size, const ak_int64 offset )
+{
+ #ifdef AK_HAVE_WINDOWS_H
+  OVERLAPPED ov;
+  DWORD dwBytesReaden = 0;
+
+  memset( &ov, 0, sizeof( OVERLAPPED ));
+  ov.Offset = ( DWORD )( offset&0xFFFFFFFF );
+  ov.OffsetHigh = ( DWORD )( offset >> 32 );
+  if( ReadFile( file->hFile, buffer, ( DWORD )size, &dwBytesReaden, &ov ) == FALSE ) {
+    if( GetLastError() == ERROR_HANDLE_EOF ) return 0;
+    ak_error_message( ak_error_read_data, __func__, "unable to read from file");
+    return -1;
+  } else return ( ssize_t ) dwBytesReaden;
+ #else
+   ssize_t rb = pread( file->fd, buffer, size, ( off_t ) offset );
+   if( rb == -1 ) ak_error_message_fmt( ak_error_read_data, __func__,
+                                               "unable to read from file (%s)", strerror( errno ));
+  return rb;
+ #endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция не изменяет текущую позицию в файле, поэтому может одновременно вызываться
+    несколькими потоками для одного и того же файла.
+
+    @param file Контекст файла.
+    @param buffer Буффер с записываемыми данными.
+    @param size Количество записываемых байт.
+    @param offset Смещение (в октетах) от начала файла.
+    @return Количество записанных байт или -1 в случае ошибки.                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ ssize_t ak_file_pwrite( ak_file file, ak_const_pointer buffer, size_t size, const ak_int64 offset )
+{
+ #ifdef AK_HAVE_WINDOWS_H
+  OVERLAPPED ov;
+  DWORD dwBytesWritten = 0;
+
+  memset( &ov, 0, sizeof( OVERLAPPED ));
+  ov.Offset = ( DWORD )( offset&0xFFFFFFFF );
+  ov.OffsetHigh = ( DWORD )( offset >> 32 );
+  if( WriteFile( file->hFile, buffer, ( DWORD )size, &dwBytesWritten, &ov ) == FALSE ) {
+    ak_error_message( ak_error_write_data, __func__, "unable to write to file");
+    return -1;
+  } else return ( ssize_t ) dwBytesWritten;
+ #else
+   ssize_t wb = pwrite( file->fd, buffer, size, ( off_t ) offset );
+   if( wb == -1 ) ak_error_message_fmt( ak_error_write_data, __func__,
+                                                "unable to write to file (%s)", strerror( errno ));
+  return wb;
+ #endif
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  ssize_t ak_file_printf( ak_file outfile, const char *format, ... )
 {
@@ -413,19 +479,133 @@
 
 /* ----------------------------------------------------------------------------------------------- */
                    /* Отображение файлов в память (обертка вокруг mmap) */
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция отображает в память содержимое файла, начиная с заданного смещения и до конца файла.
+    Для файлов, отображаемых только для чтения, операционной системе сообщается, что
+    доступ к данным будет последовательным (madvise( MADV_SEQUENTIAL )). Это позволяет
+    выполнять опережающее чтение данных с диска одновременно с их обработкой.
+
+    \note Если файл будет усечен другим процессом во время обработки отображенных данных,
+    то обращение к отсутствующим страницам памяти приведет к аварийному завершению программы.
+
+    @param file Контекст файла.
+    @param filename Имя отображаемого файла. Если имя равно NULL, то отображается файл,
+    ранее открытый с помощью функции ak_file_open_to_read() (в этом случае параметр state
+    должен принимать значение \ref readonly).
+    @param state Режим доступа к отображенной области памяти.
+    @param offset Смещение (в октетах) от начала файла; смещение должно быть кратно размеру
+    страницы памяти.
+    @return В случае успеха возвращается указатель на область памяти, содержащую данные файла.
+    Область памяти должна быть освобождена вызовом функции ak_file_unmap(), которая также
+    закрывает файл. В случае ошибки возвращается NULL, а код ошибки может быть получен
+    с помощью вызова функции ak_error_get_value().                                                 */
 /* ----------------------------------------------------------------------------------------------- */
  ak_pointer ak_file_mmap( ak_file file, const char *filename,
                                                      const filestate_t state, const size_t offset )
 {
- /* в ситуациях, когда mmap не определена, сразу выходим */
-#ifndef AK_HAVE_WINDOWS_H
- #ifndef AK_HAVE_SYSMMAN_H
-   return ak_error_undefined_function;
+#if defined( AK_HAVE_SYSMMAN_H ) && !defined( AK_HAVE_WINDOWS_H )
+  struct stat st;
+  size_t length = 0;
+  ak_pointer data = NULL;
+  long pagesize = sysconf( _SC_PAGESIZE );
+  int prot = ( state == readonly ) ? PROT_READ : PROT_READ|PROT_WRITE;
+
+  if( file == NULL ) {
+    ak_error_message( ak_error_null_pointer, __func__ , "using null pointer to file context" );
+    return NULL;
+  }
+  if(( pagesize <= 0 ) || ( offset%( size_t )pagesize )) {
+    ak_error_message( ak_error_wrong_length, __func__ ,
+                                           "using offset which is not a multiple of page size" );
+    return NULL;
+  }
+  if( filename == NULL ) {
+    if( state != readonly ) {
+      ak_error_message( ak_error_access_file, __func__ ,
+                                        "using writeable mapping for file opened to read only" );
+      return NULL;
+    }
+  } else {
+     if( state == readonly ) {
+       if( ak_file_open_to_read( file, filename ) != ak_error_ok ) {
+         ak_error_message_fmt( ak_error_open_file, __func__ ,
+                                                        "wrong opening a file %s", filename );
+         return NULL;
+       }
+     } else {
+        if(( file->fd = open( filename, O_RDWR )) < 0 ) {
+          ak_error_message_fmt( ak_error_open_file, __func__ ,
+                                     "wrong opening a file %s [%s]", filename, strerror( errno ));
+          return NULL;
+        }
+        if( fstat( file->fd, &st )) {
+          close( file->fd );
+          ak_error_message_fmt( ak_error_access_file, __func__ ,
+                                     "wrong stat file %s [%s]", filename, strerror( errno ));
+          return NULL;
+        }
+        file->size = ( ak_int64 )st.st_size;
+        file->blksize = ( ak_int64 )st.st_blksize;
+        file->map_size = 0;
+       }
+    }
+
+ /* проверяем, что отображаемая часть файла не пуста и помещается в адресное пространство */
+  if(( file->size <= ( ak_int64 )offset ) ||
+     (( ak_int64 )( length = ( size_t )( file->size - ( ak_int64 )offset )) !=
+                                                                ( file->size - ( ak_int64 )offset ))) {
+    ak_error_message( ak_error_wrong_length, __func__ , "using file with unsupported length" );
+    goto lab_exit;
+  }
+  if(( data = mmap( NULL, length, prot, MAP_SHARED, file->fd, ( off_t )offset )) == MAP_FAILED ) {
+    ak_error_message_fmt( ak_error_mmap_file, __func__ ,
+                                               "wrong mapping a file [%s]", strerror( errno ));
+    data = NULL;
+    goto lab_exit;
+  }
+ #ifdef MADV_SEQUENTIAL
+  if( state == readonly ) madvise( data, length, MADV_SEQUENTIAL );
  #endif
-#endif
+  file->map_size = length;
+ return data;
 
- ak_error_message( ak_error_undefined_function, __func__, "this function is'nt well developed" );
+  lab_exit:
+   if( filename != NULL ) ak_file_close( file );
  return NULL;
+
+#else
+  ( void )file; ( void )filename; ( void )state; ( void )offset;
+  ak_error_message( ak_error_undefined_function, __func__,
+                                     "memory mapping of files is not supported on this platform" );
+ return NULL;
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param file Контекст файла, отображенного в память функцией ak_file_mmap().
+    @param data Указатель на область памяти, возвращенный функцией ak_file_mmap().
+    @return В случае успеха возвращается \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_file_unmap( ak_file file, ak_pointer data )
+{
+#if defined( AK_HAVE_SYSMMAN_H ) && !defined( AK_HAVE_WINDOWS_H )
+  int error = ak_error_ok;
+
+  if(( file == NULL ) || ( data == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__, "using null pointer" );
+  if( munmap( data, file->map_size ) != 0 )
+    error = ak_error_message_fmt( ak_error_mmap_file, __func__ ,
+                                             "wrong unmapping a file [%s]", strerror( errno ));
+  file->map_size = 0;
+  if( ak_file_close( file ) != ak_error_ok ) error = ak_error_close_file;
+
+ return error;
+#else
+  ( void )file; ( void )data;
+ return ak_error_message( ak_error_undefined_function, __func__,
+                                     "memory mapping of files is not supported on this platform" );
+#endif
 }
 
 /* ----------------------------------------------------------------------------------------------- */
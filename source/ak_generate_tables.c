@@ -0,0 +1,248 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Copyright (c) 2014 - 2020 by Axel Kenzo, axelkenzo@mail.ru                                     */
+/*                                                                                                 */
+/*  Файл ak_generate_tables.c                                                                      */
+/*  - содержит программу, вырабатывающую на этапе сборки библиотеки развернутые таблицы            */
+/*    алгоритма блочного шифрования Кузнечик (ГОСТ Р 34.12-2015).                                  */
+/*    Результатом работы программы является исходный текст на языке С, который компилируется       */
+/*    вместе с библиотекой и размещает таблицы в секции константных данных.                        */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <stdio.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Нелинейное биективное преобразование байт, используемое в алгоритме
+    Кузнечик (ГОСТ Р 34.12-2015). */
+/* ----------------------------------------------------------------------------------------------- */
+ static const sbox gost_pi = {
+   0xFC, 0xEE, 0xDD, 0x11, 0xCF, 0x6E, 0x31, 0x16, 0xFB, 0xC4, 0xFA, 0xDA, 0x23, 0xC5, 0x04, 0x4D,
+   0xE9, 0x77, 0xF0, 0xDB, 0x93, 0x2E, 0x99, 0xBA, 0x17, 0x36, 0xF1, 0xBB, 0x14, 0xCD, 0x5F, 0xC1,
+   0xF9, 0x18, 0x65, 0x5A, 0xE2, 0x5C, 0xEF, 0x21, 0x81, 0x1C, 0x3C, 0x42, 0x8B, 0x01, 0x8E, 0x4F,
+   0x05, 0x84, 0x02, 0xAE, 0xE3, 0x6A, 0x8F, 0xA0, 0x06, 0x0B, 0xED, 0x98, 0x7F, 0xD4, 0xD3, 0x1F,
+   0xEB, 0x34, 0x2C, 0x51, 0xEA, 0xC8, 0x48, 0xAB, 0xF2, 0x2A, 0x68, 0xA2, 0xFD, 0x3A, 0xCE, 0xCC,
+   0xB5, 0x70, 0x0E, 0x56, 0x08, 0x0C, 0x76, 0x12, 0xBF, 0x72, 0x13, 0x47, 0x9C, 0xB7, 0x5D, 0x87,
+   0x15, 0xA1, 0x96, 0x29, 0x10, 0x7B, 0x9A, 0xC7, 0xF3, 0x91, 0x78, 0x6F, 0x9D, 0x9E, 0xB2, 0xB1,
+   0x32, 0x75, 0x19, 0x3D, 0xFF, 0x35, 0x8A, 0x7E, 0x6D, 0x54, 0xC6, 0x80, 0xC3, 0xBD, 0x0D, 0x57,
+   0xDF, 0xF5, 0x24, 0xA9, 0x3E, 0xA8, 0x43, 0xC9, 0xD7, 0x79, 0xD6, 0xF6, 0x7C, 0x22, 0xB9, 0x03,
+   0xE0, 0x0F, 0xEC, 0xDE, 0x7A, 0x94, 0xB0, 0xBC, 0xDC, 0xE8, 0x28, 0x50, 0x4E, 0x33, 0x0A, 0x4A,
+   0xA7, 0x97, 0x60, 0x73, 0x1E, 0x00, 0x62, 0x44, 0x1A, 0xB8, 0x38, 0x82, 0x64, 0x9F, 0x26, 0x41,
+   0xAD, 0x45, 0x46, 0x92, 0x27, 0x5E, 0x55, 0x2F, 0x8C, 0xA3, 0xA5, 0x7D, 0x69, 0xD5, 0x95, 0x3B,
+   0x07, 0x58, 0xB3, 0x40, 0x86, 0xAC, 0x1D, 0xF7, 0x30, 0x37, 0x6B, 0xE4, 0x88, 0xD9, 0xE7, 0x89,
+   0xE1, 0x1B, 0x83, 0x49, 0x4C, 0x3F, 0xF8, 0xFE, 0x8D, 0x53, 0xAA, 0x90, 0xCA, 0xD8, 0x85, 0x61,
+   0x20, 0x71, 0x67, 0xA4, 0x2D, 0x2B, 0x09, 0x5B, 0xCB, 0x9B, 0x25, 0xD0, 0xBE, 0xE5, 0x6C, 0x52,
+   0x59, 0xA6, 0x74, 0xD2, 0xE6, 0xF4, 0xB4, 0xC0, 0xD1, 0x66, 0xAF, 0xC2, 0x39, 0x4B, 0x63, 0xB6
+ };
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Значения коэффициентов линейного регистра сдвига, используемого в алгоритме
+    Кузнечик (ГОСТ Р 34.12-2015). */
+/* ----------------------------------------------------------------------------------------------- */
+ static const linear_register gost_lvec = {
+  0x01, 0x94, 0x20, 0x85, 0x10, 0xC2, 0xC0, 0x01, 0xFB, 0x01, 0xC0, 0xC2, 0x10, 0x85, 0x20, 0x94 };
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисляемые таблицы (по одному набору на каждое значение опции `openssl_compability`). */
+ static struct kuznechik_params parameters[2];
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция умножает два элемента конечного поля \f$\mathbb F_{2^8}\f$, определенного
+     согласно ГОСТ Р 34.12-2015.                                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint8 mul_gf256( ak_uint8 x, ak_uint8 y )
+{
+  ak_uint8 z = 0;
+  while( y ) {
+    if( y&0x1 ) z ^= x;
+    x = ((ak_uint8)(x << 1)) ^ ( x & 0x80 ? 0xC3 : 0x00 );
+    y >>= 1;
+  }
+ return z;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция возводит квадратную матрицу в квадрат. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void square_matrix( linear_matrix a )
+{
+  int i, j, k;
+  linear_matrix c;
+
+  for( i = 0; i < 16; i++ )
+   for( j = 0; j < 16; j++ ) {
+      c[i][j] = 0;
+      for( k = 0; k < 16; k++ ) c[i][j] ^= mul_gf256( a[i][k], a[k][j] );
+   }
+  memcpy( a, c, sizeof( linear_matrix ));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет таблицы алгоритма Кузнечик.
+    \details Вычисления в точности повторяют функцию ak_bckey_kuznechik_init_tables(),
+    совпадение результатов проверяется при выполнении тестирования библиотеки.
+
+    \param oc Значение опции `openssl_compability`.
+    \param par Структура, в которую помещаются вычисленные значения.                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static void generate_tables( const int oc, ak_kuznechik_params par )
+{
+  int i, j, l;
+
+  memcpy( par->reg, gost_lvec, sizeof( linear_register ));
+  memcpy( par->pi, gost_pi, sizeof( sbox ));
+
+ /* сопровождающая матрица и ее 16-я степень */
+  memset( par->L, 0, sizeof( linear_matrix ));
+  for( i = 1; i < 16; i++ ) par->L[i-1][i] = 0x1;
+  for( i = 0; i < 16; i++ ) par->L[15][i] = gost_lvec[i];
+  for( i = 0; i < 4; i++ ) square_matrix( par->L );
+
+ /* обратная матрица и обратная перестановка */
+  for( i = 0; i < 16; i++ )
+     for( j = 0; j < 16; j++ ) par->Linv[15-i][15-j] = par->L[i][j];
+  for( i = 0; i < 256; i++ ) par->pinv[gost_pi[i]] = ( ak_uint8 )i;
+
+ /* развернутые таблицы */
+  for( i = 0; i < 16; i++ ) {
+     for( j = 0; j < 256; j++ ) {
+       ak_uint8 b[16], ib[16];
+       for( l = 0; l < 16; l++ ) {
+          b[15*oc + (1-2*oc)*l] = mul_gf256( par->L[l][i], par->pi[j] );
+          ib[15*oc + (1-2*oc)*l] = mul_gf256( par->Linv[l][i], par->pinv[j] );
+       }
+       memcpy( par->enc[i][j], b, 16 );
+       memcpy( par->dec[i][j], ib, 16 );
+     }
+  }
+
+ /* таблицы для векторной реализации */
+  for( l = 0; l < 16; l++ ) {
+     for( i = 0; i < 16; i++ ) {
+        for( j = 0; j < 16; j++ ) {
+           par->venc[l][i][j] = mul_gf256( par->L[l][i], (ak_uint8) j );
+           par->venc[l][i][16+j] = mul_gf256( par->L[l][i], (ak_uint8)( j << 4 ));
+           par->vdec[l][i][j] = mul_gf256( par->Linv[l][i], (ak_uint8) j );
+           par->vdec[l][i][16+j] = mul_gf256( par->Linv[l][i], (ak_uint8)( j << 4 ));
+        }
+     }
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вывод массива байт в виде списка инициализации. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void print_bytes( FILE *fp, const ak_uint8 *ptr, const size_t size )
+{
+  size_t i;
+
+  fprintf( fp, "{" );
+  for( i = 0; i < size; i++ ) {
+     if(( size > 16 ) && ( i%16 == 0 )) fprintf( fp, "\n   " );
+     fprintf( fp, " 0x%02X%s", ptr[i], ( i+1 < size ) ? "," : "" );
+  }
+  fprintf( fp, " }" );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вывод матрицы линейного преобразования в виде списка инициализации. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void print_matrix( FILE *fp, linear_matrix m )
+{
+  int i;
+
+  fprintf( fp, "{" );
+  for( i = 0; i < 16; i++ ) {
+     fprintf( fp, "\n   " );
+     print_bytes( fp, m[i], 16 );
+     if( i < 15 ) fprintf( fp, "," );
+  }
+  fprintf( fp, " }" );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вывод таблиц векторной реализации в виде списка инициализации. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void print_shuffle_table( FILE *fp, shuffle_table tab )
+{
+  int l, i;
+
+  fprintf( fp, "{" );
+  for( l = 0; l < 16; l++ ) {
+     fprintf( fp, "\n   {" );
+     for( i = 0; i < 16; i++ ) {
+        fprintf( fp, "\n    " );
+        print_bytes( fp, tab[l][i], 32 );
+        if( i < 15 ) fprintf( fp, "," );
+     }
+     fprintf( fp, " }%s", ( l < 15 ) ? "," : "" );
+  }
+  fprintf( fp, " }" );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вывод развернутой таблицы в виде списка инициализации. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void print_expanded_table( FILE *fp, expanded_table tab )
+{
+  int i, j;
+
+  fprintf( fp, "{" );
+  for( i = 0; i < 16; i++ ) {
+     fprintf( fp, "\n   {" );
+     for( j = 0; j < 256; j++ ) {
+        if( j%2 == 0 ) fprintf( fp, "\n    " );
+        fprintf( fp, " { 0x%016llxULL, 0x%016llxULL }%s",
+          (unsigned long long) tab[i][j][0], (unsigned long long) tab[i][j][1],
+                                                                         ( j < 255 ) ? "," : "" );
+     }
+     fprintf( fp, " }%s", ( i < 15 ) ? "," : "" );
+  }
+  fprintf( fp, " }" );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( int argc, char *argv[] )
+{
+  int oc;
+  FILE *fp = NULL;
+
+  if( argc != 2 ) {
+    fprintf( stderr, "usage: %s output-file\n", argv[0] );
+    return 1;
+  }
+  if(( fp = fopen( argv[1], "w" )) == NULL ) {
+    fprintf( stderr, "%s: unable to create %s\n", argv[0], argv[1] );
+    return 1;
+  }
+
+  fprintf( fp, "/* This file is generated by ak-generate-tables, do not edit */\n" );
+  fprintf( fp, " #include <libakrypt-internal.h>\n\n" );
+  fprintf( fp, " const struct kuznechik_params kuznechik_gost_parameters[2] = {\n" );
+  for( oc = 0; oc < 2; oc++ ) {
+     ak_kuznechik_params par = &parameters[oc];
+
+     generate_tables( oc, par );
+     fprintf( fp, " { /* openssl_compability = %d */\n", oc );
+     fprintf( fp, "  .reg = " ); print_bytes( fp, par->reg, sizeof( linear_register ));
+     fprintf( fp, ",\n  .L = " ); print_matrix( fp, par->L );
+     fprintf( fp, ",\n  .pi = " ); print_bytes( fp, par->pi, sizeof( sbox ));
+     fprintf( fp, ",\n  .enc = " ); print_expanded_table( fp, par->enc );
+     fprintf( fp, ",\n  .venc = " ); print_shuffle_table( fp, par->venc );
+     fprintf( fp, ",\n  .Linv = " ); print_matrix( fp, par->Linv );
+     fprintf( fp, ",\n  .pinv = " ); print_bytes( fp, par->pinv, sizeof( sbox ));
+     fprintf( fp, ",\n  .dec = " ); print_expanded_table( fp, par->dec );
+     fprintf( fp, ",\n  .vdec = " ); print_shuffle_table( fp, par->vdec );
+     fprintf( fp, "\n }%s\n", oc ? "" : "," );
+  }
+  fprintf( fp, " };\n" );
+
+  if( fclose( fp ) != 0 ) {
+    fprintf( stderr, "%s: unable to write %s\n", argv[0], argv[1] );
+    return 1;
+  }
+ return 0;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                           ak_generate_tables.c  */
+/* ----------------------------------------------------------------------------------------------- */
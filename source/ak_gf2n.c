@@ -10,6 +10,13 @@
 /* ----------------------------------------------------------------------------------------------- */
 #ifdef AK_HAVE_BUILTIN_CLMULEPI64
  #include <wmmintrin.h>
+ #ifdef _MSC_VER
+  #define ak_target_pclmul
+ #else
+ /* функции, использующие инструкцию pclmulqdq, компилируются без глобального флага -mpclmul
+    и вызываются только после проверки возможностей процессора */
+  #define ak_target_pclmul __attribute__((target("pclmul")))
+ #endif
 #endif
 #ifdef _MSC_VER
  #include <stdlib.h>
@@ -279,6 +286,51 @@
 #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет сумму попарных произведений элементов поля \f$ \mathbb F_{2^{64}}\f$
+    и прибавляет ее к значению sum, т.е. вычисляет
+    \f$ sum = sum \oplus \sum_{i=0}^{count-1} x_i \cdot y_i\f$.
+    Используется переносимая реализация умножения.
+
+    @param sum Указатель на накапливаемую сумму
+    @param x Указатель на массив из count элементов поля
+    @param y Указатель на массив из count элементов поля (может быть невыровненным)
+    @param count Количество слагаемых                                                              */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_gf64_mul_sum_uint64( ak_pointer sum, ak_pointer x, ak_pointer y, const size_t count )
+{
+  size_t i = 0;
+  ak_uint64 h, v;
+
+  for( i = 0; i < count; i++ ) {
+     memcpy( &v, (ak_uint8 *)y + 8*i, 8 );
+     ak_gf64_mul_uint64( &h, (ak_uint64 *)x + i, &v );
+     ((ak_uint64 *)sum)[0] ^= h;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет сумму попарных произведений элементов поля \f$ \mathbb F_{2^{128}}\f$
+    и прибавляет ее к значению sum. Используется переносимая реализация умножения.
+
+    @param sum Указатель на накапливаемую сумму
+    @param x Указатель на массив из count элементов поля
+    @param y Указатель на массив из count элементов поля (может быть невыровненным)
+    @param count Количество слагаемых                                                              */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_gf128_mul_sum_uint64( ak_pointer sum, ak_pointer x, ak_pointer y, const size_t count )
+{
+  size_t i = 0;
+  ak_uint64 h[2], v[2];
+
+  for( i = 0; i < count; i++ ) {
+     memcpy( v, (ak_uint8 *)y + 16*i, 16 );
+     ak_gf128_mul_uint64( h, (ak_uint64 *)x + 2*i, v );
+     ((ak_uint64 *)sum)[0] ^= h[0];
+     ((ak_uint64 *)sum)[1] ^= h[1];
+  }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 #ifdef AK_HAVE_BUILTIN_CLMULEPI64
 
@@ -288,7 +340,7 @@
     \f$ f(x) = x^{64} + x^4 + x^3 + x + 1 \in \mathbb F_2[x]\f$. Для умножения используется
     реализация с помощью команды PCLMULQDQ.                                                        */
 /* ----------------------------------------------------------------------------------------------- */
- void ak_gf64_mul_pcmulqdq( ak_pointer z, ak_pointer x, ak_pointer y )
+ ak_target_pclmul void ak_gf64_mul_pcmulqdq( ak_pointer z, ak_pointer x, ak_pointer y )
 {
 #ifdef _MSC_VER
 	 __m128i gm, xm, ym, cm, cx;
@@ -328,7 +380,7 @@
     \f$ f(x) = x^{128} + x^7 + x^2 + x + 1 \in \mathbb F_2[x]\f$. Для умножения используется
     реализация с помощью команды PCLMULQDQ.                                                        */
 /* ----------------------------------------------------------------------------------------------- */
- void ak_gf128_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
+ ak_target_pclmul void ak_gf128_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
 {
 #ifdef _MSC_VER
 	 __m128i am, bm, cm, dm, em, fm;
@@ -380,7 +432,7 @@
     \f$ f(x) = x^{256} + x^10 + x^5 + x^2 + 1 \in \mathbb F_2[x]\f$. Для умножения используется
     реализация с помощью команды PCLMULQDQ.                                                        */
 /* ----------------------------------------------------------------------------------------------- */
- void ak_gf256_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
+ ak_target_pclmul void ak_gf256_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
 {
 #ifdef _MSC_VER
      __m128i a1a0, a3a2, b1b0, b3b2;
@@ -497,7 +549,7 @@
     реализация с помощью команды PCLMULQDQ.
     \todo может быть имеет смысл разбить на 2 ifdef, а середину сделать общей?                     */
 /* ----------------------------------------------------------------------------------------------- */
-void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
+ ak_target_pclmul void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
 {
 #ifdef _MSC_VER
      __m128i a1a0, a3a2, a5a4, a7a6, b1b0, b3b2, b5b4, b7b6;
@@ -785,6 +837,93 @@ void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
 #endif
 }
 
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет сумму попарных произведений элементов поля \f$ \mathbb F_{2^{64}}\f$
+    и прибавляет ее к значению sum.
+
+    Поскольку приведение по модулю многочлена \f$ f(x) \f$ является линейной операцией,
+    произведения, вычисленные командой PCLMULQDQ, складываются без приведения,
+    а приведение по модулю выполняется один раз для всей суммы.
+
+    @param sum Указатель на накапливаемую сумму
+    @param x Указатель на массив из count элементов поля
+    @param y Указатель на массив из count элементов поля (может быть невыровненным)
+    @param count Количество слагаемых                                                              */
+/* ----------------------------------------------------------------------------------------------- */
+ ak_target_pclmul void ak_gf64_mul_sum_pcmulqdq( ak_pointer sum,
+                                                  ak_pointer x, ak_pointer y, const size_t count )
+{
+  size_t i = 0;
+  ak_uint64 c[2], t[2];
+  const __m128i gm = _mm_set_epi64x( 0, 0x1B );
+  __m128i cm = _mm_setzero_si128(), dm = _mm_setzero_si128(), xm, ym;
+  const ak_uint8 *yp = (const ak_uint8 *)y;
+
+ /* накапливаем произведения без приведения (две независимые цепочки сложений) */
+  for( ; i + 1 < count; i += 2 ) {
+     xm = _mm_loadu_si128( (__m128i *)((ak_uint64 *)x + i ));
+     ym = _mm_loadu_si128( (__m128i *)( yp + 8*i ));
+     cm = _mm_xor_si128( cm, _mm_clmulepi64_si128( xm, ym, 0x00 ));
+     dm = _mm_xor_si128( dm, _mm_clmulepi64_si128( xm, ym, 0x11 ));
+  }
+  if( i < count ) {
+    xm = _mm_loadl_epi64( (__m128i *)((ak_uint64 *)x + i ));
+    ym = _mm_loadl_epi64( (__m128i *)( yp + 8*i ));
+    cm = _mm_xor_si128( cm, _mm_clmulepi64_si128( xm, ym, 0x00 ));
+  }
+  _mm_storeu_si128( (__m128i *)c, _mm_xor_si128( cm, dm ));
+
+ /* однократное приведение (аналогично функции ak_gf64_mul_pcmulqdq) */
+  _mm_storeu_si128( (__m128i *)t, _mm_clmulepi64_si128( _mm_set_epi64x( 0, c[1] ), gm, 0x00 ));
+  _mm_storeu_si128( (__m128i *)t,
+                          _mm_clmulepi64_si128( _mm_set_epi64x( 0, t[1]^c[1] ), gm, 0x00 ));
+  ((ak_uint64 *)sum)[0] ^= c[0]^t[0];
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет сумму попарных произведений элементов поля \f$ \mathbb F_{2^{128}}\f$
+    и прибавляет ее к значению sum.
+
+    Каждое произведение вычисляется четырьмя командами PCLMULQDQ и складывается с суммой
+    в неприведенном 256-ти битном виде; приведение по модулю многочлена
+    \f$ f(x) = x^{128} + x^7 + x^2 + x + 1\f$ выполняется один раз для всей суммы.
+    Тем самым, при обработке группы из \f$ n \f$ блоков выполняется одно приведение вместо \f$ n \f$.
+
+    @param sum Указатель на накапливаемую сумму
+    @param x Указатель на массив из count элементов поля
+    @param y Указатель на массив из count элементов поля (может быть невыровненным)
+    @param count Количество слагаемых                                                              */
+/* ----------------------------------------------------------------------------------------------- */
+ ak_target_pclmul void ak_gf128_mul_sum_pcmulqdq( ak_pointer sum,
+                                                  ak_pointer x, ak_pointer y, const size_t count )
+{
+  size_t i = 0;
+  ak_uint64 w[6], x3, D;
+  __m128i am, bm, lo = _mm_setzero_si128(), hi = _mm_setzero_si128(), mid = _mm_setzero_si128();
+  const ak_uint8 *yp = (const ak_uint8 *)y;
+
+ /* накапливаем неприведенные произведения */
+  for( i = 0; i < count; i++ ) {
+     am = _mm_loadu_si128( (__m128i *)((ak_uint64 *)x + 2*i ));
+     bm = _mm_loadu_si128( (__m128i *)( yp + 16*i ));
+     lo = _mm_xor_si128( lo, _mm_clmulepi64_si128( am, bm, 0x00 ));
+     hi = _mm_xor_si128( hi, _mm_clmulepi64_si128( am, bm, 0x11 ));
+     mid = _mm_xor_si128( mid, _mm_clmulepi64_si128( am, bm, 0x10 ));
+     mid = _mm_xor_si128( mid, _mm_clmulepi64_si128( am, bm, 0x01 ));
+  }
+  _mm_storeu_si128( (__m128i *)w, lo );
+  _mm_storeu_si128( (__m128i *)( w+2 ), hi );
+  _mm_storeu_si128( (__m128i *)( w+4 ), mid );
+
+ /* однократное приведение (аналогично функции ak_gf128_mul_pcmulqdq) */
+  x3 = w[3];
+  D = w[2] ^ w[5] ^ (x3 >> 63) ^ (x3 >> 62) ^ (x3 >> 57);
+  ((ak_uint64 *)sum)[0] ^= w[0] ^ D ^ (D << 1) ^ (D << 2) ^ (D << 7);
+  ((ak_uint64 *)sum)[1] ^= w[1] ^ w[4] ^ x3 ^ (x3 << 1) ^ (D >> 63) ^ (x3 << 2) ^ (D >> 62)
+                                                                         ^ (x3 << 7) ^ (D >> 57);
+}
+
 #endif
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -841,6 +980,7 @@ void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
   }
 
 #ifdef AK_HAVE_BUILTIN_CLMULEPI64
+ if( !( ak_libakrypt_dispatch.features&ak_cpu_feature_pclmul )) return ak_true;
  if( ak_log_get_level() >= ak_log_maximum )
    ak_error_message( ak_error_ok, __func__, "comparison between two implementations included");
 
@@ -930,6 +1070,7 @@ void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
  if( !ak_ptr_is_equal_with_log( result, m8, 16 )) goto lexit;
 
 #ifdef AK_HAVE_BUILTIN_CLMULEPI64
+ if( !( ak_libakrypt_dispatch.features&ak_cpu_feature_pclmul )) return ak_true;
  if( ak_log_get_level() >= ak_log_maximum )
    ak_error_message( ak_error_ok, __func__, "comparison between two implementations included");
 
@@ -1004,6 +1145,7 @@ void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
   }
 
 #ifdef AK_HAVE_BUILTIN_CLMULEPI64
+ if( !( ak_libakrypt_dispatch.features&ak_cpu_feature_pclmul )) return ak_true;
  if( ak_log_get_level() >= ak_log_maximum )
    ak_error_message( ak_error_ok, __func__, "comparison between two implementations included");
 
@@ -1088,6 +1230,7 @@ void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
   }
 
 #ifdef AK_HAVE_BUILTIN_CLMULEPI64
+ if( !( ak_libakrypt_dispatch.features&ak_cpu_feature_pclmul )) return ak_true;
  if( ak_log_get_level() >= ak_log_maximum )
    ak_error_message( ak_error_ok, __func__, "comparison between two implementations included");
 
@@ -1144,11 +1287,9 @@ void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b )
  if( audit >= ak_log_maximum )
    ak_error_message( ak_error_ok, __func__ , "testing the Galois fileds arithmetic started");
 
-#ifdef AK_HAVE_BUILTIN_CLMULEPI64
  if( audit >= ak_log_maximum )
-   ak_error_message( ak_error_ok, __func__ ,
-                                      "using pcmulqdq for multiplication in finite Galois fields");
-#endif
+   ak_error_message_fmt( ak_error_ok, __func__ ,
+           "using %s for multiplication in finite Galois fields", ak_libakrypt_dispatch.gf_mul_name );
 
  if( ak_gf64_multiplication_test( ) != ak_true ) {
    ak_error_message( ak_error_get_value(), __func__ , "incorrect multiplication test in GF(2^64)");
@@ -1135,10 +1135,10 @@
 /* ----------------------------------------------------------------------------------------------- */
 /*                            Реализация функции хеширования Стрибог                               */
 /* ----------------------------------------------------------------------------------------------- */
-/*! \brief Преобразование LPS.
+/*! \brief Преобразование LPS, реализованное с помощью таблиц, содержащих 64-х битные значения.
     \note Мы предполагаем, что данные содержат 64 байта.                                           */
 /* ----------------------------------------------------------------------------------------------- */
- static inline void ak_hash_context_streebog_lps( ak_uint64 *result, const ak_uint64 *data )
+ void ak_hash_streebog_lps_uint64( ak_uint64 *result, const ak_uint64 *data )
 {
   size_t idx = 0, idx2 = 0;
   const unsigned char *a = ( const unsigned char*) data; /* приводим к массиву байт */
@@ -1166,33 +1166,159 @@
 
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! \brief Преобразование G
-    \note Мы предполагаем, что массивы n и m содержат по 64 байта.                                 */
+/*! \brief Функция сжатия g, использующая преобразование ak_hash_streebog_lps_uint64().
+    \details Если указатель n равен NULL, то вектор n полагается нулевым.
+    \note Мы предполагаем, что массивы h, n и m содержат по 64 байта.                              */
 /* ----------------------------------------------------------------------------------------------- */
- static inline void ak_hash_context_streebog_g( ak_streebog ctx, ak_uint64 *n, const ak_uint64 *m )
+ void ak_hash_streebog_g_uint64( ak_uint64 *h, const ak_uint64 *n, const ak_uint64 *m )
 {
    int idx = 0;
    ak_uint64 K[8], T[8], B[8];
 
        if( n != NULL ) {
-         ak_hash_context_streebog_x( B, ctx->h, n );
-         ak_hash_context_streebog_lps( K, B );
+         ak_hash_context_streebog_x( B, h, n );
+         ak_hash_streebog_lps_uint64( K, B );
        }
         else
-         ak_hash_context_streebog_lps( K, ctx->h );
+         ak_hash_streebog_lps_uint64( K, h );
 
        /* K - ключ K1 */
        for( idx = 0; idx < 8; idx++ ) T[idx] = m[idx]; /* memcpy( T, m, 64 ); */
 
        for( idx = 0; idx < 12; idx++ ) {
           ak_hash_context_streebog_x( B, T, K );
-          ak_hash_context_streebog_lps( T, B ); /* преобразуем текст */
+          ak_hash_streebog_lps_uint64( T, B ); /* преобразуем текст */
 
           ak_hash_context_streebog_x( B, K, streebog_c[idx] );
-          ak_hash_context_streebog_lps( K, B );   /* новый ключ */
+          ak_hash_streebog_lps_uint64( K, B );   /* новый ключ */
        }
        /* изменяем значение переменной h */
-       for ( idx = 0; idx < 8; idx++ ) ctx->h[idx] ^= T[idx] ^ K[idx] ^ m[idx];
+       for ( idx = 0; idx < 8; idx++ ) h[idx] ^= T[idx] ^ K[idx] ^ m[idx];
+}
+
+#if defined( AK_HAVE_BUILTIN_SHUFFLE_EPI8 ) && defined( AK_LITTLE_ENDIAN ) && defined( __x86_64__ )
+ #include <immintrin.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисление двух соседних 64-х битных слов результата преобразования LPS.
+    \details Входной вектор хранится в регистрах x0, x1, x2, x3, каждый из которых содержит
+    два 64-х битных слова. Инструкция pextrw извлекает из каждого слова пару байт с номерами
+    2row и 2row+1, что позволяет вычислять слова результата с номерами 2row и 2row+1
+    без записи входного вектора в память.                                                          */
+/* ----------------------------------------------------------------------------------------------- */
+ #define ak_hash_streebog_lps_pair_sse41( x0, x1, x2, x3, row, out ) do { \
+   const unsigned int a0 = _mm_extract_epi16( x0, row ), a1 = _mm_extract_epi16( x0, row+4 ), \
+                      a2 = _mm_extract_epi16( x1, row ), a3 = _mm_extract_epi16( x1, row+4 ), \
+                      a4 = _mm_extract_epi16( x2, row ), a5 = _mm_extract_epi16( x2, row+4 ), \
+                      a6 = _mm_extract_epi16( x3, row ), a7 = _mm_extract_epi16( x3, row+4 ); \
+   const ak_uint64 lo = \
+     streebog_Areverse_expand_with_pi[0][a0&0xFF] ^ streebog_Areverse_expand_with_pi[1][a1&0xFF] ^ \
+     streebog_Areverse_expand_with_pi[2][a2&0xFF] ^ streebog_Areverse_expand_with_pi[3][a3&0xFF] ^ \
+     streebog_Areverse_expand_with_pi[4][a4&0xFF] ^ streebog_Areverse_expand_with_pi[5][a5&0xFF] ^ \
+     streebog_Areverse_expand_with_pi[6][a6&0xFF] ^ streebog_Areverse_expand_with_pi[7][a7&0xFF]; \
+   const ak_uint64 hi = \
+     streebog_Areverse_expand_with_pi[0][a0>>8] ^ streebog_Areverse_expand_with_pi[1][a1>>8] ^ \
+     streebog_Areverse_expand_with_pi[2][a2>>8] ^ streebog_Areverse_expand_with_pi[3][a3>>8] ^ \
+     streebog_Areverse_expand_with_pi[4][a4>>8] ^ streebog_Areverse_expand_with_pi[5][a5>>8] ^ \
+     streebog_Areverse_expand_with_pi[6][a6>>8] ^ streebog_Areverse_expand_with_pi[7][a7>>8]; \
+   out = _mm_insert_epi64( _mm_cvtsi64_si128(( long long )lo ), ( long long )hi, 1 ); \
+ } while( 0 )
+
+/*! \brief Преобразование LPS вектора, хранящегося в регистрах x0, x1, x2, x3. */
+ #define ak_hash_streebog_lps_sse41( x0, x1, x2, x3, y0, y1, y2, y3 ) do { \
+   ak_hash_streebog_lps_pair_sse41( x0, x1, x2, x3, 0, y0 ); \
+   ak_hash_streebog_lps_pair_sse41( x0, x1, x2, x3, 1, y1 ); \
+   ak_hash_streebog_lps_pair_sse41( x0, x1, x2, x3, 2, y2 ); \
+   ak_hash_streebog_lps_pair_sse41( x0, x1, x2, x3, 3, y3 ); \
+ } while( 0 )
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция сжатия g, использующая набор инструкций SSE4.1.
+    \details Векторы h, K и T на протяжении всех раундов хранятся в регистрах xmm,
+    преобразование X выполняется над регистрами непосредственно перед преобразованием LPS,
+    а преобразования текста и ключа одного раунда вычисляются совместно, что позволяет
+    процессору выполнять обращения к таблицам обоих преобразований параллельно.
+    \note Мы предполагаем, что массивы h, n и m содержат по 64 байта.                              */
+/* ----------------------------------------------------------------------------------------------- */
+ static __attribute__((target("sse4.1")))
+                   void ak_hash_streebog_g_sse41( ak_uint64 *h, const ak_uint64 *n, const ak_uint64 *m )
+{
+  int idx = 0;
+  __m128i h0, h1, h2, h3, m0, m1, m2, m3, k0, k1, k2, k3, t0, t1, t2, t3, b0, b1, b2, b3, c0, c1, c2, c3;
+
+  h0 = _mm_loadu_si128(( const __m128i *) h );
+  h1 = _mm_loadu_si128(( const __m128i *)( h+2 ));
+  h2 = _mm_loadu_si128(( const __m128i *)( h+4 ));
+  h3 = _mm_loadu_si128(( const __m128i *)( h+6 ));
+  m0 = t0 = _mm_loadu_si128(( const __m128i *) m );
+  m1 = t1 = _mm_loadu_si128(( const __m128i *)( m+2 ));
+  m2 = t2 = _mm_loadu_si128(( const __m128i *)( m+4 ));
+  m3 = t3 = _mm_loadu_si128(( const __m128i *)( m+6 ));
+
+ /* K - ключ K1 */
+  if( n != NULL ) {
+    b0 = _mm_xor_si128( h0, _mm_loadu_si128(( const __m128i *) n ));
+    b1 = _mm_xor_si128( h1, _mm_loadu_si128(( const __m128i *)( n+2 )));
+    b2 = _mm_xor_si128( h2, _mm_loadu_si128(( const __m128i *)( n+4 )));
+    b3 = _mm_xor_si128( h3, _mm_loadu_si128(( const __m128i *)( n+6 )));
+    ak_hash_streebog_lps_sse41( b0, b1, b2, b3, k0, k1, k2, k3 );
+  }
+   else ak_hash_streebog_lps_sse41( h0, h1, h2, h3, k0, k1, k2, k3 );
+
+  for( idx = 0; idx < 12; idx++ ) {
+     b0 = _mm_xor_si128( t0, k0 );
+     b1 = _mm_xor_si128( t1, k1 );
+     b2 = _mm_xor_si128( t2, k2 );
+     b3 = _mm_xor_si128( t3, k3 );
+     c0 = _mm_xor_si128( k0, _mm_loadu_si128(( const __m128i *) streebog_c[idx] ));
+     c1 = _mm_xor_si128( k1, _mm_loadu_si128(( const __m128i *)( streebog_c[idx]+2 )));
+     c2 = _mm_xor_si128( k2, _mm_loadu_si128(( const __m128i *)( streebog_c[idx]+4 )));
+     c3 = _mm_xor_si128( k3, _mm_loadu_si128(( const __m128i *)( streebog_c[idx]+6 )));
+     ak_hash_streebog_lps_sse41( b0, b1, b2, b3, t0, t1, t2, t3 ); /* преобразуем текст */
+     ak_hash_streebog_lps_sse41( c0, c1, c2, c3, k0, k1, k2, k3 ); /* новый ключ */
+  }
+
+ /* изменяем значение переменной h */
+  _mm_storeu_si128(( __m128i *) h, _mm_xor_si128( h0, _mm_xor_si128( _mm_xor_si128( t0, k0 ), m0 )));
+  _mm_storeu_si128(( __m128i *)( h+2 ), _mm_xor_si128( h1, _mm_xor_si128( _mm_xor_si128( t1, k1 ), m1 )));
+  _mm_storeu_si128(( __m128i *)( h+4 ), _mm_xor_si128( h2, _mm_xor_si128( _mm_xor_si128( t2, k2 ), m2 )));
+  _mm_storeu_si128(( __m128i *)( h+6 ), _mm_xor_si128( h3, _mm_xor_si128( _mm_xor_si128( t3, k3 ), m3 )));
+}
+
+ #undef ak_hash_streebog_lps_sse41
+ #undef ak_hash_streebog_lps_pair_sse41
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция выбирает реализацию функции сжатия функции хеширования Стрибог,
+    наиболее подходящую для используемого процессора.
+    \details Реализация, использующая набор инструкций SSE4.1, отличается от переносимой
+    только способом извлечения байт из 64-х битных слов, поэтому обе реализации
+    используют одни и те же таблицы и вычисляют одинаковые значения.
+
+    \param table Заполняемая таблица реализаций.                                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_hash_streebog_init_dispatch( ak_cpu_dispatch table )
+{
+  table->streebog_g = ak_hash_streebog_g_uint64;
+  table->streebog_name = "64-bit tables";
+#if defined( AK_HAVE_BUILTIN_SHUFFLE_EPI8 ) && defined( AK_LITTLE_ENDIAN ) && defined( __x86_64__ )
+  if( table->features&ak_cpu_feature_sse41 ) {
+    table->streebog_g = ak_hash_streebog_g_sse41;
+    table->streebog_name = "sse4.1 (64-bit tables)";
+  }
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Преобразование G
+    \details Используемая реализация преобразования выбирается функцией ak_libakrypt_create()
+    и хранится в таблице \ref ak_libakrypt_dispatch.
+    \note Мы предполагаем, что массивы n и m содержат по 64 байта.                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_hash_context_streebog_g( ak_streebog ctx, ak_uint64 *n, const ak_uint64 *m )
+{
+  ak_libakrypt_dispatch.streebog_g( ctx->h, n, m );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -1282,7 +1408,11 @@
 }
 
 /* ----------------------------------------------------------------------------------------------- */
- static int ak_hash_context_streebog_finalize( ak_pointer sctx,
+/*! \brief Финализация, использующая заданную реализацию функции сжатия g.
+    \details Функция позволяет при тестировании проверить каждую из реализаций функции сжатия
+    вне зависимости от реализации, выбранной в таблице \ref ak_libakrypt_dispatch.              */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_context_streebog_finalize_with_g( ak_function_streebog_g *g, ak_pointer sctx,
                    const ak_pointer in, const size_t size, ak_pointer out, const size_t out_size )
 {
   ak_uint64 m[8];
@@ -1306,11 +1436,11 @@
 
   /* при финализации мы изменяем копию существующей структуры */
   memcpy( &sx, cx, sizeof( struct streebog ));
-  ak_hash_context_streebog_g( &sx, sx.n, m );
+  g( sx.h, sx.n, m );
   ak_hash_context_streebog_add( &sx, size << 3 );
   ak_hash_context_streebog_sadd( &sx, m );
-  ak_hash_context_streebog_g( &sx, NULL, sx.n );
-  ak_hash_context_streebog_g( &sx, NULL, sx.sigma );
+  g( sx.h, NULL, sx.n );
+  g( sx.h, NULL, sx.sigma );
 
  /* копируем нужную часть результирующего массива или выдаем сообщение об ошибке */
     if( cx->hsize == 64 ) memcpy( out, sx.h, ak_min( 64, out_size ));
@@ -1318,6 +1448,405 @@
  return result;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_context_streebog_finalize( ak_pointer sctx,
+                   const ak_pointer in, const size_t size, ak_pointer out, const size_t out_size )
+{
+  return ak_hash_context_streebog_finalize_with_g( ak_libakrypt_dispatch.streebog_g,
+                                                                  sctx, in, size, out, out_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*               Одновременная обработка нескольких независимых сообщений                          */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Максимальное количество сообщений, обрабатываемых функцией хеширования Стрибог
+    одновременно. */
+ #define ak_hash_streebog_lanes (4)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Преобразование LPS, применяемое одновременно к нескольким независимым 64-х байтным
+    значениям, расположенным в памяти последовательно.
+    \details Обращения к таблице для различных значений чередуются, что позволяет процессору
+    выполнять их параллельно, не дожидаясь окончания вычислений для одного значения.
+    \note Векторные инструкции сбора данных (gather) на тестируемых процессорах работают
+    медленнее чередующихся обращений к таблицам, поэтому здесь не используются.                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_hash_streebog_lps_lanes( ak_uint64 *result,
+                                                      const ak_uint64 *data, const size_t lanes )
+{
+  size_t idx = 0, idx2 = 0, lane = 0;
+  const unsigned char *a = ( const unsigned char*) data; /* приводим к массиву байт */
+
+  for( idx = 0; idx < 8; idx++ ) {
+    ak_uint64 c[ ak_hash_streebog_lanes ] = { 0, 0, 0, 0 };
+    for( idx2 = 0; idx2 < 8; idx2++ ) {
+      for( lane = 0; lane < lanes; lane++ )
+         c[lane] ^= streebog_Areverse_expand_with_pi[idx2][a[( lane << 6 )+( idx2 << 3 )+idx]];
+    }
+    for( lane = 0; lane < lanes; lane++ ) result[( lane << 3 )+idx] = c[lane];
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Варианты преобразования LPS для фиксированного количества значений
+    (позволяют компилятору полностью развернуть внутренние циклы).                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_hash_streebog_lps_lanes1( ak_uint64 *result, const ak_uint64 *data )
+{
+  ak_hash_streebog_lps_lanes( result, data, 1 );
+}
+
+ static void ak_hash_streebog_lps_lanes2( ak_uint64 *result, const ak_uint64 *data )
+{
+  ak_hash_streebog_lps_lanes( result, data, 2 );
+}
+
+ static void ak_hash_streebog_lps_lanes3( ak_uint64 *result, const ak_uint64 *data )
+{
+  ak_hash_streebog_lps_lanes( result, data, 3 );
+}
+
+ static void ak_hash_streebog_lps_lanes4( ak_uint64 *result, const ak_uint64 *data )
+{
+  ak_hash_streebog_lps_lanes( result, data, 4 );
+}
+
+ static ak_function_streebog_lps *ak_hash_streebog_lps_lanes_table[ ak_hash_streebog_lanes ] = {
+  ak_hash_streebog_lps_lanes1,
+  ak_hash_streebog_lps_lanes2,
+  ak_hash_streebog_lps_lanes3,
+  ak_hash_streebog_lps_lanes4
+ };
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Преобразование G, применяемое одновременно к нескольким контекстам.
+    \param ctx Массив указателей на контексты функции хеширования.
+    \param use_n Флаг использования вектора n контекста (при ложном значении используется
+    нулевой вектор).
+    \param m Массив указателей на обрабатываемые 64-х байтные блоки.
+    \param lanes Количество контекстов, не более \ref ak_hash_streebog_lanes.                      */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_hash_context_streebog_g_lanes( ak_streebog *ctx, const bool_t use_n,
+                                                            ak_uint64 **m, const size_t lanes )
+{
+  size_t idx = 0, lane = 0;
+  ak_uint64 K[ ak_hash_streebog_lanes << 3 ],
+            T[ ak_hash_streebog_lanes << 3 ],
+            B[ ak_hash_streebog_lanes << 3 ];
+  ak_function_streebog_lps *lps = ak_hash_streebog_lps_lanes_table[lanes-1];
+
+  for( lane = 0; lane < lanes; lane++ ) {
+     if( use_n ) ak_hash_context_streebog_x( B+( lane << 3 ), ctx[lane]->h, ctx[lane]->n );
+       else memcpy( B+( lane << 3 ), ctx[lane]->h, 64 );
+     memcpy( T+( lane << 3 ), m[lane], 64 );
+  }
+  lps( K, B ); /* K - ключи K1 */
+
+  for( idx = 0; idx < 12; idx++ ) {
+     for( lane = 0; lane < lanes; lane++ )
+        ak_hash_context_streebog_x( B+( lane << 3 ), T+( lane << 3 ), K+( lane << 3 ));
+     lps( T, B ); /* преобразуем тексты */
+
+     for( lane = 0; lane < lanes; lane++ )
+        ak_hash_context_streebog_x( B+( lane << 3 ), K+( lane << 3 ), streebog_c[idx] );
+     lps( K, B ); /* новые ключи */
+  }
+ /* изменяем значения переменных h */
+  for( lane = 0; lane < lanes; lane++ )
+     for( idx = 0; idx < 8; idx++ )
+        ctx[lane]->h[idx] ^= T[( lane << 3 )+idx] ^ K[( lane << 3 )+idx] ^ m[lane][idx];
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Обработка одинакового количества полных блоков для нескольких контекстов.
+    \details После выполнения функции указатели на данные смещаются на обработанное
+    количество октетов.                                                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_hash_context_streebog_update_lanes( ak_streebog *ctx, ak_uint64 **dt,
+                                                         const size_t lanes, size_t blocks )
+{
+  size_t lane = 0;
+
+  for( ; blocks > 0; blocks-- ) {
+     ak_hash_context_streebog_g_lanes( ctx, ak_true, dt, lanes );
+     for( lane = 0; lane < lanes; lane++ ) {
+        ak_hash_context_streebog_add( ctx[lane], 512 );
+        ak_hash_context_streebog_sadd( ctx[lane], dt[lane] );
+        dt[lane] += 8;
+     }
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Завершение вычислений для нескольких контекстов.
+    \details В отличие от функции ak_hash_context_streebog_finalize() изменяет состояние
+    контекстов.
+    \param ctx Массив указателей на контексты функции хеширования.
+    \param in Массив указателей на последние (неполные) блоки данных.
+    \param size Массив длин последних блоков, каждая длина менее 64 октетов.
+    \param out Массив указателей на области памяти, куда помещаются результаты.
+    \param out_size Размер каждой области памяти для результата.
+    \param lanes Количество контекстов, не более \ref ak_hash_streebog_lanes.                      */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_hash_context_streebog_finalize_lanes( ak_streebog *ctx, ak_uint64 **in,
+                const size_t *size, ak_pointer *out, const size_t out_size, const size_t lanes )
+{
+  size_t lane = 0;
+  ak_uint64 m[ ak_hash_streebog_lanes ][8], *mp[ ak_hash_streebog_lanes ];
+
+ /* формируем временные тексты */
+  for( lane = 0; lane < lanes; lane++ ) {
+     memset( m[lane], 0, 64 );
+     if( size[lane] ) memcpy( m[lane], in[lane], size[lane] );
+     (( ak_uint8 * )m[lane])[size[lane]] = 1; /* дополнение */
+     mp[lane] = m[lane];
+  }
+  ak_hash_context_streebog_g_lanes( ctx, ak_true, mp, lanes );
+  for( lane = 0; lane < lanes; lane++ ) {
+     ak_hash_context_streebog_add( ctx[lane], size[lane] << 3 );
+     ak_hash_context_streebog_sadd( ctx[lane], m[lane] );
+     mp[lane] = ctx[lane]->n;
+  }
+  ak_hash_context_streebog_g_lanes( ctx, ak_false, mp, lanes );
+  for( lane = 0; lane < lanes; lane++ ) mp[lane] = ctx[lane]->sigma;
+  ak_hash_context_streebog_g_lanes( ctx, ak_false, mp, lanes );
+
+ /* копируем нужную часть результирующих массивов */
+  for( lane = 0; lane < lanes; lane++ ) {
+     if( ctx[lane]->hsize == 64 ) memcpy( out[lane], ctx[lane]->h, ak_min( 64, out_size ));
+       else memcpy( out[lane], ctx[lane]->h+4, ak_min( 32, out_size ));
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                 Древовидное хеширование на основе функций хеширования Стрибог                   */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Максимальное количество листьев, хеш-коды которых вычисляются одним вызовом
+    функции ak_hash_tree_leaves(). */
+ #define ak_hash_tree_batch (64)
+
+/*! \brief Данные, передаваемые заданиям пула потоков при вычислении хеш-кодов листьев. */
+ typedef struct hash_tree_batch {
+ /*! \brief Указатель на данные первого листа. */
+  const ak_uint8 *data;
+ /*! \brief Количество листьев. */
+  size_t count;
+ /*! \brief Длина хеш-кода в октетах. */
+  size_t hsize;
+ /*! \brief Массив для хеш-кодов листьев. */
+  ak_uint8 (*digests)[64];
+ } *ak_hash_tree_batch_t;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисление хеш-кода внутренней вершины дерева.
+    \details Хеш-код вычисляется для конкатенации хеш-кодов left и right, дополненной октетом 0x01.
+    Результат помещается в out; указатель out может совпадать с left или right.                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_hash_tree_node( const size_t hsize, const ak_uint8 *left,
+                                                          const ak_uint8 *right, ak_uint8 *out )
+{
+  struct streebog sx;
+  ak_uint64 buffer[17];
+  ak_uint8 *ptr = ( ak_uint8 * )buffer;
+  size_t len = ( hsize << 1 ) + 1, blocks = ( len >> 6 ) << 6;
+
+  memcpy( ptr, left, hsize );
+  memcpy( ptr + hsize, right, hsize );
+  ptr[ hsize << 1 ] = 0x01;
+
+  sx.hsize = hsize;
+  ak_hash_context_streebog_clean( &sx );
+  ak_hash_context_streebog_update( &sx, ptr, blocks );
+  ak_hash_context_streebog_finalize( &sx, ptr + blocks, len - blocks, out, 64 );
+
+  memset( buffer, 0, sizeof( buffer ));
+  memset( &sx, 0, sizeof( struct streebog ));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Добавление хеш-кода очередного листа в стек хеш-кодов поддеревьев.
+    \details Полные поддеревья одинаковой высоты объединяются сразу, поэтому глубина стека
+    всегда равна количеству единиц в двоичной записи количества обработанных листьев.              */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_hash_tree_push( ak_streebog_tree tx, ak_uint8 *digest )
+{
+  ak_uint64 count = ++tx->leaves;
+
+  while(( count&1 ) == 0 ) {
+    ak_hash_tree_node( tx->leaf.hsize, tx->stack[--tx->depth], digest, digest );
+    count >>= 1;
+  }
+  memcpy( tx->stack[tx->depth++], digest, 64 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Задание пула потоков: вычисление хеш-кодов группы из не более чем
+    \ref ak_hash_streebog_lanes листьев, обрабатываемых одновременно.                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_tree_leaves_task( ak_pointer ptr, const size_t task, const size_t thread )
+{
+  ak_hash_tree_batch_t batch = ( ak_hash_tree_batch_t ) ptr;
+  size_t lane = 0, first = task*ak_hash_streebog_lanes,
+         lanes = ak_min( ak_hash_streebog_lanes, batch->count - first );
+  struct streebog sx[ ak_hash_streebog_lanes ];
+  ak_streebog ctx[ ak_hash_streebog_lanes ];
+  ak_uint64 zero = 0, *dt[ ak_hash_streebog_lanes ], *tail[ ak_hash_streebog_lanes ];
+  ak_pointer out[ ak_hash_streebog_lanes ];
+  size_t size[ ak_hash_streebog_lanes ];
+
+  ( void )thread;
+  for( lane = 0; lane < lanes; lane++ ) {
+     sx[lane].hsize = batch->hsize;
+     ak_hash_context_streebog_clean( ctx[lane] = sx+lane );
+     dt[lane] = ( ak_uint64 *)( batch->data + ( first + lane )*ak_hash_tree_leaf_size );
+     tail[lane] = &zero;
+     size[lane] = 1;
+     out[lane] = batch->digests[first + lane];
+  }
+  ak_hash_context_streebog_update_lanes( ctx, dt, lanes, ak_hash_tree_leaf_size >> 6 );
+  ak_hash_context_streebog_finalize_lanes( ctx, tail, size, out, 64, lanes );
+  memset( sx, 0, sizeof( sx ));
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисление хеш-кодов нескольких полных листьев и добавление их в стек.
+    \details Листья обрабатываются группами по \ref ak_hash_streebog_lanes листьев
+    (многопоточная реализация Стрибог), группы распределяются по потокам пула.
+    Поскольку форма дерева не зависит от порядка вычислений, результат не зависит
+    от количества потоков.                                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_tree_leaves( ak_streebog_tree tx, const ak_uint8 *data, const size_t count )
+{
+  size_t idx = 0;
+  int error = ak_error_ok;
+  ak_uint8 digests[ ak_hash_tree_batch ][64];
+  struct hash_tree_batch batch;
+
+  batch.data = data;
+  batch.count = count;
+  batch.hsize = tx->leaf.hsize;
+  batch.digests = digests;
+  if(( error = ak_thread_pool_run( ak_hash_tree_leaves_task, &batch,
+                          ( count + ak_hash_streebog_lanes - 1 )/ak_hash_streebog_lanes )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect hashing of tree leaves" );
+
+  for( idx = 0; idx < count; idx++ ) ak_hash_tree_push( tx, digests[idx] );
+  memset( digests, 0, sizeof( digests ));
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_context_streebog_tree_clean( ak_pointer sctx )
+{
+  ak_streebog_tree tx = ( ak_streebog_tree ) sctx;
+  if( tx == NULL ) return ak_error_null_pointer;
+
+  ak_hash_context_streebog_clean( &tx->leaf );
+  tx->length = 0;
+  tx->leaves = 0;
+  tx->depth = 0;
+  memset( tx->stack, 0, sizeof( tx->stack ));
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Обновление контекста древовидного хеширования.
+    \details Если текущий лист пуст, а данные содержат не менее двух полных листьев,
+    то хеш-коды листьев вычисляются параллельно функцией ak_hash_tree_leaves().
+    В остальных случаях данные добавляются к текущему листу.                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_context_streebog_tree_update( ak_pointer sctx,
+                                                          const ak_pointer in, const size_t size )
+{
+  int error = ak_error_ok;
+  ak_uint8 digest[64], *ptr = ( ak_uint8 * ) in;
+  ak_streebog_tree tx = ( ak_streebog_tree ) sctx;
+  size_t len = 0, count = 0, newsize = size;
+
+  if( tx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                          "using null pointer to internal streebog tree context" );
+  if(( !size ) || ( in == NULL )) return ak_error_ok;
+  if( size&0x3f ) return ak_error_message( ak_error_wrong_length, __func__,
+                                      "data length is not a multiple of the length of the block" );
+  while( newsize > 0 ) {
+    if(( tx->length == 0 ) && ( newsize >= ( ak_hash_tree_leaf_size << 1 ))) {
+     /* обрабатываем группу полных листьев */
+      count = ak_min( newsize/ak_hash_tree_leaf_size, ak_hash_tree_batch );
+      if(( tx->leaves + count ) >> ( ak_hash_tree_max_depth - 1 ))
+        return ak_error_message( ak_error_wrong_length, __func__, "using very huge data" );
+      if(( error = ak_hash_tree_leaves( tx, ptr, count )) != ak_error_ok ) return error;
+      ptr += count*ak_hash_tree_leaf_size;
+      newsize -= count*ak_hash_tree_leaf_size;
+      continue;
+    }
+   /* дополняем текущий лист */
+    len = ak_min( newsize, ak_hash_tree_leaf_size - tx->length );
+    ak_hash_context_streebog_update( &tx->leaf, ptr, len );
+    tx->length += len;
+    ptr += len;
+    newsize -= len;
+    if( tx->length == ak_hash_tree_leaf_size ) {
+      if(( tx->leaves + 1 ) >> ( ak_hash_tree_max_depth - 1 ))
+        return ak_error_message( ak_error_wrong_length, __func__, "using very huge data" );
+      digest[0] = 0;
+      ak_hash_context_streebog_finalize( &tx->leaf, digest, 1, digest, sizeof( digest ));
+      ak_hash_tree_push( tx, digest );
+      ak_hash_context_streebog_clean( &tx->leaf );
+      tx->length = 0;
+    }
+  }
+  memset( digest, 0, sizeof( digest ));
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисление результата древовидного хеширования.
+    \details Текущее состояние контекста не изменяется.                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_context_streebog_tree_finalize( ak_pointer sctx,
+                   const ak_pointer in, const size_t size, ak_pointer out, const size_t out_size )
+{
+  size_t idx = 0;
+  ak_uint64 m[8];
+  ak_uint8 digest[64];
+  struct streebog_tree tx;
+
+  if( sctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                          "using null pointer to internal streebog tree context" );
+  if( out == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                   "using null pointer to externl result buffer" );
+  if( size >= 64 ) return ak_error_message( ak_error_wrong_length, __func__,
+                                                                      "input length is too huge" );
+  memcpy( &tx, sctx, sizeof( struct streebog_tree ));
+
+ /* последний лист, дополненный октетом 0x00 (для пустых данных дерево состоит из одного листа) */
+  if(( tx.length + size > 0 ) || ( tx.leaves == 0 )) {
+    memset( m, 0, sizeof( m ));
+    if( size ) memcpy( m, in, size );
+    if( size == 63 ) {
+      ak_hash_context_streebog_update( &tx.leaf, m, 64 );
+      ak_hash_context_streebog_finalize( &tx.leaf, NULL, 0, digest, sizeof( digest ));
+    } else ak_hash_context_streebog_finalize( &tx.leaf, m, size+1, digest, sizeof( digest ));
+    ak_hash_tree_push( &tx, digest );
+  }
+
+ /* объединяем оставшиеся поддеревья справа налево */
+  memcpy( digest, tx.stack[tx.depth-1], 64 );
+  for( idx = tx.depth-1; idx > 0; idx-- )
+     ak_hash_tree_node( tx.leaf.hsize, tx.stack[idx-1], digest, digest );
+  memcpy( out, digest, ak_min( tx.leaf.hsize, out_size ));
+
+  memset( m, 0, sizeof( m ));
+  memset( digest, 0, sizeof( digest ));
+  memset( &tx, 0, sizeof( struct streebog_tree ));
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                               Реализация функция класса hash                                    */
 /* ----------------------------------------------------------------------------------------------- */
@@ -1332,6 +1861,8 @@
   int error = ak_error_ok;
   if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                             "using null pointer to hash context" );
+  if(( error = ak_libakrypt_lazy_test( hash_test_family )) != ak_error_ok )
+    return ak_error_message( error, __func__, "streebog256 failed dynamic control" );
   hctx->data.sctx.hsize = 32;
   if(( hctx->oid = ak_oid_find_by_name( "streebog256" )) == NULL )
     return ak_error_message( ak_error_wrong_oid, __func__,
@@ -1357,6 +1888,8 @@
   int error = ak_error_ok;
   if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                             "using null pointer to hash context" );
+  if(( error = ak_libakrypt_lazy_test( hash_test_family )) != ak_error_ok )
+    return ak_error_message( error, __func__, "streebog512 failed dynamic control" );
   hctx->data.sctx.hsize = 64;
   if(( hctx->oid = ak_oid_find_by_name( "streebog512" )) == NULL )
     return ak_error_message( ak_error_wrong_oid, __func__,
@@ -1370,6 +1903,66 @@
   return ak_hash_context_streebog_clean( &hctx->data.sctx );
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Общая часть инициализации контекстов древовидного хеширования. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_create_streebog_tree( ak_hash hctx, const size_t hsize, const char *name )
+{
+  int error = ak_error_ok;
+  ak_streebog_tree tx = NULL;
+  if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                            "using null pointer to hash context" );
+  if(( error = ak_libakrypt_lazy_test( hash_test_family )) != ak_error_ok )
+    return ak_error_message_fmt( error, __func__, "%s failed dynamic control", name );
+  if(( hctx->oid = ak_oid_find_by_name( name )) == NULL )
+    return ak_error_message_fmt( ak_error_wrong_oid, __func__,
+                                                  "incorrect internal search of %s identifier", name );
+ /* внутреннее состояние размещается в динамической памяти */
+  if(( tx = malloc( sizeof( struct streebog_tree ))) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__,
+                                              "incorrect memory allocation for tree hash context" );
+  memset( tx, 0, sizeof( struct streebog_tree ));
+  tx->leaf.hsize = hsize;
+  hctx->data.tctx = tx;
+  hctx->data.sctx.hsize = hsize;
+  if(( error = ak_mac_create( &hctx->mctx, 64, tx,
+                                             ak_hash_context_streebog_tree_clean,
+                                             ak_hash_context_streebog_tree_update,
+                                             ak_hash_context_streebog_tree_finalize )) != ak_error_ok ) {
+    free( tx );
+    memset( &hctx->data, 0, sizeof( hctx->data ));
+    return ak_error_message( error, __func__, "incorrect initialization of internal mac context" );
+  }
+
+  return ak_hash_context_streebog_tree_clean( tx );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция инициализирует контекст алгоритма древовидного хеширования, использующего
+    функцию Стрибог256 для вычисления хеш-кодов листьев и внутренних вершин дерева.
+    Хеш-коды листьев вычисляются параллельно с помощью пула потоков библиотеки,
+    при этом результат не зависит от количества используемых потоков.
+
+    @param hctx Контекст функции хеширования
+    @return Функция возвращает код ошибки или \ref ak_error_ok (в случае успеха)                   */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_create_streebog256_tree( ak_hash hctx )
+{
+ return ak_hash_create_streebog_tree( hctx, 32, "streebog256-tree" );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция инициализирует контекст алгоритма древовидного хеширования, использующего
+    функцию Стрибог512 (см. описание функции ak_hash_create_streebog256_tree()).
+
+    @param hctx Контекст функции хеширования
+    @return Функция возвращает код ошибки или \ref ak_error_ok (в случае успеха)                   */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_create_streebog512_tree( ak_hash hctx )
+{
+ return ak_hash_create_streebog_tree( hctx, 64, "streebog512-tree" );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param hctx Контекст функции хеширования
     @param oid OID алгоритма бесключевого хеширования.
@@ -1415,7 +2008,12 @@
   if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                        "destroying null pointer to hash context" );
   hctx->oid = NULL;
-  memset( &hctx->data.sctx, 0, sizeof( struct streebog ));
+ /* внутреннее состояние функций древовидного хеширования размещено в динамической памяти */
+  if(( hctx->mctx.clean == ak_hash_context_streebog_tree_clean ) && ( hctx->data.tctx != NULL )) {
+    memset( hctx->data.tctx, 0, sizeof( struct streebog_tree ));
+    free( hctx->data.tctx );
+  }
+  memset( &hctx->data, 0, sizeof( hctx->data ));
   if( ak_mac_destroy( &hctx->mctx ) != ak_error_ok )
     ak_error_message( ak_error_get_value(), __func__,
                                                     "incorrect cleaning of internal mac context" );
@@ -1523,6 +2121,37 @@
  return ak_mac_update( &hctx->mctx, in, size );
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция обновляет состояние контекста данными, разбитыми на несколько фрагментов
+    произвольной длины. Результат совпадает с результатом вызова функции ak_hash_update()
+    для данных, полученных последовательным объединением всех фрагментов. Блоки, пересекающие
+    границы фрагментов, собираются во внутреннем буффере контекста, остальные данные
+    обрабатываются без копирования.
+
+    @param hctx Контекст функции хеширования
+    @param in Массив фрагментов входных данных.
+    @param count Количество фрагментов.
+
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_update_v( ak_hash hctx, ak_iovector in, const size_t count )
+{
+  size_t i = 0;
+  int error = ak_error_ok;
+
+  if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                         "updating null pointer to hash context" );
+  if(( in == NULL ) && ( count > 0 )) return ak_error_message( ak_error_null_pointer, __func__,
+                                                           "using null pointer to input data" );
+  for( i = 0; i < count; i++ ) {
+     if( in[i].size == 0 ) continue;
+     if(( error = ak_mac_update( &hctx->mctx, in[i].data, in[i].size )) != ak_error_ok )
+       return ak_error_message( error, __func__, "incorrect updating of hash context" );
+  }
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param hctx Контекст функции хеширования
     @param in Указатель на входные данные для которых вычисляется хеш-код.
@@ -1543,6 +2172,167 @@
  return ak_mac_finalize( &hctx->mctx, in, size, out, out_size );
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет хеш-коды для `count` независимых областей памяти, используя для этого
+    алгоритм, определяемый контекстом `hctx`. Для функции хеширования Стрибог
+    несколько сообщений (до четырех) обрабатываются одновременно: преобразования
+    выполняются для всех сообщений сразу, что позволяет процессору совмещать обращения к таблицам
+    для различных сообщений. Оставшиеся у сообщений различной длины блоки
+    обрабатываются по отдельности.
+
+    Результат совпадает с результатом последовательного вызова функции ak_hash_ptr()
+    для каждой области памяти. Внутреннее состояние контекста `hctx` функцией не изменяется.
+
+    @param hctx Контекст функции хеширования, определяющий используемый алгоритм.
+    @param in Массив указателей на входные данные.
+    @param size Массив длин входных данных (в октетах).
+    @param out Массив указателей на области памяти, куда будут помещены результаты.
+    @param out_size Размер каждой области памяти (в октетах), в которую помещается результат.
+    @param count Количество обрабатываемых областей памяти.
+
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_ptr_multi( ak_hash hctx, ak_pointer *in, const size_t *size,
+                                     ak_pointer *out, const size_t out_size, const size_t count )
+{
+  int error = ak_error_ok;
+  size_t idx = 0, lane = 0, lanes = 0, blocks = 0, full = 0;
+  struct streebog sx[ ak_hash_streebog_lanes ];
+  ak_streebog ctx[ ak_hash_streebog_lanes ];
+  ak_uint64 *dt[ ak_hash_streebog_lanes ];
+  size_t tail[ ak_hash_streebog_lanes ];
+
+  if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                            "using null pointer to hash context" );
+  if(( in == NULL ) || ( size == NULL ) || ( out == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__,
+                                                      "using null pointer to array of messages" );
+  for( idx = 0; idx < count; idx++ ) {
+     if((( in[idx] == NULL ) && ( size[idx] != 0 )) || ( out[idx] == NULL ))
+       return ak_error_message_fmt( ak_error_null_pointer, __func__,
+                                     "using null pointer for message %u", (unsigned int) idx );
+  }
+
+ /* одновременная обработка реализована только для функции хеширования Стрибог */
+  if( hctx->mctx.update != ak_hash_context_streebog_update ) {
+    for( idx = 0; idx < count; idx++ )
+       if(( error = ak_hash_ptr( hctx, in[idx], size[idx], out[idx], out_size )) != ak_error_ok )
+         return ak_error_message( error, __func__, "incorrect hashing of message" );
+    return error;
+  }
+
+  for( idx = 0; idx < count; idx += lanes ) {
+     lanes = ak_min( count - idx, ak_hash_streebog_lanes );
+    /* инициализируем контексты и определяем общее количество полных блоков */
+     blocks = size[idx] >> 6;
+     for( lane = 0; lane < lanes; lane++ ) {
+        sx[lane].hsize = hctx->data.sctx.hsize;
+        ak_hash_context_streebog_clean( ctx[lane] = sx+lane );
+        dt[lane] = ( ak_uint64 * ) in[idx+lane];
+        blocks = ak_min( blocks, size[idx+lane] >> 6 );
+     }
+     ak_hash_context_streebog_update_lanes( ctx, dt, lanes, blocks );
+
+    /* оставшиеся полные блоки обрабатываем по отдельности */
+     for( lane = 0; lane < lanes; lane++ ) {
+        tail[lane] = size[idx+lane] - ( blocks << 6 );
+        if(( full = ( tail[lane] >> 6 )) > 0 ) {
+          ak_hash_context_streebog_update( ctx[lane], dt[lane], full << 6 );
+          dt[lane] += full << 3;
+          tail[lane] -= full << 6;
+        }
+     }
+     ak_hash_context_streebog_finalize_lanes( ctx, dt, tail, out+idx, out_size, lanes );
+  }
+
+  memset( sx, 0, sizeof( sx ));
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Одновременная обработка данных группой контекстов функции хеширования Стрибог,
+    не содержащих данных во внутренних буфферах.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hash_update_lanes( ak_hash *hx, ak_uint64 **dt,
+                                     const size_t lanes, const size_t blocks, const size_t tail )
+{
+  size_t lane = 0;
+  int error = ak_error_ok;
+  ak_streebog ctx[ ak_hash_streebog_lanes ];
+
+  for( lane = 0; lane < lanes; lane++ ) ctx[lane] = &hx[lane]->data.sctx;
+  ak_hash_context_streebog_update_lanes( ctx, dt, lanes, blocks );
+ /* хвосты помещаются во внутренние буфферы контекстов */
+  if( tail ) {
+    for( lane = 0; lane < lanes; lane++ )
+       if(( error = ak_hash_update( hx[lane], dt[lane], tail )) != ak_error_ok )
+         return ak_error_message( error, __func__, "incorrect updating of hash context" );
+  }
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция обновляет состояния `count` независимых контекстов функции хеширования, добавляя
+    к каждому из них `size` октетов данных. Для контекстов функции хеширования Стрибог, не
+    содержащих данных во внутреннем буффере, полные блоки обрабатываются одновременно
+    (до четырех контекстов сразу), как это описано для функции ak_hash_ptr_multi().
+    Остальные данные обрабатываются функцией ak_hash_update().
+
+    Результат совпадает с результатом последовательного вызова функции ak_hash_update()
+    для каждого контекста.
+
+    @param hctx Массив указателей на контексты функции хеширования.
+    @param in Массив указателей на входные данные.
+    @param size Размер входных данных для каждого контекста (в октетах).
+    @param count Количество контекстов.
+
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hash_update_multi( ak_hash *hctx, ak_pointer *in, const size_t size, const size_t count )
+{
+  int error = ak_error_ok;
+  size_t idx = 0, lanes = 0,
+         blocks = size >> 6, tail = size - ( blocks << 6 );
+  ak_hash hx[ ak_hash_streebog_lanes ];
+  ak_uint64 *dt[ ak_hash_streebog_lanes ];
+
+  if(( hctx == NULL ) || ( in == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__,
+                                                      "using null pointer to array of contexts" );
+  for( idx = 0; idx < count; idx++ ) {
+     if( hctx[idx] == NULL ) return ak_error_message_fmt( ak_error_null_pointer, __func__,
+                                      "using null pointer for context %u", (unsigned int) idx );
+     if(( in[idx] == NULL ) && ( size != 0 )) return ak_error_message_fmt( ak_error_null_pointer,
+                                   __func__, "using null pointer for data %u", (unsigned int) idx );
+  }
+  if( !size ) return error;
+
+  for( idx = 0; idx < count; idx++ ) {
+    /* контексты, которые могут обрабатываться одновременно, собираем в группы */
+     if(( blocks > 0 ) && ( hctx[idx]->mctx.length == 0 ) &&
+                              ( hctx[idx]->mctx.update == ak_hash_context_streebog_update )) {
+       hx[lanes] = hctx[idx];
+       dt[lanes++] = ( ak_uint64 * ) in[idx];
+       if( lanes == ak_hash_streebog_lanes ) {
+         if(( error = ak_hash_update_lanes( hx, dt, lanes, blocks, tail )) != ak_error_ok )
+           return ak_error_message( error, __func__, "incorrect updating of hash contexts" );
+         lanes = 0;
+       }
+     }
+      else
+       if(( error = ak_hash_update( hctx[idx], in[idx], size )) != ak_error_ok )
+         return ak_error_message( error, __func__, "incorrect updating of hash context" );
+  }
+  if( lanes > 0 ) {
+    if(( error = ak_hash_update_lanes( hx, dt, lanes, blocks, tail )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect updating of hash contexts" );
+  }
+
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                          Функции тестирования алгоритмов работы                                 */
 /* ----------------------------------------------------------------------------------------------- */
@@ -1611,6 +2401,60 @@
    0xBA, 0x3A, 0x71, 0x5C, 0x1B, 0xCD, 0x81, 0xCB, 0x8E, 0x9F, 0x90, 0xBF, 0x4C, 0x1C, 0x1A, 0x8A
  };
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет каждую из доступных реализаций функции сжатия g на первом примере
+    из приложения А (ГОСТ Р 34.11-2012).
+    \details Тесты функций ak_libakrypt_test_streebog256() и ak_libakrypt_test_streebog512()
+    используют реализацию, выбранную в таблице \ref ak_libakrypt_dispatch, поэтому ошибка
+    в любой другой реализации, доступной для данного процессора, ими не обнаруживается.
+    Поскольку сообщение имеет длину 63 октета, хеш-код вычисляется одним вызовом функции
+    финализации, т.е. трехкратным применением проверяемой функции сжатия.
+
+    \param hsize Длина хеш-кода в октетах (32 или 64).
+    \param testM1 Ожидаемое значение хеш-кода.
+    @return Если тестирование прошло успешно возвращается \ref ak_true (истина). В противном
+    случае возвращается \ref ak_false.                                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_libakrypt_test_streebog_g_functions( const size_t hsize, const ak_uint8 *testM1 )
+{
+  size_t idx = 0;
+  ak_uint8 out[64];
+  struct streebog sx;
+  int audit = ak_log_get_level();
+  struct {
+    ak_function_streebog_g *g;
+    const char *name;
+  } impl[] = {
+    { ak_hash_streebog_g_uint64, "64-bit tables" },
+#if defined( AK_HAVE_BUILTIN_SHUFFLE_EPI8 ) && defined( AK_LITTLE_ENDIAN ) && defined( __x86_64__ )
+    { ak_hash_streebog_g_sse41, "sse4.1 (64-bit tables)" },
+#endif
+  };
+
+  for( idx = 0; idx < sizeof( impl )/sizeof( impl[0] ); idx++ ) {
+#if defined( AK_HAVE_BUILTIN_SHUFFLE_EPI8 ) && defined( AK_LITTLE_ENDIAN ) && defined( __x86_64__ )
+     if(( impl[idx].g == ak_hash_streebog_g_sse41 ) &&
+                             !( ak_libakrypt_dispatch.features&ak_cpu_feature_sse41 )) continue;
+#endif
+     sx.hsize = hsize;
+     ak_hash_context_streebog_clean( &sx );
+     memset( out, 0, sizeof( out ));
+     ak_hash_context_streebog_finalize_with_g( impl[idx].g,
+                                                  &sx, streebog_M1_message, 63, out, hsize );
+     if( !ak_ptr_is_equal_with_log( out, testM1, hsize )) {
+       ak_error_message_fmt( ak_error_not_equal_data, __func__ ,
+                   "the 1st test from GOST R 34.11-2012 for %s g function is wrong (%u bits)",
+                                                impl[idx].name, (unsigned int)( hsize << 3 ));
+       return ak_false;
+     }
+     if( audit >= ak_log_maximum )
+       ak_error_message_fmt( ak_error_ok, __func__ ,
+                      "the 1st test from GOST R 34.11-2012 for %s g function is Ok (%u bits)",
+                                                impl[idx].name, (unsigned int)( hsize << 3 ));
+  }
+ return ak_true;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*!  @return Если тестирование прошло успешно возвращается \ref ak_true (истина). В противном
      случае возвращается \ref ak_false.                                                            */
@@ -1628,6 +2472,12 @@
  /* буффер длиной 32 байта (256 бит) для хранения результата */
   ak_uint8 buffer[512], out[32], out2[32], *ptr = buffer;
 
+ /* проверяем все доступные реализации функции сжатия */
+  if( ak_libakrypt_test_streebog_g_functions( 32, streebog256_testM1 ) != ak_true ) {
+    ak_error_message( ak_error_not_equal_data, __func__ , "wrong streebog g function" );
+    return ak_false;
+  }
+
  /* инициализируем контекст функции хешиирования */
   if(( error = ak_hash_create_streebog256( &ctx )) != ak_error_ok ) {
     ak_error_message( error, __func__ , "wrong initialization of streenbog256 context" );
@@ -1776,6 +2626,12 @@
  /* буффер длиной 64 байта (512 бит) для получения результата */
   ak_uint8 out[64], out2[64], buffer[512], *ptr = buffer;
 
+ /* проверяем все доступные реализации функции сжатия */
+  if( ak_libakrypt_test_streebog_g_functions( 64, streebog512_testM1 ) != ak_true ) {
+    ak_error_message( ak_error_not_equal_data, __func__ , "wrong streebog g function" );
+    return ak_false;
+  }
+
  /* инициализируем контекст функции хешиирования */
   if(( error = ak_hash_create_streebog512( &ctx )) != ak_error_ok ) {
     ak_error_message( error, __func__ , "wrong initialization of streenbog512 context" );
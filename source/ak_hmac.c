@@ -18,8 +18,123 @@
  #error Library cannot be compiled without string.h header
 #endif
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисление внутренних состояний функции хеширования, получаемых после обработки
+    значений ключа, сложенного с константами ipad и opad.
+
+    Вычисленные состояния сохраняются в контексте алгоритма HMAC в маскированном виде:
+    на каждое состояние накладывается случайная маска, вырабатываемая генератором
+    секретного ключа. Функция вызывается при присвоении ключу нового значения, а также при
+    первом использовании ключа, значение которого было установлено иным способом
+    (например, при импорте ключа из файла).
+
+    \param hctx Контекст алгоритма HMAC выработки имитовставки.
+    \return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hmac_set_midstates( ak_hmac hctx )
+{
+  int error = ak_error_ok;
+  const ak_uint8 pad[2] = { 0x36, 0x5C };
+  ak_streebog sx = &hctx->ctx.data.sctx;
+  size_t idx = 0, jdx = 0, len = 0, pdx = 0;
+  ak_uint8 buffer[64]; /* буффер для хранения промежуточных значений */
+
+  hctx->midstate_set = ak_false;
+ /* проверяем наличие ключа */
+  if( !((hctx->key.flags)&ak_key_flag_set_key )) return ak_error_message( ak_error_key_value,
+                                               __func__ , "using hmac key with unassigned value" );
+  if( hctx->mctx.bsize > sizeof( buffer )) return ak_error_message( ak_error_wrong_length,
+                                            __func__, "using hash function with huge block size" );
+  for( pdx = 0; pdx < 2; pdx++ ) {
+    /* фомируем значение ключа, сложенное с константой */
+     len = ak_min( hctx->mctx.bsize, jdx = hctx->key.key_size );
+     for( idx = 0; idx < len; idx++, jdx++ ) {
+        buffer[idx] = hctx->key.key[idx] ^ pad[pdx];
+        buffer[idx] ^= hctx->key.key[jdx];
+     }
+     for( ; idx < hctx->mctx.bsize; idx++ ) buffer[idx] = pad[pdx];
+
+    /* вычисляем состояние контекста хеширования после обработки одного блока */
+     if(( error = ak_hash_clean( &hctx->ctx )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "wrong cleaning of hash function context" );
+       break;
+     }
+     if(( error = ak_hash_update( &hctx->ctx, buffer, hctx->mctx.bsize )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "invalid 1st step iteration for hmac key context" );
+       break;
+     }
+
+    /* сохраняем состояние, предварительно наложив на него маску */
+     if(( error = ak_random_ptr( &hctx->key.generator,
+                                 hctx->mask[pdx], sizeof( hctx->mask[pdx] ))) != ak_error_ok ) {
+       ak_error_message( error, __func__ , "wrong generation a random mask for hmac state" );
+       break;
+     }
+     for( idx = 0; idx < 8; idx++ ) {
+        hctx->midstate[pdx][idx] = sx->h[idx] ^ hctx->mask[pdx][idx];
+        hctx->midstate[pdx][idx+8] = sx->sigma[idx] ^ hctx->mask[pdx][idx+8];
+     }
+     memcpy( hctx->midcount, sx->n, sizeof( hctx->midcount ));
+  }
+
+ /* очищаем буффер и контекст функции хеширования, перемаскируем ключ */
+  ak_ptr_wipe( buffer, sizeof( buffer ), &hctx->key.generator );
+  ak_hash_clean( &hctx->ctx );
+  hctx->key.set_mask( &hctx->key );
+
+  if( error == ak_error_ok ) hctx->midstate_set = ak_true;
+   else {
+     memset( hctx->midstate, 0, sizeof( hctx->midstate ));
+     memset( hctx->mask, 0, sizeof( hctx->mask ));
+   }
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Перевод контекста функции хеширования в сохраненное ранее внутреннее состояние.
+    \details После снятия маски со значения состояния маска заменяется новой.
+    \param hctx Контекст алгоритма HMAC выработки имитовставки.
+    \param pdx Индекс состояния: 0 - для константы ipad, 1 - для константы opad.
+    \return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hmac_load_midstate( ak_hmac hctx, const size_t pdx )
+{
+  size_t idx = 0;
+  int error = ak_error_ok;
+  ak_streebog sx = &hctx->ctx.data.sctx;
+  ak_uint64 newmask[ak_hmac_midstate_words];
+
+  if( !hctx->midstate_set ) {
+    if(( error = ak_hmac_set_midstates( hctx )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect precomputation of hmac states" );
+  }
+  if(( error = ak_hash_clean( &hctx->ctx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "wrong cleaning of hash function context" );
+
+  for( idx = 0; idx < 8; idx++ ) {
+     sx->h[idx] = hctx->midstate[pdx][idx] ^ hctx->mask[pdx][idx];
+     sx->sigma[idx] = hctx->midstate[pdx][idx+8] ^ hctx->mask[pdx][idx+8];
+  }
+  memcpy( sx->n, hctx->midcount, sizeof( hctx->midcount ));
+
+ /* сменяем маску */
+  if(( error = ak_random_ptr( &hctx->key.generator,
+                                                     newmask, sizeof( newmask ))) != ak_error_ok )
+    return ak_error_message( error, __func__ , "wrong generation a random mask for hmac state" );
+  for( idx = 0; idx < ak_hmac_midstate_words; idx++ ) {
+     hctx->midstate[pdx][idx] ^= newmask[idx];
+     hctx->mask[pdx][idx] ^= newmask[idx];
+  }
+
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Очистка контекста алгоритма hmac.
+    \details Контекст функции хеширования переводится в сохраненное состояние, соответствующее
+    обработке ключа, сложенного с константой ipad.
     \param ctx Контекст алгоритма HMAC выработки имитовставки.
     \return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
     возвращается код ошибки.                                                                       */
@@ -28,8 +143,6 @@
 {
   int error = ak_error_ok;
   ak_hmac hctx = ( ak_hmac ) ctx;
-  size_t idx = 0, jdx = 0, len = 0;
-  ak_uint8 buffer[64]; /* буффер для хранения промежуточных значений */
 
   if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                       "using a null pointer to hmac key context" );
@@ -40,30 +153,12 @@
   if( hctx->key.resource.value.counter <= 1 ) return ak_error_message( ak_error_low_key_resource,
                                             __func__, "using hmac key context with low resource" );
                       /* нам надо два раза использовать ключ => ресурс должен быть не менее двух */
-  if( hctx->mctx.bsize > sizeof( buffer )) return ak_error_message( ak_error_wrong_length,
-                                            __func__, "using hash function with huge block size" );
-
- /* фомируем маскированное значение ключа */
-  len = ak_min( hctx->mctx.bsize, jdx = hctx->key.key_size );
-  for( idx = 0; idx < len; idx++, jdx++ ) {
-     buffer[idx] = hctx->key.key[idx] ^ 0x36;
-     buffer[idx] ^= hctx->key.key[jdx];
-  }
-  for( ; idx < hctx->mctx.bsize; idx++ ) buffer[idx] = 0x36;
 
- /* инициализируем начальное состояние контекста хеширования */
-  if(( error = ak_hash_clean( &hctx->ctx )) != ak_error_ok )
-    return ak_error_message( error, __func__, "wrong cleaning of hash function context" );
-
- /* обновляем состояние контекста хеширования */
-  if(( error = ak_hash_update( &hctx->ctx, buffer, hctx->mctx.bsize )) != ak_error_ok )
+ /* восстанавливаем состояние контекста хеширования после обработки первого блока */
+  if(( error = ak_hmac_load_midstate( hctx, 0 )) != ak_error_ok )
     ak_error_message( error, __func__, "invalid 1st step iteration for hmac key context" );
 
- /* очищаем буффер */
-  ak_ptr_wipe( buffer, sizeof( buffer ), &hctx->key.generator );
-
- /* перемаскируем ключ и меняем его ресурс */
-  hctx->key.set_mask( &hctx->key );
+ /* меняем ресурс ключа */
   hctx->key.resource.value.counter--; /* мы использовали ключ один раз */
 
  return error;
@@ -94,7 +189,12 @@
   if( hctx->key.resource.value.counter <= 0 ) return ak_error_message( ak_error_low_key_resource,
                                             __func__, "using hmac key context with low resource" );
 
-  return ak_hash_update( &hctx->ctx, in, size );
+ /* длина данных кратна длине блока, а их адрес выровнен функцией ak_mac_update(),
+    поэтому при пустом временном буффере контекста хеширования данные передаются
+    функции сжатия напрямую, минуя повторную обработку функцией ak_mac_update() */
+  if( hctx->ctx.mctx.length == 0 )
+    return hctx->ctx.mctx.update( hctx->ctx.mctx.ctx, in, size );
+ return ak_hash_update( &hctx->ctx, in, size );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -112,9 +212,7 @@
 {
   int error = ak_error_ok;
   ak_hmac hctx = ( ak_hmac ) ctx;
-  size_t idx = 0, jdx = 0, len = 0;
-  ak_uint8 temporary[128]; /* первый буффер для хранения промежуточных значений */
-  ak_uint8 keybuffer[128]; /* второй буффер для хранения промежуточных значений */
+  ak_uint8 temporary[128]; /* буффер для хранения промежуточных значений */
 
  /* выполняем проверки */
   if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
@@ -134,27 +232,12 @@
                                                             sizeof( temporary ))) != ak_error_ok )
     return ak_error_message( error, __func__ , "wrong updating of finalized data" );
 
- /* фомируем маскированное значение ключа */
-  len = ak_min( hctx->mctx.bsize, jdx = hctx->key.key_size );
-  for( idx = 0; idx < len; idx++ , jdx++ ) {
-     keybuffer[idx] = hctx->key.key[idx] ^ 0x5C;
-     keybuffer[idx] ^= hctx->key.key[jdx];
-  }
-  for( ; idx < hctx->mctx.bsize; idx++ ) keybuffer[idx] = 0x5C;
-
- /* возвращаем контекст хеширования в начальное состояние */
-  if(( error = ak_hash_clean( &hctx->ctx )) != ak_error_ok )
-    return ak_error_message( error, __func__, "wrong cleaning of hash function context" );
-
- /* обновляем состояние контекста хеширования */
-  if(( error = ak_hash_update( &hctx->ctx, keybuffer, hctx->mctx.bsize )) != ak_error_ok )
+ /* восстанавливаем состояние контекста хеширования после обработки ключа,
+                                                                    сложенного с константой opad */
+  if(( error = ak_hmac_load_midstate( hctx, 1 )) != ak_error_ok )
     return ak_error_message( error, __func__, "invalid 1st step iteration for hmac key context" );
 
- /* очищаем буффер */
-  ak_ptr_wipe( keybuffer, sizeof( keybuffer ), &hctx->key.generator );
-
  /* ресурс ключа */
-  hctx->key.set_mask( &hctx->key );
   hctx->key.resource.value.counter--; /* мы использовали ключ один раз */
 
  /* последний update/finalize и возврат результата */
@@ -187,6 +270,9 @@
  /* проверяем, что OID от алгоритма, а не от параметров */
   if( oid->mode != algorithm )
     return ak_error_message( ak_error_oid_mode, __func__ , "using oid with wrong mode" );
+  if(( error = ak_libakrypt_lazy_test( mac_test_family )) != ak_error_ok )
+    return ak_error_message( error, __func__, "hmac failed dynamic control" );
+  hctx->midstate_set = ak_false;
 
  /* получаем oid бесключевой функции хеширования */
   if(( hashoid = ak_oid_find_by_name( oid->name[0]+5 )) == NULL )
@@ -249,6 +335,12 @@
   int error = ak_error_ok;
   if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                             "using null pointer to hmac context" );
+ /* уничтожаем сохраненные состояния функции хеширования */
+  if( hctx->midstate_set ) {
+    ak_ptr_wipe( hctx->midstate, sizeof( hctx->midstate ), &hctx->key.generator );
+    ak_ptr_wipe( hctx->mask, sizeof( hctx->mask ), &hctx->key.generator );
+    hctx->midstate_set = ak_false;
+  }
   if(( error = ak_hash_destroy( &hctx->ctx )) != ak_error_ok )
     ak_error_message( error, __func__, "incorrect destroying of hash context" );
   if(( error = ak_skey_destroy( &hctx->key )) != ak_error_ok )
@@ -276,6 +368,7 @@
   int error = ak_error_ok;
   if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                             "using null pointer to hmac context" );
+  hctx->midstate_set = ak_false;
  /* вспоминаем, что если ключ длиннее, чем длина входного блока хэш-функции, то в качестве
                                                                       ключа используется его хэш */
   if( size > hctx->mctx.bsize ) {
@@ -300,9 +393,14 @@
   }
 
  /* устанавливаем ресурс ключа */
-  if(( error = ak_skey_set_resource_values( &hctx->key,
-                          key_using_resource, "hmac_key_count_resource", 0, 0 )) != ak_error_ok )
-    ak_error_message( error, __func__, "incorrect assigning \"hmac_key_count_resource\" option" );
+  if(( error = ak_skey_set_resource_counter( &hctx->key, key_using_resource,
+                    ak_libakrypt_get_option( hmac_key_count_resource_option ), 0, 0 )) != ak_error_ok )
+    return ak_error_message( error, __func__,
+                                           "incorrect assigning \"hmac_key_count_resource\" option" );
+
+ /* вычисляем внутренние состояния функции хеширования для нового значения ключа */
+  if(( error = ak_hmac_set_midstates( hctx )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect precomputation of hmac states" );
  return error;
 }
 
@@ -323,13 +421,19 @@
   int error = ak_error_ok;
   if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                         "using null pointer to hmac context" );
+  hctx->midstate_set = ak_false;
   if(( error = ak_skey_set_key_random( &hctx->key, generator )) != ak_error_ok )
     return ak_error_message( error, __func__ , "incorrect assigning a secret key value" );
 
  /* устанавливаем ресурс ключа */
-  if(( error = ak_skey_set_resource_values( &hctx->key,
-                          key_using_resource, "hmac_key_count_resource", 0, 0 )) != ak_error_ok )
-    ak_error_message( error, __func__, "incorrect assigning \"hmac_key_count_resource\" option" );
+  if(( error = ak_skey_set_resource_counter( &hctx->key, key_using_resource,
+                    ak_libakrypt_get_option( hmac_key_count_resource_option ), 0, 0 )) != ak_error_ok )
+    return ak_error_message( error, __func__,
+                                           "incorrect assigning \"hmac_key_count_resource\" option" );
+
+ /* вычисляем внутренние состояния функции хеширования для нового значения ключа */
+  if(( error = ak_hmac_set_midstates( hctx )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect precomputation of hmac states" );
 
  return error;
 }
@@ -358,14 +462,20 @@
   int error = ak_error_ok;
   if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                         "using null pointer to hmac context" );
+  hctx->midstate_set = ak_false;
   if(( error = ak_skey_set_key_from_password( &hctx->key,
                                           pass, pass_size, salt, salt_size )) != ak_error_ok )
     return ak_error_message( error, __func__ , "incorrect assigning a secret key value" );
 
  /* устанавливаем ресурс ключа */
-  if(( error = ak_skey_set_resource_values( &hctx->key,
-                          key_using_resource, "hmac_key_count_resource", 0, 0 )) != ak_error_ok )
-    ak_error_message( error, __func__, "incorrect assigning \"hmac_key_count_resource\" option" );
+  if(( error = ak_skey_set_resource_counter( &hctx->key, key_using_resource,
+                    ak_libakrypt_get_option( hmac_key_count_resource_option ), 0, 0 )) != ak_error_ok )
+    return ak_error_message( error, __func__,
+                                           "incorrect assigning \"hmac_key_count_resource\" option" );
+
+ /* вычисляем внутренние состояния функции хеширования для нового значения ключа */
+  if(( error = ak_hmac_set_midstates( hctx )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect precomputation of hmac states" );
 
  return error;
 }
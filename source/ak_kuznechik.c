@@ -7,6 +7,10 @@
 /* ----------------------------------------------------------------------------------------------- */
  #include <libakrypt-internal.h>
 
+#ifdef AK_HAVE_BUILTIN_SHUFFLE_EPI8
+ #include <immintrin.h>
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Нелинейное биективное преобразование байт, используемое в алгоритмах
     Стрибог (ГОСТ Р 34.11-2012) и Кузнечик (ГОСТ Р 34.12-2015). */
@@ -114,7 +118,12 @@
  typedef ak_uint64 ak_kuznechik_expanded_keys[80];
 
 /* ---------------------------------------------------------------------------------------------- */
- static struct kuznechik_params kuznechik_parameters;
+ static const struct kuznechik_params *kuznechik_parameters = NULL;
+#ifndef AK_HAVE_KUZNECHIK_TABLES
+/*! \brief Таблицы, вычисляемые при инициализации библиотеки (используются в случае,
+    если таблицы не были выработаны на этапе сборки). */
+ static struct kuznechik_params kuznechik_runtime_parameters;
+#endif
 
 /* ---------------------------------------------------------------------------------------------- */
 /*! \brief Функция умножает два элемента конечного поля \f$\mathbb F_{2^8}\f$, определенного
@@ -134,7 +143,7 @@
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция умножает вектор w на матрицу D, результат помещается в вектор x.                */
 /* ----------------------------------------------------------------------------------------------- */
- static void ak_kuznechik_matrix_mul_vector( linear_matrix D, ak_uint8 *w, ak_uint8* x )
+ static void ak_kuznechik_matrix_mul_vector( const linear_matrix D, ak_uint8 *w, ak_uint8* x )
 {
   int i = 0, j = 0;
   for( i = 0; i < 16; i++ ) {
@@ -175,7 +184,7 @@
      ak_uint8 z = w[0];
      for( i = 1; i < 16; i++ ) {
         w[i-1] = w[i];
-        z ^= ak_bckey_context_kuznechik_mul_gf256( w[i], kuznechik_parameters.reg[i] );
+        z ^= ak_bckey_context_kuznechik_mul_gf256( w[i], kuznechik_parameters->reg[i] );
      }
      w[15] = z;
   }
@@ -227,7 +236,7 @@
  int ak_bckey_kuznechik_init_tables( const linear_register reg,
                                                           const sbox pi, ak_kuznechik_params par )
 {
-  int i, j, l, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  int i, j, l, oc = (int) ak_libakrypt_get_option( openssl_compability_option );
 
   if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
                                                 "wrong value for \"openssl_compability\" option" );
@@ -255,14 +264,39 @@
        memcpy( par->dec[i][j], ib, 16 );
      }
   }
+
+ /* таблицы для векторной реализации: произведения элементов матриц на все значения тетрад */
+  for( l = 0; l < 16; l++ ) {
+     for( i = 0; i < 16; i++ ) {
+        for( j = 0; j < 16; j++ ) {
+           par->venc[l][i][j] = ak_bckey_context_kuznechik_mul_gf256( par->L[l][i], (ak_uint8) j );
+           par->venc[l][i][16+j] =
+                        ak_bckey_context_kuznechik_mul_gf256( par->L[l][i], (ak_uint8)( j << 4 ));
+           par->vdec[l][i][j] = ak_bckey_context_kuznechik_mul_gf256( par->Linv[l][i], (ak_uint8) j );
+           par->vdec[l][i][16+j] =
+                     ak_bckey_context_kuznechik_mul_gf256( par->Linv[l][i], (ak_uint8)( j << 4 ));
+        }
+     }
+  }
  return ak_error_ok;
 }
 
 /* ----------------------------------------------------------------------------------------------- */
  int ak_bckey_kuznechik_init_gost_tables( void )
 {
-  int audit = ak_log_get_level(),
-      error = ak_bckey_kuznechik_init_tables( gost_lvec, gost_pi, &kuznechik_parameters );
+  int audit = ak_log_get_level(), error = ak_error_ok;
+#ifdef AK_HAVE_KUZNECHIK_TABLES
+  int oc = (int) ak_libakrypt_get_option( openssl_compability_option );
+
+ /* таблицы уже вычислены на этапе сборки, остается лишь выбрать нужный набор */
+  if(( oc < 0 ) || ( oc > 1 )) error = ak_error_message( ak_error_wrong_option, __func__,
+                                                "wrong value for \"openssl_compability\" option" );
+   else kuznechik_parameters = &kuznechik_gost_parameters[oc];
+#else
+  if(( error = ak_bckey_kuznechik_init_tables( gost_lvec, gost_pi,
+                                        &kuznechik_runtime_parameters )) == ak_error_ok )
+    kuznechik_parameters = &kuznechik_runtime_parameters;
+#endif
 
   if( error != ak_error_ok )
     return ak_error_message( error, __func__,
@@ -313,7 +347,7 @@
   ak_uint8 reverse[64];
   int i = 0, j = 0, l = 0, kdx = 2;
   ak_uint64 a0[2], a1[2], c[2], t[2], idx = 0;
-  ak_int64 oc = ak_libakrypt_get_option_by_name( "openssl_compability" );
+  ak_int64 oc = ak_libakrypt_get_option( openssl_compability_option );
   ak_uint64 *ekey = NULL, *mkey = NULL, *dkey = NULL, *xkey = NULL, *rkey = NULL, *lkey = NULL;
 
  /* выполняем стандартные проверки */
@@ -359,7 +393,7 @@
   dkey[0] = a1[0]^xkey[0]; dkey[1] = a1[1]^xkey[1];
 
   ekey[2] = a0[0]^mkey[2]; ekey[3] = a0[1]^mkey[3];
-  ak_kuznechik_matrix_mul_vector( kuznechik_parameters.Linv,
+  ak_kuznechik_matrix_mul_vector( kuznechik_parameters->Linv,
                                             (ak_uint8 *)a0, (ak_uint8 *)( dkey+2 ));
   dkey[2] ^= xkey[2]; dkey[3] ^= xkey[3];
 
@@ -374,7 +408,7 @@
         ak_kuznechik_linear_steps(( ak_uint8 *)c );
 
         t[0] = a1[0] ^ c[0]; t[1] = a1[1] ^ c[1];
-        for( l = 0; l < 16; l++ ) ((ak_uint8 *)t)[l] = kuznechik_parameters.pi[ ((ak_uint8 *)t)[l]];
+        for( l = 0; l < 16; l++ ) ((ak_uint8 *)t)[l] = kuznechik_parameters->pi[ ((ak_uint8 *)t)[l]];
         ak_kuznechik_linear_steps(( ak_uint8 *)t );
 
         t[0] ^= a0[0]; t[1] ^= a0[1];
@@ -383,13 +417,13 @@
      }
      kdx += 2;
      ekey[kdx] = a1[0]^mkey[kdx]; ekey[kdx+1] = a1[1]^mkey[kdx+1];
-     ak_kuznechik_matrix_mul_vector( kuznechik_parameters.Linv,
+     ak_kuznechik_matrix_mul_vector( kuznechik_parameters->Linv,
                                          ( ak_uint8 *)a1, (ak_uint8 *)( dkey+kdx ));
      dkey[kdx] ^= xkey[kdx]; dkey[kdx+1] ^= xkey[kdx+1];
 
      kdx += 2;
      ekey[kdx] = a0[0]^mkey[kdx]; ekey[kdx+1] = a0[1]^mkey[kdx+1];
-     ak_kuznechik_matrix_mul_vector( kuznechik_parameters.Linv,
+     ak_kuznechik_matrix_mul_vector( kuznechik_parameters->Linv,
                                          ( ak_uint8 *)a0, (ak_uint8 *)( dkey+kdx ));
      dkey[kdx] ^= xkey[kdx]; dkey[kdx+1] ^= xkey[kdx+1];
   }
@@ -434,39 +468,39 @@
      x[0] ^= ekey[i]; x[0] ^= mkey[i];
      x[1] ^= ekey[++i]; x[1] ^= mkey[i++];
 
-     t  = kuznechik_parameters.enc[ 0][b[ 0]][0];
-     t ^= kuznechik_parameters.enc[ 1][b[ 1]][0];
-     t ^= kuznechik_parameters.enc[ 2][b[ 2]][0];
-     t ^= kuznechik_parameters.enc[ 3][b[ 3]][0];
-     t ^= kuznechik_parameters.enc[ 4][b[ 4]][0];
-     t ^= kuznechik_parameters.enc[ 5][b[ 5]][0];
-     t ^= kuznechik_parameters.enc[ 6][b[ 6]][0];
-     t ^= kuznechik_parameters.enc[ 7][b[ 7]][0];
-     t ^= kuznechik_parameters.enc[ 8][b[ 8]][0];
-     t ^= kuznechik_parameters.enc[ 9][b[ 9]][0];
-     t ^= kuznechik_parameters.enc[10][b[10]][0];
-     t ^= kuznechik_parameters.enc[11][b[11]][0];
-     t ^= kuznechik_parameters.enc[12][b[12]][0];
-     t ^= kuznechik_parameters.enc[13][b[13]][0];
-     t ^= kuznechik_parameters.enc[14][b[14]][0];
-     t ^= kuznechik_parameters.enc[15][b[15]][0];
-
-     s  = kuznechik_parameters.enc[ 0][b[ 0]][1];
-     s ^= kuznechik_parameters.enc[ 1][b[ 1]][1];
-     s ^= kuznechik_parameters.enc[ 2][b[ 2]][1];
-     s ^= kuznechik_parameters.enc[ 3][b[ 3]][1];
-     s ^= kuznechik_parameters.enc[ 4][b[ 4]][1];
-     s ^= kuznechik_parameters.enc[ 5][b[ 5]][1];
-     s ^= kuznechik_parameters.enc[ 6][b[ 6]][1];
-     s ^= kuznechik_parameters.enc[ 7][b[ 7]][1];
-     s ^= kuznechik_parameters.enc[ 8][b[ 8]][1];
-     s ^= kuznechik_parameters.enc[ 9][b[ 9]][1];
-     s ^= kuznechik_parameters.enc[10][b[10]][1];
-     s ^= kuznechik_parameters.enc[11][b[11]][1];
-     s ^= kuznechik_parameters.enc[12][b[12]][1];
-     s ^= kuznechik_parameters.enc[13][b[13]][1];
-     s ^= kuznechik_parameters.enc[14][b[14]][1];
-     s ^= kuznechik_parameters.enc[15][b[15]][1];
+     t  = kuznechik_parameters->enc[ 0][b[ 0]][0];
+     t ^= kuznechik_parameters->enc[ 1][b[ 1]][0];
+     t ^= kuznechik_parameters->enc[ 2][b[ 2]][0];
+     t ^= kuznechik_parameters->enc[ 3][b[ 3]][0];
+     t ^= kuznechik_parameters->enc[ 4][b[ 4]][0];
+     t ^= kuznechik_parameters->enc[ 5][b[ 5]][0];
+     t ^= kuznechik_parameters->enc[ 6][b[ 6]][0];
+     t ^= kuznechik_parameters->enc[ 7][b[ 7]][0];
+     t ^= kuznechik_parameters->enc[ 8][b[ 8]][0];
+     t ^= kuznechik_parameters->enc[ 9][b[ 9]][0];
+     t ^= kuznechik_parameters->enc[10][b[10]][0];
+     t ^= kuznechik_parameters->enc[11][b[11]][0];
+     t ^= kuznechik_parameters->enc[12][b[12]][0];
+     t ^= kuznechik_parameters->enc[13][b[13]][0];
+     t ^= kuznechik_parameters->enc[14][b[14]][0];
+     t ^= kuznechik_parameters->enc[15][b[15]][0];
+
+     s  = kuznechik_parameters->enc[ 0][b[ 0]][1];
+     s ^= kuznechik_parameters->enc[ 1][b[ 1]][1];
+     s ^= kuznechik_parameters->enc[ 2][b[ 2]][1];
+     s ^= kuznechik_parameters->enc[ 3][b[ 3]][1];
+     s ^= kuznechik_parameters->enc[ 4][b[ 4]][1];
+     s ^= kuznechik_parameters->enc[ 5][b[ 5]][1];
+     s ^= kuznechik_parameters->enc[ 6][b[ 6]][1];
+     s ^= kuznechik_parameters->enc[ 7][b[ 7]][1];
+     s ^= kuznechik_parameters->enc[ 8][b[ 8]][1];
+     s ^= kuznechik_parameters->enc[ 9][b[ 9]][1];
+     s ^= kuznechik_parameters->enc[10][b[10]][1];
+     s ^= kuznechik_parameters->enc[11][b[11]][1];
+     s ^= kuznechik_parameters->enc[12][b[12]][1];
+     s ^= kuznechik_parameters->enc[13][b[13]][1];
+     s ^= kuznechik_parameters->enc[14][b[14]][1];
+     s ^= kuznechik_parameters->enc[15][b[15]][1];
 
      x[0] = t; x[1] = s;
   }
@@ -489,50 +523,50 @@
   ak_uint64 t, s, x[2];
   ak_uint8 *b = ( ak_uint8 *)x;
  x[0] = (( ak_uint64 *) in)[0]; x[1] = (( ak_uint64 *) in)[1];
-  for( i = 0; i < 16; i++ ) b[i] = kuznechik_parameters.pi[b[i]];
+  for( i = 0; i < 16; i++ ) b[i] = kuznechik_parameters->pi[b[i]];
 
   i = 19;
   while( i > 1 ) {
-     t  = kuznechik_parameters.dec[ 0][b[ 0]][0];
-     t ^= kuznechik_parameters.dec[ 1][b[ 1]][0];
-     t ^= kuznechik_parameters.dec[ 2][b[ 2]][0];
-     t ^= kuznechik_parameters.dec[ 3][b[ 3]][0];
-     t ^= kuznechik_parameters.dec[ 4][b[ 4]][0];
-     t ^= kuznechik_parameters.dec[ 5][b[ 5]][0];
-     t ^= kuznechik_parameters.dec[ 6][b[ 6]][0];
-     t ^= kuznechik_parameters.dec[ 7][b[ 7]][0];
-     t ^= kuznechik_parameters.dec[ 8][b[ 8]][0];
-     t ^= kuznechik_parameters.dec[ 9][b[ 9]][0];
-     t ^= kuznechik_parameters.dec[10][b[10]][0];
-     t ^= kuznechik_parameters.dec[11][b[11]][0];
-     t ^= kuznechik_parameters.dec[12][b[12]][0];
-     t ^= kuznechik_parameters.dec[13][b[13]][0];
-     t ^= kuznechik_parameters.dec[14][b[14]][0];
-     t ^= kuznechik_parameters.dec[15][b[15]][0];
-
-     s  = kuznechik_parameters.dec[ 0][b[ 0]][1];
-     s ^= kuznechik_parameters.dec[ 1][b[ 1]][1];
-     s ^= kuznechik_parameters.dec[ 2][b[ 2]][1];
-     s ^= kuznechik_parameters.dec[ 3][b[ 3]][1];
-     s ^= kuznechik_parameters.dec[ 4][b[ 4]][1];
-     s ^= kuznechik_parameters.dec[ 5][b[ 5]][1];
-     s ^= kuznechik_parameters.dec[ 6][b[ 6]][1];
-     s ^= kuznechik_parameters.dec[ 7][b[ 7]][1];
-     s ^= kuznechik_parameters.dec[ 8][b[ 8]][1];
-     s ^= kuznechik_parameters.dec[ 9][b[ 9]][1];
-     s ^= kuznechik_parameters.dec[10][b[10]][1];
-     s ^= kuznechik_parameters.dec[11][b[11]][1];
-     s ^= kuznechik_parameters.dec[12][b[12]][1];
-     s ^= kuznechik_parameters.dec[13][b[13]][1];
-     s ^= kuznechik_parameters.dec[14][b[14]][1];
-     s ^= kuznechik_parameters.dec[15][b[15]][1];
+     t  = kuznechik_parameters->dec[ 0][b[ 0]][0];
+     t ^= kuznechik_parameters->dec[ 1][b[ 1]][0];
+     t ^= kuznechik_parameters->dec[ 2][b[ 2]][0];
+     t ^= kuznechik_parameters->dec[ 3][b[ 3]][0];
+     t ^= kuznechik_parameters->dec[ 4][b[ 4]][0];
+     t ^= kuznechik_parameters->dec[ 5][b[ 5]][0];
+     t ^= kuznechik_parameters->dec[ 6][b[ 6]][0];
+     t ^= kuznechik_parameters->dec[ 7][b[ 7]][0];
+     t ^= kuznechik_parameters->dec[ 8][b[ 8]][0];
+     t ^= kuznechik_parameters->dec[ 9][b[ 9]][0];
+     t ^= kuznechik_parameters->dec[10][b[10]][0];
+     t ^= kuznechik_parameters->dec[11][b[11]][0];
+     t ^= kuznechik_parameters->dec[12][b[12]][0];
+     t ^= kuznechik_parameters->dec[13][b[13]][0];
+     t ^= kuznechik_parameters->dec[14][b[14]][0];
+     t ^= kuznechik_parameters->dec[15][b[15]][0];
+
+     s  = kuznechik_parameters->dec[ 0][b[ 0]][1];
+     s ^= kuznechik_parameters->dec[ 1][b[ 1]][1];
+     s ^= kuznechik_parameters->dec[ 2][b[ 2]][1];
+     s ^= kuznechik_parameters->dec[ 3][b[ 3]][1];
+     s ^= kuznechik_parameters->dec[ 4][b[ 4]][1];
+     s ^= kuznechik_parameters->dec[ 5][b[ 5]][1];
+     s ^= kuznechik_parameters->dec[ 6][b[ 6]][1];
+     s ^= kuznechik_parameters->dec[ 7][b[ 7]][1];
+     s ^= kuznechik_parameters->dec[ 8][b[ 8]][1];
+     s ^= kuznechik_parameters->dec[ 9][b[ 9]][1];
+     s ^= kuznechik_parameters->dec[10][b[10]][1];
+     s ^= kuznechik_parameters->dec[11][b[11]][1];
+     s ^= kuznechik_parameters->dec[12][b[12]][1];
+     s ^= kuznechik_parameters->dec[13][b[13]][1];
+     s ^= kuznechik_parameters->dec[14][b[14]][1];
+     s ^= kuznechik_parameters->dec[15][b[15]][1];
 
      x[0] = t; x[1] = s;
 
      x[1] ^= dkey[i]; x[1] ^= xkey[i--];
      x[0] ^= dkey[i]; x[0] ^= xkey[i--];
   }
-  for( i = 0; i < 16; i++ ) b[i] = kuznechik_parameters.pinv[b[i]];
+  for( i = 0; i < 16; i++ ) b[i] = kuznechik_parameters->pinv[b[i]];
 
   x[0] ^= dkey[0]; x[1] ^= dkey[1];
   (( ak_uint64 *) out)[0] = x[0] ^ xkey[0];
@@ -561,39 +595,39 @@
      x[0] ^= ekey[i]; x[0] ^= mkey[i];
      x[1] ^= ekey[++i]; x[1] ^= mkey[i++];
 
-     t  = kuznechik_parameters.enc[ 0][b[15]][0];
-     t ^= kuznechik_parameters.enc[ 1][b[14]][0];
-     t ^= kuznechik_parameters.enc[ 2][b[13]][0];
-     t ^= kuznechik_parameters.enc[ 3][b[12]][0];
-     t ^= kuznechik_parameters.enc[ 4][b[11]][0];
-     t ^= kuznechik_parameters.enc[ 5][b[10]][0];
-     t ^= kuznechik_parameters.enc[ 6][b[ 9]][0];
-     t ^= kuznechik_parameters.enc[ 7][b[ 8]][0];
-     t ^= kuznechik_parameters.enc[ 8][b[ 7]][0];
-     t ^= kuznechik_parameters.enc[ 9][b[ 6]][0];
-     t ^= kuznechik_parameters.enc[10][b[ 5]][0];
-     t ^= kuznechik_parameters.enc[11][b[ 4]][0];
-     t ^= kuznechik_parameters.enc[12][b[ 3]][0];
-     t ^= kuznechik_parameters.enc[13][b[ 2]][0];
-     t ^= kuznechik_parameters.enc[14][b[ 1]][0];
-     t ^= kuznechik_parameters.enc[15][b[ 0]][0];
-
-     s  = kuznechik_parameters.enc[ 0][b[15]][1];
-     s ^= kuznechik_parameters.enc[ 1][b[14]][1];
-     s ^= kuznechik_parameters.enc[ 2][b[13]][1];
-     s ^= kuznechik_parameters.enc[ 3][b[12]][1];
-     s ^= kuznechik_parameters.enc[ 4][b[11]][1];
-     s ^= kuznechik_parameters.enc[ 5][b[10]][1];
-     s ^= kuznechik_parameters.enc[ 6][b[ 9]][1];
-     s ^= kuznechik_parameters.enc[ 7][b[ 8]][1];
-     s ^= kuznechik_parameters.enc[ 8][b[ 7]][1];
-     s ^= kuznechik_parameters.enc[ 9][b[ 6]][1];
-     s ^= kuznechik_parameters.enc[10][b[ 5]][1];
-     s ^= kuznechik_parameters.enc[11][b[ 4]][1];
-     s ^= kuznechik_parameters.enc[12][b[ 3]][1];
-     s ^= kuznechik_parameters.enc[13][b[ 2]][1];
-     s ^= kuznechik_parameters.enc[14][b[ 1]][1];
-     s ^= kuznechik_parameters.enc[15][b[ 0]][1];
+     t  = kuznechik_parameters->enc[ 0][b[15]][0];
+     t ^= kuznechik_parameters->enc[ 1][b[14]][0];
+     t ^= kuznechik_parameters->enc[ 2][b[13]][0];
+     t ^= kuznechik_parameters->enc[ 3][b[12]][0];
+     t ^= kuznechik_parameters->enc[ 4][b[11]][0];
+     t ^= kuznechik_parameters->enc[ 5][b[10]][0];
+     t ^= kuznechik_parameters->enc[ 6][b[ 9]][0];
+     t ^= kuznechik_parameters->enc[ 7][b[ 8]][0];
+     t ^= kuznechik_parameters->enc[ 8][b[ 7]][0];
+     t ^= kuznechik_parameters->enc[ 9][b[ 6]][0];
+     t ^= kuznechik_parameters->enc[10][b[ 5]][0];
+     t ^= kuznechik_parameters->enc[11][b[ 4]][0];
+     t ^= kuznechik_parameters->enc[12][b[ 3]][0];
+     t ^= kuznechik_parameters->enc[13][b[ 2]][0];
+     t ^= kuznechik_parameters->enc[14][b[ 1]][0];
+     t ^= kuznechik_parameters->enc[15][b[ 0]][0];
+
+     s  = kuznechik_parameters->enc[ 0][b[15]][1];
+     s ^= kuznechik_parameters->enc[ 1][b[14]][1];
+     s ^= kuznechik_parameters->enc[ 2][b[13]][1];
+     s ^= kuznechik_parameters->enc[ 3][b[12]][1];
+     s ^= kuznechik_parameters->enc[ 4][b[11]][1];
+     s ^= kuznechik_parameters->enc[ 5][b[10]][1];
+     s ^= kuznechik_parameters->enc[ 6][b[ 9]][1];
+     s ^= kuznechik_parameters->enc[ 7][b[ 8]][1];
+     s ^= kuznechik_parameters->enc[ 8][b[ 7]][1];
+     s ^= kuznechik_parameters->enc[ 9][b[ 6]][1];
+     s ^= kuznechik_parameters->enc[10][b[ 5]][1];
+     s ^= kuznechik_parameters->enc[11][b[ 4]][1];
+     s ^= kuznechik_parameters->enc[12][b[ 3]][1];
+     s ^= kuznechik_parameters->enc[13][b[ 2]][1];
+     s ^= kuznechik_parameters->enc[14][b[ 1]][1];
+     s ^= kuznechik_parameters->enc[15][b[ 0]][1];
 
      x[0] = t; x[1] = s;
   }
@@ -620,56 +654,499 @@
   ak_uint8 *b = ( ak_uint8 *)x;
 
   x[0] = (( ak_uint64 *) in)[0]; x[1] = (( ak_uint64 *) in)[1];
-  for( i = 0; i < 16; i++ ) b[i] = kuznechik_parameters.pi[b[i]];
+  for( i = 0; i < 16; i++ ) b[i] = kuznechik_parameters->pi[b[i]];
 
   i = 19;
   while( i > 1 ) {
-     t  = kuznechik_parameters.dec[ 0][b[15]][0];
-     t ^= kuznechik_parameters.dec[ 1][b[14]][0];
-     t ^= kuznechik_parameters.dec[ 2][b[13]][0];
-     t ^= kuznechik_parameters.dec[ 3][b[12]][0];
-     t ^= kuznechik_parameters.dec[ 4][b[11]][0];
-     t ^= kuznechik_parameters.dec[ 5][b[10]][0];
-     t ^= kuznechik_parameters.dec[ 6][b[ 9]][0];
-     t ^= kuznechik_parameters.dec[ 7][b[ 8]][0];
-     t ^= kuznechik_parameters.dec[ 8][b[ 7]][0];
-     t ^= kuznechik_parameters.dec[ 9][b[ 6]][0];
-     t ^= kuznechik_parameters.dec[10][b[ 5]][0];
-     t ^= kuznechik_parameters.dec[11][b[ 4]][0];
-     t ^= kuznechik_parameters.dec[12][b[ 3]][0];
-     t ^= kuznechik_parameters.dec[13][b[ 2]][0];
-     t ^= kuznechik_parameters.dec[14][b[ 1]][0];
-     t ^= kuznechik_parameters.dec[15][b[ 0]][0];
-
-     s  = kuznechik_parameters.dec[ 0][b[15]][1];
-     s ^= kuznechik_parameters.dec[ 1][b[14]][1];
-     s ^= kuznechik_parameters.dec[ 2][b[13]][1];
-     s ^= kuznechik_parameters.dec[ 3][b[12]][1];
-     s ^= kuznechik_parameters.dec[ 4][b[11]][1];
-     s ^= kuznechik_parameters.dec[ 5][b[10]][1];
-     s ^= kuznechik_parameters.dec[ 6][b[ 9]][1];
-     s ^= kuznechik_parameters.dec[ 7][b[ 8]][1];
-     s ^= kuznechik_parameters.dec[ 8][b[ 7]][1];
-     s ^= kuznechik_parameters.dec[ 9][b[ 6]][1];
-     s ^= kuznechik_parameters.dec[10][b[ 5]][1];
-     s ^= kuznechik_parameters.dec[11][b[ 4]][1];
-     s ^= kuznechik_parameters.dec[12][b[ 3]][1];
-     s ^= kuznechik_parameters.dec[13][b[ 2]][1];
-     s ^= kuznechik_parameters.dec[14][b[ 1]][1];
-     s ^= kuznechik_parameters.dec[15][b[ 0]][1];
+     t  = kuznechik_parameters->dec[ 0][b[15]][0];
+     t ^= kuznechik_parameters->dec[ 1][b[14]][0];
+     t ^= kuznechik_parameters->dec[ 2][b[13]][0];
+     t ^= kuznechik_parameters->dec[ 3][b[12]][0];
+     t ^= kuznechik_parameters->dec[ 4][b[11]][0];
+     t ^= kuznechik_parameters->dec[ 5][b[10]][0];
+     t ^= kuznechik_parameters->dec[ 6][b[ 9]][0];
+     t ^= kuznechik_parameters->dec[ 7][b[ 8]][0];
+     t ^= kuznechik_parameters->dec[ 8][b[ 7]][0];
+     t ^= kuznechik_parameters->dec[ 9][b[ 6]][0];
+     t ^= kuznechik_parameters->dec[10][b[ 5]][0];
+     t ^= kuznechik_parameters->dec[11][b[ 4]][0];
+     t ^= kuznechik_parameters->dec[12][b[ 3]][0];
+     t ^= kuznechik_parameters->dec[13][b[ 2]][0];
+     t ^= kuznechik_parameters->dec[14][b[ 1]][0];
+     t ^= kuznechik_parameters->dec[15][b[ 0]][0];
+
+     s  = kuznechik_parameters->dec[ 0][b[15]][1];
+     s ^= kuznechik_parameters->dec[ 1][b[14]][1];
+     s ^= kuznechik_parameters->dec[ 2][b[13]][1];
+     s ^= kuznechik_parameters->dec[ 3][b[12]][1];
+     s ^= kuznechik_parameters->dec[ 4][b[11]][1];
+     s ^= kuznechik_parameters->dec[ 5][b[10]][1];
+     s ^= kuznechik_parameters->dec[ 6][b[ 9]][1];
+     s ^= kuznechik_parameters->dec[ 7][b[ 8]][1];
+     s ^= kuznechik_parameters->dec[ 8][b[ 7]][1];
+     s ^= kuznechik_parameters->dec[ 9][b[ 6]][1];
+     s ^= kuznechik_parameters->dec[10][b[ 5]][1];
+     s ^= kuznechik_parameters->dec[11][b[ 4]][1];
+     s ^= kuznechik_parameters->dec[12][b[ 3]][1];
+     s ^= kuznechik_parameters->dec[13][b[ 2]][1];
+     s ^= kuznechik_parameters->dec[14][b[ 1]][1];
+     s ^= kuznechik_parameters->dec[15][b[ 0]][1];
 
      x[0] = t; x[1] = s;
 
      x[1] ^= dkey[i]; x[1] ^= xkey[i--];
      x[0] ^= dkey[i]; x[0] ^= xkey[i--];
   }
-  for( i = 0; i < 16; i++ ) b[i] = kuznechik_parameters.pinv[b[i]];
+  for( i = 0; i < 16; i++ ) b[i] = kuznechik_parameters->pinv[b[i]];
 
   x[0] ^= dkey[0]; x[1] ^= dkey[1];
   (( ak_uint64 *) out)[0] = x[0] ^ xkey[0];
   (( ak_uint64 *) out)[1] = x[1] ^ xkey[1];
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                  одновременная обработка нескольких независимых блоков данных                   */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Максимальное количество блоков, обрабатываемых одновременно. */
+ #define ak_kuznechik_blocks_count  (4)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует алгоритм зашифрования последовательности независимых блоков
+    информации шифром Кузнечик (согласно ГОСТ Р 34.12-2015).
+
+    Блоки обрабатываются группами, содержащими не более \ref ak_kuznechik_blocks_count блоков;
+    раунды преобразования для блоков группы выполняются попеременно. Это позволяет совместить
+    по времени обращения к таблицам, выполняемые для различных блоков.
+
+    \param skey Контекст секретного ключа.
+    \param in Указатель на входные данные.
+    \param out Указатель на область памяти, куда помещается результат (может совпадать с `in`).
+    \param blocks Количество обрабатываемых блоков.
+    \param oc Флаг совместимости с библиотекой openssl.                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_kuznechik_encrypt_blocks_with_mask_common( ak_skey skey,
+                              ak_pointer in, ak_pointer out, size_t blocks, const unsigned int oc )
+{
+  int i = 0, j = 0;
+  size_t k = 0, n = 0;
+  const ak_uint64 *e = NULL;
+  ak_uint64 *ekey = ( ak_uint64 *)skey->data;
+  ak_uint64 *mkey = ( ak_uint64 *)skey->data + 40;
+  ak_uint64 *inptr = ( ak_uint64 *)in, *outptr = ( ak_uint64 *)out;
+  ak_uint64 t[ak_kuznechik_blocks_count][2], x[ak_kuznechik_blocks_count][2];
+
+  while( blocks > 0 ) {
+     n = ak_min( blocks, ak_kuznechik_blocks_count );
+     for( k = 0; k < n; k++ ) { x[k][0] = inptr[2*k]; x[k][1] = inptr[2*k+1]; }
+
+     for( i = 0; i < 18; i += 2 ) {
+        for( k = 0; k < n; k++ ) {
+           x[k][0] ^= ekey[i]; x[k][0] ^= mkey[i];
+           x[k][1] ^= ekey[i+1]; x[k][1] ^= mkey[i+1];
+           t[k][0] = t[k][1] = 0;
+        }
+       /* для каждой позиции байта выполняем независимые обращения к таблице для всех блоков */
+        for( j = 0; j < 16; j++ ) {
+           for( k = 0; k < n; k++ ) {
+              e = kuznechik_parameters->enc[j][((ak_uint8 *)x[k])[oc ? 15-j : j]];
+              t[k][0] ^= e[0]; t[k][1] ^= e[1];
+           }
+        }
+        for( k = 0; k < n; k++ ) { x[k][0] = t[k][0]; x[k][1] = t[k][1]; }
+     }
+
+     for( k = 0; k < n; k++ ) {
+        x[k][0] ^= ekey[18]; x[k][1] ^= ekey[19];
+        outptr[2*k] = x[k][0] ^ mkey[18];
+        outptr[2*k+1] = x[k][1] ^ mkey[19];
+     }
+     blocks -= n; inptr += 2*n; outptr += 2*n;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует алгоритм расшифрования последовательности независимых блоков
+    информации шифром Кузнечик (согласно ГОСТ Р 34.12-2015).
+
+    \param skey Контекст секретного ключа.
+    \param in Указатель на входные данные.
+    \param out Указатель на область памяти, куда помещается результат (может совпадать с `in`).
+    \param blocks Количество обрабатываемых блоков.
+    \param oc Флаг совместимости с библиотекой openssl.                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_kuznechik_decrypt_blocks_with_mask_common( ak_skey skey,
+                              ak_pointer in, ak_pointer out, size_t blocks, const unsigned int oc )
+{
+  int i = 0, j = 0;
+  size_t k = 0, n = 0;
+  const ak_uint64 *e = NULL;
+  ak_uint64 *dkey = ( ak_uint64 *)skey->data + 20;
+  ak_uint64 *xkey = ( ak_uint64 *)skey->data + 60;
+  ak_uint64 *inptr = ( ak_uint64 *)in, *outptr = ( ak_uint64 *)out;
+  ak_uint64 t[ak_kuznechik_blocks_count][2], x[ak_kuznechik_blocks_count][2];
+
+  while( blocks > 0 ) {
+     n = ak_min( blocks, ak_kuznechik_blocks_count );
+     for( k = 0; k < n; k++ ) {
+        x[k][0] = inptr[2*k]; x[k][1] = inptr[2*k+1];
+        for( j = 0; j < 16; j++ )
+           ((ak_uint8 *)x[k])[j] = kuznechik_parameters->pi[((ak_uint8 *)x[k])[j]];
+     }
+
+     for( i = 19; i > 1; i -= 2 ) {
+        for( k = 0; k < n; k++ ) t[k][0] = t[k][1] = 0;
+        for( j = 0; j < 16; j++ ) {
+           for( k = 0; k < n; k++ ) {
+              e = kuznechik_parameters->dec[j][((ak_uint8 *)x[k])[oc ? 15-j : j]];
+              t[k][0] ^= e[0]; t[k][1] ^= e[1];
+           }
+        }
+        for( k = 0; k < n; k++ ) {
+           x[k][1] = t[k][1]; x[k][1] ^= dkey[i]; x[k][1] ^= xkey[i];
+           x[k][0] = t[k][0]; x[k][0] ^= dkey[i-1]; x[k][0] ^= xkey[i-1];
+        }
+     }
+
+     for( k = 0; k < n; k++ ) {
+        for( j = 0; j < 16; j++ )
+           ((ak_uint8 *)x[k])[j] = kuznechik_parameters->pinv[((ak_uint8 *)x[k])[j]];
+        x[k][0] ^= dkey[0]; x[k][1] ^= dkey[1];
+        outptr[2*k] = x[k][0] ^ xkey[0];
+        outptr[2*k+1] = x[k][1] ^ xkey[1];
+     }
+     blocks -= n; inptr += 2*n; outptr += 2*n;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Зашифрование последовательности независимых блоков шифром Кузнечик. */
+ static void ak_kuznechik_encrypt_blocks_with_mask( ak_skey skey,
+                                                 ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_kuznechik_encrypt_blocks_with_mask_common( skey, in, out, blocks, 0 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Расшифрование последовательности независимых блоков шифром Кузнечик. */
+ static void ak_kuznechik_decrypt_blocks_with_mask( ak_skey skey,
+                                                 ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_kuznechik_decrypt_blocks_with_mask_common( skey, in, out, blocks, 0 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Зашифрование последовательности независимых блоков шифром Кузнечик
+    в режиме совместимости с библиотекой openssl. */
+ static void ak_kuznechik_encrypt_blocks_with_mask_oc( ak_skey skey,
+                                                 ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_kuznechik_encrypt_blocks_with_mask_common( skey, in, out, blocks, 1 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Расшифрование последовательности независимых блоков шифром Кузнечик
+    в режиме совместимости с библиотекой openssl. */
+ static void ak_kuznechik_decrypt_blocks_with_mask_oc( ak_skey skey,
+                                                 ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_kuznechik_decrypt_blocks_with_mask_common( skey, in, out, blocks, 1 );
+}
+
+#ifdef AK_HAVE_BUILTIN_SHUFFLE_EPI8
+/* ----------------------------------------------------------------------------------------------- */
+/*            векторная реализация, использующая перестановки байт в регистрах SSSE3/AVX2          */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество блоков, обрабатываемых одновременно в 128-ми битных регистрах. */
+ #define ak_kuznechik_vperm128_lanes  (16)
+/*! \brief Количество блоков, обрабатываемых одновременно в 256-ти битных регистрах. */
+ #define ak_kuznechik_vperm256_lanes  (32)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Нелинейное преобразование 16-ти байт, выполняемое без обращений к памяти,
+    зависящих от преобразуемых данных.
+
+    Таблица замен рассматривается как 16 строк по 16 байт; для каждой строки h вычисляется
+    индекс, старший бит которого обнуляет результат инструкции pshufb для всех байт,
+    у которых старшая тетрада отлична от h.                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline __attribute__((target("ssse3")))
+                                         __m128i ak_kuznechik_vperm128_sbox( __m128i x, const sbox pi )
+{
+  int h;
+  __m128i idx, r = _mm_setzero_si128(), bias = _mm_set1_epi8( 0x70 );
+
+  for( h = 0; h < 16; h++ ) {
+     idx = _mm_adds_epu8( _mm_xor_si128( x, _mm_set1_epi8( (char)( h << 4 ))), bias );
+     r = _mm_xor_si128( r,
+                   _mm_shuffle_epi8( _mm_loadu_si128(( const __m128i *)( pi + ( h << 4 ))), idx ));
+  }
+ return r;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Линейное преобразование: i-й регистр содержит i-е байты всех обрабатываемых блоков,
+    умножение на константу поля выполняется двумя инструкциями pshufb (по тетрадам).               */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline __attribute__((target("ssse3")))
+                                      void ak_kuznechik_vperm128_linear( __m128i *x, const shuffle_table tab )
+{
+  int i, l;
+  __m128i lo[16], hi[16], y, m = _mm_set1_epi8( 0x0f );
+
+  for( i = 0; i < 16; i++ ) {
+     lo[i] = _mm_and_si128( x[i], m );
+     hi[i] = _mm_and_si128( _mm_srli_epi16( x[i], 4 ), m );
+  }
+  for( l = 0; l < 16; l++ ) {
+     y = _mm_setzero_si128();
+     for( i = 0; i < 16; i++ ) {
+        y = _mm_xor_si128( y,
+                 _mm_shuffle_epi8( _mm_loadu_si128(( const __m128i *) tab[l][i] ), lo[i] ));
+        y = _mm_xor_si128( y,
+                 _mm_shuffle_epi8( _mm_loadu_si128(( const __m128i *)( tab[l][i] +16 )), hi[i] ));
+     }
+     x[l] = y;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Сложение с раундовым ключом и его маской (ключ и маска прибавляются по-отдельности). */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline __attribute__((target("ssse3")))
+  void ak_kuznechik_vperm128_add_key( __m128i *x,
+                                    const ak_uint8 *key, const ak_uint8 *mask, const unsigned int oc )
+{
+  int l;
+  for( l = 0; l < 16; l++ ) {
+     x[l] = _mm_xor_si128( x[l], _mm_set1_epi8( (char) key[oc ? 15-l : l] ));
+     x[l] = _mm_xor_si128( x[l], _mm_set1_epi8( (char) mask[oc ? 15-l : l] ));
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Зашифрование (расшифрование) до 16-ти блоков, предварительно транспонированных
+    в массив st (st[i][k] есть i-й байт k-го блока).                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static __attribute__((target("ssse3"))) void ak_kuznechik_vperm128( ak_skey skey,
+                              ak_uint8 st[16][ak_kuznechik_vperm256_lanes], const unsigned int oc,
+                                                                             const bool_t decrypt )
+{
+  int i, r;
+  __m128i x[16];
+  const ak_uint8 *ekey = ( const ak_uint8 *)skey->data;
+  const ak_uint8 *mkey = ( const ak_uint8 *)(( ak_uint64 *)skey->data + 40 );
+
+  for( i = 0; i < 16; i++ ) x[i] = _mm_loadu_si128(( const __m128i *) st[i] );
+  if( decrypt ) {
+    ak_kuznechik_vperm128_add_key( x, ekey + 144, mkey + 144, oc );
+    for( r = 8; r >= 0; r-- ) {
+       ak_kuznechik_vperm128_linear( x, kuznechik_parameters->vdec );
+       for( i = 0; i < 16; i++ ) x[i] = ak_kuznechik_vperm128_sbox( x[i], kuznechik_parameters->pinv );
+       ak_kuznechik_vperm128_add_key( x, ekey + 16*r, mkey + 16*r, oc );
+    }
+  } else {
+     for( r = 0; r < 9; r++ ) {
+        ak_kuznechik_vperm128_add_key( x, ekey + 16*r, mkey + 16*r, oc );
+        for( i = 0; i < 16; i++ ) x[i] = ak_kuznechik_vperm128_sbox( x[i], kuznechik_parameters->pi );
+        ak_kuznechik_vperm128_linear( x, kuznechik_parameters->venc );
+     }
+     ak_kuznechik_vperm128_add_key( x, ekey + 144, mkey + 144, oc );
+    }
+  for( i = 0; i < 16; i++ ) _mm_storeu_si128(( __m128i *) st[i], x[i] );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Нелинейное преобразование 32-х байт (аналог функции ak_kuznechik_vperm128_sbox()). */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline __attribute__((target("avx2")))
+                                         __m256i ak_kuznechik_vperm256_sbox( __m256i x, const sbox pi )
+{
+  int h;
+  __m256i idx, r = _mm256_setzero_si256(), bias = _mm256_set1_epi8( 0x70 );
+
+  for( h = 0; h < 16; h++ ) {
+     idx = _mm256_adds_epu8( _mm256_xor_si256( x, _mm256_set1_epi8( (char)( h << 4 ))), bias );
+     r = _mm256_xor_si256( r, _mm256_shuffle_epi8(
+        _mm256_broadcastsi128_si256( _mm_loadu_si128(( const __m128i *)( pi + ( h << 4 )))), idx ));
+  }
+ return r;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Линейное преобразование (аналог функции ak_kuznechik_vperm128_linear()). */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline __attribute__((target("avx2")))
+                                      void ak_kuznechik_vperm256_linear( __m256i *x, const shuffle_table tab )
+{
+  int i, l;
+  __m256i lo[16], hi[16], y, m = _mm256_set1_epi8( 0x0f );
+
+  for( i = 0; i < 16; i++ ) {
+     lo[i] = _mm256_and_si256( x[i], m );
+     hi[i] = _mm256_and_si256( _mm256_srli_epi16( x[i], 4 ), m );
+  }
+  for( l = 0; l < 16; l++ ) {
+     y = _mm256_setzero_si256();
+     for( i = 0; i < 16; i++ ) {
+        y = _mm256_xor_si256( y, _mm256_shuffle_epi8( _mm256_broadcastsi128_si256(
+                               _mm_loadu_si128(( const __m128i *) tab[l][i] )), lo[i] ));
+        y = _mm256_xor_si256( y, _mm256_shuffle_epi8( _mm256_broadcastsi128_si256(
+                               _mm_loadu_si128(( const __m128i *)( tab[l][i] +16 ))), hi[i] ));
+     }
+     x[l] = y;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Сложение с раундовым ключом и его маской (аналог ak_kuznechik_vperm128_add_key()). */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline __attribute__((target("avx2")))
+  void ak_kuznechik_vperm256_add_key( __m256i *x,
+                                    const ak_uint8 *key, const ak_uint8 *mask, const unsigned int oc )
+{
+  int l;
+  for( l = 0; l < 16; l++ ) {
+     x[l] = _mm256_xor_si256( x[l], _mm256_set1_epi8( (char) key[oc ? 15-l : l] ));
+     x[l] = _mm256_xor_si256( x[l], _mm256_set1_epi8( (char) mask[oc ? 15-l : l] ));
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Зашифрование (расшифрование) до 32-х транспонированных блоков. */
+/* ----------------------------------------------------------------------------------------------- */
+ static __attribute__((target("avx2"))) void ak_kuznechik_vperm256( ak_skey skey,
+                              ak_uint8 st[16][ak_kuznechik_vperm256_lanes], const unsigned int oc,
+                                                                             const bool_t decrypt )
+{
+  int i, r;
+  __m256i x[16];
+  const ak_uint8 *ekey = ( const ak_uint8 *)skey->data;
+  const ak_uint8 *mkey = ( const ak_uint8 *)(( ak_uint64 *)skey->data + 40 );
+
+  for( i = 0; i < 16; i++ ) x[i] = _mm256_loadu_si256(( const __m256i *) st[i] );
+  if( decrypt ) {
+    ak_kuznechik_vperm256_add_key( x, ekey + 144, mkey + 144, oc );
+    for( r = 8; r >= 0; r-- ) {
+       ak_kuznechik_vperm256_linear( x, kuznechik_parameters->vdec );
+       for( i = 0; i < 16; i++ ) x[i] = ak_kuznechik_vperm256_sbox( x[i], kuznechik_parameters->pinv );
+       ak_kuznechik_vperm256_add_key( x, ekey + 16*r, mkey + 16*r, oc );
+    }
+  } else {
+     for( r = 0; r < 9; r++ ) {
+        ak_kuznechik_vperm256_add_key( x, ekey + 16*r, mkey + 16*r, oc );
+        for( i = 0; i < 16; i++ ) x[i] = ak_kuznechik_vperm256_sbox( x[i], kuznechik_parameters->pi );
+        ak_kuznechik_vperm256_linear( x, kuznechik_parameters->venc );
+     }
+     ak_kuznechik_vperm256_add_key( x, ekey + 144, mkey + 144, oc );
+    }
+  for( i = 0; i < 16; i++ ) _mm256_storeu_si256(( __m256i *) st[i], x[i] );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует зашифрование (расшифрование) последовательности независимых блоков
+    с использованием векторных инструкций.
+
+    Блоки транспонируются так, что в одном регистре оказываются байты с одинаковым номером
+    из 16-ти (SSSE3) или 32-х (AVX2) различных блоков. В таком представлении нелинейное
+    преобразование и умножение на элементы матрицы линейного преобразования выполняются
+    инструкцией pshufb над небольшими таблицами, целиком загружаемыми в регистры. Обращений
+    к памяти, адрес которых зависит от обрабатываемых данных, не производится.
+
+    \param skey Контекст секретного ключа.
+    \param in Указатель на входные данные.
+    \param out Указатель на область памяти, куда помещается результат (может совпадать с `in`).
+    \param blocks Количество обрабатываемых блоков.
+    \param oc Флаг совместимости с библиотекой openssl.
+    \param decrypt Флаг расшифрования.                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline __attribute__((target("ssse3")))
+                void ak_kuznechik_blocks_vperm_common( ak_skey skey, ak_pointer in,
+                   ak_pointer out, size_t blocks, const unsigned int oc, const bool_t decrypt )
+{
+  size_t i = 0, k = 0, n = 0;
+  ak_uint8 *inptr = ( ak_uint8 *)in, *outptr = ( ak_uint8 *)out;
+  ak_uint8 st[16][ak_kuznechik_vperm256_lanes];
+
+  while( blocks > 0 ) {
+     if(( blocks > ak_kuznechik_vperm128_lanes ) && ( ak_libakrypt_dispatch.features&ak_cpu_feature_avx2 ))
+       n = ak_min( blocks, ak_kuznechik_vperm256_lanes );
+      else n = ak_min( blocks, ak_kuznechik_vperm128_lanes );
+
+     for( k = 0; k < n; k++, inptr += 16 )
+        for( i = 0; i < 16; i++ ) st[i][k] = inptr[oc ? 15-i : i];
+
+     if( n > ak_kuznechik_vperm128_lanes ) ak_kuznechik_vperm256( skey, st, oc, decrypt );
+      else ak_kuznechik_vperm128( skey, st, oc, decrypt );
+
+     for( k = 0; k < n; k++, outptr += 16 )
+        for( i = 0; i < 16; i++ ) outptr[oc ? 15-i : i] = st[i][k];
+     blocks -= n;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Зашифрование последовательности независимых блоков (векторная реализация). */
+ static void ak_kuznechik_encrypt_blocks_vperm( ak_skey skey,
+                                                 ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_kuznechik_blocks_vperm_common( skey, in, out, blocks, 0, ak_false );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Расшифрование последовательности независимых блоков (векторная реализация). */
+ static void ak_kuznechik_decrypt_blocks_vperm( ak_skey skey,
+                                                 ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_kuznechik_blocks_vperm_common( skey, in, out, blocks, 0, ak_true );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Зашифрование последовательности независимых блоков (векторная реализация)
+    в режиме совместимости с openssl. */
+ static void ak_kuznechik_encrypt_blocks_vperm_oc( ak_skey skey,
+                                                 ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_kuznechik_blocks_vperm_common( skey, in, out, blocks, 1, ak_false );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Расшифрование последовательности независимых блоков (векторная реализация)
+    в режиме совместимости с openssl. */
+ static void ak_kuznechik_decrypt_blocks_vperm_oc( ak_skey skey,
+                                                 ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_kuznechik_blocks_vperm_common( skey, in, out, blocks, 1, ak_true );
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция помещает в таблицу указатели на функции групповой обработки блоков,
+    наиболее подходящие для используемого процессора. Функция вызывается из ak_libakrypt_create()
+    после определения возможностей процессора.
+
+    @param table Таблица реализаций, поле `features` которой уже определено.                      */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_bckey_kuznechik_init_dispatch( ak_cpu_dispatch table )
+{
+  table->kuznechik_encrypt_blocks[0] = ak_kuznechik_encrypt_blocks_with_mask;
+  table->kuznechik_encrypt_blocks[1] = ak_kuznechik_encrypt_blocks_with_mask_oc;
+  table->kuznechik_decrypt_blocks[0] = ak_kuznechik_decrypt_blocks_with_mask;
+  table->kuznechik_decrypt_blocks[1] = ak_kuznechik_decrypt_blocks_with_mask_oc;
+  table->kuznechik_name = "masked tables";
+
+#ifdef AK_HAVE_BUILTIN_SHUFFLE_EPI8
+ /* при наличии векторных инструкций групповая обработка блоков выполняется без таблиц */
+  if( table->features&ak_cpu_feature_ssse3 ) {
+    table->kuznechik_encrypt_blocks[0] = ak_kuznechik_encrypt_blocks_vperm;
+    table->kuznechik_encrypt_blocks[1] = ak_kuznechik_encrypt_blocks_vperm_oc;
+    table->kuznechik_decrypt_blocks[0] = ak_kuznechik_decrypt_blocks_vperm;
+    table->kuznechik_decrypt_blocks[1] = ak_kuznechik_decrypt_blocks_vperm_oc;
+    table->kuznechik_name = ( table->features&ak_cpu_feature_avx2 ) ?
+                        "avx2 vector permutation" : "ssse3 vector permutation";
+  }
+#endif
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! После инициализации устанавливаются обработчики (функции класса). Однако само значение
     ключу не присваивается - поле `bkey->key` остается неопределенным.
@@ -679,12 +1156,14 @@
 /* ----------------------------------------------------------------------------------------------- */
  int ak_bckey_create_kuznechik( ak_bckey bkey )
 {
-  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option( openssl_compability_option );
 
   if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                "using null pointer to block cipher key context" );
   if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
                                                 "wrong value for \"openssl_compability\" option" );
+  if(( error = ak_libakrypt_lazy_test( block_cipher_test_family )) != ak_error_ok )
+    return ak_error_message( error, __func__, "kuznechik failed dynamic control" );
 
  /* создаем ключ алгоритма шифрования и определяем его методы */
   if(( error = ak_bckey_create( bkey, 32, 16 )) != ak_error_ok )
@@ -706,16 +1185,40 @@
   if( oc ) {
     bkey->encrypt = ak_kuznechik_encrypt_with_mask_oc;
     bkey->decrypt = ak_kuznechik_decrypt_with_mask_oc;
+    bkey->encrypt_blocks = ak_kuznechik_encrypt_blocks_with_mask_oc;
+    bkey->decrypt_blocks = ak_kuznechik_decrypt_blocks_with_mask_oc;
   }
    else {
     bkey->encrypt = ak_kuznechik_encrypt_with_mask;
     bkey->decrypt = ak_kuznechik_decrypt_with_mask;
+    bkey->encrypt_blocks = ak_kuznechik_encrypt_blocks_with_mask;
+    bkey->decrypt_blocks = ak_kuznechik_decrypt_blocks_with_mask;
+  }
+
+
+ /* реализация групповой обработки блоков выбирается в зависимости от возможностей процессора */
+  if( ak_libakrypt_dispatch.kuznechik_encrypt_blocks[oc] != NULL ) {
+    bkey->encrypt_blocks = ak_libakrypt_dispatch.kuznechik_encrypt_blocks[oc];
+    bkey->decrypt_blocks = ak_libakrypt_dispatch.kuznechik_decrypt_blocks[oc];
   }
  return error;
 }
 
 /* ----------------------------------------------------------------------------------------------- */
 /*                                      функции тестирования                                       */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция возвращает истину, если при создании ключа выбирается векторная реализация
+    групповой обработки блоков.                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_libakrypt_test_kuznechik_vperm( void )
+{
+#ifdef AK_HAVE_BUILTIN_SHUFFLE_EPI8
+  if( ak_libakrypt_dispatch.kuznechik_encrypt_blocks[0] == ak_kuznechik_encrypt_blocks_vperm )
+    return ak_true;
+#endif
+ return ak_false;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  static bool_t ak_libakrypt_test_kuznechik_parameters( void )
 {
@@ -723,7 +1226,7 @@
   ak_uint8 out[16];
   struct kuznechik_params parameters;
   int error = ak_error_ok, audit = ak_log_get_level(),
-      oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+      oc = (int) ak_libakrypt_get_option( openssl_compability_option );
 
   ak_uint8 esum[16] = {
                  0x5b,0x80,0x54,0xb3,0x4e,0x81,0x09,0x94,0xcc,0x83,0x8b,0x8e,0x53,0xba,0x9d,0x18 };
@@ -823,18 +1326,84 @@
   if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
                                                    "expanded encryption/decryption tables is Ok" );
   ak_hash_destroy( &ctx );
+
+ /* проверяем, что используемые библиотекой таблицы совпадают с вычисленными */
+  if(( kuznechik_parameters == NULL ) ||
+     ( !ak_ptr_is_equal( kuznechik_parameters, &parameters, sizeof( struct kuznechik_params )))) {
+    ak_error_message( ak_error_not_equal_data, __func__,
+                                  "used tables differ from generated GOST R 34.12-2015 tables" );
+    return ak_false;
+  }
+  if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
+                                                                        "used tables is Ok" );
  return ak_true;
 }
 
+#ifdef AK_HAVE_BUILTIN_SHUFFLE_EPI8
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество блоков, используемое для сравнения векторной и табличной реализаций:
+    данные обрабатываются одной группой из \ref ak_kuznechik_vperm256_lanes блоков (при наличии
+    инструкций avx2) и одной группой, обрабатываемой инструкциями ssse3. */
+ #define ak_kuznechik_test_vperm_blocks  ( ak_kuznechik_vperm256_lanes + 1 )
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция сравнивает результаты зашифрования и расшифрования последовательности блоков,
+    полученные векторной реализацией, установленной в ключе, и табличной реализацией.
+    Контрольные примеры стандарта содержат всего четыре блока и поэтому не затрагивают
+    обработку блоков группами, использующими инструкции avx2.
+
+    \param bkey Контекст ключа с установленным значением.
+    \param oc Флаг совместимости с библиотекой openssl.
+    \return Функция возвращает \ref ak_true, если результаты совпадают.                           */
 /* ----------------------------------------------------------------------------------------------- */
- static bool_t ak_libakrypt_test_kuznechik_complete( void )
+ static bool_t ak_libakrypt_test_kuznechik_vperm_blocks( ak_bckey bkey, const int oc )
+{
+  size_t i = 0;
+  bool_t result = ak_true;
+  ak_uint8 data[16*ak_kuznechik_test_vperm_blocks], out[16*ak_kuznechik_test_vperm_blocks],
+                                                         check[16*ak_kuznechik_test_vperm_blocks];
+
+  for( i = 0; i < sizeof( data ); i++ ) data[i] = ( ak_uint8 )( i*7 + ( i >> 4 ));
+
+ /* зашифрование */
+  bkey->encrypt_blocks( &bkey->key, data, out, ak_kuznechik_test_vperm_blocks );
+  if( oc ) ak_kuznechik_encrypt_blocks_with_mask_oc( &bkey->key, data, check,
+                                                                  ak_kuznechik_test_vperm_blocks );
+   else ak_kuznechik_encrypt_blocks_with_mask( &bkey->key, data, check,
+                                                                  ak_kuznechik_test_vperm_blocks );
+  if( !ak_ptr_is_equal_with_log( out, check, sizeof( out ))) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                    "vector and table realizations of multiple blocks encryption are different" );
+    result = ak_false;
+  }
+
+ /* расшифрование */
+  bkey->decrypt_blocks( &bkey->key, check, out, ak_kuznechik_test_vperm_blocks );
+  if( !ak_ptr_is_equal_with_log( out, data, sizeof( out ))) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                                 "vector realization of multiple blocks decryption is wrong" );
+    result = ak_false;
+  }
+
+  memset( out, 0, sizeof( out ));
+  memset( check, 0, sizeof( check ));
+ return result;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет работу алгоритма Кузнечик на контрольных примерах.
+    \param vperm Флаг использования векторной реализации для групповой обработки блоков;
+    если значение флага ложно, то используется табличная реализация.                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_libakrypt_test_kuznechik_complete( const bool_t vperm )
 {
   size_t i = 0;
   struct bckey bkey;
   ak_uint8 myout[256];
   bool_t result = ak_true;
   int error = ak_error_ok, audit = ak_log_get_level(),
-      oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+      oc = (int) ak_libakrypt_get_option( openssl_compability_option );
 
  /* тестовый ключ из ГОСТ Р 34.13-2015, приложение А.1 */
   ak_uint8 key[32] = {
@@ -998,6 +1567,17 @@
     return ak_false;
   }
 
+ /* выбираем тестируемую реализацию групповой обработки блоков */
+  if( !vperm ) {
+    bkey.encrypt_blocks = oc ? ak_kuznechik_encrypt_blocks_with_mask_oc :
+                                                            ak_kuznechik_encrypt_blocks_with_mask;
+    bkey.decrypt_blocks = oc ? ak_kuznechik_decrypt_blocks_with_mask_oc :
+                                                            ak_kuznechik_decrypt_blocks_with_mask;
+  }
+  if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__, vperm ?
+              "testing vector permutation realization of multiple blocks processing" :
+                                      "testing table realization of multiple blocks processing" );
+
   if(( error = ak_bckey_set_key( &bkey, oc ? oc_key : key,
                                                                  sizeof( key ))) != ak_error_ok ) {
     ak_error_message( error, __func__, "wrong creation of test key" );
@@ -1036,6 +1616,16 @@
   if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
                 "the ecb mode encryption/decryption test from GOST R 34.13-2015 is Ok" );
 
+#ifdef AK_HAVE_BUILTIN_SHUFFLE_EPI8
+ /* сравниваем векторную реализацию с табличной на последовательности из нескольких групп блоков */
+  if( vperm && !ak_libakrypt_test_kuznechik_vperm_blocks( &bkey, oc )) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                             "the comparison of multiple blocks processing realizations is wrong" );
+    result = ak_false;
+    goto exit;
+  }
+#endif
+
  /* --------------------------------------------------------------------------- */
  /* 3. Проверяем режим гаммирования согласно ГОСТ Р 34.12-2015                  */
  /* --------------------------------------------------------------------------- */
@@ -1191,7 +1781,7 @@
  bool_t ak_libakrypt_test_kuznechik( void )
 {
   int audit = audit = ak_log_get_level();
-  int oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  int oc = (int) ak_libakrypt_get_option( openssl_compability_option );
 
  /* мы тестируем алгоритм Магма в двух режимах совместимисти,
     вызывая для этого функцию тестирования дважды
@@ -1206,7 +1796,8 @@
   if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
                                  "testing of predefined parameters from GOST R 34.12-2015 is Ok" );
   /* тестируем работу алоритма на контрольных примерах из ГОСТов и рекомендаций */
-  if( !ak_libakrypt_test_kuznechik_complete( )) {
+  if( !ak_libakrypt_test_kuznechik_complete( ak_false ) ||
+      ( ak_libakrypt_test_kuznechik_vperm() && !ak_libakrypt_test_kuznechik_complete( ak_true ))) {
     ak_error_message( ak_error_get_value(), __func__,
                                                    "incorrect testing of kuznechik block cipher" );
     return ak_false;
@@ -1222,7 +1813,8 @@
   if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
                                  "testing of predefined parameters from GOST R 34.12-2015 is Ok" );
   /* тестируем работу алоритма на контрольных примерах из ГОСТов и рекомендаций */
-  if( !ak_libakrypt_test_kuznechik_complete( )) {
+  if( !ak_libakrypt_test_kuznechik_complete( ak_false ) ||
+      ( ak_libakrypt_test_kuznechik_vperm() && !ak_libakrypt_test_kuznechik_complete( ak_true ))) {
     ak_error_message( ak_error_get_value(), __func__,
                                                    "incorrect testing of kuznechik block cipher" );
     return ak_false;
@@ -13,9 +13,135 @@
 #ifdef AK_HAVE_WINDOWS_H
  #include <windows.h>
 #endif
+#if defined( _MSC_VER ) && defined( AK_HAVE_BUILTIN_CLMULEPI64 )
+ #include <intrin.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
  #include <libakrypt-internal.h>
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Таблица реализаций, используемых библиотекой.
+    \details До вызова функции ak_libakrypt_create() таблица содержит переносимые реализации,
+    не использующие расширений системы команд процессора. Указатели на функции групповой
+    обработки блоков устанавливаются при инициализации библиотеки.                                */
+/* ----------------------------------------------------------------------------------------------- */
+ struct cpu_dispatch ak_libakrypt_dispatch = {
+   0,
+   ak_gf64_mul_uint64,
+   ak_gf128_mul_uint64,
+   ak_gf256_mul_uint64,
+   ak_gf512_mul_uint64,
+   ak_gf64_mul_sum_uint64,
+   ak_gf128_mul_sum_uint64,
+   { NULL, NULL },
+   { NULL, NULL },
+   { NULL, NULL },
+   { NULL, NULL },
+   ak_hash_streebog_g_uint64,
+   ak_mpzn_mul_montgomery_uint64,
+   { ak_mpzn_mul_montgomery_uint64, ak_mpzn_mul_montgomery_pseudo_mersenne_uint64 },
+   "uint64",
+   "masked tables",
+   "random walk tables",
+   "64-bit tables",
+#ifdef AK_HAVE_BUILTIN_MULQ_GCC
+   "mulq"
+#else
+   "uint64"
+#endif
+ };
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция определяет расширения системы команд, поддерживаемые процессором.
+    \return Комбинация флагов \ref ak_cpu_feature_pclmul, \ref ak_cpu_feature_ssse3,
+    \ref ak_cpu_feature_sse41, \ref ak_cpu_feature_avx2 и \ref ak_cpu_feature_bmi2_adx.         */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_uint32 ak_libakrypt_get_cpu_features( void )
+{
+  ak_uint32 features = 0;
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ))
+  __builtin_cpu_init();
+ #ifdef AK_HAVE_BUILTIN_CLMULEPI64
+  if( __builtin_cpu_supports( "pclmul" )) features |= ak_cpu_feature_pclmul;
+ #endif
+ #ifdef AK_HAVE_BUILTIN_SHUFFLE_EPI8
+  if( __builtin_cpu_supports( "ssse3" )) features |= ak_cpu_feature_ssse3;
+  if( __builtin_cpu_supports( "sse4.1" )) features |= ak_cpu_feature_sse41;
+  if( __builtin_cpu_supports( "avx2" )) features |= ak_cpu_feature_avx2;
+ #endif
+ #ifdef AK_HAVE_BUILTIN_MULX_ADX
+  if( __builtin_cpu_supports( "bmi2" ) && __builtin_cpu_supports( "adx" ))
+    features |= ak_cpu_feature_bmi2_adx;
+ #endif
+#endif
+#if defined( _MSC_VER ) && defined( AK_HAVE_BUILTIN_CLMULEPI64 )
+  int regs[4];
+  __cpuid( regs, 1 );
+  if( regs[2]&0x2 ) features |= ak_cpu_feature_pclmul;
+#endif
+
+ return features;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция заполняет таблицу \ref ak_libakrypt_dispatch реализациями, наиболее
+    подходящими для процессора, на котором выполняется программа.
+
+    Выбор выполняется во время выполнения, а не во время сборки библиотеки, поэтому
+    одна и та же сборка может использоваться на процессорах с различными возможностями.            */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_libakrypt_init_dispatch( void )
+{
+  ak_cpu_dispatch table = &ak_libakrypt_dispatch;
+
+  table->features = ak_libakrypt_get_cpu_features();
+
+ /* умножение в конечных полях характеристики два */
+  table->gf64_mul = ak_gf64_mul_uint64;
+  table->gf128_mul = ak_gf128_mul_uint64;
+  table->gf256_mul = ak_gf256_mul_uint64;
+  table->gf512_mul = ak_gf512_mul_uint64;
+  table->gf64_mul_sum = ak_gf64_mul_sum_uint64;
+  table->gf128_mul_sum = ak_gf128_mul_sum_uint64;
+  table->gf_mul_name = "uint64";
+#ifdef AK_HAVE_BUILTIN_CLMULEPI64
+  if( table->features&ak_cpu_feature_pclmul ) {
+    table->gf64_mul = ak_gf64_mul_pcmulqdq;
+    table->gf128_mul = ak_gf128_mul_pcmulqdq;
+    table->gf256_mul = ak_gf256_mul_pcmulqdq;
+    table->gf512_mul = ak_gf512_mul_pcmulqdq;
+    table->gf64_mul_sum = ak_gf64_mul_sum_pcmulqdq;
+    table->gf128_mul_sum = ak_gf128_mul_sum_pcmulqdq;
+    table->gf_mul_name = "pclmulqdq";
+  }
+#endif
+
+ /* алгоритмы блочного шифрования */
+  ak_bckey_kuznechik_init_dispatch( table );
+  ak_bckey_magma_init_dispatch( table );
+
+ /* функция хеширования Стрибог */
+  ak_hash_streebog_init_dispatch( table );
+
+ /* умножение вычетов в представлении Монтгомери */
+  table->mpzn_mul_montgomery = ak_mpzn_mul_montgomery_uint64;
+  table->wcurve_mul[wcurve_field_pseudo_mersenne] = ak_mpzn_mul_montgomery_pseudo_mersenne_uint64;
+#ifdef AK_HAVE_BUILTIN_MULQ_GCC
+  table->mpzn_name = "mulq";
+#else
+  table->mpzn_name = "uint64";
+#endif
+#ifdef AK_HAVE_BUILTIN_MULX_ADX
+  if( table->features&ak_cpu_feature_bmi2_adx ) {
+    table->mpzn_mul_montgomery = ak_mpzn_mul_montgomery_mulx;
+    table->mpzn_name = "mulx/adx";
+    table->wcurve_mul[wcurve_field_pseudo_mersenne] = ak_mpzn_mul_montgomery_pseudo_mersenne_mulx;
+  }
+#endif
+  table->wcurve_mul[wcurve_field_montgomery] = table->mpzn_mul_montgomery;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция проверяет корректность определения базовых типов данных
     \return В случе успешного тестирования возвращает \ref ak_true (истина).
@@ -76,7 +202,10 @@
    ak_error_message( ak_error_ok, __func__ , "library applies __m128i base type" );
   #endif
   #ifdef AK_HAVE_BUILTIN_CLMULEPI64
-   ak_error_message( ak_error_ok, __func__ , "library applies clmulepi64 instruction" );
+   ak_error_message( ak_error_ok, __func__ , "library contains code for clmulepi64 instruction" );
+  #endif
+  #ifdef AK_HAVE_BUILTIN_SHUFFLE_EPI8
+   ak_error_message( ak_error_ok, __func__ , "library contains code for ssse3, sse4.1 and avx2 instructions" );
   #endif
   #ifdef AK_HAVE_BUILTIN_MULQ_GCC
    ak_error_message( ak_error_ok, __func__ , "library applies assembler code for mulq command" );
@@ -295,6 +424,364 @@
  return ak_true;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                   динамический контроль при инициализации библиотеки                            */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция тестирования группы криптографических механизмов. */
+ typedef bool_t ( ak_function_test_family )( void );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция тестирует блочные шифры вместе с арифметикой в полях характеристики два,
+    используемой режимом MGM.                                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_libakrypt_test_block_cipher_family( void )
+{
+  if( ak_libakrypt_test_gfn_multiplication() != ak_true ) {
+    ak_error_message( ak_error_get_value(), __func__ ,
+                                          "incorrect testing of multiplication in Galois fields" );
+    return ak_false;
+  }
+ return ak_libakrypt_test_block_ciphers();
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Состояние тестирования группы механизмов. */
+ typedef enum {
+   not_tested_family,
+   tested_now_family,
+   passed_family,
+   failed_family
+ } test_family_state_t;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Группа механизмов, тестируемых совместно. */
+ typedef struct test_family {
+  /*! \brief Имя группы, используемое при выводе сообщений */
+   const char *name;
+  /*! \brief Функция тестирования */
+   ak_function_test_family *test;
+  /*! \brief Текущее состояние тестирования */
+   volatile test_family_state_t state;
+  /*! \brief Индекс группы, в потоке которой выполняется тестирование при параллельном контроле
+      (группы с одинаковым индексом тестируются последовательно в одном потоке). */
+   size_t thread;
+ } *ak_test_family;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Группы механизмов (индекс массива совпадает со значением типа test_family_t). */
+ static struct test_family test_families[ak_test_family_count] = {
+   { "hash functions", ak_libakrypt_test_hash_functions, not_tested_family, 0 },
+   { "block ciphers", ak_libakrypt_test_block_cipher_family, not_tested_family, 1 },
+  /* тестирование блочных шифров изменяет глобальную опцию openssl_compability и таблицы
+     алгоритма Кузнечик, поэтому алгоритмы выработки имитовставки, использующие блочные шифры,
+     тестируются в том же потоке после завершения тестирования блочных шифров */
+   { "mac algorithms", ak_libakrypt_test_mac_functions, not_tested_family, 1 },
+   { "asymmetric mechanisms", ak_libakrypt_test_asymmetric_functions, not_tested_family, 3 }
+ };
+
+/*! \brief Режим динамического контроля, установленный при инициализации библиотеки. */
+ static dynamic_control_t ak_dynamic_control = none_dynamic_control;
+
+#ifdef AK_HAVE_PTHREAD_H
+/*! \brief Мьютекс, защищающий состояния групп механизмов. Мьютекс является рекурсивным,
+    поскольку тестирование группы приводит к созданию контекстов из той же группы. */
+ static pthread_mutex_t test_families_mutex;
+ static pthread_once_t test_families_mutex_once = PTHREAD_ONCE_INIT;
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_libakrypt_init_test_families_mutex( void )
+{
+  pthread_mutexattr_t attr;
+
+  pthread_mutexattr_init( &attr );
+  pthread_mutexattr_settype( &attr, PTHREAD_MUTEX_RECURSIVE );
+  pthread_mutex_init( &test_families_mutex, &attr );
+  pthread_mutexattr_destroy( &attr );
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция тестирует одну группу механизмов и сохраняет результат тестирования. */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_libakrypt_run_test_family( ak_test_family family )
+{
+  bool_t result = ak_false;
+
+  family->state = tested_now_family;
+  if(( result = family->test( )) == ak_true ) family->state = passed_family;
+   else family->state = failed_family;
+
+  if( result != ak_true ) ak_error_message_fmt( ak_error_self_test, __func__,
+                                                "dynamic control of %s is wrong", family->name );
+   else if( ak_log_get_level() >= ak_log_maximum ) ak_error_message_fmt( ak_error_ok, __func__,
+                                                   "dynamic control of %s is Ok", family->name );
+ return result;
+}
+
+#ifdef AK_HAVE_PTHREAD_H
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция последовательно тестирует все группы механизмов, выполняемые в потоке
+    группы с индексом `thread`.                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_libakrypt_run_test_family_group( const size_t thread )
+{
+  size_t i = 0;
+
+  for( i = thread; i < ak_test_family_count; i++ )
+     if( test_families[i].thread == thread ) ak_libakrypt_run_test_family( test_families+i );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_libakrypt_run_test_family_thread( void *ptr )
+{
+  ak_libakrypt_run_test_family_group(( size_t )(( ak_test_family ) ptr - test_families ));
+ return NULL;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция тестирует все группы механизмов.
+    \details При наличии поддержки потоков и установленном флаге `parallel` группы тестируются
+    в отдельных потоках (группы, использующие общие глобальные параметры, тестируются
+    последовательно в одном потоке); в противном случае группы тестируются последовательно.
+
+    \param parallel Флаг использования потоков.
+    \return Функция возвращает \ref ak_true, если тестирование всех групп успешно.                */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_libakrypt_run_test_families( bool_t parallel )
+{
+  size_t i = 0;
+  bool_t result = ak_true;
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_t threads[ak_test_family_count];
+  bool_t started[ak_test_family_count];
+
+  if( parallel ) {
+    for( i = 0; i < ak_test_family_count; i++ ) {
+       started[i] = ak_false;
+       if( test_families[i].thread != i ) continue;
+       started[i] = ( pthread_create( threads+i, NULL,
+                          ak_libakrypt_run_test_family_thread, test_families+i ) == 0 );
+    }
+    for( i = 0; i < ak_test_family_count; i++ ) {
+       if( test_families[i].thread != i ) continue;
+      /* если поток не был создан, то тестируем группы в текущем потоке */
+       if( started[i] ) pthread_join( threads[i], NULL );
+        else ak_libakrypt_run_test_family_group( i );
+    }
+    for( i = 0; i < ak_test_family_count; i++ )
+       if( test_families[i].state != passed_family ) result = ak_false;
+    if( result != ak_true ) ak_error_set_value( ak_error_self_test );
+    return result;
+  }
+#else
+  (void) parallel;
+#endif
+  for( i = 0; i < ak_test_family_count; i++ )
+     if( ak_libakrypt_run_test_family( test_families+i ) != ak_true ) return ak_false;
+
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция формирует строку, однозначно определяющую сборку библиотеки и набор
+    выбранных для данного процессора реализаций.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_libakrypt_test_cache_key( char *key, const size_t size )
+{
+  ak_snprintf( key, size,
+     "libakrypt %s (%s %s), features 0x%x, %s, %s, %s, %s, %s, openssl_compability %d\n",
+      ak_libakrypt_version(), __DATE__, __TIME__, (unsigned int) ak_libakrypt_dispatch.features,
+      ak_libakrypt_dispatch.gf_mul_name, ak_libakrypt_dispatch.kuznechik_name,
+      ak_libakrypt_dispatch.magma_name, ak_libakrypt_dispatch.streebog_name,
+      ak_libakrypt_dispatch.mpzn_name,
+               (int) ak_libakrypt_get_option( openssl_compability_option ));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет значение, сохраняемое в файле selftest.cache.
+    \details Значение представляет собой хеш-код Стрибог-512 от строки, определяющей сборку
+    библиотеки (см. ak_libakrypt_test_cache_key()), и результатов вычислений, выполненных
+    выбранными для данного процессора реализациями: зашифрования в режиме mgm алгоритмами
+    Кузнечик и Магма и вычисления кратных точек эллиптических кривых. Вычисления занимают
+    значительно меньше времени, чем полное тестирование, при этом изменение результатов
+    любой из реализаций приводит к изменению значения и, как следствие, к выполнению полного
+    тестирования.
+
+    \param value Буффер для значения, длиной 64 октета.
+    \return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_libakrypt_test_cache_value( ak_uint8 *value )
+{
+  size_t i = 0, off = 512;
+  struct hash ctx;
+  struct wpoint wp, wq;
+  struct bckey ekey, akey;
+  int error = ak_error_ok;
+  ak_uint64 k[ak_mpzn512_size];
+  ak_uint8 buffer[512 + 2*( 512 + 16 ) + 2*( 2*8*ak_mpzn512_size )], iv[16];
+  int ( *create[2] )( ak_bckey ) = { ak_bckey_create_kuznechik, ak_bckey_create_magma };
+  const ak_wcurve curves[2] = {( ak_wcurve ) &id_tc26_gost_3410_2012_256_paramSetA,
+                               ( ak_wcurve ) &id_tc26_gost_3410_2012_512_paramSetA };
+
+  memset( buffer, 0, sizeof( buffer ));
+  ak_libakrypt_test_cache_key( (char *)buffer, 512 );
+  for( i = 0; i < sizeof( iv ); i++ ) iv[i] = ( ak_uint8 )( 0x11*i );
+
+ /* зашифрование строки, определяющей сборку, в режиме mgm */
+  for( i = 0; i < 2; i++ ) {
+     if(( error = create[i]( &ekey )) != ak_error_ok ) return error;
+     if(( error = create[i]( &akey )) != ak_error_ok ) {
+       ak_bckey_destroy( &ekey );
+       return error;
+     }
+     if((( error = ak_bckey_set_key( &ekey, buffer + 32, 32 )) == ak_error_ok ) &&
+        (( error = ak_bckey_set_key( &akey, buffer + 96, 32 )) == ak_error_ok ))
+       error = ak_bckey_encrypt_mgm( &ekey, &akey, buffer, 41, buffer, buffer + off, 512,
+                                           iv, ekey.bsize, buffer + off + 512, ekey.bsize );
+     ak_bckey_destroy( &akey );
+     ak_bckey_destroy( &ekey );
+     if( error != ak_error_ok ) return error;
+     off += 512 + 16;
+  }
+
+ /* вычисление кратных точек */
+  for( i = 0; i < ak_mpzn512_size; i++ ) k[i] = 0x0123456789abcdefLL*( i+1 );
+  for( i = 0; i < 2; i++ ) {
+     k[curves[i]->size - 1] >>= 2; /* значение должно быть меньше порядка группы точек */
+     if(( error = ak_wpoint_set( &wq, curves[i] )) != ak_error_ok ) return error;
+     ak_wpoint_pow( &wp, &wq, k, curves[i]->size, curves[i] );
+     ak_wpoint_reduce( &wp, curves[i] );
+     memcpy( buffer + off, wp.x, 8*curves[i]->size );
+     memcpy( buffer + off + 8*ak_mpzn512_size, wp.y, 8*curves[i]->size );
+     off += 2*8*ak_mpzn512_size;
+  }
+
+  if(( error = ak_hash_create_streebog512( &ctx )) != ak_error_ok ) return error;
+  error = ak_hash_ptr( &ctx, buffer, sizeof( buffer ), value, 64 );
+  ak_hash_destroy( &ctx );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция выполняет полное тестирование, если его успешный результат не был
+    ранее сохранен для данной сборки библиотеки и данного набора реализаций.
+    \details В файле selftest.cache, расположенном в домашнем каталоге пользователя,
+    сохраняется значение, вычисляемое функцией ak_libakrypt_test_cache_value(). Поскольку
+    значение не зависит от секретных данных, режим предполагает, что запись в домашний
+    каталог пользователя доступна только самому пользователю.                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_libakrypt_run_cached_test_families( void )
+{
+  struct file fd;
+  ssize_t len = 0;
+  int error = ak_error_ok;
+  ak_uint8 value[64], stored[65];
+  char filename[FILENAME_MAX];
+
+  memset( stored, 0, sizeof( stored ));
+  if( ak_libakrypt_create_home_filename( filename, FILENAME_MAX,
+                                                         "selftest.cache", 0 ) != ak_error_ok ) {
+   /* сохранить результат негде, поэтому просто тестируем */
+    return ak_libakrypt_run_test_families( ak_true );
+  }
+  if(( error = ak_libakrypt_test_cache_value( value )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect calculation of dynamic control cache value" );
+    return ak_libakrypt_run_test_families( ak_true );
+  }
+
+ /* сравниваем сохраненный результат с текущим */
+  if( ak_file_open_to_read( &fd, filename ) == ak_error_ok ) {
+    len = ak_file_read( &fd, stored, sizeof( stored ));
+    ak_file_close( &fd );
+    if(( len == sizeof( value )) && ak_ptr_is_equal( value, stored, sizeof( value ))) {
+      size_t i = 0;
+      for( i = 0; i < ak_test_family_count; i++ ) test_families[i].state = passed_family;
+      if( ak_log_get_level() >= ak_log_maximum ) ak_error_message_fmt( ak_error_ok, __func__,
+                                       "dynamic control skipped, result is read from %s", filename );
+      return ak_true;
+    }
+  }
+
+ /* тестируем и сохраняем результат */
+  if( ak_libakrypt_run_test_families( ak_true ) != ak_true ) return ak_false;
+  if( ak_file_create_to_write( &fd, filename ) == ak_error_ok ) {
+    if( ak_file_write( &fd, value, sizeof( value )) != (ssize_t) sizeof( value ))
+      ak_error_message_fmt( ak_error_write_data, __func__,
+                                           "result of dynamic control is not stored in %s", filename );
+    ak_file_close( &fd );
+  }
+ return ak_true;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция выполняет динамический контроль в соответствии со значением
+    опции `dynamic_control_test`.                                                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_libakrypt_run_dynamic_control( void )
+{
+  ak_int64 value = ak_libakrypt_get_option( dynamic_control_test_option );
+
+  if(( value < none_dynamic_control ) || ( value > cached_dynamic_control )) {
+    ak_error_message_fmt( ak_error_wrong_option, __func__,
+                             "wrong option's value \"dynamic_control_test\" = %d", (int) value );
+    return ak_false;
+  }
+
+  switch( ak_dynamic_control = ( dynamic_control_t ) value ) {
+    case full_dynamic_control:     return ak_libakrypt_run_test_families( ak_false );
+    case parallel_dynamic_control: return ak_libakrypt_run_test_families( ak_true );
+    case cached_dynamic_control:   return ak_libakrypt_run_cached_test_families();
+    default:                       break;
+  }
+ return ak_true;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! В режиме \ref lazy_dynamic_control функция тестирует заданную группу механизмов в момент
+    первого обращения к ней. Результат тестирования сохраняется и используется при последующих
+    обращениях. В остальных режимах функция сразу возвращает \ref ak_error_ok.
+
+    \param family Группа криптографических механизмов.
+    \return В случае успешного тестирования группы возвращается \ref ak_error_ok.
+    В противном случае возвращается \ref ak_error_self_test.                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_libakrypt_lazy_test( const test_family_t family )
+{
+  int error = ak_error_ok;
+
+  if( ak_dynamic_control != lazy_dynamic_control ) return ak_error_ok;
+  if( family >= ak_test_family_count )
+    return ak_error_message( ak_error_wrong_index, __func__, "using unexpected test family" );
+
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_once( &test_families_mutex_once, ak_libakrypt_init_test_families_mutex );
+  pthread_mutex_lock( &test_families_mutex );
+#endif
+  switch( test_families[family].state ) {
+   /* группа еще не тестировалась */
+    case not_tested_family:
+      if( ak_libakrypt_run_test_family( test_families+family ) != ak_true )
+        error = ak_error_self_test;
+      break;
+
+   /* группа тестировалась ранее с отрицательным результатом */
+    case failed_family:
+      error = ak_error_message_fmt( ak_error_self_test, __func__,
+                 "using %s, which failed dynamic control earlier", test_families[family].name );
+      break;
+
+   /* группа протестирована, либо тестируется сейчас этим же потоком */
+    default:
+      break;
+  }
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &test_families_mutex );
+#endif
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция должна вызываться перед использованием любых криптографических механизмов библиотеки.
 
@@ -346,6 +833,9 @@
      return ak_false;
    }
 
+ /* выбираем реализации алгоритмов в соответствии с возможностями процессора */
+   ak_libakrypt_init_dispatch();
+
 #ifdef _WIN32
  /* использование цвета в стандартной консоли Windows бессмысленно
                             поэтому мы его принудительно запрещаем */
@@ -387,15 +877,24 @@
 
  /* процедура полного тестирования всех криптографических алгоритмов
     занимает крайне много времени, особенно на встраиваемых платформах,
-    поэтому ее запуск должен производиться в соответствии с неким (внешним) регламентом ....
-
-    if( !ak_libakrypt_dynamic_control_test( )) {
-      ak_error_message( error, __func__, "incorrect dynamic control test" );
-      return ak_false;
-    }
+    поэтому по-умолчанию ее запуск должен производиться в соответствии с неким (внешним)
+    регламентом; поскольку функция динамического контроля экспортируется,
+    то она может быть запущена пользователем самостоятельно.
+
+    опция dynamic_control_test позволяет выполнять тестирование при инициализации
+    библиотеки: полностью, в нескольких потоках, при первом использовании механизмов
+    или один раз для данной сборки библиотеки. */
+   if( ak_libakrypt_run_dynamic_control() != ak_true ) {
+     ak_error_message( ak_error_get_value(), __func__, "incorrect dynamic control test" );
+     return ak_false;
+   }
 
-    поскольку функция динамического контроля экспортируется,
-    то она может быть запущена пользователем самостоятельно. */
+ /* создаем рабочие потоки, используемые для параллельной обработки данных */
+   if(( error = ak_thread_pool_create(
+                          ak_libakrypt_get_option( thread_pool_size_option ))) != ak_error_ok ) {
+     ak_error_message( error, __func__, "incorrect creation of thread pool" );
+     return ak_false;
+   }
 
  if( ak_log_get_level() != ak_log_none )
    ak_error_message( ak_error_ok, __func__ , "creation of libakrypt is Ok" );
@@ -410,6 +909,11 @@
   if( error != ak_error_ok )
     ak_error_message( error, __func__ , "before destroing library holds an error" );
 
+ /* завершаем работу рабочих потоков */
+  ak_thread_pool_destroy();
+ /* освобождаем память, занятую таблицами кратных точек */
+  ak_wcurve_destroy_base_tables();
+
 #ifdef AK_HAVE_WINDOWS_H
   #ifdef LIBAKRYPT_NETWORK
     if( WSACleanup() != 0 )
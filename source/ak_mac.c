@@ -71,7 +71,16 @@
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! @param mctx Указатель на контекст итерационного сжатия.
+/*! Функция сжатия вызывается непосредственно для данных, на которые указывает in, без
+    их копирования во внутренний буффер контекста. Во внутреннем буффере сохраняются только
+    неполные блоки: начальный, дополняющий данные, оставшиеся от предыдущего вызова, и хвост,
+    который будет обработан при следующем вызове функции.
+
+    Функции сжатия обрабатывают данные как последовательность 64-х битных слов. Поэтому,
+    если адрес данных не выровнен на границу 64-х битного слова, данные передаются в функцию
+    сжатия через внутренний буффер фрагментами, длина которых не превосходит длины буффера.
+
+    @param mctx Указатель на контекст итерационного сжатия.
     @param in Сжимаемые данные
     @param size Размер сжимаемых данных в байтах. Данное значение может
     быть произвольным, в том числе равным нулю и/или не кратным длине блока обрабатываемых данных
@@ -80,8 +89,9 @@
 /* ----------------------------------------------------------------------------------------------- */
  int ak_mac_update( ak_mac mctx, const ak_pointer in, const size_t size )
 {
+  int error = ak_error_ok;
   ak_uint8 *ptrin = (ak_uint8 *) in;
-  size_t quot = 0, offset = 0, newsize = size;
+  size_t offset = 0, newsize = size;
 
   if( mctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                   "using a null pointer to internal mac context" );
@@ -100,24 +110,41 @@
     memcpy( mctx->data + mctx->length, ptrin, offset );
 
    /* обновляем значение контекста функции и очищаем временный буффер */
-    mctx->update( mctx->ctx, mctx->data, mctx->bsize );
+    error = mctx->update( mctx->ctx, mctx->data, mctx->bsize );
     memset( mctx->data, 0, mctx->bsize );
     mctx->length = 0;
+    if( error != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect updating of internal context" );
     ptrin += offset;
     newsize -= offset;
   }
 
- /* теперь обрабатываем входные данные с пустым временным буффером */
+ /* теперь обрабатываем часть, кратную величине bsize, с пустым временным буффером */
+  if(( offset = ( newsize/mctx->bsize )*mctx->bsize ) > 0 ) {
+    if((( size_t )ptrin )%sizeof( ak_uint64 ) == 0 ) {
+     /* выровненные данные передаются в функцию сжатия без копирования */
+      if(( error = mctx->update( mctx->ctx, ptrin, offset )) != ak_error_ok )
+        return ak_error_message( error, __func__, "incorrect updating of internal context" );
+    } else {
+       /* невыровненные данные копируются во временный буффер фрагментами */
+        size_t len = 0, chunk = ( ak_mac_max_buffer_size/mctx->bsize )*mctx->bsize;
+        for( len = 0; len < offset; len += chunk ) {
+           if( chunk > offset - len ) chunk = offset - len;
+           memcpy( mctx->data, ptrin + len, chunk );
+           if(( error = mctx->update( mctx->ctx, mctx->data, chunk )) != ak_error_ok ) break;
+        }
+        memset( mctx->data, 0, sizeof( mctx->data ));
+        if( error != ak_error_ok )
+          return ak_error_message( error, __func__, "incorrect updating of internal context" );
+      }
+    ptrin += offset;
+    newsize -= offset;
+  }
+
+ /* хвост оставляем на следующий раз */
   if( newsize != 0 ) {
-    quot = newsize/mctx->bsize;
-    offset = quot*mctx->bsize;
-   /* обрабатываем часть, кратную величине bsize */
-    if( quot > 0 ) mctx->update( mctx->ctx, ptrin, offset );
-   /* хвост оставляем на следующий раз */
-    if( offset < newsize ) {
-      mctx->length = newsize - offset;
-      memcpy( mctx->data, ptrin + offset, mctx->length );
-    }
+    mctx->length = newsize;
+    memcpy( mctx->data, ptrin, newsize );
   }
 
  return ak_error_ok;
@@ -190,6 +217,12 @@
 /*! Функция вычисляет результат сжимающего отображения для заданного файла и помещает
     его в область памяти, на которую указывает out.
 
+    Если операционная система поддерживает отображение файлов в память, то файл отображается
+    в память функцией ak_file_mmap() и обрабатывается целиком, без копирования данных;
+    опережающее чтение файла с диска выполняется операционной системой одновременно
+    с вычислениями. В противном случае файл последовательно считывается фрагментами
+    длины \ref ak_mac_file_buffer_size октетов.
+
     @param mctx Указатель на контекст итерационного сжатия.
     @param filename имя сжимаемого файла
     @param out Область памяти, куда будет помещен результат. Память должна быть заранее выделена.
@@ -202,10 +235,9 @@
 /* ----------------------------------------------------------------------------------------------- */
  int ak_mac_file( ak_mac mctx, const char* filename, ak_pointer out, const size_t out_size )
 {
-  size_t len = 0;
+  ssize_t len = 0;
   struct file file;
   int error = ak_error_ok;
-  size_t block_size = 4096; /* оптимальная длина блока для Windows пока не ясна */
   ak_uint8 *localbuffer = NULL; /* место для локального считывания информации */
 
  /* выполняем необходимые проверки */
@@ -225,30 +257,39 @@
     return ak_mac_finalize( mctx, "", 0, out, out_size );
   }
 
- /* готовим область для хранения данных */
-  block_size = ak_max( ( size_t )file.blksize, mctx->bsize );
+#if defined( AK_HAVE_SYSMMAN_H ) && !defined( AK_HAVE_WINDOWS_H )
+ /* отображаем файл в память и обрабатываем его целиком */
+  if(( localbuffer = ak_file_mmap( &file, NULL, readonly, 0 )) != NULL ) {
+    error = ak_mac_finalize( mctx, localbuffer, ( size_t )file.size, out, out_size );
+    ak_file_unmap( &file, localbuffer );
+    ak_mac_clean( mctx );
+    return error;
+  }
+ /* файл не может быть отображен в память (например, из-за размера адресного пространства),
+    поэтому переходим к последовательному чтению */
+  ak_error_set_value( ak_error_ok );
+#endif
+
  /* здесь мы выделяем локальный буффер для считывания/обработки данных */
-  if(( localbuffer = ( ak_uint8 * ) ak_aligned_malloc( block_size )) == NULL ) {
+  if(( localbuffer = ( ak_uint8 * ) ak_aligned_malloc( ak_mac_file_buffer_size )) == NULL ) {
     ak_file_close( &file );
     return ak_error_message( ak_error_out_of_memory, __func__ ,
                                                       "memory allocation error for local buffer" );
   }
  /* теперь обрабатываем файл с данными */
-  read_label: len = ( size_t ) ak_file_read( &file, localbuffer, block_size );
-  if( len == block_size ) {
-    ak_mac_update( mctx, localbuffer, block_size ); /* добавляем считанные данные */
-    goto read_label;
-  } else {
-           size_t qcnt = len / mctx->bsize,
-                  tail = len - qcnt*mctx->bsize;
-           if( qcnt ) ak_mac_update( mctx, localbuffer, qcnt*mctx->bsize );
-           error = ak_mac_finalize( mctx,
-                                             localbuffer + qcnt*mctx->bsize, tail, out, out_size );
-         }
+  while(( len = ak_file_read( &file, localbuffer, ak_mac_file_buffer_size )) > 0 )
+    if(( error = ak_mac_update( mctx, localbuffer, ( size_t ) len )) != ak_error_ok ) break;
+
+  if( error == ak_error_ok ) {
+    if( len < 0 ) error = ak_error_message_fmt( ak_error_read_data, __func__,
+                                                      "wrong reading a file %s", filename );
+     else error = ak_mac_finalize( mctx, "", 0, out, out_size );
+  }
  /* очищаем за собой данные, содержащиеся в контексте */
   ak_mac_clean( mctx );
  /* закрываем данные */
   ak_file_close( &file );
+  memset( localbuffer, 0, ak_mac_file_buffer_size );
   free( localbuffer );
  return error;
 }
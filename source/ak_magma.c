@@ -8,6 +8,10 @@
 /* ----------------------------------------------------------------------------------------------- */
  #include <libakrypt-internal.h>
 
+#if defined( AK_HAVE_BUILTIN_SHUFFLE_EPI8 ) && defined( AK_LITTLE_ENDIAN )
+ #include <immintrin.h>
+#endif
+
 /* о масированной реализации Магмы смотри
    S. V. Matveev, “GOST 28147-89 masking against side channel attacks”,
    Матем. вопр. криптогр., 6:2 (2015).                                   */
@@ -639,6 +643,330 @@
 #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                  одновременная обработка нескольких независимых блоков данных                   */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Максимальное количество блоков, обрабатываемых одновременно. */
+ #define ak_magma_blocks_count  (8)
+
+/*! \brief Последовательность индексов раундовых ключей, используемая при зашифровании. */
+ static const ak_uint8 magma_encrypt_key_index[32] = {
+   7, 6, 5, 4, 3, 2, 1, 0, 7, 6, 5, 4, 3, 2, 1, 0, 7, 6, 5, 4, 3, 2, 1, 0, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+/*! \brief Последовательность индексов раундовых ключей, используемая при расшифровании. */
+ static const ak_uint8 magma_decrypt_key_index[32] = {
+   7, 6, 5, 4, 3, 2, 1, 0, 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует преобразование последовательности независимых блоков информации
+    алгоритмом ГОСТ 34.12-2015 (Магма).
+
+    Блоки обрабатываются группами, содержащими не более \ref ak_magma_blocks_count блоков.
+    Для каждой группы вырабатывается одна случайная траектория, после чего такты сети
+    Фейстеля выполняются для всех блоков группы попеременно. Тем самым, с одной стороны,
+    совмещаются по времени обращения к таблицам замен, выполняемые для различных блоков,
+    с другой стороны, сокращается количество обращений к генератору случайных чисел.
+
+    @param skey Контекст секретного ключа.
+    @param in Указатель на входные данные.
+    @param out Указатель на область памяти, куда помещается результат (может совпадать с `in`).
+    @param blocks Количество обрабатываемых блоков.
+    @param kidx Последовательность индексов раундовых ключей (определяет зашифрование
+    или расшифрование).
+    @param oc Флаг совместимости с библиотекой openssl.                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_magma_blocks_with_random_walk( ak_skey skey, ak_pointer in,
+             ak_pointer out, size_t blocks, const ak_uint8 *kidx, const unsigned int oc )
+{
+  ak_uint8 m[34];
+  size_t k = 0, n = 0;
+  ak_uint32 i, mv = 0, p = 0;
+  ak_uint32 n3[ak_magma_blocks_count], n4[ak_magma_blocks_count];
+  ak_uint32 *inptr = (ak_uint32 *) in, *outptr = (ak_uint32 *) out;
+  ak_uint32 (*kp)[8] = ((struct magma_encrypted_keys *)skey->data)->inkey;
+  ak_uint32 (*mp)[8] = ((struct magma_encrypted_keys *)skey->data)->inmask;
+
+  while( blocks > 0 ) {
+     n = ak_min( blocks, ak_magma_blocks_count );
+
+    /* вырабатываем случайную траекторию и формируем вектор раундовых поворотов */
+     skey->generator.random( &skey->generator, &mv, sizeof( ak_uint32 ));
+     if( oc ) {
+       m[0] = m[1] = m[32] = m[33] = 0;
+       for( i = 1; i < 31; i++ ) m[i+1] = (ak_uint8)(( mv >> i) & 0x01 );
+     } else {
+         m[0] = m[33] = 0;
+         for( i = 0; i < 32; i++ ) m[i+1] = (ak_uint8)(( mv >> i) & 0x01 );
+       }
+
+    /* загружаем блоки */
+     for( k = 0; k < n; k++ ) {
+      #ifdef AK_LITTLE_ENDIAN
+        if( oc ) {
+          n4[k] = bswap_32( inptr[2*k] )^( m[1] * 0xffffffff );
+          n3[k] = bswap_32( inptr[2*k+1] );
+        } else {
+            n3[k] = inptr[2*k]^( m[1] * 0xffffffff );
+            n4[k] = inptr[2*k+1];
+          }
+      #else
+        if( oc ) {
+          n4[k] = inptr[2*k]^( m[1] * 0xffffffff );
+          n3[k] = inptr[2*k+1];
+        } else {
+            n3[k] = bswap_32( inptr[2*k] )^( m[1] * 0xffffffff );
+            n4[k] = bswap_32( inptr[2*k+1] );
+          }
+      #endif
+     }
+
+    /* начинаем движение: за одну итерацию выполняются два такта для всех блоков группы */
+     for( i = 1; i < 33; i += 2 ) {
+        for( k = 0; k < n; k++ ) {
+           p = n3[k]; p -= mp[m[i]][kidx[i-1]]; p += kp[m[i]][kidx[i-1]] + m[i];
+           n4[k] ^= ak_magma_gostf_boxes( p, m[i+1] ^ m[i-1], m[i] );
+        }
+        for( k = 0; k < n; k++ ) {
+           p = n4[k]; p -= mp[m[i+1]][kidx[i]]; p += kp[m[i+1]][kidx[i]] + m[i+1];
+           n3[k] ^= ak_magma_gostf_boxes( p, m[i+2] ^ m[i], m[i+1] );
+        }
+     }
+
+    /* сохраняем результат */
+     for( k = 0; k < n; k++ ) {
+      #ifdef AK_LITTLE_ENDIAN
+        if( oc ) {
+          outptr[2*k+1] = bswap_32( n4[k] )^( m[32] * 0xffffffff );
+          outptr[2*k] = bswap_32( n3[k] );
+        } else {
+            outptr[2*k] = n4[k]^( m[32] * 0xffffffff );
+            outptr[2*k+1] = n3[k];
+          }
+      #else
+        if( oc ) {
+          outptr[2*k+1] = n4[k]^( m[32] * 0xffffffff );
+          outptr[2*k] = n3[k];
+        } else {
+            outptr[2*k] = bswap_32( n4[k] )^( m[32] * 0xffffffff );
+            outptr[2*k+1] = bswap_32( n3[k] );
+          }
+      #endif
+     }
+     blocks -= n; inptr += 2*n; outptr += 2*n;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Зашифрование последовательности независимых блоков алгоритмом Магма. */
+ static void ak_magma_encrypt_blocks_with_random_walk( ak_skey skey,
+                                                 ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_magma_blocks_with_random_walk( skey, in, out, blocks, magma_encrypt_key_index, 0 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Расшифрование последовательности независимых блоков алгоритмом Магма. */
+ static void ak_magma_decrypt_blocks_with_random_walk( ak_skey skey,
+                                                 ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_magma_blocks_with_random_walk( skey, in, out, blocks, magma_decrypt_key_index, 0 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Зашифрование последовательности независимых блоков алгоритмом Магма
+    в режиме совместимости с библиотекой openssl. */
+ static void ak_magma_encrypt_blocks_with_random_walk_oc( ak_skey skey,
+                                                 ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_magma_blocks_with_random_walk( skey, in, out, blocks, magma_encrypt_key_index, 1 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Расшифрование последовательности независимых блоков алгоритмом Магма
+    в режиме совместимости с библиотекой openssl. */
+ static void ak_magma_decrypt_blocks_with_random_walk_oc( ak_skey skey,
+                                                 ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_magma_blocks_with_random_walk( skey, in, out, blocks, magma_decrypt_key_index, 1 );
+}
+
+#if defined( AK_HAVE_BUILTIN_SHUFFLE_EPI8 ) && defined( AK_LITTLE_ENDIAN )
+/* ----------------------------------------------------------------------------------------------- */
+/*                   векторная реализация, использующая 256-ти битные регистры AVX2                */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество групп из восьми блоков, обрабатываемых одновременно (всего 32 блока). */
+ #define ak_magma_vperm_groups  (4)
+
+/*! \brief Таблицы замен для векторной реализации: первые четыре строки содержат значения
+    узлов замены для младших тетрад байт, последние четыре - для старших тетрад (со сдвигом).
+    \details Таблицы формируются функцией ak_bckey_magma_init_dispatch(). */
+ static ak_uint8 magma_vperm_boxes[8][16];
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция выполняет 32 такта сети Фейстеля для нескольких групп из восьми блоков.
+
+    Каждый 32-х битный элемент регистра содержит половину одного блока. Нелинейное преобразование
+    вычисляется инструкцией pshufb: для каждой позиции байта в 32-х битном слове используются
+    свои таблицы для младшей и старшей тетрад, а байты, находящиеся в других позициях, обнуляются
+    установкой старшего бита индекса. Обращения к памяти не зависят от обрабатываемых данных.
+
+    Раундовые ключи используются в маскированном виде: маска вычитается, а маскированный
+    ключ прибавляется к обрабатываемой половине блока.
+
+    @param skey Контекст секретного ключа.
+    @param n3 Массив младших половин блоков.
+    @param n4 Массив старших половин блоков.
+    @param groups Количество обрабатываемых групп (не более \ref ak_magma_vperm_groups).
+    @param kidx Последовательность индексов раундовых ключей.                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ static __attribute__((target("avx2"))) void ak_magma_vperm256( ak_skey skey,
+                          __m256i *n3, __m256i *n4, const size_t groups, const ak_uint8 *kidx )
+{
+  size_t g;
+  int b, i;
+  __m256i lot[4], hit[4], sel[4], k, m, p, lo, hi, r, mask = _mm256_set1_epi8( 0x0f );
+  ak_uint32 (*kp)[8] = ((struct magma_encrypted_keys *)skey->data)->inkey;
+  ak_uint32 (*mp)[8] = ((struct magma_encrypted_keys *)skey->data)->inmask;
+
+  for( b = 0; b < 4; b++ ) {
+     lot[b] = _mm256_broadcastsi128_si256(
+                                _mm_loadu_si128(( const __m128i *) magma_vperm_boxes[b] ));
+     hit[b] = _mm256_broadcastsi128_si256(
+                                _mm_loadu_si128(( const __m128i *) magma_vperm_boxes[4+b] ));
+     sel[b] = _mm256_set1_epi32(( int )( 0x80808080 ^ ( 0x80u << ( b << 3 ))));
+  }
+
+ /* такт преобразования: y ^= (( x + k ) -> замены -> циклический сдвиг на 11 разрядов ) */
+  #define ak_magma_vperm_round( x, y ) \
+   p = _mm256_add_epi32( _mm256_sub_epi32( (x), m ), k ); \
+   lo = _mm256_and_si256( p, mask ); \
+   hi = _mm256_and_si256( _mm256_srli_epi32( p, 4 ), mask ); \
+   r = _mm256_setzero_si256(); \
+   for( b = 0; b < 4; b++ ) { \
+      r = _mm256_or_si256( r, _mm256_shuffle_epi8( lot[b], _mm256_or_si256( lo, sel[b] ))); \
+      r = _mm256_or_si256( r, _mm256_shuffle_epi8( hit[b], _mm256_or_si256( hi, sel[b] ))); \
+   } \
+   (y) = _mm256_xor_si256( (y), \
+                    _mm256_or_si256( _mm256_slli_epi32( r, 11 ), _mm256_srli_epi32( r, 21 )));
+
+  for( i = 0; i < 32; i += 2 ) {
+     k = _mm256_set1_epi32(( int ) kp[0][kidx[i]] );
+     m = _mm256_set1_epi32(( int ) mp[0][kidx[i]] );
+     for( g = 0; g < groups; g++ ) { ak_magma_vperm_round( n3[g], n4[g] ); }
+     k = _mm256_set1_epi32(( int ) kp[0][kidx[i+1]] );
+     m = _mm256_set1_epi32(( int ) mp[0][kidx[i+1]] );
+     for( g = 0; g < groups; g++ ) { ak_magma_vperm_round( n4[g], n3[g] ); }
+  }
+  #undef ak_magma_vperm_round
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует преобразование последовательности независимых блоков информации
+    с использованием векторной реализации.
+
+    Блоки обрабатываются группами по 32 блока; неполная последняя группа дополняется нулями
+    во временном буффере. Если необработанными остаются менее 8 блоков (меньше, чем помещается
+    в одну пару векторных регистров), то они обрабатываются табличной реализацией
+    ak_magma_blocks_with_random_walk(), поскольку копирование во временный буффер и обработка
+    пустых строк регистров требуют больше времени.
+
+    @param skey Контекст секретного ключа.
+    @param in Указатель на входные данные.
+    @param out Указатель на область памяти, куда помещается результат (может совпадать с `in`).
+    @param blocks Количество обрабатываемых блоков.
+    @param kidx Последовательность индексов раундовых ключей.
+    @param oc Флаг совместимости с библиотекой openssl.                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ static __attribute__((target("avx2"))) void ak_magma_blocks_vperm( ak_skey skey,
+              ak_pointer in, ak_pointer out, size_t blocks, const ak_uint8 *kidx, const bool_t oc )
+{
+  size_t g, n, groups;
+  __m256i a, c, e, o, n3[ak_magma_vperm_groups], n4[ak_magma_vperm_groups];
+  ak_uint8 *inptr = ( ak_uint8 *) in, *outptr = ( ak_uint8 *) out, *iptr, *optr;
+  ak_uint8 temp[64*ak_magma_vperm_groups];
+  const __m256i swap = _mm256_setr_epi8(
+                      3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                      3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 );
+
+  while( blocks > 0 ) {
+     if( blocks < 8 ) {
+       ak_magma_blocks_with_random_walk( skey, inptr, outptr, blocks, kidx, oc );
+       return;
+     }
+     n = ak_min( blocks, 8*ak_magma_vperm_groups );
+     groups = ( n+7 ) >> 3;
+     if( n < 8*groups ) { /* неполная группа обрабатывается во временном буффере */
+       memset( temp, 0, sizeof( temp ));
+       memcpy( temp, inptr, n << 3 );
+       iptr = optr = temp;
+     } else { iptr = inptr; optr = outptr; }
+
+    /* загружаем блоки: разделяем четные и нечетные 32-х битные слова */
+     for( g = 0; g < groups; g++ ) {
+        a = _mm256_loadu_si256(( const __m256i *)( iptr + 64*g ));
+        c = _mm256_loadu_si256(( const __m256i *)( iptr + 64*g + 32 ));
+        e = _mm256_castps_si256( _mm256_shuffle_ps(
+                      _mm256_castsi256_ps( a ), _mm256_castsi256_ps( c ), _MM_SHUFFLE( 2, 0, 2, 0 )));
+        o = _mm256_castps_si256( _mm256_shuffle_ps(
+                      _mm256_castsi256_ps( a ), _mm256_castsi256_ps( c ), _MM_SHUFFLE( 3, 1, 3, 1 )));
+        if( oc ) {
+          n4[g] = _mm256_shuffle_epi8( e, swap );
+          n3[g] = _mm256_shuffle_epi8( o, swap );
+        } else { n3[g] = e; n4[g] = o; }
+     }
+
+     ak_magma_vperm256( skey, n3, n4, groups, kidx );
+
+    /* сохраняем результат, меняя местами половины блоков */
+     for( g = 0; g < groups; g++ ) {
+        if( oc ) {
+          e = _mm256_shuffle_epi8( n3[g], swap );
+          o = _mm256_shuffle_epi8( n4[g], swap );
+        } else { e = n4[g]; o = n3[g]; }
+        _mm256_storeu_si256(( __m256i *)( optr + 64*g ), _mm256_unpacklo_epi32( e, o ));
+        _mm256_storeu_si256(( __m256i *)( optr + 64*g + 32 ), _mm256_unpackhi_epi32( e, o ));
+     }
+     if( optr == temp ) memcpy( outptr, temp, n << 3 );
+
+     blocks -= n; inptr += ( n << 3 ); outptr += ( n << 3 );
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Зашифрование последовательности независимых блоков (векторная реализация). */
+ static void ak_magma_encrypt_blocks_vperm( ak_skey skey,
+                                                 ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_magma_blocks_vperm( skey, in, out, blocks, magma_encrypt_key_index, ak_false );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Расшифрование последовательности независимых блоков (векторная реализация). */
+ static void ak_magma_decrypt_blocks_vperm( ak_skey skey,
+                                                 ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_magma_blocks_vperm( skey, in, out, blocks, magma_decrypt_key_index, ak_false );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Зашифрование последовательности независимых блоков (векторная реализация)
+    в режиме совместимости с библиотекой openssl. */
+ static void ak_magma_encrypt_blocks_vperm_oc( ak_skey skey,
+                                                 ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_magma_blocks_vperm( skey, in, out, blocks, magma_encrypt_key_index, ak_true );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Расшифрование последовательности независимых блоков (векторная реализация)
+    в режиме совместимости с библиотекой openssl. */
+ static void ak_magma_decrypt_blocks_vperm_oc( ak_skey skey,
+                                                 ak_pointer in, ak_pointer out, size_t blocks )
+{
+  ak_magma_blocks_vperm( skey, in, out, blocks, magma_decrypt_key_index, ak_true );
+}
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция уничтожения развернутых ключей для маскированной магмы
 
@@ -903,6 +1231,43 @@
     else return ak_false;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция помещает в таблицу указатели на функции групповой обработки блоков,
+    наиболее подходящие для используемого процессора. Функция вызывается из ak_libakrypt_create()
+    после определения возможностей процессора.
+
+    @param table Таблица реализаций, поле `features` которой уже определено.                      */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_bckey_magma_init_dispatch( ak_cpu_dispatch table )
+{
+#if defined( AK_HAVE_BUILTIN_SHUFFLE_EPI8 ) && defined( AK_LITTLE_ENDIAN )
+  int b, v;
+#endif
+
+  table->magma_encrypt_blocks[0] = ak_magma_encrypt_blocks_with_random_walk;
+  table->magma_encrypt_blocks[1] = ak_magma_encrypt_blocks_with_random_walk_oc;
+  table->magma_decrypt_blocks[0] = ak_magma_decrypt_blocks_with_random_walk;
+  table->magma_decrypt_blocks[1] = ak_magma_decrypt_blocks_with_random_walk_oc;
+  table->magma_name = "random walk tables";
+
+#if defined( AK_HAVE_BUILTIN_SHUFFLE_EPI8 ) && defined( AK_LITTLE_ENDIAN )
+ /* при наличии инструкций AVX2 групповая обработка блоков выполняется без таблиц замен */
+  if( table->features&ak_cpu_feature_avx2 ) {
+    for( b = 0; b < 4; b++ ) {
+       for( v = 0; v < 16; v++ ) {
+          magma_vperm_boxes[b][v] = magma_boxes[0][0][b][v]&0x0F;
+          magma_vperm_boxes[4+b][v] = magma_boxes[0][0][b][v << 4]&0xF0;
+       }
+    }
+    table->magma_encrypt_blocks[0] = ak_magma_encrypt_blocks_vperm;
+    table->magma_encrypt_blocks[1] = ak_magma_encrypt_blocks_vperm_oc;
+    table->magma_decrypt_blocks[0] = ak_magma_decrypt_blocks_vperm;
+    table->magma_decrypt_blocks[1] = ak_magma_decrypt_blocks_vperm_oc;
+    table->magma_name = "avx2 vector permutation";
+  }
+#endif
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция инициализируете контекст ключа алгоритма блочного шифрования Магма (ГОСТ Р 34.12-2015).
     После инициализации устанавливаются обработчики (функции класса). Однако само значение
@@ -914,12 +1279,14 @@
 /* ----------------------------------------------------------------------------------------------- */
  int ak_bckey_create_magma( ak_bckey bkey )
 {
-  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option( openssl_compability_option );
 
   if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                "using null pointer to block cipher key context" );
   if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
                                                 "wrong value for \"openssl_compability\" option" );
+  if(( error = ak_libakrypt_lazy_test( block_cipher_test_family )) != ak_error_ok )
+    return ak_error_message( error, __func__, "magma failed dynamic control" );
 
  /* создаем ключ алгоритма шифрования и определяем его методы */
   if(( error = ak_bckey_create( bkey, 32, 8 )) != ak_error_ok )
@@ -946,16 +1313,94 @@
   if( oc ) {
     bkey->encrypt = ak_magma_encrypt_with_random_walk_oc;
     bkey->decrypt = ak_magma_decrypt_with_random_walk_oc;
+    bkey->encrypt_blocks = ak_magma_encrypt_blocks_with_random_walk_oc;
+    bkey->decrypt_blocks = ak_magma_decrypt_blocks_with_random_walk_oc;
   }
    else {
     bkey->encrypt = ak_magma_encrypt_with_random_walk;
     bkey->decrypt = ak_magma_decrypt_with_random_walk;
+    bkey->encrypt_blocks = ak_magma_encrypt_blocks_with_random_walk;
+    bkey->decrypt_blocks = ak_magma_decrypt_blocks_with_random_walk;
+  }
+
+ /* реализация групповой обработки блоков выбирается в зависимости от возможностей процессора */
+  if( ak_libakrypt_dispatch.magma_encrypt_blocks[oc] != NULL ) {
+    bkey->encrypt_blocks = ak_libakrypt_dispatch.magma_encrypt_blocks[oc];
+    bkey->decrypt_blocks = ak_libakrypt_dispatch.magma_decrypt_blocks[oc];
   }
   return error;
 }
 
 /* ----------------------------------------------------------------------------------------------- */
- static bool_t ak_libakrypt_test_magma_complete( void )
+/*! \brief Функция возвращает истину, если при создании ключа выбирается векторная реализация
+    групповой обработки блоков.                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_libakrypt_test_magma_vperm( void )
+{
+#if defined( AK_HAVE_BUILTIN_SHUFFLE_EPI8 ) && defined( AK_LITTLE_ENDIAN )
+  if( ak_libakrypt_dispatch.magma_encrypt_blocks[0] == ak_magma_encrypt_blocks_vperm )
+    return ak_true;
+#endif
+ return ak_false;
+}
+
+#if defined( AK_HAVE_BUILTIN_SHUFFLE_EPI8 ) && defined( AK_LITTLE_ENDIAN )
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Максимальное количество блоков, используемое для сравнения векторной
+    и табличной реализаций. */
+ #define ak_magma_test_vperm_blocks  ( 8*ak_magma_vperm_groups + 11 )
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция сравнивает результаты зашифрования и расшифрования последовательности блоков,
+    полученные векторной реализацией, установленной в ключе, и табличной реализацией.
+    Контрольные примеры стандарта содержат всего четыре блока и поэтому обрабатываются
+    векторной реализацией без использования векторных инструкций. Проверяются последовательности
+    из 43 блоков (полная группа и неполная группа, дополняемая нулями) и из 35 блоков
+    (полная группа и остаток, обрабатываемый табличной реализацией).
+
+    \param bkey Контекст ключа с установленным значением.
+    \param oc Флаг совместимости с библиотекой openssl.
+    \return Функция возвращает \ref ak_true, если результаты совпадают.                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_libakrypt_test_magma_vperm_blocks( ak_bckey bkey, const int oc )
+{
+  size_t i = 0, j = 0;
+  bool_t result = ak_true;
+  const size_t count[2] = { ak_magma_test_vperm_blocks, 8*ak_magma_vperm_groups + 3 };
+  ak_uint8 data[8*ak_magma_test_vperm_blocks], out[8*ak_magma_test_vperm_blocks],
+                                                               check[8*ak_magma_test_vperm_blocks];
+
+  for( i = 0; i < sizeof( data ); i++ ) data[i] = ( ak_uint8 )( i*7 + ( i >> 3 ));
+
+  for( j = 0; j < 2; j++ ) {
+    /* зашифрование */
+     bkey->encrypt_blocks( &bkey->key, data, out, count[j] );
+     if( oc ) ak_magma_encrypt_blocks_with_random_walk_oc( &bkey->key, data, check, count[j] );
+      else ak_magma_encrypt_blocks_with_random_walk( &bkey->key, data, check, count[j] );
+     if( !ak_ptr_is_equal_with_log( out, check, 8*count[j] )) {
+       ak_error_message_fmt( ak_error_not_equal_data, __func__ ,
+                        "vector and table realizations of %u blocks encryption are different",
+                                                                         (unsigned int) count[j] );
+       result = ak_false;
+     }
+
+    /* расшифрование */
+     bkey->decrypt_blocks( &bkey->key, check, out, count[j] );
+     if( !ak_ptr_is_equal_with_log( out, data, 8*count[j] )) {
+       ak_error_message_fmt( ak_error_not_equal_data, __func__ ,
+              "vector realization of %u blocks decryption is wrong", (unsigned int) count[j] );
+       result = ak_false;
+     }
+  }
+
+  memset( out, 0, sizeof( out ));
+  memset( check, 0, sizeof( check ));
+ return result;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_libakrypt_test_magma_complete( const bool_t vperm )
 {
  /* значение секретного ключа согласно ГОСТ Р 34.12-2015 для алгоритма Магма, приложение А.2 */
   ak_uint8 key_magma[32] = {
@@ -1105,7 +1550,7 @@
   ak_uint8 myout[256];
   bool_t result = ak_true;
   int error = ak_error_ok, audit = ak_log_get_level(),
-      oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+      oc = (int) ak_libakrypt_get_option( openssl_compability_option );
 
  /* Проверка используемого режима совместимости */
   if(( oc < 0 ) || ( oc > 1 )) {
@@ -1144,6 +1589,17 @@
     return ak_false;
   }
 
+ /* выбираем тестируемую реализацию групповой обработки блоков */
+  if( !vperm ) {
+    mkey.encrypt_blocks = oc ? ak_magma_encrypt_blocks_with_random_walk_oc :
+                                                         ak_magma_encrypt_blocks_with_random_walk;
+    mkey.decrypt_blocks = oc ? ak_magma_decrypt_blocks_with_random_walk_oc :
+                                                         ak_magma_decrypt_blocks_with_random_walk;
+  }
+  if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__, vperm ?
+              "testing vector permutation realization of multiple blocks processing" :
+                                      "testing table realization of multiple blocks processing" );
+
   if(( error = ak_bckey_set_key( &mkey, oc ? openssl_key_magma : key_magma,
                                                            sizeof( key_magma ))) != ak_error_ok ) {
     ak_error_message( error, __func__, "wrong creation of test key" );
@@ -1183,6 +1639,16 @@
   if( audit >= ak_log_maximum ) ak_error_message( ak_error_ok, __func__ ,
                 "the ecb mode encryption/decryption test from GOST R 34.13-2015 is Ok" );
 
+#if defined( AK_HAVE_BUILTIN_SHUFFLE_EPI8 ) && defined( AK_LITTLE_ENDIAN )
+ /* сравниваем векторную реализацию с табличной на последовательностях из нескольких групп блоков */
+  if( vperm && !ak_libakrypt_test_magma_vperm_blocks( &mkey, oc )) {
+    ak_error_message( ak_error_not_equal_data, __func__ ,
+                             "the comparison of multiple blocks processing realizations is wrong" );
+    result = ak_false;
+    goto exit;
+  }
+#endif
+
  /* ----------------------------------------------------------------- */
  /* 3. Проверяем режим гаммирования согласно ГОСТ Р 34.12-2015        */
  /* ----------------------------------------------------------------- */
@@ -1438,14 +1904,15 @@
 /* ----------------------------------------------------------------------------------------------- */
  bool_t ak_libakrypt_test_magma( void )
 {
- int oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+ int oc = (int) ak_libakrypt_get_option( openssl_compability_option );
 
  /* мы тестируем алгоритм Магма в двух режимах совместимисти,
     вызывая для этого функцию тестирования дважды
 
     сначала запуск в базовом режиме работы библиотеки */
    ak_libakrypt_set_openssl_compability( ak_false );
-   if( ak_libakrypt_test_magma_complete() != ak_true ) {
+   if( !ak_libakrypt_test_magma_complete( ak_false ) ||
+       ( ak_libakrypt_test_magma_vperm() && !ak_libakrypt_test_magma_complete( ak_true ))) {
      ak_error_message( ak_error_get_value(), __func__ ,
                                             "incorrect testing of magma algorithm in base mode" );
      return ak_false;
@@ -1453,7 +1920,8 @@
 
  /* потом запускаем тестирование в режиме совместимости с openssl */
    ak_libakrypt_set_openssl_compability( ak_true );
-   if( ak_libakrypt_test_magma_complete() != ak_true ) {
+   if( !ak_libakrypt_test_magma_complete( ak_false ) ||
+       ( ak_libakrypt_test_magma_vperm() && !ak_libakrypt_test_magma_complete( ak_true ))) {
      ak_error_message( ak_error_get_value(), __func__ ,
                          "incorrect testing of magma algorithm in mode with openssl compability" );
      return ak_false;
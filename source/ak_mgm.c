@@ -51,23 +51,6 @@
     \note Алгоритм аутентифицированного шифрования может не принимать на вход зашифровываемые
     данные. В этом случае алгоритм должен действовать как обычный алгоритм имитозащиты.   */
 
-/* ----------------------------------------------------------------------------------------------- */
-/*! \brief Структура, содержащая текущее состояние внутренних переменных режима `mgm`
-   аутентифицированного шифрования. */
- typedef struct mgm_ctx {
-  /*! \brief Текущее значение имитовставки. */
-   ak_uint128 sum;
-  /*! \brief Счетчик, значения которого используются при шифровании информации. */
-   ak_uint128 ycount;
-  /*! \brief Счетчик, значения которого используются при выработке имитовставки. */
-   ak_uint128 zcount;
-  /*! \brief Размер обработанных зашифровываемых/расшифровываемых данных в битах. */
-   ssize_t pbitlen;
-  /*! \brief Размер обработанных дополнительных данных в битах. */
-   ssize_t abitlen;
-  /*! \brief Флаги состояния контекста. */
-   ak_uint32 flags;
-} *ak_mgm_ctx;
 /** @} */
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -129,6 +112,64 @@
  return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Увеличение на единицу 32-х и 64-х битных половин счетчиков алгоритма MGM,
+    хранящихся в big-endian формате.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+#ifdef AK_LITTLE_ENDIAN
+ #define ak_mgm_increment32(x) (x)++;
+ #define ak_mgm_increment64(x) (x)++;
+#else
+ #define ak_mgm_increment32(x) (x) = bswap_32( bswap_32( (x) ) + 1 );
+ #define ak_mgm_increment64(x) (x) = bswap_64( bswap_64( (x) ) + 1 );
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает группу полных блоков данных и обновляет значение имитовставки.
+
+    Последовательные значения счетчика zcount формируются заранее и зашифровываются
+    одним вызовом функции encrypt_blocks, после чего сумма произведений полученных значений
+    на блоки данных вычисляется функцией ak_gf128_mul_sum() (ak_gf64_mul_sum()),
+    выполняющей одно приведение по модулю для всей группы блоков.
+
+    @param ctx Контекст внутреннего состояния алгоритма
+    @param authenticationKey Ключ блочного алгоритма шифрования
+    @param data Указатель на обрабатываемые данные
+    @param blocks Количество полных блоков данных                                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_mgm_authentication_blocks( ak_mgm_ctx ctx,
+                       ak_bckey authenticationKey, const ak_uint8 *data, size_t blocks )
+{
+  size_t k = 0, n = 0;
+  ak_uint64 z[ak_bckey_batch_words];
+
+  if( authenticationKey->bsize == 16 ) {
+    while( blocks > 0 ) {
+       n = ak_min( blocks, ak_bckey_batch_words >> 1 );
+       for( k = 0; k < n; k++ ) {
+          z[2*k] = ctx->zcount.q[0]; z[2*k+1] = ctx->zcount.q[1];
+          ak_mgm_increment64( ctx->zcount.q[1] );
+       }
+       authenticationKey->encrypt_blocks( &authenticationKey->key, z, z, n );
+       ak_gf128_mul_sum( ctx->sum.q, z, (ak_pointer) data, n );
+       data += ( n << 4 );
+       blocks -= n;
+    }
+  } else {
+    while( blocks > 0 ) {
+       n = ak_min( blocks, ak_bckey_batch_words );
+       for( k = 0; k < n; k++ ) {
+          z[k] = ctx->zcount.q[0];
+          ak_mgm_increment32( ctx->zcount.w[1] );
+       }
+       authenticationKey->encrypt_blocks( &authenticationKey->key, z, z, n );
+       ak_gf64_mul_sum( ctx->sum.q, z, (ak_pointer) data, n );
+       data += ( n << 3 );
+       blocks -= n;
+    }
+  }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 #ifdef AK_LITTLE_ENDIAN
  #define astep64(DATA)  authenticationKey->encrypt( &authenticationKey->key, &ctx->zcount, &h ); \
@@ -204,7 +245,8 @@
  if( absize == 16 ) { /* обработка 128-битным шифром */
 
    ctx->abitlen += ( blocks  << 7 );
-   for( ; blocks > 0; blocks--, aptr += 16 ) { astep128( aptr ); }
+   ak_mgm_authentication_blocks( ctx, authenticationKey, aptr, ( size_t )blocks );
+   aptr += ( blocks << 4 );
    if( tail ) {
     memset( temp, 0, 16 );
     memcpy( temp+absize-tail, aptr, (size_t)tail );
@@ -217,7 +259,8 @@
  } else { /* обработка 64-битным шифром */
 
    ctx->abitlen += ( blocks << 6 );
-   for( ; blocks > 0; blocks--, aptr += 8 ) { astep64( aptr ); }
+   ak_mgm_authentication_blocks( ctx, authenticationKey, aptr, ( size_t )blocks );
+   aptr += ( blocks << 3 );
    if( tail ) {
     memset( temp, 0, 8 );
     memcpy( temp+absize-tail, aptr, (size_t)tail );
@@ -351,30 +394,115 @@
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-#ifdef AK_LITTLE_ENDIAN
- #define estep64  encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e ); \
-                  outp[0] = inp[0] ^ e.q[0]; \
-                  ctx->ycount.w[0]++;
+/*! \brief Функция зашифровывает (расшифровывает) группу полных блоков данных.
 
- #define estep128 encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e ); \
-                  outp[0] = inp[0] ^ e.q[0]; \
-                  outp[1] = inp[1] ^ e.q[1]; \
-                  ctx->ycount.q[0]++;
+    Последовательные значения счетчика ycount формируются заранее и зашифровываются
+    одним вызовом функции encrypt_blocks, после чего полученная гамма складывается с данными.
 
-#else
- #define estep64  encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e ); \
-                  outp[0] = inp[0] ^ e.q[0]; \
-                  ctx->ycount.w[0] = bswap_32( ctx->ycount.w[0] ); \
-                  ctx->ycount.w[0]++; \
-                  ctx->ycount.w[0] = bswap_32( ctx->ycount.w[0] );
-
- #define estep128 encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e ); \
-                  outp[0] = inp[0] ^ e.q[0]; \
-                  outp[1] = inp[1] ^ e.q[1]; \
-                  ctx->ycount.q[0] = bswap_64( ctx->ycount.q[0] ); \
-                  ctx->ycount.q[0]++; \
-                  ctx->ycount.q[0] = bswap_64( ctx->ycount.q[0] );
-#endif
+    @param ctx Контекст внутреннего состояния алгоритма
+    @param encryptionKey Ключ блочного алгоритма шифрования
+    @param inp Указатель на входные данные
+    @param outp Указатель на область памяти, куда помещаются выходные данные
+    @param blocks Количество полных блоков данных                                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_mgm_encryption_blocks( ak_mgm_ctx ctx,
+                   ak_bckey encryptionKey, const ak_uint64 *inp, ak_uint64 *outp, size_t blocks )
+{
+  size_t k = 0, n = 0;
+  ak_uint64 y[ak_bckey_batch_words];
+
+  if( encryptionKey->bsize == 16 ) {
+    while( blocks > 0 ) {
+       n = ak_min( blocks, ak_bckey_batch_words >> 1 );
+       for( k = 0; k < n; k++ ) {
+          y[2*k] = ctx->ycount.q[0]; y[2*k+1] = ctx->ycount.q[1];
+          ak_mgm_increment64( ctx->ycount.q[0] );
+       }
+       encryptionKey->encrypt_blocks( &encryptionKey->key, y, y, n );
+       for( k = 0; k < 2*n; k++ ) outp[k] = inp[k] ^ y[k];
+       inp += 2*n; outp += 2*n;
+       blocks -= n;
+    }
+  } else {
+    while( blocks > 0 ) {
+       n = ak_min( blocks, ak_bckey_batch_words );
+       for( k = 0; k < n; k++ ) {
+          y[k] = ctx->ycount.q[0];
+          ak_mgm_increment32( ctx->ycount.w[0] );
+       }
+       encryptionKey->encrypt_blocks( &encryptionKey->key, y, y, n );
+       for( k = 0; k < n; k++ ) outp[k] = inp[k] ^ y[k];
+       inp += n; outp += n;
+       blocks -= n;
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает (расшифровывает) группу полных блоков данных с одновременным
+    обновлением значения имитовставки.
+
+    Для каждой группы блоков значения счетчиков ycount и zcount формируются заранее. Если для
+    шифрования и выработки имитовставки используется один и тот же ключ, то оба набора
+    счетчиков зашифровываются одним вызовом функции encrypt_blocks, что позволяет
+    использовать все блоки, обрабатываемые параллельно реализацией блочного шифра.
+    Сумма произведений вычисляется функцией ak_gf128_mul_sum() (ak_gf64_mul_sum())
+    с одним приведением по модулю для всей группы.
+
+    @param ctx Контекст внутреннего состояния алгоритма
+    @param encryptionKey Ключ шифрования
+    @param authenticationKey Ключ выработки имитовставки
+    @param inp Указатель на входные данные
+    @param outp Указатель на область памяти, куда помещаются выходные данные
+    @param blocks Количество полных блоков данных
+    @param decrypt Если значение истинно, то имитовставка вычисляется от входных данных
+    (расшифрование), в противном случае - от выходных (зашифрование)                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_mgm_encryption_authentication_blocks( ak_mgm_ctx ctx, ak_bckey encryptionKey,
+                      ak_bckey authenticationKey, const ak_uint64 *inp, ak_uint64 *outp,
+                                                        size_t blocks, const bool_t decrypt )
+{
+  size_t k = 0, n = 0, words = encryptionKey->bsize >> 3;
+  ak_uint64 y[2*ak_bckey_batch_words], *z = NULL;
+
+  while( blocks > 0 ) {
+     n = ak_min( blocks, ak_bckey_batch_words/words );
+     z = y + n*words; /* счетчики zcount размещаются сразу за счетчиками ycount */
+     if( words == 2 ) {
+       for( k = 0; k < n; k++ ) {
+          y[2*k] = ctx->ycount.q[0]; y[2*k+1] = ctx->ycount.q[1];
+          ak_mgm_increment64( ctx->ycount.q[0] );
+          z[2*k] = ctx->zcount.q[0]; z[2*k+1] = ctx->zcount.q[1];
+          ak_mgm_increment64( ctx->zcount.q[1] );
+       }
+     } else {
+       for( k = 0; k < n; k++ ) {
+          y[k] = ctx->ycount.q[0];
+          ak_mgm_increment32( ctx->ycount.w[0] );
+          z[k] = ctx->zcount.q[0];
+          ak_mgm_increment32( ctx->zcount.w[1] );
+       }
+     }
+     if( encryptionKey == authenticationKey )
+       encryptionKey->encrypt_blocks( &encryptionKey->key, y, y, 2*n );
+      else {
+       encryptionKey->encrypt_blocks( &encryptionKey->key, y, y, n );
+       authenticationKey->encrypt_blocks( &authenticationKey->key, z, z, n );
+      }
+
+     if( decrypt ) {
+       if( words == 2 ) ak_gf128_mul_sum( ctx->sum.q, z, (ak_pointer) inp, n );
+        else ak_gf64_mul_sum( ctx->sum.q, z, (ak_pointer) inp, n );
+       for( k = 0; k < n*words; k++ ) outp[k] = inp[k] ^ y[k];
+     } else {
+       for( k = 0; k < n*words; k++ ) outp[k] = inp[k] ^ y[k];
+       if( words == 2 ) ak_gf128_mul_sum( ctx->sum.q, z, outp, n );
+        else ak_gf64_mul_sum( ctx->sum.q, z, outp, n );
+     }
+     inp += n*words; outp += n*words;
+     blocks -= n;
+  }
+}
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция зашифровывает очередной фрагмент данных и
@@ -436,9 +564,8 @@
 
     if( absize&0x10 ) { /* режим работы для 128-битного шифра */
      /* основная часть */
-      for( ; blocks > 0; blocks--, inp += 2, outp += 2 ) {
-         estep128;
-      }
+      ak_mgm_encryption_blocks( ctx, encryptionKey, inp, outp, blocks );
+      inp += ( blocks << 1 ); outp += ( blocks << 1 );
       /* хвост */
       if( tail ) {
         encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e );
@@ -451,9 +578,8 @@
 
     } else { /* режим работы для 64-битного шифра */
        /* основная часть */
-        for( ; blocks > 0; blocks--, inp++, outp++ ) {
-           estep64;
-        }
+        ak_mgm_encryption_blocks( ctx, encryptionKey, inp, outp, blocks );
+        inp += blocks; outp += blocks;
        /* хвост */
         if( tail ) {
           encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e );
@@ -469,10 +595,9 @@
 
      if( absize&0x10 ) { /* режим работы для 128-битного шифра */
       /* основная часть */
-      for( ; blocks > 0; blocks--, inp += 2, outp += 2 ) {
-         estep128;
-         astep128( outp );
-      }
+      ak_mgm_encryption_authentication_blocks( ctx, encryptionKey, authenticationKey,
+                                                                    inp, outp, blocks, ak_false );
+      inp += ( blocks << 1 ); outp += ( blocks << 1 );
       /* хвост */
       if( tail ) {
         memset( temp, 0, 16 );
@@ -489,10 +614,9 @@
 
     } else { /* режим работы для 64-битного шифра */
       /* основная часть */
-       for( ; blocks > 0; blocks--, inp++, outp++ ) {
-          estep64;
-          astep64( outp );
-       }
+       ak_mgm_encryption_authentication_blocks( ctx, encryptionKey, authenticationKey,
+                                                                    inp, outp, blocks, ak_false );
+       inp += blocks; outp += blocks;
        /* хвост */
        if( tail ) {
          memset( temp, 0, 8 );
@@ -572,9 +696,8 @@
                                     /* это полная копия кода, содержащегося в функции .. _encryption_ ... */
     if( absize&0x10 ) { /* режим работы для 128-битного шифра */
      /* основная часть */
-      for( ; blocks > 0; blocks--, inp += 2, outp += 2 ) {
-         estep128;
-      }
+      ak_mgm_encryption_blocks( ctx, encryptionKey, inp, outp, blocks );
+      inp += ( blocks << 1 ); outp += ( blocks << 1 );
       /* хвост */
       if( tail ) {
         encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e );
@@ -587,9 +710,8 @@
 
     } else { /* режим работы для 64-битного шифра */
        /* основная часть */
-        for( ; blocks > 0; blocks--, inp++, outp++ ) {
-           estep64;
-        }
+        ak_mgm_encryption_blocks( ctx, encryptionKey, inp, outp, blocks );
+        inp += blocks; outp += blocks;
        /* хвост */
         if( tail ) {
           encryptionKey->encrypt( &encryptionKey->key, &ctx->ycount, &e );
@@ -605,10 +727,9 @@
 
      if( absize&0x10 ) { /* режим работы для 128-битного шифра */
       /* основная часть */
-      for( ; blocks > 0; blocks--, inp += 2, outp += 2 ) {
-         astep128( inp );
-         estep128;
-      }
+      ak_mgm_encryption_authentication_blocks( ctx, encryptionKey, authenticationKey,
+                                                                     inp, outp, blocks, ak_true );
+      inp += ( blocks << 1 ); outp += ( blocks << 1 );
       /* хвост */
       if( tail ) {
         memset( temp, 0, 16 );
@@ -625,10 +746,9 @@
 
     } else { /* режим работы для 64-битного шифра */
       /* основная часть */
-       for( ; blocks > 0; blocks--, inp++, outp++ ) {
-          astep64( inp );
-          estep64;
-       }
+       ak_mgm_encryption_authentication_blocks( ctx, encryptionKey, authenticationKey,
+                                                                     inp, outp, blocks, ak_true );
+       inp += blocks; outp += blocks;
        /* хвост */
        if( tail ) {
          memset( temp, 0, 8 );
@@ -902,6 +1022,540 @@
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                обработка данных, разбитых на несколько фрагментов (scatter/gather)              */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет суммарную длину фрагментов. */
+ static size_t ak_mgm_iovector_size( ak_iovector iov, const size_t count )
+{
+  size_t i = 0, size = 0;
+
+  if( iov != NULL )
+    for( i = 0; i < count; i++ ) size += iov[i].size;
+ return size;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Обработка фрагмента ассоциированных данных (контекст - struct mgm_stream). */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_mgm_iovector_authentication( ak_pointer ctx,
+                                                 ak_pointer in, ak_pointer out, const size_t size )
+{
+  ak_mgm_stream sx = ( ak_mgm_stream )ctx;
+  (void) out;
+ return ak_mgm_authentication_update( &sx->state, sx->authenticationKey, in, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Зашифрование фрагмента данных (контекст - struct mgm_stream). */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_mgm_iovector_encryption( ak_pointer ctx,
+                                                 ak_pointer in, ak_pointer out, const size_t size )
+{
+  ak_mgm_stream sx = ( ak_mgm_stream )ctx;
+ return ak_mgm_encryption_update( &sx->state,
+                                           sx->encryptionKey, sx->authenticationKey, in, out, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Расшифрование фрагмента данных (контекст - struct mgm_stream). */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_mgm_iovector_decryption( ak_pointer ctx,
+                                                 ak_pointer in, ak_pointer out, const size_t size )
+{
+  ak_mgm_stream sx = ( ak_mgm_stream )ctx;
+ return ak_mgm_decryption_update( &sx->state,
+                                           sx->encryptionKey, sx->authenticationKey, in, out, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает ассоциированные и зашифровываемые (расшифровываемые) данные,
+    разбитые на фрагменты; имитовставка не вычисляется. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_mgm_iovector_process( ak_mgm_stream sx, ak_iovector adata, const size_t acount,
+              ak_iovector in, const size_t count, ak_iovector out, const size_t out_count,
+                 const ak_pointer iv, const size_t iv_size, ak_function_iovector_update *update )
+{
+  size_t bs = 0;
+  int error = ak_error_ok;
+
+ /* проверки ключей */
+  if(( sx->encryptionKey == NULL ) && ( sx->authenticationKey == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__ ,
+                               "using null pointers both to encryption and authentication keys" );
+  if(( sx->encryptionKey != NULL ) && ( sx->authenticationKey != NULL )) {
+    if( sx->encryptionKey->bsize != sx->authenticationKey->bsize )
+      return ak_error_message( ak_error_not_equal_data, __func__,
+                                                   "different block sizes for given secret keys");
+  }
+  if( sx->encryptionKey != NULL ) bs = sx->encryptionKey->bsize;
+    else bs = sx->authenticationKey->bsize;
+
+ /* проверяем размер входных данных */
+  if(( error = ak_bckey_check_mgm_length( ak_mgm_iovector_size( adata, acount ),
+                                         ak_mgm_iovector_size( in, count ), bs )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect length of input data");
+
+ /* в начале обрабатываем ассоциированные данные */
+  if( sx->authenticationKey != NULL ) {
+    if(( error = ak_mgm_authentication_clean( &sx->state,
+                                       sx->authenticationKey, iv, iv_size )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect initialization of internal mgm context" );
+    if(( error = ak_bckey_iovector_update( adata, acount, NULL, 0, bs,
+                                     ak_mgm_iovector_authentication, sx )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect hashing of associated data" );
+  }
+
+ /* потом зашифровываем (расшифровываем) данные */
+  if( sx->encryptionKey != NULL ) {
+    if(( error = ak_mgm_encryption_clean( &sx->state,
+                                           sx->encryptionKey, iv, iv_size )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect initialization of internal mgm context" );
+    if(( error = ak_bckey_iovector_update( in, count, out, out_count,
+                                                             bs, update, sx )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect processing of fragmented data" );
+  }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует режим `mgm` для данных, разбитых на несколько фрагментов произвольной
+    длины, например, для сетевого пакета, заголовок и содержимое которого расположены в различных
+    областях памяти. Результат совпадает с результатом вызова функции ak_bckey_encrypt_mgm()
+    для данных, полученных последовательным объединением всех фрагментов, при этом
+    копирование фрагментов в одну область памяти не производится: блоки, пересекающие
+    границы фрагментов, собираются во временном буффере, остальные блоки обрабатываются
+    непосредственно в памяти фрагментов.
+
+    Требования к ключам, синхропосылке и имитовставке совпадают с требованиями, предъявляемыми
+    к параметрам функции ak_bckey_encrypt_mgm().
+
+    @param encryptionKey ключ шифрования; может принимать значение `NULL`;
+    @param authenticationKey ключ выработки имитовставки; может принимать значение `NULL`;
+    @param adata массив фрагментов ассоциированных (незашифровываемых) данных;
+    @param acount количество фрагментов ассоциированных данных;
+    @param in массив фрагментов зашифровываемых данных;
+    @param count количество фрагментов зашифровываемых данных;
+    @param out массив фрагментов, в которые помещаются зашифрованные данные; разбиение
+           на фрагменты может отличаться от разбиения массива `in`, должна совпадать только
+           общая длина данных;
+    @param out_count количество фрагментов массива `out`;
+    @param iv указатель на синхропосылку;
+    @param iv_size длина синхропосылки в байтах;
+    @param icode указатель на область памяти, куда будет помещено значение имитовставки;
+    @param icode_size ожидаемый размер имитовставки в байтах.
+
+   @return Функция возвращает \ref ak_error_ok в случае успешного завершения.
+   В противном случае, возвращается код ошибки.                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_encrypt_mgm_v( ak_pointer encryptionKey, ak_pointer authenticationKey,
+                  ak_iovector adata, const size_t acount, ak_iovector in, const size_t count,
+              ak_iovector out, const size_t out_count, const ak_pointer iv, const size_t iv_size,
+                                                         ak_pointer icode, const size_t icode_size )
+{
+  int error = ak_error_ok;
+  struct mgm_stream sx; /* контекст, в котором хранятся ключи и промежуточные данные */
+
+  memset( &sx, 0, sizeof( struct mgm_stream ));
+  sx.encryptionKey = encryptionKey;
+  sx.authenticationKey = authenticationKey;
+  if(( error = ak_mgm_iovector_process( &sx, adata, acount, in, count, out, out_count,
+                                        iv, iv_size, ak_mgm_iovector_encryption )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect encryption of fragmented data" );
+
+ /* в конце - вырабатываем имитовставку */
+  if(( error == ak_error_ok ) && ( authenticationKey != NULL )) {
+    if(( error = ak_mgm_authentication_finalize( &sx.state,
+                                         authenticationKey, icode, icode_size )) != ak_error_ok )
+      ak_error_message( error, __func__, "incorrect finanlize of integrity code" );
+  }
+  if( sx.authenticationKey != NULL )
+    ak_ptr_wipe( &sx.state, sizeof( struct mgm_ctx ), &sx.authenticationKey->key.generator );
+   else if( sx.encryptionKey != NULL )
+     ak_ptr_wipe( &sx.state, sizeof( struct mgm_ctx ), &sx.encryptionKey->key.generator );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует процедуру расшифрования с одновременной проверкой целостности данных,
+    разбитых на несколько фрагментов произвольной длины. Требования к передаваемым параметрам
+    аналогичны требованиям, предъявляемым к параметрам функции ak_bckey_encrypt_mgm_v().
+
+    @return Функция возвращает \ref ak_error_ok, если значение имитовтсавки совпало с
+            вычисленным в ходе выполнения функции значением; если значения не совпадают,
+            или в ходе выполнения функции возникла ошибка, то возвращается код ошибки.             */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_decrypt_mgm_v( ak_pointer encryptionKey, ak_pointer authenticationKey,
+                  ak_iovector adata, const size_t acount, ak_iovector in, const size_t count,
+              ak_iovector out, const size_t out_count, const ak_pointer iv, const size_t iv_size,
+                                                         ak_pointer icode, const size_t icode_size )
+{
+  int error = ak_error_ok;
+  ak_uint8 icode2[16];
+  struct mgm_stream sx; /* контекст, в котором хранятся ключи и промежуточные данные */
+
+  memset( &sx, 0, sizeof( struct mgm_stream ));
+  sx.encryptionKey = encryptionKey;
+  sx.authenticationKey = authenticationKey;
+  if(( error = ak_mgm_iovector_process( &sx, adata, acount, in, count, out, out_count,
+                                        iv, iv_size, ak_mgm_iovector_decryption )) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect decryption of fragmented data" );
+
+ /* в конце - проверяем имитовставку */
+  if(( error == ak_error_ok ) && ( authenticationKey != NULL )) {
+    memset( icode2, 0, sizeof( icode2 ));
+    if(( error = ak_mgm_authentication_finalize( &sx.state,
+                                          authenticationKey, icode2, icode_size )) != ak_error_ok )
+      ak_error_message( error, __func__, "incorrect finalize of integrity code" );
+     else {
+        if( ak_ptr_is_equal( icode, icode2, icode_size )) error = ak_error_ok;
+          else error = ak_error_not_equal_data;
+     }
+  }
+  if( sx.authenticationKey != NULL )
+    ak_ptr_wipe( &sx.state, sizeof( struct mgm_ctx ), &sx.authenticationKey->key.generator );
+   else if( sx.encryptionKey != NULL )
+     ak_ptr_wipe( &sx.state, sizeof( struct mgm_ctx ), &sx.encryptionKey->key.generator );
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                     потоковая обработка данных в режиме аутентифицированного шифрования mgm     */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обновления внутреннего состояния при зашифровании/расшифровании данных. */
+ typedef int ( ak_function_mgm_update )( ak_mgm_ctx , ak_bckey , ak_bckey ,
+                                                  const ak_pointer , ak_pointer , const size_t );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция инициализирует контекст, предназначенный для обработки данных, поступающих
+    последовательными фрагментами произвольной длины. В отличие от функции ak_bckey_encrypt_mgm()
+    объем используемой памяти не зависит от длины обрабатываемых данных.
+
+    Последовательность вызовов имеет вид: ak_mgm_stream_init(), ноль или более вызовов
+    ak_mgm_stream_aad_update(), ноль или более вызовов ak_mgm_stream_encrypt_update()
+    (ak_mgm_stream_decrypt_update()), вызов ak_mgm_stream_encrypt_finalize()
+    (ak_mgm_stream_decrypt_finalize()) и, в заключение, ak_mgm_stream_destroy().
+    Результат вычислений совпадает с результатом однократного вызова функции ak_bckey_encrypt_mgm()
+    для тех же данных.
+
+    @param ctx Контекст потокового шифрования
+    @param encryptionKey Ключ шифрования, должен быть инициализирован перед вызовом функции
+    @param authenticationKey Ключ выработки имитовставки, должен быть инициализирован перед
+           вызовом функции; может совпадать с ключом шифрования
+    @param iv Указатель на синхропосылку
+    @param iv_size Длина синхропосылки в байтах
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_mgm_stream_init( ak_mgm_stream ctx, ak_bckey encryptionKey,
+                         ak_bckey authenticationKey, const ak_pointer iv, const size_t iv_size )
+{
+  int error = ak_error_ok;
+
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                    "using null pointer to mgm stream context" );
+  if(( encryptionKey == NULL ) || ( authenticationKey == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__ , "using null pointer to secret key" );
+  if( encryptionKey->bsize != authenticationKey->bsize )
+    return ak_error_message( ak_error_not_equal_data, __func__,
+                                                   "different block sizes for given secret keys");
+  memset( ctx, 0, sizeof( struct mgm_stream ));
+  if(( error = ak_mgm_authentication_clean( &ctx->state,
+                                           authenticationKey, iv, iv_size )) != ak_error_ok ) {
+    ak_ptr_wipe( ctx, sizeof( struct mgm_stream ), &authenticationKey->key.generator );
+    return ak_error_message( error, __func__, "incorrect initialization of internal mgm context" );
+  }
+  if(( error = ak_mgm_encryption_clean( &ctx->state,
+                                               encryptionKey, iv, iv_size )) != ak_error_ok ) {
+    ak_ptr_wipe( ctx, sizeof( struct mgm_stream ), &encryptionKey->key.generator );
+    return ak_error_message( error, __func__, "incorrect initialization of internal mgm context" );
+  }
+  ctx->encryptionKey = encryptionKey;
+  ctx->authenticationKey = authenticationKey;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция обрабатывает очередной фрагмент ассоциированных данных. Длина фрагмента может быть
+    произвольной: неполный блок сохраняется в контексте и обрабатывается вместе со следующим
+    фрагментом. Функция может вызываться только до начала обработки шифруемых данных.
+
+    @param ctx Контекст потокового шифрования
+    @param adata Указатель на ассоциированные данные
+    @param adata_size Длина ассоциированных данных в байтах
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_mgm_stream_aad_update( ak_mgm_stream ctx, const ak_pointer adata, const size_t adata_size )
+{
+  int error = ak_error_ok;
+  ak_uint8 *aptr = (ak_uint8 *)adata;
+  size_t bsize = 0, take = 0, size = adata_size;
+
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                    "using null pointer to mgm stream context" );
+  if( ctx->authenticationKey == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                         "using uninitialized mgm stream context" );
+  if( ctx->state.flags&ak_aead_assosiated_data_bit )
+    return ak_error_message( ak_error_wrong_block_cipher_function, __func__ ,
+                                                  "attemp to update previously closed mgm context");
+  if( size == 0 ) return ak_error_ok;
+  if( adata == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                         "using null pointer to associated data" );
+  bsize = ctx->authenticationKey->bsize;
+
+ /* дополняем ранее сохраненный неполный блок */
+  if( ctx->alength ) {
+    take = ak_min( bsize - ctx->alength, size );
+    memcpy( ctx->abuffer + ctx->alength, aptr, take );
+    ctx->alength += take; aptr += take; size -= take;
+    if( ctx->alength < bsize ) return ak_error_ok;
+    if(( error = ak_mgm_authentication_update( &ctx->state,
+                               ctx->authenticationKey, ctx->abuffer, bsize )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect hashing of associated data" );
+    ctx->alength = 0;
+  }
+
+ /* обрабатываем полные блоки и сохраняем остаток */
+  take = size - size%bsize;
+  if(( take > 0 ) && (( error = ak_mgm_authentication_update( &ctx->state,
+                                      ctx->authenticationKey, aptr, take )) != ak_error_ok ))
+    return ak_error_message( error, __func__, "incorrect hashing of associated data" );
+  if(( ctx->alength = size - take ) > 0 ) memcpy( ctx->abuffer, aptr + take, ctx->alength );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция завершает обработку ассоциированных данных. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_mgm_stream_close_adata( ak_mgm_stream ctx )
+{
+  int error = ak_error_ok;
+
+  if( ctx->state.flags&ak_aead_assosiated_data_bit ) return ak_error_ok;
+  if( ctx->alength ) {
+    if(( error = ak_mgm_authentication_update( &ctx->state,
+                      ctx->authenticationKey, ctx->abuffer, ctx->alength )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect hashing of associated data" );
+    ctx->alength = 0;
+  }
+  ak_aead_set_bit( ctx->state.flags, ak_aead_assosiated_data_bit );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает очередной фрагмент зашифровываемых (расшифровываемых) данных.
+
+    Полные блоки обрабатываются немедленно, неполный блок в конце фрагмента сохраняется
+    в контексте, поскольку способ его обработки зависит от того, будет ли он последним.
+
+    @return Количество октетов, помещенных в out, или отрицательный код ошибки.                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static ssize_t ak_mgm_stream_update( ak_mgm_stream ctx, const ak_pointer in, ak_pointer out,
+                                            const size_t size, ak_function_mgm_update *update )
+{
+  int error = ak_error_ok;
+  ak_uint8 *inp = (ak_uint8 *)in, *outp = (ak_uint8 *)out;
+  size_t bsize = 0, take = 0, len = size;
+  ssize_t written = 0;
+
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                    "using null pointer to mgm stream context" );
+  if( ctx->encryptionKey == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                         "using uninitialized mgm stream context" );
+  if(( error = ak_mgm_stream_close_adata( ctx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect finalizing of associated data" );
+  if( ctx->state.flags&ak_aead_encrypted_data_bit )
+    return ak_error_message( ak_error_wrong_block_cipher_function, __func__ ,
+                                                  "attemp to update previously closed mgm context");
+  if( len == 0 ) return 0;
+  if(( in == NULL ) || ( out == NULL )) return ak_error_message( ak_error_null_pointer,
+                                                    __func__ , "using null pointer to data" );
+  bsize = ctx->encryptionKey->bsize;
+
+ /* дополняем ранее сохраненный неполный блок */
+  if( ctx->length ) {
+    take = ak_min( bsize - ctx->length, len );
+    memcpy( ctx->buffer + ctx->length, inp, take );
+    ctx->length += take; inp += take; len -= take;
+    if( ctx->length < bsize ) return 0;
+    if(( error = update( &ctx->state, ctx->encryptionKey, ctx->authenticationKey,
+                                                   ctx->buffer, outp, bsize )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect processing of data" );
+    outp += bsize; written += ( ssize_t )bsize;
+    ctx->length = 0;
+  }
+
+ /* обрабатываем полные блоки и сохраняем остаток */
+  take = len - len%bsize;
+  if( take > 0 ) {
+    if(( error = update( &ctx->state, ctx->encryptionKey, ctx->authenticationKey,
+                                                               inp, outp, take )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect processing of data" );
+    written += ( ssize_t )take;
+  }
+  if(( ctx->length = len - take ) > 0 ) memcpy( ctx->buffer, inp + take, ctx->length );
+
+ return written;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает сохраненный в контексте неполный блок и вычисляет имитовставку. */
+/* ----------------------------------------------------------------------------------------------- */
+ static ssize_t ak_mgm_stream_finalize( ak_mgm_stream ctx, ak_pointer out,
+                    ak_pointer icode, const size_t icode_size, ak_function_mgm_update *update )
+{
+  int error = ak_error_ok;
+  ssize_t written = 0;
+
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                    "using null pointer to mgm stream context" );
+  if( ctx->encryptionKey == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                         "using uninitialized mgm stream context" );
+  if(( error = ak_mgm_stream_close_adata( ctx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect finalizing of associated data" );
+  if( ctx->length ) {
+    if( out == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                        "using null pointer to output buffer" );
+    if(( error = update( &ctx->state, ctx->encryptionKey, ctx->authenticationKey,
+                                              ctx->buffer, out, ctx->length )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect processing of data" );
+    written = ( ssize_t )ctx->length;
+    ctx->length = 0;
+  }
+  if(( error = ak_mgm_authentication_finalize( &ctx->state,
+                                   ctx->authenticationKey, icode, icode_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect finanlize of integrity code" );
+
+ return written;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция зашифровывает очередной фрагмент данных произвольной длины. Неполный блок в конце
+    фрагмента сохраняется в контексте и зашифровывается при следующем вызове функции,
+    либо при вызове ak_mgm_stream_encrypt_finalize(), поэтому количество зашифрованных октетов
+    может отличаться от длины фрагмента не более чем на длину блока.
+
+    Указатели in и out могут совпадать, если длины всех ранее обработанных фрагментов
+    кратны длине блока; в противном случае области памяти не должны пересекаться.
+
+    @param ctx Контекст потокового шифрования
+    @param in Указатель на зашифровываемые данные
+    @param out Указатель на область памяти, куда помещаются зашифрованные данные;
+           размер области должен быть не менее size + 15 октетов
+    @param size Длина зашифровываемого фрагмента в байтах
+
+    @return Количество октетов, помещенных в out. В случае возникновения ошибки
+    возвращается ее код (отрицательное число).                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ ssize_t ak_mgm_stream_encrypt_update( ak_mgm_stream ctx, const ak_pointer in,
+                                                             ak_pointer out, const size_t size )
+{
+  return ak_mgm_stream_update( ctx, in, out, size, ak_mgm_encryption_update );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция зашифровывает сохраненный в контексте неполный блок данных и вырабатывает
+    имитовставку от всех обработанных ассоциированных и зашифрованных данных.
+
+    @param ctx Контекст потокового шифрования
+    @param out Указатель на область памяти (не менее 16 октетов), куда помещаются последние
+           зашифрованные данные
+    @param icode Указатель на область памяти, куда помещается имитовставка
+    @param icode_size Ожидаемый размер имитовставки в байтах
+
+    @return Количество октетов, помещенных в out (всегда меньше длины блока).
+    В случае возникновения ошибки возвращается ее код (отрицательное число).                       */
+/* ----------------------------------------------------------------------------------------------- */
+ ssize_t ak_mgm_stream_encrypt_finalize( ak_mgm_stream ctx, ak_pointer out,
+                                                          ak_pointer icode, const size_t icode_size )
+{
+  return ak_mgm_stream_finalize( ctx, out, icode, icode_size, ak_mgm_encryption_update );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция расшифровывает очередной фрагмент данных произвольной длины. Требования к параметрам
+    аналогичны требованиям функции ak_mgm_stream_encrypt_update().
+
+    \note Расшифрованные данные становятся доступны до проверки имитовставки; они не должны
+    использоваться, если функция ak_mgm_stream_decrypt_finalize() вернула код ошибки.
+
+    @param ctx Контекст потокового шифрования
+    @param in Указатель на расшифровываемые данные
+    @param out Указатель на область памяти, куда помещаются расшифрованные данные
+    @param size Длина расшифровываемого фрагмента в байтах
+
+    @return Количество октетов, помещенных в out. В случае возникновения ошибки
+    возвращается ее код (отрицательное число).                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ ssize_t ak_mgm_stream_decrypt_update( ak_mgm_stream ctx, const ak_pointer in,
+                                                             ak_pointer out, const size_t size )
+{
+  return ak_mgm_stream_update( ctx, in, out, size, ak_mgm_decryption_update );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция расшифровывает сохраненный в контексте неполный блок данных, вычисляет имитовставку
+    и сравнивает ее с заданным значением. Время сравнения не зависит от значений имитовставок.
+
+    @param ctx Контекст потокового шифрования
+    @param out Указатель на область памяти (не менее 16 октетов), куда помещаются последние
+           расшифрованные данные
+    @param icode Указатель на проверяемое значение имитовставки
+    @param icode_size Размер имитовставки в байтах
+
+    @return Количество октетов, помещенных в out (всегда меньше длины блока). Если значение
+    имитовставки не совпало с вычисленным, возвращается \ref ak_error_not_equal_data; в случае
+    возникновения иной ошибки возвращается ее код.                                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ ssize_t ak_mgm_stream_decrypt_finalize( ak_mgm_stream ctx, ak_pointer out,
+                                                    const ak_pointer icode, const size_t icode_size )
+{
+  ssize_t written = 0;
+  ak_uint8 icode2[16];
+
+  if( icode == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                          "using null pointer to integrity code" );
+  memset( icode2, 0, sizeof( icode2 ));
+  if(( written = ak_mgm_stream_finalize( ctx, out,
+                                     icode2, icode_size, ak_mgm_decryption_update )) < 0 )
+    return ak_error_message( ( int )written, __func__, "incorrect finalize of integrity code" );
+  if( !ak_ptr_is_equal( icode, icode2,
+                                   ak_min( icode_size, ctx->authenticationKey->bsize )))
+    written = ak_error_not_equal_data;
+  ak_ptr_wipe( icode2, sizeof( icode2 ), &ctx->authenticationKey->key.generator );
+
+ return written;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param ctx Контекст потокового шифрования
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_mgm_stream_destroy( ak_mgm_stream ctx )
+{
+  ak_random generator = NULL;
+
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                    "using null pointer to mgm stream context" );
+  if( ctx->authenticationKey == NULL ) {
+    memset( ctx, 0, sizeof( struct mgm_stream ));
+    return ak_error_ok;
+  }
+  generator = &ctx->authenticationKey->key.generator;
+  ak_ptr_wipe( ctx, sizeof( struct mgm_stream ), generator );
+  memset( ctx, 0, sizeof( struct mgm_stream ));
+
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  bool_t ak_libakrypt_test_mgm( void )
 {
@@ -4,7 +4,7 @@
 /*  Файл ak_mpzn.c                                                                                 */
 /*  - содержит реализации функций для вычислений с большими целыми числами                         */
 /* ----------------------------------------------------------------------------------------------- */
- #include <libakrypt.h>
+ #include <libakrypt-internal.h>
 
 /* ----------------------------------------------------------------------------------------------- */
 /** \addtogroup math-doc Математические функции
@@ -644,6 +644,39 @@
 /* реализованы операции сложения и умножения вычетов по материалам статьи                          */
 /* C. Koc, T.Acar, B. Kaliski Analyzing and Comparing Montgomery Multiplication Algorithms         */
 /*                                                             IEEE Micro, 16(3):26-33, June 1996. */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Окончательное приведение результата операции Монтгомери.
+
+    Функция вычисляет разность \f$ t + 2^{64\cdot size}hi - p \f$ и помещает в z либо ее,
+    либо значение t, если разность отрицательна. Выбор выполняется с помощью маски, поэтому
+    последовательность выполняемых операций и обращений к памяти не зависит от значений
+    аргументов. Указатель z не должен совпадать с указателем t.
+
+    @param z Вычет, в который помещается результат
+    @param t Приводимое значение (младшие size слов)
+    @param p Модуль
+    @param hi Старшее слово приводимого значения (0 или 1)
+    @param size Размер модуля в словах                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mpzn_montgomery_select( ak_uint64 *z, ak_uint64 *t, ak_uint64 *p,
+                                                          const ak_uint64 hi, const size_t size )
+{
+  size_t i;
+  ak_uint64 av = 0, bv = 0, cy = 0, mask = 0;
+
+  for( i = 0; i < size; i++ ) {
+     av = t[i];
+     bv = av - cy;
+     cy = bv > av;
+     av = bv - p[i];
+     cy += av > bv;
+     z[i] = av;
+  }
+ /* маска состоит из единиц только в случае, когда t < p */
+  mask = hi - cy;
+  for( i = 0; i < size; i++ ) z[i] = ( z[i]&~mask )|( t[i]&mask );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция складывает два вычета x и y по модулю p, после чего приводит полученную сумму
     по модулю p, то есть вычисляет значение сравнения \f$ z \equiv x + y \pmod{p}\f$.
@@ -672,17 +705,9 @@
      cy += bv < av;
      t[i] = bv;
   }
-  t[size] = cy; cy = 0;
+  t[size] = cy;
  // потом вычитаем: (t - p) -> z
-  for( i = 0; i < size; i++, p++ ) {
-     av = t[i];
-     bv = av - cy;
-     cy = bv > av;
-     av = bv - *p;
-     cy += av > bv;
-     z[i] = av;
-  }
-  if( t[size] != cy ) memcpy( z, t, size*sizeof( ak_uint64 ));
+  ak_mpzn_montgomery_select( z, t, p, t[size], size );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -702,21 +727,60 @@
  void ak_mpzn_lshift_montgomery( ak_uint64 *z, ak_uint64 *x, ak_uint64 *p, const size_t size )
 {
   size_t i;
-  ak_uint64 av = 0, bv = 0, cy = 0;
   ak_mpznmax t = ak_mpznmax_zero;
 
   t[size] = 0;
-  for( i = 0; i < size; i++, p++ ) {
+  for( i = 0; i < size; i++ ) {
     t[i+1] =  (( x[i]&0x8000000000000000LL ) > 0 );
     t[i] |= x[i] << 1; // сначала сдвигаем на один разряд влево
-    av = t[i];         // потом вычитаем модуль
-    bv = av - cy;
-    cy = bv > av;
-    av = bv - *p;
-    cy += av > bv;
-    z[i] = av;
    }
-   if( t[size] != cy ) memcpy( z, t, size*sizeof( ak_uint64 ));
+   ak_mpzn_montgomery_select( z, t, p, t[size], size ); // потом вычитаем модуль
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Умножение вычетов в представлении Монтгомери с чередованием умножения и приведения
+    (вариант CIOS, Coarsely Integrated Operand Scanning, из статьи Koc, Acar, Kaliski).
+
+    После прибавления к промежуточному значению очередного произведения \f$ x_iy \f$
+    сразу выполняется его приведение, поэтому промежуточное значение занимает
+    только size+2 слова. Функция вызывается с константным значением size, что позволяет
+    компилятору полностью развернуть циклы для каждого из используемых размеров модуля.       */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mpzn_mul_montgomery_cios( ak_uint64 *z, ak_uint64 *x, ak_uint64 *y,
+                                               ak_uint64 *p, ak_uint64 n0, const size_t size )
+{
+  size_t i = 0, j = 0;
+  ak_uint64 c = 0, m = 0, w1 = 0, w0 = 0;
+  ak_mpznmax t;
+
+  memset( t, 0, ( size+2 )*sizeof( ak_uint64 ));
+  for( i = 0; i < size; i++ ) {
+    /* t <- t + x[i]y */
+     for( j = 0, c = 0; j < size; j++ ) {
+        umul_ppmm( w1, w0, x[i], y[j] );
+        w0 += c;
+        w1 += w0 < c;
+        t[j] += w0;
+        c = w1 + ( t[j] < w0 );
+     }
+     t[size] += c;
+     t[size+1] = t[size] < c;
+
+    /* t <- ( t + mp )/2^64, младшее слово суммы t + mp равно нулю */
+     m = t[0]*n0;
+     umul_ppmm( w1, w0, m, p[0] );
+     c = w1 + (( t[0] + w0 ) < w0 );
+     for( j = 1; j < size; j++ ) {
+        umul_ppmm( w1, w0, m, p[j] );
+        w0 += c;
+        w1 += w0 < c;
+        t[j-1] = t[j] + w0;
+        c = w1 + ( t[j-1] < w0 );
+     }
+     t[size-1] = t[size] + c;
+     t[size] = t[size+1] + ( t[size-1] < c );
+  }
+  ak_mpzn_montgomery_select( z, t, p, t[size], size );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -727,6 +791,9 @@
     Результат помещается в переменную z. Указатель на z может совпадать с одним из указателей на
     перемножаемые вычеты.
 
+    Для модулей длины 256 и 512 бит используются отдельные, полностью развернутые компилятором,
+    варианты умножения. Окончательное вычитание модуля выполняется без ветвлений.
+
     @param z Указатель на вычет, в который помещается результат
     @param x Левый аргумент опреации сложения
     @param y Правый аргумент операции сложения
@@ -736,65 +803,223 @@
     @param size Размер модуля в словах (значение константы \ref ak_mpzn256_size или
                                                                           \ref ak_mpzn512_size).   */
 /* ----------------------------------------------------------------------------------------------- */
- inline void ak_mpzn_mul_montgomery( ak_uint64 *z, ak_uint64 *x, ak_uint64 *y,
+ void ak_mpzn_mul_montgomery_uint64( ak_uint64 *z, ak_uint64 *x, ak_uint64 *y,
                                                ak_uint64 *p, ak_uint64 n0, const size_t size )
 {
-  size_t i = 0, j = 0, ij = 0;
-  ak_uint64 av = 0, bv = 0, cy = 0;
-  ak_mpznmax t = ak_mpznmax_zero;
+  switch( size ) {
+    case ak_mpzn256_size:
+      ak_mpzn_mul_montgomery_cios( z, x, y, p, n0, ak_mpzn256_size );
+      break;
+    case ak_mpzn512_size:
+      ak_mpzn_mul_montgomery_cios( z, x, y, p, n0, ak_mpzn512_size );
+      break;
+    default:
+      ak_mpzn_mul_montgomery_cios( z, x, y, p, n0, size );
+  }
+}
 
-  // ak_mpzn_mul( t, x, y, size );
-  for( i = 0; i < size; i++ ) {
-     ak_uint64 c = 0, m = x[i];
-     for( j = 0, ij = i; j < size; j++ , ij++ ) {
-        ak_uint64 w1, w0, cy;
-        umul_ppmm( w1, w0, m, y[j] );
-        t[ij] += c;
-        cy = t[ij] < c;
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вызывает реализацию умножения, выбранную при инициализации библиотеки для
+    используемого процессора. Внутри библиотеки вместо функции используется одноименный макрос,
+    вызывающий ту же реализацию напрямую (имя функции взято в скобки, чтобы макрос
+    не подставлялся в ее определение).
+
+    @param z Указатель на вычет, в который помещается результат
+    @param x Левый множитель
+    @param y Правый множитель
+    @param p Модуль, по которому производятся вычисления
+    @param n0 Константа, используемая в вычислениях
+    @param size Размер модуля в словах                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ void ( ak_mpzn_mul_montgomery )( ak_uint64 *z, ak_uint64 *x, ak_uint64 *y,
+                                               ak_uint64 *p, ak_uint64 n0, const size_t size )
+{
+  ak_libakrypt_dispatch.mpzn_mul_montgomery( z, x, y, p, n0, size );
+}
+
+#ifdef AK_HAVE_BUILTIN_MULX_ADX
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Один шаг умножения Монтгомери для 256-битного модуля: к промежуточному значению
+    t0, ..., t4 прибавляются произведения \f$ x_iy \f$ и \f$ mp \f$, после чего младшее
+    (нулевое) слово отбрасывается.
+
+    Сложение старших и младших половин произведений выполняется двумя независимыми цепочками
+    переносов: инструкция adcx использует только флаг CF, инструкция adox -- только флаг OF.
+    Регистр t5 на входе должен быть равен нулю; на выходе нулю равен регистр t0, поэтому
+    следующий шаг выполняется с циклически сдвинутым набором регистров без пересылок.          */
+/* ----------------------------------------------------------------------------------------------- */
+ #define ak_mpzn256_mulx_step( i, t0, t1, t2, t3, t4, t5 ) \
+   "movq " #i "(%[x]), %%rdx\n\t"                                                          \
+   "xorq %[zr], %[zr]\n\t"                                                                 \
+   "mulxq 0(%[y]), %[lo], %[hi]\n\t"  "adcxq %[lo], %[" #t0 "]\n\t" "adoxq %[hi], %[" #t1 "]\n\t" \
+   "mulxq 8(%[y]), %[lo], %[hi]\n\t"  "adcxq %[lo], %[" #t1 "]\n\t" "adoxq %[hi], %[" #t2 "]\n\t" \
+   "mulxq 16(%[y]), %[lo], %[hi]\n\t" "adcxq %[lo], %[" #t2 "]\n\t" "adoxq %[hi], %[" #t3 "]\n\t" \
+   "mulxq 24(%[y]), %[lo], %[hi]\n\t" "adcxq %[lo], %[" #t3 "]\n\t" "adoxq %[hi], %[" #t4 "]\n\t" \
+   "adcxq %[zr], %[" #t4 "]\n\t"  "adoxq %[zr], %[" #t5 "]\n\t"  "adcxq %[zr], %[" #t5 "]\n\t"   \
+   "movq %[" #t0 "], %%rdx\n\t"                                                            \
+   "imulq %[n0], %%rdx\n\t"                                                                \
+   "xorq %[zr], %[zr]\n\t"                                                                 \
+   "mulxq 0(%[p]), %[lo], %[hi]\n\t"  "adcxq %[lo], %[" #t0 "]\n\t" "adoxq %[hi], %[" #t1 "]\n\t" \
+   "mulxq 8(%[p]), %[lo], %[hi]\n\t"  "adcxq %[lo], %[" #t1 "]\n\t" "adoxq %[hi], %[" #t2 "]\n\t" \
+   "mulxq 16(%[p]), %[lo], %[hi]\n\t" "adcxq %[lo], %[" #t2 "]\n\t" "adoxq %[hi], %[" #t3 "]\n\t" \
+   "mulxq 24(%[p]), %[lo], %[hi]\n\t" "adcxq %[lo], %[" #t3 "]\n\t" "adoxq %[hi], %[" #t4 "]\n\t" \
+   "adcxq %[zr], %[" #t4 "]\n\t"  "adoxq %[zr], %[" #t5 "]\n\t"  "adcxq %[zr], %[" #t5 "]\n\t"
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Умножение вычетов в представлении Монтгомери по 256-битному модулю с использованием
+    инструкций mulx, adcx и adox (все промежуточные значения хранятся в регистрах).             */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_mpzn256_mul_montgomery_mulx( ak_uint64 *z, ak_uint64 *x, ak_uint64 *y,
+                                                                     ak_uint64 *p, ak_uint64 n0 )
+{
+  ak_mpzn256 t;
+  ak_uint64 t0 = 0, t1 = 0, t2 = 0, t3 = 0, t4 = 0, t5 = 0, lo, hi, zr;
+
+  __asm__ (
+    ak_mpzn256_mulx_step(  0, t0, t1, t2, t3, t4, t5 )
+    ak_mpzn256_mulx_step(  8, t1, t2, t3, t4, t5, t0 )
+    ak_mpzn256_mulx_step( 16, t2, t3, t4, t5, t0, t1 )
+    ak_mpzn256_mulx_step( 24, t3, t4, t5, t0, t1, t2 )
+    : [t0] "+&r" (t0), [t1] "+&r" (t1), [t2] "+&r" (t2), [t3] "+&r" (t3), [t4] "+&r" (t4),
+      [t5] "+&r" (t5), [lo] "=&r" (lo), [hi] "=&r" (hi), [zr] "=&r" (zr)
+    : [x] "r" (x), [y] "r" (y), [p] "r" (p), [n0] "m" (n0)
+    : "rdx", "cc", "memory" );
+
+ /* после четырех шагов результат находится в регистрах t4, t5, t0, t1, старшее слово -- в t2 */
+  t[0] = t4; t[1] = t5; t[2] = t0; t[3] = t1;
+  ak_mpzn_montgomery_select( z, t, p, t2, ak_mpzn256_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет то же значение, что и функция ak_mpzn_mul_montgomery_uint64(). Для модулей
+    длины 256 бит используется реализация, в которой умножение выполняется инструкцией mulx,
+    а сложение -- двумя независимыми цепочками переносов (инструкции adcx и adox);
+    для модулей другой длины вызывается функция ak_mpzn_mul_montgomery_uint64().
+    Функция может вызываться только на процессорах, поддерживающих расширения BMI2 и ADX
+    (флаг \ref ak_cpu_feature_bmi2_adx).
+
+    @param z Указатель на вычет, в который помещается результат
+    @param x Левый аргумент операции умножения
+    @param y Правый аргумент операции умножения
+    @param p Модуль, по которому производятся вычисления
+    @param n0 Константа, используемая в вычислениях
+    @param size Размер модуля в словах                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_mpzn_mul_montgomery_mulx( ak_uint64 *z, ak_uint64 *x, ak_uint64 *y,
+                                               ak_uint64 *p, ak_uint64 n0, const size_t size )
+{
+  if( size == ak_mpzn256_size ) ak_mpzn256_mul_montgomery_mulx( z, x, y, p, n0 );
+   else ak_mpzn_mul_montgomery_uint64( z, x, y, p, n0, size );
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Умножение вычетов в представлении Монтгомери по модулю вида \f$ p = 2^{64\cdot size} - c \f$.
+
+    Для такого модуля \f$ n_0 \equiv c^{-1} \pmod{2^{64}}\f$, а каждый шаг приведения
+    \f$ t \leftarrow t + mp2^{64i} \f$ сводится к вычитанию двухсловного произведения \f$ mc \f$
+    и прибавлению слова \f$ m \f$ к старшей половине произведения. Поэтому на приведение
+    тратится size, а не \f$ size^2 \f$ умножений слов; слова \f$ m \f$ накапливаются и
+    прибавляются к старшей половине одной цепочкой сложений в конце вычислений.
+    Результат совпадает с результатом функции ak_mpzn_mul_montgomery_uint64(),
+    то есть вычеты остаются в представлении Монтгомери.                                          */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mpzn_mul_montgomery_pseudo_mersenne_kernel( ak_uint64 *z, ak_uint64 *x,
+                                  ak_uint64 *y, ak_uint64 *p, ak_uint64 n0, const size_t size )
+{
+  size_t i = 0, j = 0;
+  ak_uint64 c = 0 - p[0], w1 = 0, w0 = 0, cy = 0, bw = 0;
+  ak_uint64 t[2*ak_mpzn512_size], m[ak_mpzn512_size];
 
-        t[ij] += w0;
-        cy += t[ij] < w0;
-        c = w1 + cy;
+ /* t <- xy */
+  memset( t, 0, 2*size*sizeof( ak_uint64 ));
+  for( i = 0; i < size; i++ ) {
+     for( j = 0, cy = 0; j < size; j++ ) {
+        umul_ppmm( w1, w0, x[i], y[j] );
+        w0 += cy;
+        w1 += w0 < cy;
+        t[i+j] += w0;
+        cy = w1 + ( t[i+j] < w0 );
      }
-     t[ij] = c;
+     t[i+size] = cy;
   }
 
-  //  ak_mpzn_mul( u, t, n, size );
-  //  ak_mpzn_mul( u, u, p, size );
-  //  ak_mpzn_add( u, u, t, (size<<1));
+ /* t <- t - mc2^{64i}; младшее слово произведения mc совпадает с t[i], а заем
+    из слова t[i+1] учитывается на следующем шаге вместе со старшим словом произведения */
   for( i = 0; i < size; i++ ) {
-     ak_uint64 c = 0, m = t[i]*n0;
-     for( j = 0, ij = i; j < size; j++ , ij++ ) {
-        ak_uint64 w1, w0, cy;
-        umul_ppmm( w1, w0, m, p[j] );
-        t[ij] += c;
-        cy = t[ij] < c;
+     m[i] = t[i]*n0;
+     umul_ppmm( w1, w0, m[i], c );
+     w1 += bw;
+     bw = t[i+1] < w1;
+     t[i+1] -= w1;
+  }
+  for( i = size+1; i < 2*size; i++ ) {
+     w0 = t[i];
+     t[i] = w0 - bw;
+     bw = t[i] > w0;
+  }
 
-        t[ij] += w0;
-        cy += t[ij] < w0;
-        c = w1;
-        c += cy;
-     }
-     do {
-         t[ij] += c;
-         c = t[ij] < c;
-         ij++;
-     } while( c != 0 );
+ /* t <- t/2^{64size} + m */
+  for( i = 0, cy = 0; i < size; i++ ) {
+     t[size+i] += cy;
+     w0 = t[size+i] < cy;
+     t[size+i] += m[i];
+     cy = w0 + ( t[size+i] < m[i] );
   }
+  ak_mpzn_montgomery_select( z, t+size, p, cy - bw, size );
+}
 
-  // вычитаем из результата модуль p
-  for( i = 0, j = size; i < size; i++, j++ ) {
-     av = t[j];
-     bv = av - cy;
-     cy = bv > av;
-     av = bv - p[i];
-     cy += av > bv;
-     z[i] = av;
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет то же значение, что и функция ak_mpzn_mul_montgomery_uint64(), однако
+    может использоваться только для модулей вида \f$ p = 2^{64\cdot size} - c \f$,
+    где \f$ c < 2^{32} \f$ (см. \ref wcurve_field_pseudo_mersenne).
+    Такие модули имеют, в частности, кривые из рекомендаций Р 50.1.114-2016 и RFC 4357
+    с модулем \f$ 2^{256} - 617 \f$ и кривые с модулем \f$ 2^{512} - 569 \f$.
+
+    @param z Указатель на вычет, в который помещается результат
+    @param x Левый аргумент операции умножения
+    @param y Правый аргумент операции умножения
+    @param p Модуль, по которому производятся вычисления
+    @param n0 Константа, используемая в вычислениях
+    @param size Размер модуля в словах                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_mpzn_mul_montgomery_pseudo_mersenne_uint64( ak_uint64 *z, ak_uint64 *x, ak_uint64 *y,
+                                               ak_uint64 *p, ak_uint64 n0, const size_t size )
+{
+  switch( size ) {
+    case ak_mpzn256_size:
+      ak_mpzn_mul_montgomery_pseudo_mersenne_kernel( z, x, y, p, n0, ak_mpzn256_size );
+      break;
+    case ak_mpzn512_size:
+      ak_mpzn_mul_montgomery_pseudo_mersenne_kernel( z, x, y, p, n0, ak_mpzn512_size );
+      break;
+    default:
+      ak_mpzn_mul_montgomery_uint64( z, x, y, p, n0, size );
   }
-  //if( cy == 1 ) memcpy( z, t+size, size*sizeof( ak_uint64 )); <--- это ошибочный вариант !!!
-  if( cy != t[2*size] ) memcpy( z, t+size, size*sizeof( ak_uint64 ));
 }
 
+#ifdef AK_HAVE_BUILTIN_MULX_ADX
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет то же значение, что и функция ak_mpzn_mul_montgomery_pseudo_mersenne_uint64(),
+    и используется на процессорах, поддерживающих расширения BMI2 и ADX. Для модулей длины
+    256 бит умножение Монтгомери общего вида, выполняемое инструкциями mulx, adcx и adox,
+    оказывается быстрее специализированного приведения, поэтому вызывается именно оно.
+
+    @param z Указатель на вычет, в который помещается результат
+    @param x Левый аргумент операции умножения
+    @param y Правый аргумент операции умножения
+    @param p Модуль, по которому производятся вычисления
+    @param n0 Константа, используемая в вычислениях
+    @param size Размер модуля в словах                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_mpzn_mul_montgomery_pseudo_mersenne_mulx( ak_uint64 *z, ak_uint64 *x, ak_uint64 *y,
+                                               ak_uint64 *p, ak_uint64 n0, const size_t size )
+{
+  if( size == ak_mpzn256_size ) ak_mpzn256_mul_montgomery_mulx( z, x, y, p, n0 );
+   else ak_mpzn_mul_montgomery_pseudo_mersenne_uint64( z, x, y, p, n0, size );
+}
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Для вычета \f$ x \f$, заданного в представлении Монтгомери в виде \f$ xr \f$, где \f$ r \f$
     заданная степень двойки, вычисляется вычет \f$ z \f$,
@@ -841,6 +1066,150 @@
   memcpy( z, res, size*sizeof( ak_uint64 ));
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Ширина окна, используемая при вычислении обратного элемента в представлении Монтгомери. */
+ #define ak_mpzn_modinv_window (5)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Для вычета \f$ x \f$, заданного в представлении Монтгомери, вычисляется вычет
+    \f$ z \equiv x^{-1} \equiv x^{p-2} \pmod{p} \f$, также в представлении Монтгомери.
+
+    Возведение в степень \f$ p-2 \f$ выполняется методом скользящего окна ширины
+    \ref ak_mpzn_modinv_window: для заданного модуля \f$ p \f$ вычисляется
+    аддитивная цепочка, в которой на каждые пять бит степени приходится не более
+    одного умножения (вместо умножения на каждый ненулевой бит в функции
+    ak_mpzn_modpow_montgomery()). Последовательность выполняемых операций зависит только от
+    модуля \f$ p \f$ и не зависит от значения обращаемого вычета, поэтому функция может
+    использоваться для секретных данных.
+
+    @param z Вычет, в который помещается результат
+    @param x Обращаемый вычет; для нулевого значения результат также равен нулю
+    @param p Простой модуль, по которому производятся вычисления
+    @param n0 Константа, используемая в вычислениях (см. ak_mpzn_modpow_montgomery())
+    @param size Размер модуля в словах (значение константы \ref ak_mpzn256_size
+    или \ref ak_mpzn512_size )                                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_mpzn_modinv_montgomery( ak_uint64 *z, ak_uint64 *x,
+                                                   ak_uint64 *p, ak_uint64 n0, const size_t size )
+{
+  bool_t start = ak_false;
+  long long int i, j, l;
+  ak_uint64 w;
+  ak_mpznmax e, res, x2, tab[1 << ( ak_mpzn_modinv_window - 1 )];
+
+ /* e <- p - 2 */
+  ak_mpzn_set_ui( e, size, 2 );
+  ak_mpzn_sub( e, p, e, size );
+
+ /* tab[j] <- x^{2j+1} */
+  ak_mpzn_set( tab[0], x, size );
+  ak_mpzn_mul_montgomery( x2, x, x, p, n0, size );
+  for( j = 1; j < ( 1 << ( ak_mpzn_modinv_window - 1 )); j++ )
+     ak_mpzn_mul_montgomery( tab[j], tab[j-1], x2, p, n0, size );
+
+ /* просматриваем биты степени от старших к младшим */
+  #define ak_mpzn_bit( k, n ) (( (k)[(n) >> 6] >> ( (n)&0x3f ))&1 )
+  for( i = 64*( long long int )size - 1; i >= 0; ) {
+     if( ak_mpzn_bit( e, i ) == 0 ) {
+       if( start ) ak_mpzn_mul_montgomery( res, res, res, p, n0, size );
+       i--;
+       continue;
+     }
+    /* окно [l, i] заканчивается единичным битом */
+     l = ak_max( i - ak_mpzn_modinv_window + 1, 0 );
+     while( ak_mpzn_bit( e, l ) == 0 ) l++;
+     for( w = 0, j = i; j >= l; j-- ) w = ( w << 1 )^ak_mpzn_bit( e, j );
+
+     if( start ) {
+       for( j = i; j >= l; j-- ) ak_mpzn_mul_montgomery( res, res, res, p, n0, size );
+       ak_mpzn_mul_montgomery( res, res, tab[w >> 1], p, n0, size );
+     } else {
+         ak_mpzn_set( res, tab[w >> 1], size );
+         start = ak_true;
+       }
+     i = l - 1;
+  }
+  #undef ak_mpzn_bit
+
+  memcpy( z, res, size*sizeof( ak_uint64 ));
+  memset( tab, 0, sizeof( tab ));
+  memset( x2, 0, sizeof( x2 ));
+  memset( res, 0, sizeof( res ));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Деление четного числа на два по модулю p.
+
+    Функция вычисляет \f$ u \leftarrow u/2 \f$ для четного \f$ u \f$ и
+    \f$ x \leftarrow x/2 \pmod{p} \f$ для \f$ x < p \f$.                                         */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mpzn_modinv_binary_halve( ak_uint64 *u, ak_uint64 *x,
+                                                                   ak_uint64 *p, const size_t size )
+{
+  size_t i;
+  ak_uint64 cy = 0;
+
+  for( i = 0; i < size-1; i++ ) u[i] = ( u[i] >> 1 )^( u[i+1] << 63 );
+  u[size-1] >>= 1;
+
+  if( x[0]&1 ) cy = ak_mpzn_add( x, x, p, size );
+  for( i = 0; i < size-1; i++ ) x[i] = ( x[i] >> 1 )^( x[i+1] << 63 );
+  x[size-1] = ( x[size-1] >> 1 )^( cy << 63 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычитание \f$ u \leftarrow u - v \f$ и \f$ x \leftarrow x - y \pmod{p} \f$. */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mpzn_modinv_binary_sub( ak_uint64 *u, ak_uint64 *v,
+                                           ak_uint64 *x, ak_uint64 *y, ak_uint64 *p, const size_t size )
+{
+  ak_mpzn_sub( u, u, v, size );
+  if( ak_mpzn_sub( x, x, y, size )) ak_mpzn_add( x, x, p, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Для вычета \f$ x \f$, заданного в естественном представлении, вычисляется вычет \f$ z \f$,
+    удовлетворяющий сравнению \f$ xz \equiv 1 \pmod{p} \f$. Для вычислений используется
+    бинарный расширенный алгоритм Евклида.
+
+    \warning Время работы функции зависит от значения \f$ x \f$, поэтому функция
+    должна использоваться только для открытых данных, например, при проверке электронной подписи.
+
+    @param z Вычет, в который помещается результат
+    @param x Обращаемый вычет, удовлетворяющий неравенству \f$ x < p \f$; если
+    вычет не является обратимым, то результат равен нулю
+    @param p Нечетный модуль, по которому производятся вычисления
+    @param size Размер модуля в словах (значение константы \ref ak_mpzn256_size
+    или \ref ak_mpzn512_size )                                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_mpzn_modinv_binary( ak_uint64 *z, ak_uint64 *x, ak_uint64 *p, const size_t size )
+{
+  ak_mpznmax u, v, x1, x2;
+
+  if( ak_mpzn_cmp_ui( x, size, 0 )) {
+    ak_mpzn_set_ui( z, size, 0 );
+    return;
+  }
+  ak_mpzn_set( u, x, size );
+  ak_mpzn_set( v, p, size );
+  ak_mpzn_set_ui( x1, size, 1 );
+  ak_mpzn_set_ui( x2, size, 0 );
+
+ /* инвариант: x*x1 = u (mod p), x*x2 = v (mod p) */
+  while( !ak_mpzn_cmp_ui( u, size, 1 ) && !ak_mpzn_cmp_ui( v, size, 1 )) {
+    if( ak_mpzn_cmp_ui( u, size, 0 )) { /* x и p не являются взаимно простыми */
+      ak_mpzn_set_ui( z, size, 0 );
+      return;
+    }
+    while(( u[0]&1 ) == 0 ) ak_mpzn_modinv_binary_halve( u, x1, p, size );
+    while(( v[0]&1 ) == 0 ) ak_mpzn_modinv_binary_halve( v, x2, p, size );
+    if( ak_mpzn_cmp( u, v, size ) >= 0 ) ak_mpzn_modinv_binary_sub( u, v, x1, x2, p, size );
+     else ak_mpzn_modinv_binary_sub( v, u, x2, x1, p, size );
+  }
+  if( ak_mpzn_cmp_ui( u, size, 1 )) ak_mpzn_set( z, x1, size );
+   else ak_mpzn_set( z, x2, size );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 #ifdef AK_HAVE_GMP_H
 /* преобразование "туда и обратно" */
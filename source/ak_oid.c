@@ -90,6 +90,7 @@
   - `1.2.643.2.52.1.5` базовые режимы работы блочных шифров,
   - `1.2.643.2.52.1.6` расширенные режимы работы блочных шифров,
   - `1.2.643.2.52.1.7` алгоритмы выработки имитовставки,
+  - `1.2.643.2.52.1.8` алгоритмы бесключевого хеширования,
 
   - `1.2.643.2.52.1.10` алгоритмы выработки электронной подписи,
   - `1.2.643.2.52.1.11` алгоритмы проверки электронной подписи,
@@ -132,6 +133,10 @@
  static const char *asn1_streebog256_i[] = { "1.2.643.7.1.1.2.2", NULL };
  static const char *asn1_streebog512_n[] = { "streebog512", "md_gost12_512", NULL };
  static const char *asn1_streebog512_i[] = { "1.2.643.7.1.1.2.3", NULL };
+ static const char *asn1_streebog256_tree_n[] = { "streebog256-tree", NULL };
+ static const char *asn1_streebog256_tree_i[] = { "1.2.643.2.52.1.8.1", NULL };
+ static const char *asn1_streebog512_tree_n[] = { "streebog512-tree", NULL };
+ static const char *asn1_streebog512_tree_i[] = { "1.2.643.2.52.1.8.2", NULL };
  static const char *asn1_hmac_streebog256_n[] = { "hmac-streebog256", "HMAC-md_gost12_256", NULL };
  static const char *asn1_hmac_streebog256_i[] = { "1.2.643.7.1.1.4.1", NULL };
  static const char *asn1_hmac_streebog512_n[] = { "hmac-streebog512", "HMAC-md_gost12_512", NULL };
@@ -496,6 +501,16 @@ ak_object_undefined,NULL,NULL }},
                               ( ak_function_destroy_object *) ak_hash_destroy, NULL, NULL, NULL },
                               ak_object_undefined, (ak_function_run_object *) ak_hash_ptr, NULL }},
 
+ { hash_function, algorithm, asn1_streebog256_tree_i, asn1_streebog256_tree_n, NULL,
+  {{ sizeof( struct hash ), ( ak_function_create_object *) ak_hash_create_streebog256_tree,
+                              ( ak_function_destroy_object *) ak_hash_destroy, NULL, NULL, NULL },
+                              ak_object_undefined, (ak_function_run_object *) ak_hash_ptr, NULL }},
+
+ { hash_function, algorithm, asn1_streebog512_tree_i, asn1_streebog512_tree_n, NULL,
+  {{ sizeof( struct hash ), ( ak_function_create_object *) ak_hash_create_streebog512_tree,
+                              ( ak_function_destroy_object *) ak_hash_destroy, NULL, NULL, NULL },
+                              ak_object_undefined, (ak_function_run_object *) ak_hash_ptr, NULL }},
+
  { hmac_function, algorithm, asn1_hmac_streebog256_i, asn1_hmac_streebog256_n, NULL,
                             { ak_object_hmac_streebog256,
                               ak_object_undefined, (ak_function_run_object *) ak_hmac_ptr, NULL }},
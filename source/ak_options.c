@@ -4,7 +4,7 @@
 /*  Файл ak_options.с                                                                              */
 /*  - содержит реализацию функций для работы с опциями библиотеки                                  */
 /* ----------------------------------------------------------------------------------------------- */
- #include <libakrypt.h>
+ #include <libakrypt-internal.h>
 
 /* ----------------------------------------------------------------------------------------------- */
 #ifdef AK_HAVE_ERRNO_H
@@ -13,6 +13,12 @@
 #ifdef AK_HAVE_SYSSTAT_H
  #include <sys/stat.h>
 #endif
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
+#ifdef AK_HAVE_WINDOWS_H
+ #include <windows.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Тип данных для хранения одной опции библиотеки */
@@ -30,31 +36,63 @@
 /* ----------------------------------------------------------------------------------------------- */
 /*! Константные значения опций (значения по-умолчанию) */
  static struct option options[] = {
-     { "log_level", ak_log_standard, 0, 2 },
-     { "context_manager_size", 32, 32, 65536 },
-     { "context_manager_max_size", 4096, 4096, 2147483648 },
-     { "pbkdf2_iteration_count", 2000, 1000, 65536 },
-     { "hmac_key_count_resource", 65536, 1024, 2147483648 },
-     { "digital_signature_count_resource", 65536, 1024, 2147483648 },
+     [log_level_option] = { "log_level", ak_log_standard, 0, 2 },
+     [context_manager_size_option] = { "context_manager_size", 32, 32, 65536 },
+     [context_manager_max_size_option] = { "context_manager_max_size", 4096, 4096, 2147483648 },
+     [pbkdf2_iteration_count_option] = { "pbkdf2_iteration_count", 2000, 1000, 65536 },
+     [hmac_key_count_resource_option] = { "hmac_key_count_resource", 65536, 1024, 2147483648 },
+     [digital_signature_count_resource_option] =
+                             { "digital_signature_count_resource", 65536, 1024, 2147483648 },
 
   /* значение константы задает максимальный объем зашифрованной информации на одном ключе в 4 Mб:
                                  524288 блока x 8 байт на блок = 4.194.304 байт = 4096 Кб = 4 Mб   */
-     { "magma_cipher_resource", 524288, 1024, 2147483648 },
+     [magma_cipher_resource_option] = { "magma_cipher_resource", 524288, 1024, 2147483648 },
 
   /* значение константы задает максимальный объем зашифрованной информации на одном ключе в 32 Mб:
                              2097152 блока x 16 байт на блок = 33.554.432 байт = 32768 Кб = 32 Mб  */
-     { "kuznechik_cipher_resource", 2097152, 8196, 2147483648 },
-     { "acpkm_message_count", 4096, 128, 65536 },
-     { "acpkm_section_magma_block_count", 128, 128, 16777216 },
-     { "acpkm_section_kuznechik_block_count", 512, 512, 16777216 },
+     [kuznechik_cipher_resource_option] =
+                                    { "kuznechik_cipher_resource", 2097152, 8196, 2147483648 },
+     [acpkm_message_count_option] = { "acpkm_message_count", 4096, 128, 65536 },
+     [acpkm_section_magma_block_count_option] =
+                                     { "acpkm_section_magma_block_count", 128, 128, 16777216 },
+     [acpkm_section_kuznechik_block_count_option] =
+                                 { "acpkm_section_kuznechik_block_count", 512, 512, 16777216 },
 
   /* при значении равным единицы, формат шифрования данных соответствует варианту OpenSSL */
-     { "openssl_compability", 0, 0, 1 },
+     [openssl_compability_option] = { "openssl_compability", 0, 0, 1 },
   /* флаг использования цвета при выводе сообщений библиотеки */
-     { "use_color_output", 1, 0, 1 },
-     { NULL, 0, 0, 0 } /* завершающая константа, должна всегда принимать нулевые значения */
+     [use_color_output_option] = { "use_color_output", 1, 0, 1 },
+  /* режим динамического контроля при инициализации библиотеки (значение типа dynamic_control_t) */
+     [dynamic_control_test_option] = { "dynamic_control_test",
+                                 none_dynamic_control, none_dynamic_control, cached_dynamic_control },
+  /* общее количество потоков, используемых для параллельной обработки данных
+                                                 (ноль - по количеству доступных процессоров) */
+     [thread_pool_size_option] = { "thread_pool_size", 0, 0, 1024 },
+  /* завершающая константа, должна всегда принимать нулевые значения */
+     [undefined_option] = { NULL, 0, 0, 0 }
  };
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Счетчик изменений значений опций.
+    \details Перед изменением и после изменения опции счетчик увеличивается на единицу,
+    поэтому нечетное значение счетчика означает, что в данный момент опция изменяется.
+    Счетчик позволяет читать согласованный набор опций без блокировок (см. функцию
+    ak_libakrypt_get_options_snapshot()).                                                          */
+ static volatile ak_uint32 options_sequence = 0;
+#ifdef AK_HAVE_PTHREAD_H
+/*! \brief Мьютекс, упорядочивающий одновременное изменение опций несколькими потоками. */
+ static pthread_mutex_t options_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/*! \brief Барьер памяти, упорядочивающий обращения к счетчику изменений и значениям опций. */
+#if defined( __GNUC__ )
+ #define ak_options_barrier() __sync_synchronize()
+#elif defined( AK_HAVE_WINDOWS_H )
+ #define ak_options_barrier() MemoryBarrier()
+#else
+ #define ak_options_barrier()
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
  const char *ak_libakrypt_version( void )
 {
@@ -94,11 +132,23 @@
  ak_int64 ak_libakrypt_get_option_by_name( const char *name )
 {
   size_t i = 0;
-  ak_int64 result = ak_error_wrong_option;
   for( i = 0; i < ak_libakrypt_options_count(); i++ ) {
-     if( strncmp( name, options[i].name, strlen( options[i].name )) == 0 ) result = options[i].value;
+     if( strncmp( name, options[i].name, strlen( options[i].name )) == 0 ) return options[i].value;
   }
- return result;
+ return ak_error_wrong_option;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция не выполняет поиск опции по имени и может использоваться в часто вызываемых функциях.
+
+    \param opt Идентификатор опции.
+    \return Значение опции. Если идентификатор указан неверно, то возвращается
+    ошибка \ref ak_error_wrong_option.                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ ak_int64 ak_libakrypt_get_option( const option_t opt )
+{
+  if(( size_t ) opt >= undefined_option ) return ak_error_wrong_option;
+ return options[opt].value;
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -126,14 +176,78 @@
  int ak_libakrypt_set_option( const char *name, const ak_int64 value )
 {
   size_t i = 0;
-  int result = ak_error_wrong_option;
   for( i = 0; i < ak_libakrypt_options_count(); i++ ) {
-     if( strncmp( name, options[i].name, strlen( options[i].name )) == 0 ) {
-       options[i].value = value;
-       result = ak_error_ok;
-     }
+     if( strncmp( name, options[i].name, strlen( options[i].name )) == 0 )
+       return ak_libakrypt_set_option_value(( option_t ) i, value );
   }
- return result;
+ return ak_error_wrong_option;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \param opt Идентификатор опции.
+    \param value Проверяемое значение опции.
+    \return Функция возвращает \ref ak_error_ok, если значение лежит в допустимых для опции
+    пределах. В противном случае возвращается код ошибки.                                         */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_libakrypt_check_option_value( const option_t opt, const ak_int64 value )
+{
+  if(( size_t ) opt >= undefined_option ) return ak_error_wrong_option;
+  if(( value < options[opt].min ) || ( value > options[opt].max )) return ak_error_invalid_value;
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \note Функция не проверяет и не интерпретирует значение устанавливааемой опции.
+
+    \param opt Идентификатор опции.
+    \param value Значение опции
+
+    \return В случае удачного установления значения опции возввращается \ref ak_error_ok.
+     Если идентификатор опции указан неверно, то возвращается ошибка \ref ak_error_wrong_option.  */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_libakrypt_set_option_value( const option_t opt, const ak_int64 value )
+{
+  if(( size_t ) opt >= undefined_option ) return ak_error_wrong_option;
+
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &options_mutex );
+#endif
+  options_sequence++;
+  ak_options_barrier();
+  options[opt].value = value;
+  ak_options_barrier();
+  options_sequence++;
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &options_mutex );
+#endif
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция копирует значения всех опций, не используя блокировок. Если во время копирования
+    значение какой-либо опции было изменено, то копирование повторяется.
+
+    \param snapshot Структура, в которую помещаются значения опций.
+    \return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_libakrypt_get_options_snapshot( ak_options_snapshot snapshot )
+{
+  size_t i = 0;
+  ak_uint32 start = 0;
+
+  if( snapshot == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                          "using null pointer to options snapshot" );
+  do {
+    /* дожидаемся завершения изменения опции */
+     while(( start = options_sequence )&0x1 );
+     ak_options_barrier();
+     for( i = 0; i < undefined_option; i++ ) snapshot->value[i] = options[i].value;
+     ak_options_barrier();
+  } while( start != options_sequence );
+  snapshot->version = start >> 1;
+
+ return ak_error_ok;
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -161,6 +275,17 @@
                                           "option %s is %ld", options[i].name, options[i].value );
        }
     }
+   /* выводим названия реализаций, выбранных для используемого процессора */
+    ak_error_message_fmt( ak_error_ok, __func__,
+                      "galois fields multiplication is %s", ak_libakrypt_dispatch.gf_mul_name );
+    ak_error_message_fmt( ak_error_ok, __func__,
+                       "kuznechik multiple blocks are %s", ak_libakrypt_dispatch.kuznechik_name );
+    ak_error_message_fmt( ak_error_ok, __func__,
+                               "magma multiple blocks are %s", ak_libakrypt_dispatch.magma_name );
+    ak_error_message_fmt( ak_error_ok, __func__,
+                          "streebog compression function is %s", ak_libakrypt_dispatch.streebog_name );
+    ak_error_message_fmt( ak_error_ok, __func__,
+                         "montgomery multiplication is %s", ak_libakrypt_dispatch.mpzn_name );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
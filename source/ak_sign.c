@@ -37,7 +37,7 @@
 #ifndef AK_LITTLE_ENDIAN
   int i = 0;
 #endif
-  ak_mpznmax u, zeta;
+  ak_mpznmax zeta;
   ak_wcurve wc = NULL;
   int error = ak_error_ok;
   ak_uint64 *key = NULL, *mask = NULL;
@@ -80,10 +80,7 @@
      ak_mpzn_mul_montgomery( key, key, mask, wc->q, wc->nq, wc->size);
 
     /* вычисляем обратное значение для маски */
-     ak_mpzn_set_ui( u, wc->size, 2 );
-     ak_mpzn_sub( u, wc->q, u, wc->size );
-     ak_mpzn_modpow_montgomery( mask, // m <- m^{q-2} (mod q)
-                                    mask, u, wc->q, wc->nq, wc->size );
+     ak_mpzn_modinv_montgomery( mask, mask, wc->q, wc->nq, wc->size ); // m <- m^{-1} (mod q)
     /* меняем значение флага */
      skey->flags |= ak_key_flag_set_mask;
 
@@ -100,9 +97,7 @@
     /* домножаем ключ на случайное число */
      ak_mpzn_mul_montgomery( key, key, zeta, wc->q, wc->nq, wc->size );
     /* вычисляем обратное значение zeta */
-     ak_mpzn_set_ui( u, wc->size, 2 );
-     ak_mpzn_sub( u, wc->q, u, wc->size );
-     ak_mpzn_modpow_montgomery( zeta, zeta, u, wc->q, wc->nq, wc->size ); // z <- z^{q-2} (mod q)
+     ak_mpzn_modinv_montgomery( zeta, zeta, wc->q, wc->nq, wc->size ); // z <- z^{-1} (mod q)
 
     /* домножаем маску на обратное значение zeta */
      ak_mpzn_mul_montgomery( mask, mask, zeta, wc->q, wc->nq, wc->size );
@@ -245,6 +240,8 @@
 
    if( sk == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                     "using null pointer to digital signature secret key context" );
+   if(( error = ak_libakrypt_lazy_test( asymmetric_test_family )) != ak_error_ok )
+     return ak_error_message( error, __func__, "digital signature failed dynamic control" );
   /* первичная инициализация */
    memset( sk, 0, sizeof( struct signkey ));
 
@@ -335,10 +332,15 @@
 /* ----------------------------------------------------------------------------------------------- */
  int ak_signkey_set_curve( ak_signkey sctx, const ak_wcurve wc )
 {
+   int error = ak_error_ok;
+
    if( sctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                     "using null pointer to digital signature secret key context" );
    if( wc == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                   "using null pointer to elliptic curve context" );
+  /* вид модуля определяет реализацию умножения, используемую при вычислениях на кривой */
+   if(( error = ak_wcurve_check_field( wc )) != ak_error_ok )
+     return ak_error_message( error, __func__ , "using elliptic curve with wrong modulo type" );
    if( wc->size != ( sctx->ctx.data.sctx.hsize >> 3 ))
     return ak_error_message_fmt( ak_error_curve_not_supported, __func__ ,
                               "%u bits elliptic curve is not applicable for algorithm %s",
@@ -594,7 +596,7 @@
 
  /* поскольку функция не экспортируется, мы оставляем все проверки функциям верхнего уровня */
  /* вычисляем r */
-  ak_wpoint_pow( &wr, &wc->point, k, wc->size, wc );
+  ak_wpoint_pow_base( &wr, k, wc->size, wc );
   ak_wpoint_reduce( &wr, wc );
   ak_mpzn_rem( r, wr.x, wc->q, wc->size );
 
@@ -807,6 +809,10 @@
   if( ak_oid_find_by_data( wc ) == NULL )
     return ak_error_message( ak_error_null_pointer, __func__ ,
                                           "using unsearchable pointer to elliptic curve context" );
+  if(( error = ak_wcurve_check_field( wc )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "using elliptic curve with wrong modulo type" );
+  if(( error = ak_libakrypt_lazy_test( asymmetric_test_family )) != ak_error_ok )
+    return ak_error_message( error, __func__, "digital signature failed dynamic control" );
  /* очищаем контекст,
     в частности, здесь обнуляется номер открытого ключа */
   memset( pctx, 0, sizeof( struct verifykey ));
@@ -872,13 +878,15 @@
   }
    else return ak_error_message( error, __func__, "using incorrect oid for secret key" );
 
- /* теперь определяем открытый ключ */
+ /* теперь определяем открытый ключ: значение секретного ключа d не вычисляется,
+    точка [d]P определяется последовательным умножением на множители, хранящиеся
+    в контексте секретного ключа (первое умножение использует таблицу кратных точки P) */
   ak_mpzn_mul_montgomery( k, ( ak_uint64 *)sctx->key.key, one,
                                                       pctx->wc->q, pctx->wc->nq, pctx->wc->size );
-  ak_wpoint_pow( &pctx->qpoint, &pctx->wc->point, k, pctx->wc->size, pctx->wc );
+  ak_wpoint_pow_base( &pctx->qpoint, k, pctx->wc->size, pctx->wc );
 
   ak_mpzn_mul_montgomery( k, ( ak_uint64 *)( sctx->key.key + sctx->key.key_size ),
-                                                  one, pctx->wc->q, pctx->wc->nq, pctx->wc->size);
+                                                  one, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
   ak_wpoint_pow( &pctx->qpoint, &pctx->qpoint, k, pctx->wc->size, pctx->wc );
   ak_wpoint_reduce( &pctx->qpoint, pctx->wc );
 
@@ -969,8 +977,8 @@
 #ifndef AK_LITTLE_ENDIAN
   int i = 0;
 #endif
-  ak_mpzn512 v, z1, z2, u, r, s, h;
-  struct wpoint cpoint, tpoint;
+  ak_mpzn512 v, z1, z2, r, s, h;
+  struct wpoint cpoint;
 
   if( pctx == NULL ) {
     ak_error_message( ak_error_null_pointer, __func__,
@@ -1003,12 +1011,10 @@
   ak_mpzn_set( v, h, pctx->wc->size );
   ak_mpzn_rem( v, v, pctx->wc->q, pctx->wc->size );
   if( ak_mpzn_cmp_ui( v, pctx->wc->size, 0 )) ak_mpzn_set_ui( v, pctx->wc->size, 1 );
-  ak_mpzn_mul_montgomery( v, v, pctx->wc->r2q, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
 
-  /* вычисляем v (в представлении Монтгомери) */
-  ak_mpzn_set_ui( u, pctx->wc->size, 2 );
-  ak_mpzn_sub( u, pctx->wc->q, u, pctx->wc->size );
-  ak_mpzn_modpow_montgomery( v, v, u, pctx->wc->q, pctx->wc->nq, pctx->wc->size ); // v <- v^{q-2} (mod q)
+  /* вычисляем v <- e^{-1} (mod q) (в представлении Монтгомери); значение e не является секретным */
+  ak_mpzn_modinv_binary( v, v, pctx->wc->q, pctx->wc->size );
+  ak_mpzn_mul_montgomery( v, v, pctx->wc->r2q, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
 
   /* вычисляем z1 */
   ak_mpzn_mul_montgomery( z1, s, pctx->wc->r2q, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
@@ -1021,10 +1027,8 @@
   ak_mpzn_mul_montgomery( z2, z2, v, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
   ak_mpzn_mul_montgomery( z2, z2, pctx->wc->point.z, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
 
- /* сложение точек и проверка */
-  ak_wpoint_pow( &cpoint, &pctx->wc->point, z1, pctx->wc->size, pctx->wc );
-  ak_wpoint_pow( &tpoint, &pctx->qpoint, z2, pctx->wc->size, pctx->wc );
-  ak_wpoint_add( &cpoint, &tpoint, pctx->wc );
+ /* вычисление точки C = [z1]P + [z2]Q и проверка */
+  ak_wpoint_pow_base_sum( &cpoint, z1, &pctx->qpoint, z2, pctx->wc->size, pctx->wc );
   ak_wpoint_reduce( &cpoint, pctx->wc );
   ak_mpzn_rem( cpoint.x, cpoint.x, pctx->wc->q, pctx->wc->size );
 
@@ -4,7 +4,7 @@
 /*  Файл ak_skey.c                                                                                 */
 /*  - содержит реализации функций, предназначенных для хранения и обработки ключевой информации.   */
 /* ----------------------------------------------------------------------------------------------- */
- #include <libakrypt.h>
+ #include <libakrypt-internal.h>
 
 /* ----------------------------------------------------------------------------------------------- */
 #ifdef AK_HAVE_TIME_H
@@ -600,17 +600,41 @@
  int ak_skey_set_resource_values( ak_skey skey, counter_resource_t type,
                                          const char *option, time_t not_before, time_t not_after )
 {
+  ak_int64 value = 0;
+
   if( skey == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                             "using a null pointer to secret key" );
   if( option == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                            "using a null pointer to option name" );
+  if(( value = ak_libakrypt_get_option_by_name( option )) == ak_error_wrong_option )
+    return ak_error_wrong_option;
+ return ak_skey_set_resource_counter( skey, type, value, not_before, not_after );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция аналогична функции ak_skey_set_resource_values(), однако значение ресурса
+    передается явно, а не через имя опции библиотеки.
+
+    \param skey Контекст секретного ключа.
+    \param type Тип присваиваемого ресурса.
+    \param value Значение ресурса.
+    \param not_before Время, начиная с которого ключ действителен. Значение, равное нулю,
+    означает, что будет установлено текущее время.
+    \param not_after Время, начиная с которого ключ недействителен.
+    \return В случае успеха функция возвращает \ref ak_error_ok. В противном случае,
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_skey_set_resource_counter( ak_skey skey, counter_resource_t type,
+                                      const ak_int64 value, time_t not_before, time_t not_after )
+{
+  if( skey == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                            "using a null pointer to secret key" );
   ak_skey_set_validity( skey, not_before, not_after );
   switch( skey->resource.value.type = type ) {
     case block_counter_resource:
     case key_using_resource:
-      if(( skey->resource.value.counter =
-          ak_libakrypt_get_option_by_name( option )) != ak_error_wrong_option ) return ak_error_ok;
-        else return ak_error_wrong_option;
+      skey->resource.value.counter = value;
+      break;
   }
  return ak_error_ok;
 }
@@ -789,7 +813,7 @@
                                                              "using a password with zero length" );
  /* присваиваем буффер и маскируем его */
   if(( error = ak_hmac_pbkdf2_streebog512( pass, pass_size, salt, salt_size,
-                   (const size_t) ak_libakrypt_get_option_by_name( "pbkdf2_iteration_count" ),
+                   (const size_t) ak_libakrypt_get_option( pbkdf2_iteration_count_option ),
                                                      skey->key_size, skey->key )) != ak_error_ok )
     return ak_error_message( error, __func__ , "wrong generation a secret key data" );
   memset( skey->key+skey->key_size, 0, skey->key_size ); /* обнуляем массив масок */
@@ -0,0 +1,388 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  Copyright (c) 2014 - 2020 by Axel Kenzo, axelkenzo@mail.ru                                     */
+/*                                                                                                 */
+/*  Файл ak_thread.c                                                                               */
+/*  - содержит реализацию пула потоков, используемого для параллельной обработки данных            */
+/* ----------------------------------------------------------------------------------------------- */
+ #include <libakrypt-internal.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
+#ifdef AK_HAVE_UNISTD_H
+ #include <unistd.h>
+#endif
+
+#ifdef AK_HAVE_PTHREAD_H
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Группа заданий, запущенная одним вызовом функции ak_thread_pool_run(). */
+ typedef struct thread_pool_job {
+  /*! \brief Функция, выполняющая одно задание группы. */
+   ak_function_thread_task *func;
+  /*! \brief Контекст, передаваемый функции. */
+   ak_pointer ctx;
+  /*! \brief Количество еще не выполненных заданий. */
+   size_t remaining;
+  /*! \brief Код первой из возникших при выполнении заданий ошибок. */
+   int error;
+  /*! \brief Мьютекс, защищающий поля remaining и error. */
+   pthread_mutex_t mutex;
+  /*! \brief Условная переменная, сигнализирующая о выполнении всех заданий группы. */
+   pthread_cond_t done;
+ } *ak_thread_pool_job;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Задание, помещаемое в очередь потока. */
+ typedef struct thread_pool_task {
+  /*! \brief Группа, которой принадлежит задание. */
+   ak_thread_pool_job job;
+  /*! \brief Номер задания в группе. */
+   size_t index;
+ } *ak_thread_pool_task;
+
+/*! \brief Максимальное количество заданий в очереди одного потока. */
+ #define ak_thread_pool_deque_size (256)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Двусторонняя очередь заданий потока.
+    \details Поток извлекает задания из своей очереди с конца (bottom), последними помещенными
+    в очередь; свободные потоки забирают (крадут) задания из начала (top) чужих очередей.
+    Значения top и bottom только увеличиваются, индекс в массиве вычисляется по модулю
+    размера очереди.                                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ typedef struct thread_pool_deque {
+  /*! \brief Кольцевой буффер заданий. */
+   struct thread_pool_task tasks[ak_thread_pool_deque_size];
+  /*! \brief Номер первого задания очереди. */
+   size_t top;
+  /*! \brief Номер, следующий за номером последнего задания очереди. */
+   size_t bottom;
+  /*! \brief Мьютекс, защищающий очередь. */
+   pthread_mutex_t mutex;
+ } *ak_thread_pool_deque;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Пул потоков библиотеки. */
+ static struct thread_pool {
+  /*! \brief Количество рабочих потоков. */
+   size_t count;
+  /*! \brief Идентификаторы рабочих потоков. */
+   pthread_t *threads;
+  /*! \brief Очереди заданий рабочих потоков. */
+   ak_thread_pool_deque deques;
+  /*! \brief Номер очереди, в которую будет помещено следующее задание. */
+   size_t next;
+  /*! \brief Общее количество заданий, помещенных в очереди. */
+   size_t pending;
+  /*! \brief Флаг завершения работы пула. */
+   bool_t stop;
+  /*! \brief Мьютекс, защищающий поля next, pending и stop. */
+   pthread_mutex_t mutex;
+  /*! \brief Условная переменная, используемая для пробуждения рабочих потоков. */
+   pthread_cond_t wakeup;
+ } pool = { 0, NULL, NULL, 0, 0, ak_false,
+                                               PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_thread_pool_push( ak_thread_pool_deque deque, ak_thread_pool_task task )
+{
+  bool_t result = ak_false;
+
+  pthread_mutex_lock( &deque->mutex );
+  if( deque->bottom - deque->top < ak_thread_pool_deque_size ) {
+    deque->tasks[ deque->bottom%ak_thread_pool_deque_size ] = *task;
+    deque->bottom++;
+    result = ak_true;
+  }
+  pthread_mutex_unlock( &deque->mutex );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Извлечение задания из конца собственной очереди потока. */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_thread_pool_pop( ak_thread_pool_deque deque, ak_thread_pool_task task )
+{
+  bool_t result = ak_false;
+
+  pthread_mutex_lock( &deque->mutex );
+  if( deque->bottom != deque->top ) {
+    deque->bottom--;
+    *task = deque->tasks[ deque->bottom%ak_thread_pool_deque_size ];
+    result = ak_true;
+  }
+  pthread_mutex_unlock( &deque->mutex );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Извлечение задания из начала чужой очереди.
+    \details Если значение `job` отлично от NULL, то извлекается только задание,
+    принадлежащее указанной группе.                                                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_thread_pool_steal( ak_thread_pool_deque deque,
+                                                     ak_thread_pool_job job, ak_thread_pool_task task )
+{
+  bool_t result = ak_false;
+
+  pthread_mutex_lock( &deque->mutex );
+  if( deque->bottom != deque->top ) {
+    ak_thread_pool_task top = deque->tasks + deque->top%ak_thread_pool_deque_size;
+    if(( job == NULL ) || ( top->job == job )) {
+      *task = *top;
+      deque->top++;
+      result = ak_true;
+    }
+  }
+  pthread_mutex_unlock( &deque->mutex );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Поиск очередного задания для потока с номером `id`.
+    \details Рабочий поток сначала обращается к своей очереди, потом к очередям остальных потоков.
+    Поток, вызвавший ak_thread_pool_run(), имеет номер pool.count и выполняет только
+    задания своей группы.                                                                          */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_thread_pool_take( const size_t id,
+                                                     ak_thread_pool_job job, ak_thread_pool_task task )
+{
+  size_t i = 0;
+  bool_t result = ak_false;
+
+  if( id < pool.count ) result = ak_thread_pool_pop( pool.deques + id, task );
+  for( i = 1; ( i <= pool.count ) && ( result == ak_false ); i++ )
+     result = ak_thread_pool_steal( pool.deques + ( id + i )%pool.count, job, task );
+
+  if( result ) {
+    pthread_mutex_lock( &pool.mutex );
+    pool.pending--;
+    pthread_mutex_unlock( &pool.mutex );
+  }
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_thread_pool_execute( ak_thread_pool_task task, const size_t id )
+{
+  ak_thread_pool_job job = task->job;
+  int error = job->func( job->ctx, task->index, id );
+
+  pthread_mutex_lock( &job->mutex );
+  if(( error != ak_error_ok ) && ( job->error == ak_error_ok )) job->error = error;
+  if( --job->remaining == 0 ) pthread_cond_broadcast( &job->done );
+  pthread_mutex_unlock( &job->mutex );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Основной цикл рабочего потока.
+    @param ptr Указатель на очередь заданий потока.
+    @return Функция всегда возвращает NULL.                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_thread_pool_worker( void *ptr )
+{
+  struct thread_pool_task task;
+  const size_t id = ( size_t )(( ak_thread_pool_deque ) ptr - pool.deques );
+
+  for( ;; ) {
+     if( ak_thread_pool_take( id, NULL, &task )) {
+       ak_thread_pool_execute( &task, id );
+       continue;
+     }
+     pthread_mutex_lock( &pool.mutex );
+     while(( pool.stop == ak_false ) && ( pool.pending == 0 ))
+       pthread_cond_wait( &pool.wakeup, &pool.mutex );
+     if(( pool.stop == ak_true ) && ( pool.pending == 0 )) {
+       pthread_mutex_unlock( &pool.mutex );
+       break;
+     }
+     pthread_mutex_unlock( &pool.mutex );
+  }
+ return NULL;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция создает рабочие потоки, которые используются функциями параллельной обработки данных,
+    например, ak_bckey_ctr_parallel(). Поток, вызывающий функцию ak_thread_pool_run(), также
+    выполняет задания, поэтому количество создаваемых рабочих потоков на единицу меньше
+    заданного общего количества потоков.
+
+    @param size Общее количество потоков (значение опции `thread_pool_size`); нулевое значение
+    означает, что количество потоков совпадает с количеством доступных процессоров.
+    @return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_thread_pool_create( const ak_int64 size )
+{
+#ifdef AK_HAVE_PTHREAD_H
+  size_t i = 0, count = ( size_t ) size;
+
+  if( pool.count ) return ak_error_ok; /* пул уже создан */
+  if( size < 0 ) return ak_error_message( ak_error_invalid_value, __func__,
+                                                          "using negative number of threads" );
+ #ifdef _SC_NPROCESSORS_ONLN
+  if( count == 0 ) {
+    long cpus = sysconf( _SC_NPROCESSORS_ONLN );
+    count = ( cpus > 0 ) ? ( size_t ) cpus : 1;
+  }
+ #endif
+  if( count < 2 ) return ak_error_ok; /* параллельная обработка данных не используется */
+  count--;
+
+  if(( pool.deques = calloc( count, sizeof( struct thread_pool_deque ))) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__,
+                                                   "incorrect memory allocation for task queues" );
+  if(( pool.threads = calloc( count, sizeof( pthread_t ))) == NULL ) {
+    free( pool.deques ); pool.deques = NULL;
+    return ak_error_message( ak_error_out_of_memory, __func__,
+                                                     "incorrect memory allocation for threads" );
+  }
+  for( i = 0; i < count; i++ ) pthread_mutex_init( &pool.deques[i].mutex, NULL );
+
+  pool.stop = ak_false;
+  pool.next = pool.pending = 0;
+  for( i = 0; i < count; i++ ) {
+     if( pthread_create( pool.threads+i, NULL, ak_thread_pool_worker, pool.deques+i ) != 0 ) {
+       ak_error_message_fmt( ak_error_not_ready, __func__,
+                                                 "only %u threads were created", (unsigned int) i );
+       break;
+     }
+  }
+  pool.count = i;
+  if( pool.count == 0 ) return ak_thread_pool_destroy();
+
+  if( ak_log_get_level() > ak_log_standard )
+    ak_error_message_fmt( ak_error_ok, __func__,
+                           "thread pool with %u worker threads created", (unsigned int) pool.count );
+#else
+  (void) size;
+#endif
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция дожидается завершения рабочих потоков и освобождает память, выделенную под пул.
+    @return Функция возвращает \ref ak_error_ok.                                                   */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_thread_pool_destroy( void )
+{
+#ifdef AK_HAVE_PTHREAD_H
+  size_t i = 0;
+
+  pthread_mutex_lock( &pool.mutex );
+  pool.stop = ak_true;
+  pthread_cond_broadcast( &pool.wakeup );
+  pthread_mutex_unlock( &pool.mutex );
+
+  for( i = 0; i < pool.count; i++ ) pthread_join( pool.threads[i], NULL );
+  if( pool.deques != NULL ) {
+    for( i = 0; i < pool.count; i++ ) pthread_mutex_destroy( &pool.deques[i].mutex );
+    free( pool.deques );
+  }
+  if( pool.threads != NULL ) free( pool.threads );
+
+  pool.deques = NULL;
+  pool.threads = NULL;
+  pool.count = 0;
+  pool.stop = ak_false;
+#endif
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @return Количество рабочих потоков пула. Нулевое значение означает, что пул не создан
+    и все задания выполняются вызывающим потоком.                                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ size_t ak_thread_pool_size( void )
+{
+#ifdef AK_HAVE_PTHREAD_H
+  return pool.count;
+#else
+  return 0;
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция распределяет `count` заданий по очередям рабочих потоков и дожидается их выполнения.
+    Вызывающий поток также выполняет задания своей группы. Функция `func` вызывается с номером
+    задания (от нуля до `count-1`) и номером выполняющего его потока (от нуля до значения
+    ak_thread_pool_size() включительно); задания, выполняемые одним потоком, выполняются
+    последовательно, поэтому номер потока может использоваться для выбора принадлежащих потоку
+    данных, например, копии секретного ключа.
+
+    @param func Функция, выполняющая одно задание.
+    @param ctx Контекст, передаваемый функции.
+    @param count Количество заданий.
+    @return Функция возвращает \ref ak_error_ok, если все задания выполнены успешно.
+    В противном случае возвращается код первой из возникших ошибок.                                */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_thread_pool_run( ak_function_thread_task *func, ak_pointer ctx, const size_t count )
+{
+  size_t i = 0;
+  int error = ak_error_ok;
+#ifdef AK_HAVE_PTHREAD_H
+  struct thread_pool_job job;
+  struct thread_pool_task task;
+#endif
+
+  if( func == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                            "using null pointer to task function" );
+#ifdef AK_HAVE_PTHREAD_H
+  if( pool.count == 0 ) {
+#endif
+   /* пул не создан, выполняем задания последовательно */
+    for( i = 0; i < count; i++ ) {
+       int result = func( ctx, i, 0 );
+       if(( result != ak_error_ok ) && ( error == ak_error_ok )) error = result;
+    }
+    return error;
+#ifdef AK_HAVE_PTHREAD_H
+  }
+
+  job.func = func;
+  job.ctx = ctx;
+  job.remaining = count;
+  job.error = ak_error_ok;
+  pthread_mutex_init( &job.mutex, NULL );
+  pthread_cond_init( &job.done, NULL );
+
+ /* распределяем задания по очередям */
+  task.job = &job;
+  for( i = 0; i < count; i++ ) {
+     size_t idx = 0;
+     task.index = i;
+     pthread_mutex_lock( &pool.mutex );
+     idx = pool.next++%pool.count;
+     pool.pending++;
+     pthread_mutex_unlock( &pool.mutex );
+
+     if( !ak_thread_pool_push( pool.deques + idx, &task )) {
+       pthread_mutex_lock( &pool.mutex );
+       pool.pending--;
+       pthread_mutex_unlock( &pool.mutex );
+      /* очередь переполнена, задание выполняется вызывающим потоком */
+       ak_thread_pool_execute( &task, pool.count );
+     }
+  }
+  pthread_mutex_lock( &pool.mutex );
+  pthread_cond_broadcast( &pool.wakeup );
+  pthread_mutex_unlock( &pool.mutex );
+
+ /* выполняем задания своей группы, пока они есть в очередях, затем дожидаемся остальных */
+  while( ak_thread_pool_take( pool.count, &job, &task )) ak_thread_pool_execute( &task, pool.count );
+  pthread_mutex_lock( &job.mutex );
+  while( job.remaining ) pthread_cond_wait( &job.done, &job.mutex );
+  error = job.error;
+  pthread_mutex_unlock( &job.mutex );
+
+  pthread_cond_destroy( &job.done );
+  pthread_mutex_destroy( &job.mutex );
+ return error;
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                                                                                    ak_thread.c  */
+/* ----------------------------------------------------------------------------------------------- */
@@ -608,6 +608,9 @@
      else printf("Not equal");
   \endcode
 
+    Время выполнения функции зависит только от длины сравниваемых областей и не зависит
+    от их содержимого, поэтому функция может использоваться для проверки имитовставок.
+
     @param left Указатель на область памяти, участвующей в сравнении слева.
     @param right Указатель на область пямяти, участвующей в сравнении справа.
     @param size Размер области, для которой производяится сравнение.
@@ -618,7 +621,7 @@
  bool_t ak_ptr_is_equal( ak_const_pointer left, ak_const_pointer right, const size_t size )
 {
   size_t i = 0;
-  bool_t result = ak_true;
+  volatile ak_uint8 diff = 0;
   const ak_uint8 *lp = left, *rp = right;
 
   if(( left == NULL ) || ( right == NULL )) {
@@ -626,10 +629,10 @@
     return ak_false;
   }
 
-  for( i = 0; i < size; i++ )
-     if( lp[i] != rp[i] ) result = ak_false;
+ /* накапливаем отличия без ветвлений и досрочного выхода из цикла */
+  for( i = 0; i < size; i++ ) diff |= lp[i]^rp[i];
 
-  return result;
+  return diff ? ak_false : ak_true;
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -13,36 +13,87 @@
 #endif
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! Функция реализует алгоритм двухключевого шифрования, описываемый в стандарте IEEE P 1619.
-
-    \note Для блочных шифров с длиной блока 128 бит реализация полностью соответствует
-    указанному стандарту. Для шифров с длиной блока 64 реализация использует преобразования,
-    в частности вычисления к конечном поле \f$ \mathbb F_{2^{128}}\f$,
-    определенные для 128 битных шифров.
+/*! \brief Функция вычисляет следующее значение tweak (умножение на примитивный элемент
+    поля \f$ \mathbb F_{2^{128}} \f$).
 
-    @param encryptionKey Ключ, используемый для шифрования информации
-    @param authenticationKey Ключ, используемый для преобразования синхропосылки и выработки
-    псевдослучайной последовательности
-    @param in Указатель на область памяти, где хранятся входные (открытые) данные
-    @param out Указатель на область памяти, куда будут помещены зашифровываемые данные
-    @param size Размер входных данных (в октетах)
-    @param iv Указатель на область памяти, где находится синхропосылка (произвольные данные).
-    @param iv_size Размер синхропосылки в октетах, должен быть отличен от нуля.
-    Если размер синхропосылки превышает 16 октетов (128 бит), то оставшиеся значения не используются.
+    @param tweak Текущее значение, изменяемое функцией.
+    @param t Временный буффер (два 64-х битных слова).                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_xts_next_tweak( ak_uint64 *tweak, ak_uint64 *t )
+{
+  t[0] = tweak[0] >> 63;
+  t[1] = tweak[1] >> 63;
+  tweak[0] <<= 1;
+  tweak[1] <<= 1;
+  tweak[1] ^= t[0];
+  if( t[1] ) tweak[0] ^= 0x87;
+}
 
-    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В случае возникновения
-    ошибки возвращается ее код.                                                                    */
 /* ----------------------------------------------------------------------------------------------- */
- int ak_bckey_encrypt_xts( ak_bckey encryptionKey,  ak_bckey authenticationKey,
-                        ak_pointer in, ak_pointer out, size_t size, ak_pointer iv, size_t iv_size )
+/*! \brief Функция зашифровывает или расшифровывает последовательность блоков, начиная
+    с заданного значения tweak.
+
+    @param key Ключ, используемый для шифрования информации.
+    @param tweak Значение tweak для первых 16 октетов данных; после завершения работы функции
+    содержит значение для октетов, следующих за последними обработанными.
+    @param inptr Указатель на входные данные.
+    @param outptr Указатель на выходные данные.
+    @param words Количество обрабатываемых 64-х битных слов.
+    @param encrypt Флаг зашифрования (ak_true) или расшифрования (ak_false) данных.            */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_xts_process_words( ak_bckey key, ak_uint64 *tweak,
+                                  ak_uint64 *inptr, ak_uint64 *outptr, ak_int64 words, bool_t encrypt )
 {
   int error = ak_error_ok;
-  ak_int64 jcnt = 0, blocks = 0;
-  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
+  ak_int64 jcnt = 0, n = 0;
+  ak_function_bckey_blocks *process = encrypt ? key->encrypt_blocks : key->decrypt_blocks;
 #ifdef AK_HAVE_STDALIGN_H
   alignas(16)
 #endif
-  ak_uint64 tweak[2], t[2], *tptr = t;
+  ak_uint64 t[2], gamma[ak_bckey_batch_words], data[ak_bckey_batch_words];
+
+ /* последовательность значений tweak не зависит от обрабатываемых данных, поэтому
+    сначала вырабатываются значения tweak для группы блоков, а потом сама группа
+    обрабатывается одним вызовом функции encrypt_blocks (decrypt_blocks);
+    для шифра с длиной блока 64 бита каждое значение tweak используется для двух блоков */
+   while( words > 0 ) {
+      n = ak_min( words, ak_bckey_batch_words );
+      for( jcnt = 0; jcnt < n; jcnt += 2 ) {
+         gamma[jcnt] = tweak[0]; gamma[jcnt+1] = tweak[1];
+        /* изменяем значение tweak */
+         ak_xts_next_tweak( tweak, t );
+      }
+      for( jcnt = 0; jcnt < n; jcnt++ ) data[jcnt] = inptr[jcnt]^gamma[jcnt];
+      process( &key->key, data, data, ( size_t )(( n << 3 )/key->bsize ));
+      for( jcnt = 0; jcnt < n; jcnt++ ) outptr[jcnt] = data[jcnt]^gamma[jcnt];
+      inptr += n; outptr += n;
+      words -= n;
+   }
+
+ /* очищаем */
+  if(( error = ak_ptr_wipe( gamma, sizeof( gamma ), &key->key.generator )) != ak_error_ok )
+   ak_error_message( error, __func__ , "wrong wiping of gamma values" );
+  if(( error = ak_ptr_wipe( data, sizeof( data ), &key->key.generator )) != ak_error_ok )
+   ak_error_message( error, __func__ , "wrong wiping of processed data" );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция проверяет ключи и вырабатывает начальное значение tweak.
+
+    @param encryptionKey Ключ, используемый для шифрования информации
+    @param authenticationKey Ключ, используемый для преобразования синхропосылки
+    @param size Размер обрабатываемых данных (в октетах)
+    @param iv Указатель на синхропосылку
+    @param iv_size Размер синхропосылки в октетах
+    @param tweak Массив из двух 64-х битных слов, в который помещается значение tweak
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В случае возникновения
+    ошибки возвращается ее код.                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_xts_create_tweak( ak_bckey encryptionKey,  ak_bckey authenticationKey,
+                                     size_t size, ak_pointer iv, size_t iv_size, ak_uint64 *tweak )
+{
+  ak_int64 blocks = 0;
 
  /* проверяем целостность ключа */
   if( encryptionKey->key.check_icode( &encryptionKey->key ) != ak_true )
@@ -59,8 +110,8 @@
    else authenticationKey->key.resource.value.counter -= ( authenticationKey->bsize >> 3 );
 
  /* вырабатываем начальное состояние вектора */
-  memset( tweak, 0, sizeof( tweak ));
-  memcpy( tweak, iv, ak_min( iv_size, sizeof( tweak )));
+  memset( tweak, 0, 2*sizeof( ak_uint64 ));
+  memcpy( tweak, iv, ak_min( iv_size, 2*sizeof( ak_uint64 )));
 
   if( authenticationKey->bsize == 8 ) {
     authenticationKey->encrypt( &authenticationKey->key, tweak, tweak );
@@ -80,48 +131,43 @@
     return ak_error_message( ak_error_low_key_resource,
                                               __func__ , "low resource of encryption cipher key" );
    else encryptionKey->key.resource.value.counter -= blocks;
+ return ak_error_ok;
+}
 
- /* запускаем основной цикл обработки блоков информации */
-   switch( encryptionKey->bsize ) {
-     case  8: /* шифр с длиной блока 64 бита */
-       while( blocks > 0 ) {
-          *tptr = *inptr^*(tweak+jcnt); inptr++;
-          encryptionKey->encrypt( &encryptionKey->key, tptr, tptr );
-          *outptr = *tptr ^ *(tweak+jcnt); outptr++;
-          --blocks;
-          tptr++;
-
-          if( !(jcnt = 1 - jcnt)) { /* изменяем значение tweak */
-            tptr = t;
-            t[0] = tweak[0] >> 63; t[1] = tweak[1] >> 63;
-            tweak[0] <<= 1; tweak[1] <<= 1;
-            tweak[1] ^= t[0];
-            if( t[1] ) tweak[0] ^= 0x87;
-          }
-       }
-       break;
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует алгоритм двухключевого шифрования, описываемый в стандарте IEEE P 1619.
 
-     case 16: /* шифр с длиной блока 128 бит */
-       while( blocks > 0 ) {
-         /* шифруем */
-          t[0] = *inptr^*tweak; inptr++;
-          t[1] = *inptr^*(tweak+1); inptr++;
+    \note Для блочных шифров с длиной блока 128 бит реализация полностью соответствует
+    указанному стандарту. Для шифров с длиной блока 64 реализация использует преобразования,
+    в частности вычисления к конечном поле \f$ \mathbb F_{2^{128}}\f$,
+    определенные для 128 битных шифров.
 
-          encryptionKey->encrypt( &encryptionKey->key, t, t );
-          *outptr = t[0]^*tweak; outptr++;
-          *outptr = t[1]^*(tweak+1); outptr++;
-          --blocks;
+    @param encryptionKey Ключ, используемый для шифрования информации
+    @param authenticationKey Ключ, используемый для преобразования синхропосылки и выработки
+    псевдослучайной последовательности
+    @param in Указатель на область памяти, где хранятся входные (открытые) данные
+    @param out Указатель на область памяти, куда будут помещены зашифровываемые данные
+    @param size Размер входных данных (в октетах)
+    @param iv Указатель на область памяти, где находится синхропосылка (произвольные данные).
+    @param iv_size Размер синхропосылки в октетах, должен быть отличен от нуля.
+    Если размер синхропосылки превышает 16 октетов (128 бит), то оставшиеся значения не используются.
 
-         /* изменяем значение tweak */
-          t[0] = tweak[0] >> 63;
-          t[1] = tweak[1] >> 63;
-          tweak[0] <<= 1;
-          tweak[1] <<= 1;
-          tweak[1] ^= t[0];
-          if( t[1] ) tweak[0] ^= 0x87;
-       }
-       break;
-   }
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В случае возникновения
+    ошибки возвращается ее код.                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_encrypt_xts( ak_bckey encryptionKey,  ak_bckey authenticationKey,
+                        ak_pointer in, ak_pointer out, size_t size, ak_pointer iv, size_t iv_size )
+{
+  int error = ak_error_ok;
+  ak_uint64 tweak[2];
+
+  if(( error = ak_xts_create_tweak( encryptionKey, authenticationKey,
+                                                   size, iv, iv_size, tweak )) != ak_error_ok )
+    return error;
+
+ /* запускаем основной цикл обработки блоков информации */
+   ak_xts_process_words( encryptionKey, tweak, (ak_uint64 *)in, (ak_uint64 *)out,
+                                                       ( ak_int64 )( size >> 3 ), ak_true );
 
  /* очищаем */
   if(( error = ak_ptr_wipe( tweak, sizeof( tweak ), &encryptionKey->key.generator )) != ak_error_ok )
@@ -172,95 +218,158 @@
                         ak_pointer in, ak_pointer out, size_t size, ak_pointer iv, size_t iv_size )
 {
   int error = ak_error_ok;
-  ak_int64 jcnt = 0, blocks = 0;
-  ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
-#ifdef AK_HAVE_STDALIGN_H
-  alignas(16)
-#endif
-  ak_uint64 tweak[2], t[2], *tptr = t;
+  ak_uint64 tweak[2];
 
- /* проверяем целостность ключа */
-  if( encryptionKey->key.check_icode( &encryptionKey->key ) != ak_true )
-    return ak_error_message( ak_error_wrong_key_icode, __func__,
-                                               "incorrect integrity code of encryption key value" );
-  if( authenticationKey->key.check_icode( &authenticationKey->key ) != ak_true )
-    return ak_error_message( ak_error_wrong_key_icode, __func__,
-                                           "incorrect integrity code of authentication key value" );
+  if(( error = ak_xts_create_tweak( encryptionKey, authenticationKey,
+                                                   size, iv, iv_size, tweak )) != ak_error_ok )
+    return error;
 
- /* проверяем ресурс ключа аутентификации */
-  if( authenticationKey->key.resource.value.counter < (ssize_t)( authenticationKey->bsize >> 3 ))
-    return ak_error_message( ak_error_low_key_resource,
-                                              __func__ , "low resource of authentication cipher key" );
-   else authenticationKey->key.resource.value.counter -= ( authenticationKey->bsize >> 3 );
+ /* запускаем основной цикл обработки блоков информации */
+   ak_xts_process_words( encryptionKey, tweak, (ak_uint64 *)in, (ak_uint64 *)out,
+                                                       ( ak_int64 )( size >> 3 ), ak_false );
 
- /* вырабатываем начальное состояние вектора */
-  memset( tweak, 0, sizeof( tweak ));
-  memcpy( tweak, iv, ak_min( iv_size, sizeof( tweak )));
+ /* очищаем */
+  if(( error = ak_ptr_wipe( tweak, sizeof( tweak ), &encryptionKey->key.generator )) != ak_error_ok )
+   ak_error_message( error, __func__ , "wrong wiping of tweak value" );
 
-  if( authenticationKey->bsize == 8 ) {
-    authenticationKey->encrypt( &authenticationKey->key, tweak, tweak );
-    tweak[1] ^= tweak[0];
-    authenticationKey->encrypt( &authenticationKey->key, tweak+1, tweak+1 );
-  } else
-      authenticationKey->encrypt( &authenticationKey->key, tweak, tweak );
+ /* перемаскируем ключ */
+  if(( error = encryptionKey->key.set_mask( &encryptionKey->key )) != ak_error_ok )
+    ak_error_message( error, __func__ , "wrong remasking of encryption key" );
+  if(( error = authenticationKey->key.set_mask( &authenticationKey->key )) != ak_error_ok )
+    ak_error_message( error, __func__ , "wrong remasking of authentication key" );
 
- /* вычисляем количество блоков */
-  blocks = ( ak_int64 )( size/encryptionKey->bsize );
-  if( size != blocks*encryptionKey->bsize )
-    return ak_error_message( ak_error_wrong_block_cipher_length,
-                            __func__ , "the length of input data is not divided by block length" );
+  return error;
+}
 
- /* изменяем ресурс ключа */
-  if( encryptionKey->key.resource.value.counter < blocks )
+/* ----------------------------------------------------------------------------------------------- */
+/*                   параллельная реализация режима xts с помощью пула потоков                     */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Контекст параллельной обработки данных в режиме xts. */
+ typedef struct xts_parallel {
+  /*! \brief Копии ключа шифрования, по одной для каждого потока пула. */
+   ak_bckey keys;
+  /*! \brief Указатель на входные данные. */
+   ak_uint64 *in;
+  /*! \brief Указатель на выходные данные. */
+   ak_uint64 *out;
+  /*! \brief Общее количество 64-х битных слов. */
+   ak_int64 words;
+  /*! \brief Количество слов, обрабатываемых одним заданием (кратно двум). */
+   ak_int64 chunk;
+  /*! \brief Количество заданий. */
+   size_t tasks;
+  /*! \brief Значение tweak для первых 16 октетов данных. */
+   ak_uint64 tweak[2];
+  /*! \brief Флаг зашифрования данных. */
+   bool_t encrypt;
+ } *ak_xts_parallel;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Умножение в поле \f$ \mathbb F_{2^{128}} \f$ значений, представленных так же,
+    как значение tweak (младшее слово первым, слова в машинном порядке байт). */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_xts_mul_tweak( ak_uint64 *z, const ak_uint64 *x, const ak_uint64 *y )
+{
+#ifdef AK_LITTLE_ENDIAN
+  ak_uint64 a[2], b[2];
+  a[0] = x[0]; a[1] = x[1];
+  b[0] = y[0]; b[1] = y[1];
+#else
+  ak_uint64 a[2] = { bswap_64( x[0] ), bswap_64( x[1] ) },
+            b[2] = { bswap_64( y[0] ), bswap_64( y[1] ) };
+#endif
+  ak_gf128_mul( z, a, b );
+#ifndef AK_LITTLE_ENDIAN
+  z[0] = bswap_64( z[0] ); z[1] = bswap_64( z[1] );
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисление значения tweak, отстоящего от заданного на `count` шагов.
+    \details Функция ak_xts_next_tweak() умножает tweak на примитивный элемент поля
+    \f$ \alpha \f$, поэтому значение вычисляется как \f$ tweak \cdot \alpha^{count} \f$ с помощью
+    возведения в степень последовательным возведением в квадрат. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_xts_skip_tweak( ak_uint64 *tweak, ak_uint64 count )
+{
+  ak_uint64 alpha[2] = { 2, 0 }, t[2];
+
+  while( count ) {
+    if( count&0x1 ) {
+      ak_xts_mul_tweak( t, tweak, alpha );
+      tweak[0] = t[0]; tweak[1] = t[1];
+    }
+    if(( count >>= 1 ) != 0 ) {
+      ak_xts_mul_tweak( t, alpha, alpha );
+      alpha[0] = t[0]; alpha[1] = t[1];
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_xts_parallel_task( ak_pointer ptr, const size_t task, const size_t thread )
+{
+  ak_xts_parallel ctx = ( ak_xts_parallel ) ptr;
+  ak_bckey key = ctx->keys + thread;
+  ak_int64 start = ( ak_int64 )task*ctx->chunk,
+           words = ( task == ctx->tasks - 1 ) ? ctx->words - start : ctx->chunk;
+  ak_uint64 tweak[2];
+
+ /* каждое значение tweak используется для 16 октетов (двух 64-х битных слов) данных */
+  tweak[0] = ctx->tweak[0]; tweak[1] = ctx->tweak[1];
+  ak_xts_skip_tweak( tweak, ( ak_uint64 )( start >> 1 ));
+
+  if( key->key.resource.value.counter < ( words << 3 )/( ak_int64 )key->bsize )
     return ak_error_message( ak_error_low_key_resource,
                                               __func__ , "low resource of encryption cipher key" );
-   else encryptionKey->key.resource.value.counter -= blocks;
-
- /* запускаем основной цикл обработки блоков информации */
-   switch( encryptionKey->bsize ) {
-     case  8: /* шифр с длиной блока 64 бита */
-       while( blocks > 0 ) {
-          *tptr = *inptr^*(tweak+jcnt); inptr++;
-          encryptionKey->decrypt( &encryptionKey->key, tptr, tptr );
-          *outptr = *tptr ^ *(tweak+jcnt); outptr++;
-          --blocks;
-          tptr++;
-
-          if( !(jcnt = 1 - jcnt)) { /* изменяем значение tweak */
-            tptr = t;
-            t[0] = tweak[0] >> 63; t[1] = tweak[1] >> 63;
-            tweak[0] <<= 1; tweak[1] <<= 1;
-            tweak[1] ^= t[0];
-            if( t[1] ) tweak[0] ^= 0x87;
-          }
-       }
-       break;
+   else key->key.resource.value.counter -= ( words << 3 )/( ak_int64 )key->bsize;
 
-     case 16: /* шифр с длиной блока 128 бит */
-       while( blocks > 0 ) {
-         /* шифруем */
-          t[0] = *inptr^*tweak; inptr++;
-          t[1] = *inptr^*(tweak+1); inptr++;
+  ak_xts_process_words( key, tweak, ctx->in + start, ctx->out + start, words, ctx->encrypt );
+ return ak_ptr_wipe( tweak, sizeof( tweak ), &key->key.generator );
+}
 
-          encryptionKey->decrypt( &encryptionKey->key, t, t );
-          *outptr = t[0]^*tweak; outptr++;
-          *outptr = t[1]^*(tweak+1); outptr++;
-          --blocks;
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Общая часть функций ak_bckey_encrypt_xts_parallel() и ak_bckey_decrypt_xts_parallel(). */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_xts_parallel( ak_bckey encryptionKey,  ak_bckey authenticationKey,
+    ak_pointer in, ak_pointer out, size_t size, ak_pointer iv, size_t iv_size, bool_t encrypt )
+{
+  size_t tasks = 0;
+  struct xts_parallel ctx;
+  int error = ak_error_ok;
 
-         /* изменяем значение tweak */
-          t[0] = tweak[0] >> 63;
-          t[1] = tweak[1] >> 63;
-          tweak[0] <<= 1;
-          tweak[1] <<= 1;
-          tweak[1] ^= t[0];
-          if( t[1] ) tweak[0] ^= 0x87;
-       }
-       break;
+  if(( encryptionKey == NULL ) || ( authenticationKey == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__,
+                                                        "using null pointer to block cipher key" );
+  if(( tasks = ak_bckey_parallel_tasks( size )) < 2 ) {
+    if( encrypt ) return ak_bckey_encrypt_xts( encryptionKey, authenticationKey,
+                                                                     in, out, size, iv, iv_size );
+     else return ak_bckey_decrypt_xts( encryptionKey, authenticationKey,
+                                                                     in, out, size, iv, iv_size );
+  }
+  if(( error = ak_xts_create_tweak( encryptionKey, authenticationKey,
+                                               size, iv, iv_size, ctx.tweak )) != ak_error_ok )
+    return error;
+
+ /* разбиваем данные на задания, длина которых кратна 16 октетам */
+  ctx.in = ( ak_uint64 * ) in;
+  ctx.out = ( ak_uint64 * ) out;
+  ctx.encrypt = encrypt;
+  ctx.words = ( ak_int64 )( size >> 3 );
+  ctx.chunk = ( ctx.words + ( ak_int64 )tasks - 1 )/( ak_int64 )tasks;
+  ctx.chunk += ( ctx.chunk&0x1 );
+  ctx.tasks = ( size_t )(( ctx.words + ctx.chunk - 1 )/ctx.chunk );
+
+  if(( error = ak_bckey_parallel_create_keys( encryptionKey, &ctx.keys,
+                       ( ak_int64 )( size/encryptionKey->bsize ))) != ak_error_ok )
+    ak_error_message( error, __func__, "incorrect creation of block cipher keys" );
+   else {
+     if(( error = ak_thread_pool_run( ak_xts_parallel_task, &ctx, ctx.tasks )) != ak_error_ok )
+       ak_error_message( error, __func__, "incorrect parallel processing of data" );
+     ak_bckey_parallel_destroy_keys( ctx.keys );
    }
-
- /* очищаем */
-  if(( error = ak_ptr_wipe( tweak, sizeof( tweak ), &encryptionKey->key.generator )) != ak_error_ok )
-   ak_error_message( error, __func__ , "wrong wiping of tweak value" );
+  ak_ptr_wipe( ctx.tweak, sizeof( ctx.tweak ), &encryptionKey->key.generator );
+  if( error != ak_error_ok ) return error;
 
  /* перемаскируем ключ */
   if(( error = encryptionKey->key.set_mask( &encryptionKey->key )) != ak_error_ok )
@@ -268,30 +377,62 @@
   if(( error = authenticationKey->key.set_mask( &authenticationKey->key )) != ak_error_ok )
     ak_error_message( error, __func__ , "wrong remasking of authentication key" );
 
-  return error;
+ return error;
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*                 реализация режима аутентифицирующего шифрования xtsmac                          */
+/*! Функция распределяет зашифрование данных между потоками пула, созданного при инициализации
+    библиотеки. Данные разбиваются на фрагменты, длина которых кратна 16 октетам; для каждого
+    фрагмента начальное значение tweak вычисляется умножением на соответствующую степень
+    примитивного элемента поля \f$ \mathbb F_{2^{128}}\f$.
+
+    Результат работы функции совпадает с результатом работы функции ak_bckey_encrypt_xts().
+    Если пул потоков не создан или объем данных невелик, то функция ak_bckey_encrypt_xts()
+    вызывается непосредственно.
+
+    @param encryptionKey Ключ, используемый для шифрования информации
+    @param authenticationKey Ключ, используемый для преобразования синхропосылки
+    @param in Указатель на область памяти, где хранятся входные (открытые) данные
+    @param out Указатель на область памяти, куда будут помещены зашифровываемые данные
+    @param size Размер входных данных (в октетах)
+    @param iv Указатель на область памяти, где находится синхропосылка.
+    @param iv_size Размер синхропосылки в октетах, должен быть отличен от нуля.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В случае возникновения
+    ошибки возвращается ее код.                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_encrypt_xts_parallel( ak_bckey encryptionKey,  ak_bckey authenticationKey,
+                        ak_pointer in, ak_pointer out, size_t size, ak_pointer iv, size_t iv_size )
+{
+ return ak_bckey_xts_parallel( encryptionKey, authenticationKey,
+                                                          in, out, size, iv, iv_size, ak_true );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует обратное преобразование к алгоритму, реализуемому с помощью
+    функции ak_bckey_encrypt_xts_parallel(); результат совпадает с результатом работы
+    функции ak_bckey_decrypt_xts().
+
+    @param encryptionKey Ключ, используемый для шифрования информации
+    @param authenticationKey Ключ, используемый для преобразования синхропосылки
+    @param in Указатель на область памяти, где хранятся входные (зашифрованные) данные
+    @param out Указатель на область памяти, куда будут помещены расшифрованные данные
+    @param size Размер входных данных (в октетах)
+    @param iv Указатель на область памяти, где находится синхропосылка.
+    @param iv_size Размер синхропосылки в октетах, должен быть отличен от нуля.
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В случае возникновения
+    ошибки возвращается ее код.                                                                    */
 /* ----------------------------------------------------------------------------------------------- */
-/** \addtogroup aead-doc
- @{ */
-/*! \brief Структура, содержащая текущее состояние внутренних переменных режима `xtsmac`
-   аутентифицированного шифрования. */
- typedef struct xtsmac_ctx {
-  /*! \brief Текущее значение имитовставки. */
-   ak_uint64 sum[2];
-  /*! \brief Вектор, используемый для маскирования шифруемой информации. */
-   ak_uint64 gamma[6];
-  /*! \brief Размер обработанных зашифровываемых/расшифровываемых данных в битах. */
-   ssize_t pbitlen;
-  /*! \brief Размер обработанных ассоциированных данных в битах. */
-   ssize_t abitlen;
-  /*! \brief Флаги состояния контекста. */
-   ak_uint32 flags;
-} *ak_xtsmac_ctx;
-/** @} */
+ int ak_bckey_decrypt_xts_parallel( ak_bckey encryptionKey,  ak_bckey authenticationKey,
+                        ak_pointer in, ak_pointer out, size_t size, ak_pointer iv, size_t iv_size )
+{
+ return ak_bckey_xts_parallel( encryptionKey, authenticationKey,
+                                                          in, out, size, iv, iv_size, ak_false );
+}
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                 реализация режима аутентифицирующего шифрования xtsmac                          */
 /* ----------------------------------------------------------------------------------------------- */
  static int ak_xtsmac_authentication_clean( ak_xtsmac_ctx ctx,
                             ak_bckey authenticationKey, const ak_pointer iv, const size_t iv_size )
@@ -376,8 +517,7 @@
  #define ak_xtsmac_authenticate_step64( in ) { \
             t[0] = *(in)^ctx->gamma[0]; (in)++; \
             t[1] = *(in)^ctx->gamma[1]; (in)++; \
-            authenticationKey->encrypt( &authenticationKey->key, t, t ); \
-            authenticationKey->encrypt( &authenticationKey->key, t+1, t+1 ); \
+            authenticationKey->encrypt_blocks( &authenticationKey->key, t, t, 2 ); \
            /* вычисляем слагаемое для имитовставки */ \
             ak_xtsmac_update_sum; \
            /* изменяем значение гаммы */ \
@@ -387,8 +527,7 @@
  #define ak_xtsmac_encrypt_step64( in, out ) { \
             t[0] = *(in)^ctx->gamma[0]; (in)++; \
             t[1] = *(in)^ctx->gamma[1]; (in)++; \
-            encryptionKey->encrypt( &encryptionKey->key, t, t ); \
-            encryptionKey->encrypt( &encryptionKey->key, t+1, t+1 ); \
+            encryptionKey->encrypt_blocks( &encryptionKey->key, t, t, 2 ); \
             *(out) = t[0]^ctx->gamma[0]; (out)++; \
             *(out) = t[1]^ctx->gamma[1]; (out)++; \
            /* вычисляем слагаемое для имитовставки */ \
@@ -403,8 +542,7 @@
            /* вычисляем слагаемое для имитовставки */ \
             ak_xtsmac_update_sum;  \
            /* расшифровываем данные */ \
-            encryptionKey->decrypt( &encryptionKey->key, temp, t ); \
-            encryptionKey->decrypt( &encryptionKey->key, temp+1, t+1 ); \
+            encryptionKey->decrypt_blocks( &encryptionKey->key, temp, t, 2 ); \
             *(out) = t[0]^ctx->gamma[0]; (out)++; \
             *(out) = t[1]^ctx->gamma[1]; (out)++; \
             ak_xtsmac_next_gamma; \
@@ -926,6 +1064,330 @@
  return ak_error_not_equal_data;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                  потоковая обработка данных в режиме аутентифицированного шифрования xtsmac     */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обновления внутреннего состояния при зашифровании/расшифровании данных. */
+ typedef int ( ak_function_xtsmac_update )( ak_xtsmac_ctx , ak_bckey ,
+                                                  const ak_pointer , ak_pointer , const size_t );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция инициализирует контекст, предназначенный для обработки данных, поступающих
+    последовательными фрагментами произвольной длины. Последовательность вызовов функций
+    аналогична последовательности, описанной для функции ak_mgm_stream_init().
+    Результат вычислений совпадает с результатом однократного вызова функции
+    ak_bckey_encrypt_xtsmac() для тех же данных.
+
+    @param ctx Контекст потокового шифрования
+    @param encryptionKey Ключ шифрования, должен быть инициализирован перед вызовом функции
+    @param authenticationKey Ключ выработки имитовставки, должен быть инициализирован перед
+           вызовом функции
+    @param iv Указатель на синхропосылку
+    @param iv_size Длина синхропосылки в байтах
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_xtsmac_stream_init( ak_xtsmac_stream ctx, ak_bckey encryptionKey,
+                         ak_bckey authenticationKey, const ak_pointer iv, const size_t iv_size )
+{
+  int error = ak_error_ok;
+
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                 "using null pointer to xtsmac stream context" );
+  if(( encryptionKey == NULL ) || ( authenticationKey == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__ , "using null pointer to secret key" );
+  if( encryptionKey->bsize != authenticationKey->bsize )
+    return ak_error_message( ak_error_not_equal_data, __func__,
+                                                   "different block sizes for given secret keys");
+  memset( ctx, 0, sizeof( struct xtsmac_stream ));
+  if(( error = ak_xtsmac_authentication_clean( &ctx->state,
+                                           authenticationKey, iv, iv_size )) != ak_error_ok ) {
+    ak_ptr_wipe( ctx, sizeof( struct xtsmac_stream ), &authenticationKey->key.generator );
+    return ak_error_message( error, __func__,
+                                           "incorrect initialization of internal xtsmac context" );
+  }
+  ctx->encryptionKey = encryptionKey;
+  ctx->authenticationKey = authenticationKey;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция обрабатывает очередной фрагмент ассоциированных данных произвольной длины.
+    Функция может вызываться только до начала обработки шифруемых данных.
+
+    @param ctx Контекст потокового шифрования
+    @param adata Указатель на ассоциированные данные
+    @param adata_size Длина ассоциированных данных в байтах
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_xtsmac_stream_aad_update( ak_xtsmac_stream ctx,
+                                                  const ak_pointer adata, const size_t adata_size )
+{
+  int error = ak_error_ok;
+  ak_uint8 *aptr = (ak_uint8 *)adata;
+  size_t take = 0, size = adata_size;
+
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                 "using null pointer to xtsmac stream context" );
+  if( ctx->authenticationKey == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                      "using uninitialized xtsmac stream context" );
+  if( ctx->state.flags&ak_aead_assosiated_data_bit )
+    return ak_error_message( ak_error_wrong_block_cipher_function, __func__ ,
+                                              "attemp to update previously closed xtsmac context");
+  if( size == 0 ) return ak_error_ok;
+  if( adata == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                         "using null pointer to associated data" );
+ /* дополняем ранее сохраненный неполный блок */
+  if( ctx->alength ) {
+    take = ak_min( 16 - ctx->alength, size );
+    memcpy( ctx->abuffer + ctx->alength, aptr, take );
+    ctx->alength += take; aptr += take; size -= take;
+    if( ctx->alength < 16 ) return ak_error_ok;
+    if(( error = ak_xtsmac_authentication_update( &ctx->state,
+                                  ctx->authenticationKey, ctx->abuffer, 16 )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect hashing of associated data" );
+    ctx->alength = 0;
+  }
+
+ /* обрабатываем полные блоки и сохраняем остаток */
+  take = size&( ~( size_t )0xf );
+  if(( take > 0 ) && (( error = ak_xtsmac_authentication_update( &ctx->state,
+                                      ctx->authenticationKey, aptr, take )) != ak_error_ok ))
+    return ak_error_message( error, __func__, "incorrect hashing of associated data" );
+  if(( ctx->alength = size - take ) > 0 ) memcpy( ctx->abuffer, aptr + take, ctx->alength );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция завершает обработку ассоциированных данных. */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_xtsmac_stream_close_adata( ak_xtsmac_stream ctx )
+{
+  int error = ak_error_ok;
+
+  if( ctx->state.flags&ak_aead_assosiated_data_bit ) return ak_error_ok;
+  if( ctx->alength ) {
+    if(( error = ak_xtsmac_authentication_update( &ctx->state,
+                      ctx->authenticationKey, ctx->abuffer, ctx->alength )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect hashing of associated data" );
+    ctx->alength = 0;
+  }
+  ak_aead_set_bit( ctx->state.flags, ak_aead_assosiated_data_bit );
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает очередной фрагмент зашифровываемых (расшифровываемых) данных.
+
+    Поскольку последний полный блок сообщения изменяется при "скрадывании" шифртекста,
+    в контексте всегда сохраняются от 16 до 31 последних октетов (либо все данные, если их
+    меньше 32 октетов); они обрабатываются при вызове функции завершения.
+
+    @return Количество октетов, помещенных в out, или отрицательный код ошибки.                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static ssize_t ak_xtsmac_stream_update( ak_xtsmac_stream ctx, const ak_pointer in,
+                      ak_pointer out, const size_t size, ak_function_xtsmac_update *update )
+{
+  int error = ak_error_ok;
+  ak_uint8 *inp = (ak_uint8 *)in, *outp = (ak_uint8 *)out;
+  size_t take = 0, total = 0, process = 0, len = size;
+  ssize_t written = 0;
+
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                 "using null pointer to xtsmac stream context" );
+  if( ctx->encryptionKey == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                      "using uninitialized xtsmac stream context" );
+  if(( error = ak_xtsmac_stream_close_adata( ctx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect finalizing of associated data" );
+  if( ctx->state.flags&ak_aead_encrypted_data_bit )
+    return ak_error_message( ak_error_wrong_block_cipher_function, __func__ ,
+                                              "attemp to update previously closed xtsmac context");
+  if( len == 0 ) return 0;
+  if(( in == NULL ) || ( out == NULL )) return ak_error_message( ak_error_null_pointer,
+                                                    __func__ , "using null pointer to data" );
+ /* определяем количество октетов, которые могут быть обработаны прямо сейчас */
+  total = ctx->length + len;
+  process = total - (( total < 32 ) ? total : 16 + ( total&0xf ));
+
+ /* в начале обрабатываем данные, сохраненные в контексте */
+  while(( ctx->length > 0 ) && ( process > 0 )) {
+     if( ctx->length < 16 ) {
+       take = 16 - ctx->length;
+       memcpy( ctx->buffer + ctx->length, inp, take );
+       inp += take; len -= take;
+       ctx->length = 16;
+     }
+     if(( error = update( &ctx->state, ctx->encryptionKey,
+                                                     ctx->buffer, outp, 16 )) != ak_error_ok )
+       return ak_error_message( error, __func__, "incorrect processing of data" );
+     outp += 16; written += 16; process -= 16;
+     if(( ctx->length -= 16 ) > 0 ) memmove( ctx->buffer, ctx->buffer + 16, ctx->length );
+  }
+
+ /* потом - данные, переданные в функцию */
+  if( process > 0 ) {
+    if(( error = update( &ctx->state, ctx->encryptionKey, inp, outp, process )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect processing of data" );
+    inp += process; len -= process; written += ( ssize_t )process;
+  }
+  memcpy( ctx->buffer + ctx->length, inp, len );
+  ctx->length += len;
+
+ return written;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает сохраненные в контексте данные и вычисляет имитовставку. */
+/* ----------------------------------------------------------------------------------------------- */
+ static ssize_t ak_xtsmac_stream_finalize( ak_xtsmac_stream ctx, ak_pointer out,
+                 ak_pointer icode, const size_t icode_size, ak_function_xtsmac_update *update )
+{
+  int error = ak_error_ok;
+  ssize_t written = 0;
+
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                 "using null pointer to xtsmac stream context" );
+  if( ctx->encryptionKey == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                      "using uninitialized xtsmac stream context" );
+  if(( error = ak_xtsmac_stream_close_adata( ctx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect finalizing of associated data" );
+  if( ctx->length ) {
+    if( out == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                        "using null pointer to output buffer" );
+    if(( error = update( &ctx->state, ctx->encryptionKey,
+                                              ctx->buffer, out, ctx->length )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect processing of data" );
+    written = ( ssize_t )ctx->length;
+    ctx->length = 0;
+  }
+  if(( error = ak_xtsmac_authentication_finalize( &ctx->state,
+                                   ctx->authenticationKey, icode, icode_size )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect finanlize of integrity code" );
+
+ return written;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция зашифровывает очередной фрагмент данных произвольной длины. Последние 16-31 октет
+    данных сохраняются в контексте и зашифровываются при следующем вызове функции,
+    либо при вызове ak_xtsmac_stream_encrypt_finalize(). Области памяти in и out не должны
+    пересекаться.
+
+    @param ctx Контекст потокового шифрования
+    @param in Указатель на зашифровываемые данные
+    @param out Указатель на область памяти, куда помещаются зашифрованные данные;
+           размер области должен быть не менее size + 31 октета
+    @param size Длина зашифровываемого фрагмента в байтах
+
+    @return Количество октетов, помещенных в out. В случае возникновения ошибки
+    возвращается ее код (отрицательное число).                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ ssize_t ak_xtsmac_stream_encrypt_update( ak_xtsmac_stream ctx, const ak_pointer in,
+                                                             ak_pointer out, const size_t size )
+{
+  return ak_xtsmac_stream_update( ctx, in, out, size, ak_xtsmac_encryption_update );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция зашифровывает сохраненные в контексте данные и вырабатывает имитовставку.
+    \note Режим не позволяет обрабатывать сообщения, длина которых менее 16 октетов.
+
+    @param ctx Контекст потокового шифрования
+    @param out Указатель на область памяти (не менее 32 октетов), куда помещаются последние
+           зашифрованные данные
+    @param icode Указатель на область памяти, куда помещается имитовставка
+    @param icode_size Ожидаемый размер имитовставки в байтах
+
+    @return Количество октетов, помещенных в out. В случае возникновения ошибки
+    возвращается ее код (отрицательное число).                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ ssize_t ak_xtsmac_stream_encrypt_finalize( ak_xtsmac_stream ctx, ak_pointer out,
+                                                          ak_pointer icode, const size_t icode_size )
+{
+  return ak_xtsmac_stream_finalize( ctx, out, icode, icode_size, ak_xtsmac_encryption_update );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция расшифровывает очередной фрагмент данных произвольной длины. Требования к параметрам
+    аналогичны требованиям функции ak_xtsmac_stream_encrypt_update().
+
+    \note Расшифрованные данные становятся доступны до проверки имитовставки; они не должны
+    использоваться, если функция ak_xtsmac_stream_decrypt_finalize() вернула код ошибки.
+
+    @param ctx Контекст потокового шифрования
+    @param in Указатель на расшифровываемые данные
+    @param out Указатель на область памяти, куда помещаются расшифрованные данные
+    @param size Длина расшифровываемого фрагмента в байтах
+
+    @return Количество октетов, помещенных в out. В случае возникновения ошибки
+    возвращается ее код (отрицательное число).                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ ssize_t ak_xtsmac_stream_decrypt_update( ak_xtsmac_stream ctx, const ak_pointer in,
+                                                             ak_pointer out, const size_t size )
+{
+  return ak_xtsmac_stream_update( ctx, in, out, size, ak_xtsmac_decryption_update );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция расшифровывает сохраненные в контексте данные, вычисляет имитовставку
+    и сравнивает ее с заданным значением. Время сравнения не зависит от значений имитовставок.
+
+    @param ctx Контекст потокового шифрования
+    @param out Указатель на область памяти (не менее 32 октетов), куда помещаются последние
+           расшифрованные данные
+    @param icode Указатель на проверяемое значение имитовставки
+    @param icode_size Размер имитовставки в байтах
+
+    @return Количество октетов, помещенных в out. Если значение имитовставки не совпало
+    с вычисленным, возвращается \ref ak_error_not_equal_data; в случае возникновения
+    иной ошибки возвращается ее код.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ ssize_t ak_xtsmac_stream_decrypt_finalize( ak_xtsmac_stream ctx, ak_pointer out,
+                                                    const ak_pointer icode, const size_t icode_size )
+{
+  ssize_t written = 0;
+  ak_uint8 icode2[16];
+
+  if( icode == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                          "using null pointer to integrity code" );
+  memset( icode2, 0, sizeof( icode2 ));
+  if(( written = ak_xtsmac_stream_finalize( ctx, out,
+                                     icode2, icode_size, ak_xtsmac_decryption_update )) < 0 )
+    return ak_error_message( ( int )written, __func__, "incorrect finalize of integrity code" );
+  if( !ak_ptr_is_equal( icode, icode2, ak_min( icode_size, 16 ))) written = ak_error_not_equal_data;
+  ak_ptr_wipe( icode2, sizeof( icode2 ), &ctx->authenticationKey->key.generator );
+
+ return written;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param ctx Контекст потокового шифрования
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_xtsmac_stream_destroy( ak_xtsmac_stream ctx )
+{
+  ak_random generator = NULL;
+
+  if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                 "using null pointer to xtsmac stream context" );
+  if( ctx->authenticationKey == NULL ) {
+    memset( ctx, 0, sizeof( struct xtsmac_stream ));
+    return ak_error_ok;
+  }
+  generator = &ctx->authenticationKey->key.generator;
+  ak_ptr_wipe( ctx, sizeof( struct xtsmac_stream ), generator );
+  memset( ctx, 0, sizeof( struct xtsmac_stream ));
+
+ return ak_error_ok;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                                                                                       ak_xts.c  */
 /* ----------------------------------------------------------------------------------------------- */
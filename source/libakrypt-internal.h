@@ -10,10 +10,56 @@
 /* ----------------------------------------------------------------------------------------------- */
  #include <libakrypt.h>
 
+/* ----------------------------------------------------------------------------------------------- */
+/** \addtogroup options-doc
+ @{ */
+/*! \brief Проверка того, что значение лежит в допустимых для опции пределах. */
+ int ak_libakrypt_check_option_value( const option_t , const ak_int64 );
+/** @} */
+
+/* ----------------------------------------------------------------------------------------------- */
+/** \addtogroup threads-doc
+ @{ */
+/*! \brief Минимальный объем данных (в октетах), обрабатываемый одним заданием пула потоков. */
+ #define ak_thread_pool_min_task_size (65536)
+/*! \brief Создание рабочих потоков библиотеки. */
+ int ak_thread_pool_create( const ak_int64 );
+/*! \brief Завершение работы рабочих потоков библиотеки. */
+ int ak_thread_pool_destroy( void );
+/** @} */
+
+/* ----------------------------------------------------------------------------------------------- */
+/** \addtogroup tests-doc
+ @{ */
+/*! \brief Группы криптографических механизмов, динамический контроль которых
+    выполняется независимо друг от друга. */
+ typedef enum {
+  /*! \brief Функции хеширования. */
+   hash_test_family,
+  /*! \brief Блочные шифры, режимы их использования и арифметика в полях характеристики два. */
+   block_cipher_test_family,
+  /*! \brief Алгоритмы выработки имитовставки. */
+   mac_test_family,
+  /*! \brief Эллиптические кривые и электронная подпись. */
+   asymmetric_test_family
+ } test_family_t;
+/*! \brief Количество групп криптографических механизмов. */
+ #define ak_test_family_count (4)
+/*! \brief Тестирование группы механизмов при первом ее использовании (в режиме
+    \ref lazy_dynamic_control, в остальных режимах функция ничего не делает). */
+ int ak_libakrypt_lazy_test( const test_family_t );
+/** @} */
+
 /* ----------------------------------------------------------------------------------------------- */
 /** \addtogroup mac-doc
  @{ */
  extern const ak_uint64 streebog_Areverse_expand_with_pi[8][256];
+/*! \brief Преобразование LPS функции хеширования Стрибог, использующее 64-х битные таблицы. */
+ void ak_hash_streebog_lps_uint64( ak_uint64 * , const ak_uint64 * );
+/*! \brief Функция сжатия функции хеширования Стрибог, не использующая расширений системы команд. */
+ void ak_hash_streebog_g_uint64( ak_uint64 * , const ak_uint64 * , const ak_uint64 * );
+/*! \brief Выбор реализации функции сжатия функции хеширования Стрибог. */
+ void ak_hash_streebog_init_dispatch( ak_cpu_dispatch );
 /** @} */
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -24,6 +70,8 @@
 /*! \brief Формирование имени файла, в который будет помещаться секретный или открытый ключ. */
  int ak_skey_generate_file_name_from_buffer( ak_uint8 * , const size_t ,
                                                          char * , const size_t , export_format_t );
+/*! \brief Установка ресурса секретного ключа заданным значением. */
+ int ak_skey_set_resource_counter( ak_skey , counter_resource_t , const ak_int64 , time_t , time_t );
 /*! \brief Инициализация секретного ключа алгоритма блочного шифрования. */
  int ak_bckey_create( ak_bckey , size_t , size_t );
 /*! \brief Инициализация ключа алгоритма блочного шифрования значением другого ключа */
@@ -31,6 +79,22 @@
 /*! \brief Процедура вычисления производного ключа в соответствии с алгоритмом ACPKM
     из рекомендаций Р 1323565.1.012-2018. */
  int ak_bckey_next_acpkm_key( ak_bckey );
+/*! \brief Размер (в 64-х битных словах) буффера, используемого режимами шифрования
+    для передачи группы блоков в функции encrypt_blocks() и decrypt_blocks(). */
+ #define ak_bckey_batch_words (64)
+/*! \brief Функция обработки данных, длина которых кратна длине блока (за исключением,
+    быть может, данных, передаваемых при последнем вызове). */
+ typedef int ( ak_function_iovector_update )( ak_pointer , ak_pointer , ak_pointer , const size_t );
+/*! \brief Поблочная обработка данных, разбитых на фрагменты произвольной длины. */
+ int ak_bckey_iovector_update( ak_iovector , const size_t , ak_iovector , const size_t ,
+                                  const size_t , ak_function_iovector_update * , ak_pointer );
+/*! \brief Количество заданий, на которое разбивается обработка данных заданной длины
+    функциями параллельного шифрования. */
+ size_t ak_bckey_parallel_tasks( const size_t );
+/*! \brief Создание копий ключа алгоритма блочного шифрования для каждого потока пула. */
+ int ak_bckey_parallel_create_keys( ak_bckey , ak_bckey * , const ak_int64 );
+/*! \brief Удаление копий ключа алгоритма блочного шифрования. */
+ int ak_bckey_parallel_destroy_keys( ak_bckey );
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция вырабатывает пару ключей алгоритма блочного шифрования из заданного
@@ -51,6 +115,31 @@
                                                                 const sbox , ak_kuznechik_params );
 /*! \brief Инициализация внутренних переменных значениями, регламентируемыми ГОСТ Р 34.12-2015. */
  int ak_bckey_kuznechik_init_gost_tables( void );
+#ifdef AK_HAVE_KUZNECHIK_TABLES
+/*! \brief Таблицы алгоритма Кузнечик, вычисленные на этапе сборки библиотеки
+    (индекс массива совпадает со значением опции `openssl_compability`). */
+ extern const struct kuznechik_params kuznechik_gost_parameters[2];
+#endif
+/*! \brief Выбор реализации групповой обработки блоков алгоритма Кузнечик. */
+ void ak_bckey_kuznechik_init_dispatch( ak_cpu_dispatch );
+/*! \brief Выбор реализации групповой обработки блоков алгоритма Магма. */
+ void ak_bckey_magma_init_dispatch( ak_cpu_dispatch );
+/** @} */
+
+/* ----------------------------------------------------------------------------------------------- */
+/** \addtogroup mpzn-doc
+ @{ */
+/*! \brief Умножение двух вычетов в представлении Монтгомери, вызывающее реализацию из таблицы
+    \ref ak_libakrypt_dispatch без промежуточного вызова функции ak_mpzn_mul_montgomery(). */
+ #define ak_mpzn_mul_montgomery( z, x, y, p, n0, size ) \
+                            ak_libakrypt_dispatch.mpzn_mul_montgomery( z, x, y, p, n0, size )
+/** @} */
+
+/* ----------------------------------------------------------------------------------------------- */
+/** \addtogroup curves-doc
+ @{ */
+/*! \brief Удаление таблиц кратных образующих точек эллиптических кривых. */
+ void ak_wcurve_destroy_base_tables( void );
 /** @} */
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -80,6 +169,11 @@
  #define ak_aead_encrypted_data_bit   (0x2)
 
  #define ak_aead_set_bit( x, n ) ( (x) = ((x)&(0xFFFFFFFF^(n)))^(n) )
+
+/*! \brief Размер фрагмента данных (в октетах), который в режимах `ctr-cmac` и `ctr-hmac`
+    зашифровывается и сразу же передается алгоритму выработки имитовставки, пока он находится
+    в кэше процессора; значение кратно длинам блоков всех используемых алгоритмов. */
+ #define ak_aead_tile_size (16384)
 /** @} */
 
 #endif
@@ -33,6 +33,8 @@ extern "C" {
  #define ak_error_wrong_option                (-100)
 /*! \brief Ошибка использования неправильного (неожидаемого) значения. */
  #define ak_error_invalid_value               (-101)
+/*! \brief Ошибка динамического контроля (тестирования) криптографических механизмов. */
+ #define ak_error_self_test                   (-102)
 
 /*! \brief Неверный тип криптографического механизма. */
  #define ak_error_oid_engine                  (-110)
@@ -107,6 +109,60 @@ extern "C" {
 /* ----------------------------------------------------------------------------------------------- */
 /** \addtogroup options-doc Инициализация и настройка параметров библиотеки
  @{ */
+/*! \brief Режим выполнения динамического контроля криптографических механизмов
+    при инициализации библиотеки (значение опции `dynamic_control_test`). */
+ typedef enum {
+  /*! \brief Тестирование при инициализации не выполняется, функция
+      ak_libakrypt_dynamic_control_test() вызывается пользователем самостоятельно. */
+   none_dynamic_control,
+  /*! \brief Полное последовательное тестирование всех механизмов. */
+   full_dynamic_control,
+  /*! \brief Полное тестирование, группы механизмов тестируются в отдельных потоках. */
+   parallel_dynamic_control,
+  /*! \brief Группа механизмов тестируется при первом создании контекста из этой группы. */
+   lazy_dynamic_control,
+  /*! \brief Полное тестирование выполняется один раз для данной сборки библиотеки и данного
+      набора реализаций; успешный результат сохраняется в домашнем каталоге пользователя.
+      \note Сохраняемое значение не защищено секретным ключом, поэтому режим доверяет
+      домашнему каталогу пользователя: любой, кто может записывать в него, может отключить
+      тестирование. */
+   cached_dynamic_control
+ } dynamic_control_t;
+
+/*! \brief Идентификаторы опций библиотеки.
+    \details Значение идентификатора совпадает с индексом опции, поэтому доступ к значению
+    опции с помощью функции ak_libakrypt_get_option() не требует поиска по имени. */
+ typedef enum {
+   log_level_option,
+   context_manager_size_option,
+   context_manager_max_size_option,
+   pbkdf2_iteration_count_option,
+   hmac_key_count_resource_option,
+   digital_signature_count_resource_option,
+   magma_cipher_resource_option,
+   kuznechik_cipher_resource_option,
+   acpkm_message_count_option,
+   acpkm_section_magma_block_count_option,
+   acpkm_section_kuznechik_block_count_option,
+   openssl_compability_option,
+   use_color_output_option,
+   dynamic_control_test_option,
+   thread_pool_size_option,
+  /*! \brief Общее количество опций (не является идентификатором опции). */
+   undefined_option
+ } option_t;
+
+/*! \brief Согласованный набор значений всех опций библиотеки.
+    \details Структура заполняется функцией ak_libakrypt_get_options_snapshot() без
+    использования блокировок; при одновременном изменении опций другим потоком копирование
+    повторяется, поэтому все значения снимка относятся к одному и тому же моменту времени. */
+ typedef struct options_snapshot {
+  /*! \brief Значения опций (индекс массива совпадает со значением типа option_t). */
+   ak_int64 value[undefined_option];
+  /*! \brief Номер версии набора опций (увеличивается при каждом изменении опций). */
+   ak_uint32 version;
+ } *ak_options_snapshot;
+
 /*! \brief Функция инициализации библиотеки. */
  dll_export bool_t ak_libakrypt_create( ak_function_log * );
 /*! \brief Функция завершает работу с библиотекой. */
@@ -125,6 +181,12 @@ extern "C" {
  dll_export ak_int64 ak_libakrypt_get_option_by_index( const size_t );
 /*! \brief Функция устанавливает значение заданной опции. */
  dll_export int ak_libakrypt_set_option( const char * , const ak_int64 );
+/*! \brief Функция возвращает значение опции по ее идентификатору. */
+ dll_export ak_int64 ak_libakrypt_get_option( const option_t );
+/*! \brief Функция устанавливает значение опции по ее идентификатору. */
+ dll_export int ak_libakrypt_set_option_value( const option_t , const ak_int64 );
+/*! \brief Функция возвращает согласованный набор значений всех опций библиотеки. */
+ dll_export int ak_libakrypt_get_options_snapshot( ak_options_snapshot );
 /*! \brief Функция считывает значения опций библиотеки из файла. */
  dll_export bool_t ak_libakrypt_load_options( void );
 /*! \brief Функция выводит текущие значения всех опций библиотеки. */
@@ -183,6 +245,17 @@ extern "C" {
 
 /** @}*//** @}*/
 
+/* ----------------------------------------------------------------------------------------------- */
+/** \addtogroup threads-doc Пул потоков библиотеки
+ @{ */
+/*! \brief Функция, выполняющая одно задание пула потоков (контекст, номер задания, номер потока). */
+ typedef int ( ak_function_thread_task )( ak_pointer , const size_t , const size_t );
+/*! \brief Количество рабочих потоков библиотеки. */
+ dll_export size_t ak_thread_pool_size( void );
+/*! \brief Выполнение группы заданий с помощью рабочих потоков библиотеки. */
+ dll_export int ak_thread_pool_run( ak_function_thread_task * , ak_pointer , const size_t );
+/** @} */
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Указатель на класс генератора псевдо-случайных чисел. */
  typedef struct random *ak_random;
@@ -652,10 +725,26 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
  typedef int ( ak_function_bckey_create ) ( ak_bckey );
 /*! \brief Функция зашифрования/расширования одного блока информации. */
  typedef void ( ak_function_bckey )( ak_skey, ak_pointer, ak_pointer );
+/*! \brief Функция зашифрования/расширования последовательности независимых блоков информации. */
+ typedef void ( ak_function_bckey_blocks )( ak_skey, ak_pointer, ak_pointer, size_t );
 /*! \brief Функция, предназначенная для зашифрования/расшифрования области памяти заданного размера */
  typedef int ( ak_function_bckey_encrypt )( ak_bckey, ak_pointer, ak_pointer, size_t,
                                                                                 ak_pointer, size_t );
 /* ----------------------------------------------------------------------------------------------- */
+/*! \brief Значения опций библиотеки, используемые ключом блочного алгоритма шифрования.
+    \details Значения копируются из опций библиотеки при создании ключа, поэтому режимы
+    шифрования не обращаются к опциям библиотеки при каждом вызове. Ресурс ключа и длина
+    секции режима ACPKM могут быть изменены для отдельного ключа функцией ak_bckey_set_option(). */
+ typedef struct bckey_options {
+  /*! \brief Флаг совместимости с библиотекой openssl (не изменяется после создания ключа). */
+   ak_int64 openssl_compability;
+  /*! \brief Ресурс ключа (количество блоков), устанавливаемый при присвоении ключа. */
+   ak_int64 cipher_resource;
+  /*! \brief Количество блоков в одной секции режима ACPKM. */
+   ak_int64 acpkm_section_block_count;
+ } *ak_bckey_options;
+
+/* ----------------------------------------------------------------------------------------------- */
 /*! \brief Секретный ключ блочного алгоритма шифрования. */
  struct bckey {
   /*! \brief Указатель на секретный ключ. */
@@ -672,10 +761,18 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
    ak_function_bckey *encrypt;
   /*! \brief Функция расширования одного блока информации. */
    ak_function_bckey *decrypt;
+  /*! \brief Функция зашифрования заданного количества независимых блоков информации.
+      \details Блоки обрабатываются одновременно, с чередованием раундов преобразования,
+      что позволяет процессору не простаивать в ожидании результатов обращений к таблицам. */
+   ak_function_bckey_blocks *encrypt_blocks;
+  /*! \brief Функция расшифрования заданного количества независимых блоков информации. */
+   ak_function_bckey_blocks *decrypt_blocks;
   /*! \brief Функция развертки ключа. */
    ak_function_skey *schedule_keys;
   /*! \brief Функция уничтожения развернутых ключей. */
    ak_function_skey *delete_keys;
+  /*! \brief Значения опций библиотеки, используемые ключом. */
+   struct bckey_options options;
 };
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -694,11 +791,24 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
 /*! \brief Присвоение ключу алгоритма блочного шифрования значения, выработанного из пароля. */
  dll_export int ak_bckey_set_key_from_password( ak_bckey ,
                                 const ak_pointer , const size_t , const ak_pointer , const size_t );
+/*! \brief Изменение значения опции библиотеки для отдельного ключа блочного шифрования. */
+ dll_export int ak_bckey_set_option( ak_bckey , const option_t , const ak_int64 );
 /** @} */
 
 /* ----------------------------------------------------------------------------------------------- */
 /** \addtogroup enc-doc Шифрование данных
  @{ */
+/*! \brief Фрагмент данных, расположенный в памяти независимо от остальных фрагментов.
+    \details Массивы фрагментов позволяют обрабатывать данные, размещенные в нескольких областях
+    памяти (например, заголовок и содержимое сетевого пакета), без их предварительного
+    копирования в одну область. */
+ typedef struct iovector {
+  /*! \brief Указатель на данные. */
+   ak_pointer data;
+  /*! \brief Длина данных (в октетах). */
+   size_t size;
+ } *ak_iovector;
+
 /*! \brief Нелинейная перестановка для алгоритмов хеширования и блочного шифрования */
  typedef ak_uint8 sbox[256];
 /*! \brief Набор таблиц замен для блочного шифра Магма. */
@@ -709,6 +819,10 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
  typedef ak_uint8 linear_register[16];
 /*! \brief Таблица, используемая для эффективной реализации алгоритма шифрования Кузнечик. */
  typedef ak_uint64 expanded_table[16][256][2];
+/*! \brief Таблицы умножения на элементы матрицы линейного преобразования, используемые
+    векторной реализацией алгоритма шифрования Кузнечик (по 16 значений для младшей и
+    старшей тетрад каждого байта). */
+ typedef ak_uint8 shuffle_table[16][16][32];
 /*! \brief Структура, содержащая параметры алгоритма блочного шифрования Кузнечик. */
  typedef struct kuznechik_params {
   /*! \brief Линейный регистр сдвига */
@@ -719,12 +833,16 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
    sbox pi;
   /*! \brief Развернутые таблицы, используемые для эффективного зашифрования */
    expanded_table enc;
+  /*! \brief Таблицы, используемые векторной реализацией зашифрования */
+   shuffle_table venc;
   /*! \brief Обратная матрица, к 16й степени сопровождающей матрицы линейного регистра сдвига. */
    linear_matrix Linv;
   /*! \brief Обратная нелинейная перестановка. */
    sbox pinv;
   /*! \brief Развернутые таблицы, используемые для эффективного расшифрования */
    expanded_table dec;
+  /*! \brief Таблицы, используемые векторной реализацией расшифрования */
+   shuffle_table vdec;
  } *ak_kuznechik_params;
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -743,6 +861,9 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
 /*! \brief Шифрование данных в режиме гаммирования из ГОСТ Р 34.13-2015
    (counter mode, ctr). */
  dll_export int ak_bckey_ctr( ak_bckey , ak_pointer , ak_pointer , size_t , ak_pointer , size_t );
+/*! \brief Шифрование в режиме гаммирования данных, разбитых на несколько фрагментов. */
+ dll_export int ak_bckey_ctr_v( ak_bckey , ak_iovector , const size_t , ak_iovector ,
+                                                               const size_t , ak_pointer , size_t );
 /*! \brief Шифрование данных в режиме гаммирования с обратной связью по выходу
    (output feedback, ofb). */
  dll_export int ak_bckey_ofb( ak_bckey , ak_pointer , ak_pointer , size_t , ak_pointer , size_t );
@@ -763,6 +884,23 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
 /*! \brief Расшифрование данных в режиме `XTS`. */
  dll_export int ak_bckey_decrypt_xts( ak_bckey ,  ak_bckey , ak_pointer , ak_pointer , size_t ,
                                                                              ak_pointer , size_t );
+/*! \brief Шифрование данных в режиме гаммирования с использованием пула потоков библиотеки. */
+ dll_export int ak_bckey_ctr_parallel( ak_bckey , ak_pointer , ak_pointer , size_t ,
+                                                                             ak_pointer , size_t );
+/*! \brief Расшифрование данных в режиме простой замены с зацеплением
+    с использованием пула потоков библиотеки. */
+ dll_export int ak_bckey_decrypt_cbc_parallel( ak_bckey , ak_pointer , ak_pointer , size_t ,
+                                                                             ak_pointer , size_t );
+/*! \brief Расшифрование данных в режиме гаммирования с обратной связью по шифртексту
+    с использованием пула потоков библиотеки. */
+ dll_export int ak_bckey_decrypt_cfb_parallel( ak_bckey , ak_pointer , ak_pointer , size_t ,
+                                                                             ak_pointer , size_t );
+/*! \brief Зашифрование данных в режиме `XTS` с использованием пула потоков библиотеки. */
+ dll_export int ak_bckey_encrypt_xts_parallel( ak_bckey ,  ak_bckey , ak_pointer , ak_pointer ,
+                                                                     size_t , ak_pointer , size_t );
+/*! \brief Расшифрование данных в режиме `XTS` с использованием пула потоков библиотеки. */
+ dll_export int ak_bckey_decrypt_xts_parallel( ak_bckey ,  ak_bckey , ak_pointer , ak_pointer ,
+                                                                     size_t , ak_pointer , size_t );
 /** @} */
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -792,6 +930,9 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Максимальный размер блока входных данных в октетах (байтах). */
  #define ak_mac_max_buffer_size (64)
+/*! \brief Размер буффера (в октетах), используемого для последовательного чтения файлов
+    функцией ak_mac_file(), если отображение файлов в память не поддерживается. */
+ #define ak_mac_file_buffer_size (1048576)
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Контекст алгоритма итерационного сжатия. */
@@ -829,13 +970,46 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
   size_t hsize;
 } *ak_streebog;
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Длина листа (в октетах) для функций древовидного хеширования. */
+ #define ak_hash_tree_leaf_size (1048576)
+/*! \brief Максимальное количество хеш-кодов поддеревьев, хранимых в контексте
+    древовидного хеширования (определяет максимальный объем хешируемых данных). */
+ #define ak_hash_tree_max_depth (48)
+
+/*! \brief Структура для хранения внутренних данных функций древовидного хеширования,
+    построенных на основе функций хеширования семейства Стрибог. */
+/*! \details Хешируемые данные разбиваются на листья длины \ref ak_hash_tree_leaf_size октетов
+    (последний лист может быть короче). Хеш-код листа вычисляется как хеш-код данных листа,
+    дополненных октетом 0x00; хеш-код внутренней вершины вычисляется как хеш-код конкатенации
+    хеш-кодов левого и правого поддеревьев, дополненной октетом 0x01. Дерево строится
+    слева направо: полные поддеревья объединяются сразу после их вычисления, а оставшиеся
+    после обработки последнего листа поддеревья объединяются справа налево.
+
+    Структура занимает около трех килобайт, поэтому в контексте \ref hash хранится только
+    указатель на нее, а сама структура размещается в динамической памяти.                          */
+ typedef struct streebog_tree {
+ /*! \brief Контекст функции хеширования текущего листа. */
+  struct streebog leaf;
+ /*! \brief Количество октетов, обработанных в текущем листе. */
+  size_t length;
+ /*! \brief Количество полностью обработанных листьев. */
+  ak_uint64 leaves;
+ /*! \brief Количество хеш-кодов поддеревьев в стеке (равно количеству единиц в записи leaves). */
+  size_t depth;
+ /*! \brief Стек хеш-кодов полных поддеревьев, упорядоченных по убыванию их высоты. */
+  ak_uint8 stack[ ak_hash_tree_max_depth ][64];
+} *ak_streebog_tree;
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Контекст бесключевой функции хеширования. */
 /*! \details Класс предоставляет интерфейс для реализации бесключевых функций хеширования, построенных
     с использованием итеративных сжимающих отображений. В настоящее время
     с использованием класса \ref hash реализованы следующие отечественные алгоритмы хеширования
      - Стрибог256,
-     - Стрибог512.
+     - Стрибог512,
+     - древовидное хеширование на основе функций Стрибог256 и Стрибог512
+       (см. описание структуры \ref streebog_tree).
 
   Перед началом работы контекст функции хэширования должен быть инициализирован
   вызовом одной из функций инициализации, например, функции ak_hash_create_streebog256()
@@ -852,6 +1026,10 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
    union {
    /*! \brief Структура алгоритмов семейства Стрибог. */
     struct streebog sctx;
+   /*! \brief Указатель на структуру алгоритмов древовидного хеширования на основе функций
+       Стрибог; структура размещается в динамической памяти при создании контекста,
+       длина хеш-кода, как и для остальных функций, хранится в поле `sctx.hsize`. */
+    ak_streebog_tree tctx;
    } data;
  } *ak_hash;
 
@@ -860,6 +1038,10 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
  dll_export int ak_hash_create_streebog256( ak_hash );
 /*! \brief Инициализация контекста функции бесключевого хеширования ГОСТ Р 34.11-2012 (Стрибог512). */
  dll_export int ak_hash_create_streebog512( ak_hash );
+/*! \brief Инициализация контекста функции древовидного хеширования на основе функции Стрибог256. */
+ dll_export int ak_hash_create_streebog256_tree( ak_hash );
+/*! \brief Инициализация контекста функции древовидного хеширования на основе функции Стрибог512. */
+ dll_export int ak_hash_create_streebog512_tree( ak_hash );
 /*! \brief Инициализация контекста функции бесключевого хеширования по заданному OID алгоритма. */
  dll_export int ak_hash_create_oid( ak_hash, ak_oid );
 /*! \brief Уничтожение контекста функции хеширования. */
@@ -874,17 +1056,28 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
  dll_export int ak_hash_clean( ak_hash );
 /*! \brief Обновление состояния контекста хеширования. */
  dll_export int ak_hash_update( ak_hash , const ak_pointer , const size_t );
+/*! \brief Обновление состояния контекста хеширования данными, разбитыми на несколько фрагментов. */
+ dll_export int ak_hash_update_v( ak_hash , ak_iovector , const size_t );
 /*! \brief Обновление состояния и вычисление результата применения алгоритма хеширования. */
  dll_export int ak_hash_finalize( ak_hash , const ak_pointer , const size_t , ak_pointer , const size_t );
 /*! \brief Хеширование заданной области памяти. */
  dll_export int ak_hash_ptr( ak_hash , const ak_pointer , const size_t , ak_pointer , const size_t );
 /*! \brief Хеширование заданного файла. */
  dll_export int ak_hash_file( ak_hash , const char*, ak_pointer , const size_t );
+/*! \brief Хеширование нескольких независимых областей памяти. */
+ dll_export int ak_hash_ptr_multi( ak_hash , ak_pointer * , const size_t * ,
+                                                     ak_pointer * , const size_t , const size_t );
+/*! \brief Обновление состояния нескольких независимых контекстов хеширования. */
+ dll_export int ak_hash_update_multi( ak_hash * , ak_pointer * , const size_t , const size_t );
 /** @} */
 
 /* ----------------------------------------------------------------------------------------------- */
 /** \addtogroup skey-doc Cекретные ключи криптографических механизмов
  @{ */
+/*! \brief Количество 64-х битных слов в секретной части внутреннего состояния функции хеширования
+    (векторы h и \f$ \Sigma \f$ функции Стрибог), сохраняемой алгоритмом HMAC. */
+ #define ak_hmac_midstate_words (16)
+
 /*! \brief Секретный ключ алгоритма выработки имитовставки HMAC. */
 /*!  Алгоритм выработки имитовставки HMAC основан на двукратном применении бесключевой функции
      хеширования. Алгоритм описывается рекомендациями IETF RFC 2104 (см. также RFC 7836) и
@@ -898,7 +1091,11 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
      (с длиной хеш кода как 256 бит, так и 512 бит).
 
      \note Использование ключей, чья длина превышает размер блока бесключевой функции
-     хеширования, реализовано в соответствии с RFC 2104.                                           */
+     хеширования, реализовано в соответствии с RFC 2104.
+
+     Внутренние состояния функции хеширования, получаемые после обработки ключа, сложенного
+     с константами ipad и opad, вычисляются один раз при присвоении ключа и хранятся
+     в маскированном виде; маски сменяются при каждом использовании состояний.                     */
 /* ----------------------------------------------------------------------------------------------- */
  typedef struct hmac {
   /*! \brief Контекст секретного ключа */
@@ -907,6 +1104,14 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
    struct mac mctx;
   /*! \brief Контекст функции хеширования */
    struct hash ctx;
+  /*! \brief Маскированные внутреннее (ipad) и внешнее (opad) состояния функции хеширования. */
+   ak_uint64 midstate[2][ak_hmac_midstate_words];
+  /*! \brief Маски, наложенные на значения midstate. */
+   ak_uint64 mask[2][ak_hmac_midstate_words];
+  /*! \brief Значение вектора n после обработки одного блока (не является секретным). */
+   ak_uint64 midcount[8];
+  /*! \brief Флаг того, что значения midstate вычислены для текущего значения ключа. */
+   bool_t midstate_set;
 } *ak_hmac;
 
 /*! \brief Создание секретного ключа алгоритма выработки имитовставки HMAC на основе функции Стрибог256. */
@@ -970,6 +1175,14 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
  dll_export int ak_bckey_decrypt_mgm( ak_pointer , ak_pointer , const ak_pointer ,
     const size_t , const ak_pointer , ak_pointer , const size_t , const ak_pointer , const size_t ,
                                                                           ak_pointer, const size_t );
+/*! \brief Зашифрование в режиме `mgm` данных, разбитых на несколько фрагментов. */
+ dll_export int ak_bckey_encrypt_mgm_v( ak_pointer , ak_pointer , ak_iovector , const size_t ,
+                        ak_iovector , const size_t , ak_iovector , const size_t , const ak_pointer ,
+                                                     const size_t , ak_pointer , const size_t );
+/*! \brief Расшифрование в режиме `mgm` данных, разбитых на несколько фрагментов. */
+ dll_export int ak_bckey_decrypt_mgm_v( ak_pointer , ak_pointer , ak_iovector , const size_t ,
+                        ak_iovector , const size_t , ak_iovector , const size_t , const ak_pointer ,
+                                                     const size_t , ak_pointer , const size_t );
 /*! \brief Зашифрование данных в режиме `xtsmac` с одновременной выработкой имитовставки. */
  dll_export int ak_bckey_encrypt_xtsmac( ak_pointer , ak_pointer , const ak_pointer ,
     const size_t , const ak_pointer , ak_pointer , const size_t , const ak_pointer , const size_t ,
@@ -997,6 +1210,117 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
  dll_export int ak_bckey_decrypt_ctr_hmac( ak_pointer , ak_pointer , const ak_pointer ,
     const size_t , const ak_pointer , ak_pointer , const size_t , const ak_pointer , const size_t ,
                                                                           ak_pointer, const size_t );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Структура, содержащая текущее состояние внутренних переменных режима `mgm`
+   аутентифицированного шифрования. */
+ typedef struct mgm_ctx {
+  /*! \brief Текущее значение имитовставки. */
+   ak_uint128 sum;
+  /*! \brief Счетчик, значения которого используются при шифровании информации. */
+   ak_uint128 ycount;
+  /*! \brief Счетчик, значения которого используются при выработке имитовставки. */
+   ak_uint128 zcount;
+  /*! \brief Размер обработанных зашифровываемых/расшифровываемых данных в битах. */
+   ssize_t pbitlen;
+  /*! \brief Размер обработанных дополнительных данных в битах. */
+   ssize_t abitlen;
+  /*! \brief Флаги состояния контекста. */
+   ak_uint32 flags;
+} *ak_mgm_ctx;
+
+/*! \brief Контекст потокового аутентифицированного шифрования в режиме `mgm`. */
+ typedef struct mgm_stream {
+  /*! \brief Внутреннее состояние алгоритма. */
+   struct mgm_ctx state;
+  /*! \brief Ключ шифрования. */
+   ak_bckey encryptionKey;
+  /*! \brief Ключ выработки имитовставки. */
+   ak_bckey authenticationKey;
+  /*! \brief Неполный блок ассоциированных данных, ожидающий обработки. */
+   ak_uint8 abuffer[16];
+  /*! \brief Количество октетов в буффере ассоциированных данных. */
+   size_t alength;
+  /*! \brief Неполный блок шифруемых данных, ожидающий обработки. */
+   ak_uint8 buffer[16];
+  /*! \brief Количество октетов в буффере шифруемых данных. */
+   size_t length;
+} *ak_mgm_stream;
+
+/*! \brief Инициализация контекста потокового шифрования в режиме `mgm`. */
+ dll_export int ak_mgm_stream_init( ak_mgm_stream , ak_bckey , ak_bckey ,
+                                                                const ak_pointer , const size_t );
+/*! \brief Обработка очередного фрагмента ассоциированных данных в режиме `mgm`. */
+ dll_export int ak_mgm_stream_aad_update( ak_mgm_stream , const ak_pointer , const size_t );
+/*! \brief Зашифрование очередного фрагмента данных в режиме `mgm`. */
+ dll_export ssize_t ak_mgm_stream_encrypt_update( ak_mgm_stream , const ak_pointer ,
+                                                                       ak_pointer , const size_t );
+/*! \brief Завершение зашифрования данных в режиме `mgm` и выработка имитовставки. */
+ dll_export ssize_t ak_mgm_stream_encrypt_finalize( ak_mgm_stream , ak_pointer ,
+                                                                       ak_pointer , const size_t );
+/*! \brief Расшифрование очередного фрагмента данных в режиме `mgm`. */
+ dll_export ssize_t ak_mgm_stream_decrypt_update( ak_mgm_stream , const ak_pointer ,
+                                                                       ak_pointer , const size_t );
+/*! \brief Завершение расшифрования данных в режиме `mgm` и проверка имитовставки. */
+ dll_export ssize_t ak_mgm_stream_decrypt_finalize( ak_mgm_stream , ak_pointer ,
+                                                                 const ak_pointer , const size_t );
+/*! \brief Очистка контекста потокового шифрования в режиме `mgm`. */
+ dll_export int ak_mgm_stream_destroy( ak_mgm_stream );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Структура, содержащая текущее состояние внутренних переменных режима `xtsmac`
+   аутентифицированного шифрования. */
+ typedef struct xtsmac_ctx {
+  /*! \brief Текущее значение имитовставки. */
+   ak_uint64 sum[2];
+  /*! \brief Вектор, используемый для маскирования шифруемой информации. */
+   ak_uint64 gamma[6];
+  /*! \brief Размер обработанных зашифровываемых/расшифровываемых данных в битах. */
+   ssize_t pbitlen;
+  /*! \brief Размер обработанных ассоциированных данных в битах. */
+   ssize_t abitlen;
+  /*! \brief Флаги состояния контекста. */
+   ak_uint32 flags;
+} *ak_xtsmac_ctx;
+
+/*! \brief Контекст потокового аутентифицированного шифрования в режиме `xtsmac`. */
+ typedef struct xtsmac_stream {
+  /*! \brief Внутреннее состояние алгоритма. */
+   struct xtsmac_ctx state;
+  /*! \brief Ключ шифрования. */
+   ak_bckey encryptionKey;
+  /*! \brief Ключ выработки имитовставки. */
+   ak_bckey authenticationKey;
+  /*! \brief Неполный блок ассоциированных данных, ожидающий обработки. */
+   ak_uint8 abuffer[16];
+  /*! \brief Количество октетов в буффере ассоциированных данных. */
+   size_t alength;
+  /*! \brief Последние октеты шифруемых данных, обработка которых откладывается
+      до вызова функции завершения (режим использует "скрадывание" шифртекста). */
+   ak_uint8 buffer[32];
+  /*! \brief Количество октетов в буффере шифруемых данных. */
+   size_t length;
+} *ak_xtsmac_stream;
+
+/*! \brief Инициализация контекста потокового шифрования в режиме `xtsmac`. */
+ dll_export int ak_xtsmac_stream_init( ak_xtsmac_stream , ak_bckey , ak_bckey ,
+                                                                const ak_pointer , const size_t );
+/*! \brief Обработка очередного фрагмента ассоциированных данных в режиме `xtsmac`. */
+ dll_export int ak_xtsmac_stream_aad_update( ak_xtsmac_stream , const ak_pointer , const size_t );
+/*! \brief Зашифрование очередного фрагмента данных в режиме `xtsmac`. */
+ dll_export ssize_t ak_xtsmac_stream_encrypt_update( ak_xtsmac_stream , const ak_pointer ,
+                                                                       ak_pointer , const size_t );
+/*! \brief Завершение зашифрования данных в режиме `xtsmac` и выработка имитовставки. */
+ dll_export ssize_t ak_xtsmac_stream_encrypt_finalize( ak_xtsmac_stream , ak_pointer ,
+                                                                       ak_pointer , const size_t );
+/*! \brief Расшифрование очередного фрагмента данных в режиме `xtsmac`. */
+ dll_export ssize_t ak_xtsmac_stream_decrypt_update( ak_xtsmac_stream , const ak_pointer ,
+                                                                       ak_pointer , const size_t );
+/*! \brief Завершение расшифрования данных в режиме `xtsmac` и проверка имитовставки. */
+ dll_export ssize_t ak_xtsmac_stream_decrypt_finalize( ak_xtsmac_stream , ak_pointer ,
+                                                                 const ak_pointer , const size_t );
+/*! \brief Очистка контекста потокового шифрования в режиме `xtsmac`. */
+ dll_export int ak_xtsmac_stream_destroy( ak_xtsmac_stream );
 /** @} */
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -1073,12 +1397,39 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
                                                          ak_uint64 *, ak_uint64 *, const size_t );
 /*! \brief Удвоение на двойку в представлении Монтгомери. */
  dll_export void ak_mpzn_lshift_montgomery( ak_uint64 *, ak_uint64 *, ak_uint64 *, const size_t );
-/*! \brief Умножение двух вычетов в представлении Монтгомери. */
+/*! \brief Умножение двух вычетов в представлении Монтгомери (используется реализация,
+    выбранная при инициализации библиотеки). */
  dll_export void ak_mpzn_mul_montgomery( ak_uint64 *, ak_uint64 *, ak_uint64 *,
                                                            ak_uint64 *, ak_uint64, const size_t );
+/*! \brief Умножение двух вычетов в представлении Монтгомери без использования
+    расширений системы команд. */
+ dll_export void ak_mpzn_mul_montgomery_uint64( ak_uint64 *, ak_uint64 *, ak_uint64 *,
+                                                           ak_uint64 *, ak_uint64, const size_t );
+#ifdef AK_HAVE_BUILTIN_MULX_ADX
+/*! \brief Умножение двух вычетов в представлении Монтгомери, использующее инструкции
+    mulx, adcx и adox. */
+ dll_export void ak_mpzn_mul_montgomery_mulx( ak_uint64 *, ak_uint64 *, ak_uint64 *,
+                                                           ak_uint64 *, ak_uint64, const size_t );
+#endif
+/*! \brief Умножение двух вычетов в представлении Монтгомери по модулю вида
+    \f$ 2^{64\cdot size} - c \f$. */
+ dll_export void ak_mpzn_mul_montgomery_pseudo_mersenne_uint64( ak_uint64 *, ak_uint64 *,
+                                              ak_uint64 *, ak_uint64 *, ak_uint64, const size_t );
+#ifdef AK_HAVE_BUILTIN_MULX_ADX
+/*! \brief Умножение двух вычетов в представлении Монтгомери по модулю вида
+    \f$ 2^{64\cdot size} - c \f$, использующее инструкции mulx, adcx и adox. */
+ dll_export void ak_mpzn_mul_montgomery_pseudo_mersenne_mulx( ak_uint64 *, ak_uint64 *,
+                                              ak_uint64 *, ak_uint64 *, ak_uint64, const size_t );
+#endif
 /*! \brief Модульное возведение в степень в представлении Монтгомери. */
  dll_export void ak_mpzn_modpow_montgomery( ak_uint64 *, ak_uint64 *, ak_uint64 *,
                                                            ak_uint64 *, ak_uint64, const size_t );
+/*! \brief Вычисление обратного вычета в представлении Монтгомери
+    (время вычисления не зависит от значения вычета). */
+ dll_export void ak_mpzn_modinv_montgomery( ak_uint64 *, ak_uint64 *,
+                                                           ak_uint64 *, ak_uint64, const size_t );
+/*! \brief Вычисление обратного вычета с помощью бинарного алгоритма Евклида. */
+ dll_export void ak_mpzn_modinv_binary( ak_uint64 *, ak_uint64 *, ak_uint64 *, const size_t );
 /* ----------------------------------------------------------------------------------------------- */
 #ifdef AK_HAVE_GMP_H
 /*! \brief Преобразование ak_mpznxxx в mpz_t. */
@@ -1136,6 +1487,25 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
  dll_export void ak_wpoint_reduce( ak_wpoint , ak_wcurve );
 /*! \brief Вычисление кратной точки эллиптической кривой. */
  dll_export void ak_wpoint_pow( ak_wpoint , ak_wpoint , ak_uint64 *, size_t , ak_wcurve );
+/*! \brief Вычисление кратной точки для образующей точки эллиптической кривой
+    с использованием предвычисленной таблицы. */
+ dll_export void ak_wpoint_pow_base( ak_wpoint , ak_uint64 *, size_t , ak_wcurve );
+/*! \brief Вычисление суммы кратных образующей точки и заданной точки эллиптической кривой
+    (функция не является функцией с постоянным временем выполнения). */
+ dll_export void ak_wpoint_pow_base_sum( ak_wpoint , ak_uint64 *,
+                                                  ak_wpoint , ak_uint64 *, size_t , ak_wcurve );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вид модуля \f$ p \f$ эллиптической кривой, определяющий реализацию умножения
+    по этому модулю (см. \ref ak_wcurve_mul). */
+ typedef enum {
+  /*! \brief Произвольный простой модуль, используется умножение Монтгомери общего вида. */
+   wcurve_field_montgomery = 0,
+  /*! \brief Модуль вида \f$ p = 2^{64\cdot size} - c \f$, где \f$ c < 2^{32} \f$. */
+   wcurve_field_pseudo_mersenne = 1
+ } wcurve_field_t;
+/*! \brief Количество различных видов модуля эллиптической кривой. */
+ #define ak_wcurve_field_count (2)
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Класс, реализующий эллиптическую кривую, заданную в короткой форме Вейерштрасса
@@ -1180,6 +1550,8 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
  /*! \brief Строка, содержащая символьную запись модуля \f$ p \f$.
      \details Используется для проверки корректного хранения параметров кривой в памяти. */
   const char *pchar;
+ /*! \brief Вид модуля \f$ p \f$, определяющий используемую реализацию умножения. */
+  wcurve_field_t field;
 };
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -1189,6 +1561,8 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
  dll_export int ak_wcurve_discriminant_is_ok( ak_wcurve );
 /*! \brief Проверка корректности параметров, необходимых для вычисления по модулю q. */
  dll_export int ak_wcurve_check_order_parameters( ak_wcurve );
+/*! \brief Проверка соответствия вида модуля эллиптической кривой значению модуля. */
+ dll_export int ak_wcurve_check_field( ak_wcurve );
 /*! \brief Проверка набора параметров эллиптической кривой, заданной в форме Вейерштрасса. */
  dll_export int ak_wcurve_is_ok( ak_wcurve );
 
@@ -1243,6 +1617,10 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
  dll_export void ak_gf256_mul_uint64( ak_pointer z, ak_pointer x, ak_pointer y );
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{512}}\f$. */
  dll_export void ak_gf512_mul_uint64( ak_pointer z, ak_pointer x, ak_pointer y );
+/*! \brief Сумма попарных произведений элементов поля \f$ \mathbb F_{2^{64}}\f$. */
+ dll_export void ak_gf64_mul_sum_uint64( ak_pointer , ak_pointer , ak_pointer , const size_t );
+/*! \brief Сумма попарных произведений элементов поля \f$ \mathbb F_{2^{128}}\f$. */
+ dll_export void ak_gf128_mul_sum_uint64( ak_pointer , ak_pointer , ak_pointer , const size_t );
 
 #ifdef AK_HAVE_BUILTIN_CLMULEPI64
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{64}}\f$. */
@@ -1253,17 +1631,12 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
  dll_export void ak_gf256_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b );
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{512}}\f$. */
  dll_export void ak_gf512_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b );
-
- #define ak_gf64_mul ak_gf64_mul_pcmulqdq
- #define ak_gf128_mul ak_gf128_mul_pcmulqdq
- #define ak_gf256_mul ak_gf256_mul_pcmulqdq
- #define ak_gf512_mul ak_gf512_mul_pcmulqdq
-#else
-
- #define ak_gf64_mul ak_gf64_mul_uint64
- #define ak_gf128_mul ak_gf128_mul_uint64
- #define ak_gf256_mul ak_gf256_mul_uint64
- #define ak_gf512_mul ak_gf512_mul_uint64
+/*! \brief Сумма попарных произведений элементов поля \f$ \mathbb F_{2^{64}}\f$
+    с однократным приведением по модулю. */
+ dll_export void ak_gf64_mul_sum_pcmulqdq( ak_pointer , ak_pointer , ak_pointer , const size_t );
+/*! \brief Сумма попарных произведений элементов поля \f$ \mathbb F_{2^{128}}\f$
+    с однократным приведением по модулю. */
+ dll_export void ak_gf128_mul_sum_pcmulqdq( ak_pointer , ak_pointer , ak_pointer , const size_t );
 #endif
 
 /* Размеры конечных полей (в октетах) */
@@ -1841,6 +2214,104 @@ dll_export int *ak_gost_1323565_1_006_2017( ak_oid, ak_random );
  dll_export bool_t ak_verifykey_verify_file( ak_verifykey , const char * , ak_pointer );
 /** @} *//** @} */
 
+/* ----------------------------------------------------------------------------------------------- */
+/** \addtogroup dispatch-doc Выбор реализаций в зависимости от возможностей процессора
+ @{
+   \details Реализации, использующие расширения системы команд процессора (pclmulqdq, ssse3, sse4.1, avx2),
+   компилируются всегда, но выбираются только после проверки возможностей процессора
+   во время выполнения функции ak_libakrypt_create(). До ее вызова, а также на процессорах
+   без соответствующих расширений, используются переносимые реализации.                           */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Процессор поддерживает инструкцию pclmulqdq. */
+ #define ak_cpu_feature_pclmul                     (0x1)
+/*! \brief Процессор поддерживает набор инструкций SSSE3. */
+ #define ak_cpu_feature_ssse3                      (0x2)
+/*! \brief Процессор поддерживает набор инструкций AVX2. */
+ #define ak_cpu_feature_avx2                       (0x4)
+/*! \brief Процессор поддерживает набор инструкций SSE4.1. */
+ #define ak_cpu_feature_sse41                      (0x8)
+/*! \brief Процессор поддерживает инструкции mulx, adcx и adox (расширения BMI2 и ADX). */
+ #define ak_cpu_feature_bmi2_adx                   (0x10)
+
+/*! \brief Функция умножения двух элементов конечного поля характеристики два. */
+ typedef void ( ak_function_gf_mul )( ak_pointer , ak_pointer , ak_pointer );
+/*! \brief Функция, прибавляющая к первому аргументу сумму попарных произведений элементов
+    двух массивов, содержащих заданное количество элементов конечного поля характеристики два. */
+ typedef void ( ak_function_gf_mul_sum )( ak_pointer , ak_pointer , ak_pointer , const size_t );
+/*! \brief Функция, реализующая преобразование LPS функции хеширования Стрибог. */
+ typedef void ( ak_function_streebog_lps )( ak_uint64 * , const ak_uint64 * );
+/*! \brief Функция сжатия g функции хеширования Стрибог (аргументы: вектор h, вектор n
+    или NULL, блок сообщения m). */
+ typedef void ( ak_function_streebog_g )( ak_uint64 * , const ak_uint64 * , const ak_uint64 * );
+/*! \brief Функция умножения двух вычетов в представлении Монтгомери. */
+ typedef void ( ak_function_mpzn_montgomery )( ak_uint64 *, ak_uint64 *, ak_uint64 *,
+                                                              ak_uint64 *, ak_uint64, const size_t );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Таблица реализаций, выбранных для используемого процессора. */
+ typedef struct cpu_dispatch {
+  /*! \brief Поддерживаемые процессором расширения (комбинация флагов ak_cpu_feature_xxx). */
+   ak_uint32 features;
+  /*! \brief Умножение в поле \f$ \mathbb F_{2^{64}}\f$. */
+   ak_function_gf_mul *gf64_mul;
+  /*! \brief Умножение в поле \f$ \mathbb F_{2^{128}}\f$. */
+   ak_function_gf_mul *gf128_mul;
+  /*! \brief Умножение в поле \f$ \mathbb F_{2^{256}}\f$. */
+   ak_function_gf_mul *gf256_mul;
+  /*! \brief Умножение в поле \f$ \mathbb F_{2^{512}}\f$. */
+   ak_function_gf_mul *gf512_mul;
+  /*! \brief Сумма попарных произведений в поле \f$ \mathbb F_{2^{64}}\f$. */
+   ak_function_gf_mul_sum *gf64_mul_sum;
+  /*! \brief Сумма попарных произведений в поле \f$ \mathbb F_{2^{128}}\f$. */
+   ak_function_gf_mul_sum *gf128_mul_sum;
+  /*! \brief Зашифрование последовательности блоков алгоритмом Кузнечик
+      (индекс массива определяет режим совместимости с openssl). */
+   ak_function_bckey_blocks *kuznechik_encrypt_blocks[2];
+  /*! \brief Расшифрование последовательности блоков алгоритмом Кузнечик. */
+   ak_function_bckey_blocks *kuznechik_decrypt_blocks[2];
+  /*! \brief Зашифрование последовательности блоков алгоритмом Магма. */
+   ak_function_bckey_blocks *magma_encrypt_blocks[2];
+  /*! \brief Расшифрование последовательности блоков алгоритмом Магма. */
+   ak_function_bckey_blocks *magma_decrypt_blocks[2];
+  /*! \brief Функция сжатия функции хеширования Стрибог. */
+   ak_function_streebog_g *streebog_g;
+  /*! \brief Умножение вычетов в представлении Монтгомери. */
+   ak_function_mpzn_montgomery *mpzn_mul_montgomery;
+  /*! \brief Умножение вычетов по модулю эллиптической кривой
+      (индекс массива определяет вид модуля, см. \ref wcurve_field_t). */
+   ak_function_mpzn_montgomery *wcurve_mul[ak_wcurve_field_count];
+  /*! \brief Название реализации умножения в конечных полях. */
+   const char *gf_mul_name;
+  /*! \brief Название реализации алгоритма Кузнечик. */
+   const char *kuznechik_name;
+  /*! \brief Название реализации алгоритма Магма. */
+   const char *magma_name;
+  /*! \brief Название реализации функции хеширования Стрибог. */
+   const char *streebog_name;
+  /*! \brief Название реализации умножения в представлении Монтгомери. */
+   const char *mpzn_name;
+ } *ak_cpu_dispatch;
+
+/*! \brief Таблица реализаций, используемых библиотекой. */
+ dll_export extern struct cpu_dispatch ak_libakrypt_dispatch;
+
+/*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{64}}\f$. */
+ #define ak_gf64_mul ( ak_libakrypt_dispatch.gf64_mul )
+/*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{128}}\f$. */
+ #define ak_gf128_mul ( ak_libakrypt_dispatch.gf128_mul )
+/*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{256}}\f$. */
+ #define ak_gf256_mul ( ak_libakrypt_dispatch.gf256_mul )
+/*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{512}}\f$. */
+ #define ak_gf512_mul ( ak_libakrypt_dispatch.gf512_mul )
+/*! \brief Сумма попарных произведений элементов поля \f$ \mathbb F_{2^{64}}\f$. */
+ #define ak_gf64_mul_sum ( ak_libakrypt_dispatch.gf64_mul_sum )
+/*! \brief Сумма попарных произведений элементов поля \f$ \mathbb F_{2^{128}}\f$. */
+ #define ak_gf128_mul_sum ( ak_libakrypt_dispatch.gf128_mul_sum )
+/*! \brief Умножение двух вычетов в представлении Монтгомери по модулю эллиптической кривой ec
+    (реализация выбирается в соответствии с видом модуля кривой). */
+ #define ak_wcurve_mul( ec ) ( ak_libakrypt_dispatch.wcurve_mul[( ec )->field] )
+/** @} */
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \addtogroup skey-doc
  @{ */